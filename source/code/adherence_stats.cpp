@@ -0,0 +1,146 @@
+#include "adherence_stats.h"
+#include "stats_store.h"
+#include "file_utils.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+	const uint32_t SKETCHES_MAGIC = 0x544B5345; // "ESKT"
+	const uint16_t SKETCHES_VERSION = 1;
+
+	// Layout: magic(u32) version(u16) metrics(u16) days(u16)
+	//         lifetime sketches, then for every day slot: day(i32) + sketches
+	struct SketchesHeader
+	{
+		uint32_t magic;
+		uint16_t version;
+		uint16_t metricCount;
+		uint16_t dayCount;
+	};
+}
+
+AdherenceStats::AdherenceStats() :
+	_dirty(false)
+{
+	for (int slot = 0; slot < DAYS; ++slot)
+		_days[slot] = -1;
+}
+
+bool AdherenceStats::Load(wxString const & path)
+{
+	_path = path;
+
+#ifdef WIN32
+	FILE * file = 0;
+	_wfopen_s(&file, path.c_str(), L"rb");
+#else
+	FILE * file = fopen(path.fn_str(), "rb");
+#endif
+	if (!file)
+		return false;
+
+	std::vector<unsigned char> content;
+	unsigned char chunk[4096];
+	size_t got;
+	while ((got = fread(chunk, 1, sizeof(chunk), file)) > 0)
+		content.insert(content.end(), chunk, chunk + got);
+	fclose(file);
+
+	SketchesHeader header;
+	if (content.size() < sizeof(header))
+		return false;
+	memcpy(&header, &content[0], sizeof(header));
+	if (header.magic != SKETCHES_MAGIC || header.version != SKETCHES_VERSION ||
+		header.metricCount != ADHERENCE_METRIC_COUNT || header.dayCount != DAYS)
+		return false;
+
+	const unsigned char * data = &content[0] + sizeof(header);
+	const unsigned char * end = &content[0] + content.size();
+
+	bool ok = true;
+	for (int metric = 0; metric < ADHERENCE_METRIC_COUNT && ok; ++metric)
+		ok = _lifetime[metric].Decode(data, end);
+
+	for (int slot = 0; slot < DAYS && ok; ++slot)
+	{
+		ok = end - data >= (long)sizeof(int32_t);
+		if (!ok)
+			break;
+		memcpy(&_days[slot], data, sizeof(int32_t));
+		data += sizeof(int32_t);
+
+		for (int metric = 0; metric < ADHERENCE_METRIC_COUNT && ok; ++metric)
+			ok = _daily[slot][metric].Decode(data, end);
+	}
+
+	if (!ok)
+	{
+		// corrupted file, start over
+		*this = AdherenceStats();
+		_path = path;
+	}
+	return ok;
+}
+
+bool AdherenceStats::Save() const
+{
+	if (_path.empty())
+		return false;
+
+	SketchesHeader header = { SKETCHES_MAGIC, SKETCHES_VERSION, ADHERENCE_METRIC_COUNT, DAYS };
+
+	std::string content(reinterpret_cast<const char*>(&header), sizeof(header));
+	for (int metric = 0; metric < ADHERENCE_METRIC_COUNT; ++metric)
+		_lifetime[metric].Encode(content);
+
+	for (int slot = 0; slot < DAYS; ++slot)
+	{
+		content.append(reinterpret_cast<const char*>(&_days[slot]), sizeof(int32_t));
+		for (int metric = 0; metric < ADHERENCE_METRIC_COUNT; ++metric)
+			_daily[slot][metric].Encode(content);
+	}
+
+	return writeFileAtomically(_path, content.data(), content.size());
+}
+
+void AdherenceStats::Add(AdherenceMetric metric, long ms)
+{
+	int today = StatsStore::Today();
+	int slot = today % DAYS;
+
+	if (_days[slot] != today)
+	{
+		for (int m = 0; m < ADHERENCE_METRIC_COUNT; ++m)
+			_daily[slot][m].Clear();
+		_days[slot] = today;
+	}
+
+	_daily[slot][metric].Add(ms);
+	_lifetime[metric].Add(ms);
+	_dirty = true;
+}
+
+bool AdherenceStats::Flush()
+{
+	if (!_dirty)
+		return true;
+
+	// a failed write is tried again with the next flush
+	_dirty = !Save();
+	return !_dirty;
+}
+
+QuantileSketch AdherenceStats::GetRecent(AdherenceMetric metric) const
+{
+	int today = StatsStore::Today();
+
+	QuantileSketch result;
+	for (int slot = 0; slot < DAYS; ++slot)
+	{
+		if (_days[slot] > today - DAYS && _days[slot] <= today)
+			result.Merge(_daily[slot][metric]);
+	}
+	return result;
+}
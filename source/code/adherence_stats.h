@@ -0,0 +1,48 @@
+#ifndef ADHERENCE_STATS_H
+#define ADHERENCE_STATS_H
+
+#include "wx/string.h"
+#include "quantile_sketch.h"
+
+enum AdherenceMetric
+{
+	ADHERENCE_RELAX_BEFORE_SKIP, // how long people rest before skipping a long break
+	ADHERENCE_RESPONSE_TIME, // how long it takes to answer BeforePauseWindow
+	ADHERENCE_SCREEN_TIME, // active time between two breaks
+
+	ADHERENCE_METRIC_COUNT
+};
+
+// Duration distributions for the last days and the whole lifetime, kept as sketches
+// instead of raw events. Changes are written to sketches.bin by Flush, which EyeApp
+// calls with the state journal and on exit, never on the way to a break.
+class AdherenceStats
+{
+public:
+	enum
+	{
+		DAYS = 7
+	};
+
+	AdherenceStats();
+
+	bool Load(wxString const & path);
+	bool Save() const;
+	// Saves when something was added since the last save
+	bool Flush();
+
+	void Add(AdherenceMetric metric, long ms);
+
+	QuantileSketch GetRecent(AdherenceMetric metric) const; // merged over the last DAYS days
+	QuantileSketch const & GetLifetime(AdherenceMetric metric) const { return _lifetime[metric]; }
+
+private:
+	wxString _path;
+	bool _dirty;
+
+	int32_t _days[DAYS]; // day number of every slot, see StatsStore::Today
+	QuantileSketch _daily[DAYS][ADHERENCE_METRIC_COUNT];
+	QuantileSketch _lifetime[ADHERENCE_METRIC_COUNT];
+};
+
+#endif
@@ -0,0 +1,119 @@
+#include "animation_driver.h"
+#include <math.h>
+
+AnimationDriver * g_Animations = 0;
+
+const wxString AnimationDriver::ADDRESS("AnimationDriver");
+
+namespace
+{
+	// The task manager wakes every 20 ms, a shorter period makes every wake a frame
+	const int FRAME_MS = 16;
+}
+
+float Ease(EEasing easing, float t)
+{
+	if (t <= 0.0f)
+		return 0.0f;
+	if (t >= 1.0f)
+		return 1.0f;
+
+	switch (easing)
+	{
+	case EASE_IN:
+		return t * t;
+	case EASE_OUT:
+		return t * (2.0f - t);
+	case EASE_IN_OUT:
+		return t * t * (3.0f - 2.0f * t);
+	default:
+		return t;
+	}
+}
+
+AnimationDriver::AnimationDriver() :
+	_ticking(false)
+{
+}
+
+void AnimationDriver::Fade(IFadeTarget * target, int from, int to, long durationMs, EEasing easing)
+{
+	Stop(target);
+
+	FadeState fade = { target, from, to, from, durationMs, easing, ::wxGetLocalTimeMillis() };
+	_fades.push_back(fade);
+	target->SetFadeAlpha(from);
+
+	if (!_ticking && g_TaskMgr)
+	{
+		_ticking = true;
+		g_TaskMgr->AddTask(ADDRESS, FRAME_MS);
+	}
+}
+
+void AnimationDriver::Stop(IFadeTarget * target)
+{
+	for (size_t i = 0; i < _fades.size(); ++i)
+	{
+		if (_fades[i].target == target)
+		{
+			_fades.erase(_fades.begin() + i);
+			return;
+		}
+	}
+}
+
+bool AnimationDriver::IsFading(IFadeTarget const * target) const
+{
+	for (size_t i = 0; i < _fades.size(); ++i)
+	{
+		if (_fades[i].target == target)
+			return true;
+	}
+	return false;
+}
+
+void AnimationDriver::ExecuteTask(float, long)
+{
+	tick(::wxGetLocalTimeMillis());
+
+	// tasks repeat until they are removed
+	if (_fades.empty() && _ticking)
+	{
+		_ticking = false;
+		if (g_TaskMgr)
+			g_TaskMgr->RemoveTasks(ADDRESS);
+	}
+}
+
+void AnimationDriver::tick(wxMilliClock_t now)
+{
+	std::vector<IFadeTarget *> finished;
+	for (size_t i = 0; i < _fades.size(); )
+	{
+		FadeState & fade = _fades[i];
+		long elapsed = (now - fade.start).ToLong();
+		float t = fade.duration > 0 ? (float)elapsed / fade.duration : 1.0f;
+		int alpha = fade.from + (int)floorf((fade.to - fade.from) * Ease(fade.easing, t) + 0.5f);
+
+		if (alpha != fade.alpha)
+		{
+			fade.alpha = alpha;
+			fade.target->SetFadeAlpha(alpha);
+		}
+
+		if (t >= 1.0f)
+		{
+			finished.push_back(fade.target);
+			_fades.erase(_fades.begin() + i);
+		}
+		else
+		{
+			++i;
+		}
+	}
+
+	// after the pass, the targets may start new fades or close themselves
+	for (size_t i = 0; i < finished.size(); ++i)
+		finished[i]->OnFadeFinished();
+}
@@ -0,0 +1,65 @@
+#ifndef ANIMATION_DRIVER_H
+#define ANIMATION_DRIVER_H
+
+#include "task_mgr.h"
+#include <vector>
+
+enum EEasing
+{
+	EASE_LINEAR,
+	EASE_IN,	// starts slowly, for fading out
+	EASE_OUT,	// ends slowly, for fading in
+	EASE_IN_OUT
+};
+
+// Progress of an eased animation, t is the share of its time in [0, 1]
+float Ease(EEasing easing, float t);
+
+class IFadeTarget
+{
+public:
+	virtual ~IFadeTarget() {}
+	virtual void SetFadeAlpha(int alpha) = 0;
+	// The fade reached its end. The target may start another one or close itself here.
+	virtual void OnFadeFinished() {}
+};
+
+// One clock for the fades of all overlays. It ticks only while something fades and
+// updates every target in one pass; values are computed from the start time of a fade,
+// so a late tick drops frames instead of making the fade longer.
+class AnimationDriver : public ITask
+{
+public:
+	AnimationDriver();
+
+	// Replaces the running fade of target. The from value is applied at once.
+	void Fade(IFadeTarget * target, int from, int to, long durationMs, EEasing easing);
+	// Must be called before the target is destroyed
+	void Stop(IFadeTarget * target);
+	bool IsFading(IFadeTarget const * target) const;
+
+	void ExecuteTask(float f, long time_went);
+
+	static const wxString ADDRESS;
+
+private:
+	struct FadeState
+	{
+		IFadeTarget * target;
+		int from;
+		int to;
+		int alpha;
+		long duration;
+		EEasing easing;
+		wxMilliClock_t start;
+	};
+
+	void tick(wxMilliClock_t now);
+
+	std::vector<FadeState> _fades;
+	bool _ticking;
+};
+
+extern AnimationDriver * g_Animations;
+
+#endif
@@ -0,0 +1,159 @@
+#include "backdrop.h"
+#include "main.h"
+#include "oscapabilities.h"
+#include "logging.h"
+#include "wx/stopwatch.h"
+#include <string.h>
+
+Backdrops::Backdrops(BlurWorkers & workers) :
+	_workers(workers),
+	_thread(0),
+	_ready(false)
+{
+}
+
+Backdrops::~Backdrops()
+{
+	if (_thread)
+	{
+		_thread->Wait();
+		delete _thread;
+	}
+}
+
+void Backdrops::Capture()
+{
+	wxStopWatch captureTime;
+
+	HDC screenDC = ::GetDC(NULL);
+	HDC memDC = CreateCompatibleDC(screenDC);
+	SetStretchBltMode(memDC, HALFTONE);
+	SetBrushOrgEx(memDC, 0, 0, NULL);
+
+	_frames.resize(osCaps.numDisplays);
+	for (int displayInd = 0; displayInd < osCaps.numDisplays; ++displayInd)
+	{
+		wxRect geometry = osCaps.displays[displayInd].geometry;
+		BackdropFrame & frame = _frames[displayInd];
+		frame.width = (geometry.GetWidth() + BACKDROP_SCALE - 1) / BACKDROP_SCALE;
+		frame.height = (geometry.GetHeight() + BACKDROP_SCALE - 1) / BACKDROP_SCALE;
+
+		BITMAPINFO info;
+		memset(&info, 0, sizeof(info));
+		info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+		info.bmiHeader.biWidth = frame.width;
+		info.bmiHeader.biHeight = -frame.height;
+		info.bmiHeader.biPlanes = 1;
+		info.bmiHeader.biBitCount = 32;
+		info.bmiHeader.biCompression = BI_RGB;
+
+		void * dibPixels = 0;
+		HBITMAP dib = CreateDIBSection(screenDC, &info, DIB_RGB_COLORS, &dibPixels, NULL, 0);
+		if (!dib)
+		{
+			LOG_WARNING("Can't capture display %d, error %u", displayInd, (unsigned)GetLastError());
+			frame.width = frame.height = 0;
+			continue;
+		}
+
+		// downscaled while it is captured, the blur doesn't need the full resolution
+		HGDIOBJ oldBitmap = SelectObject(memDC, dib);
+		StretchBlt(memDC, 0, 0, frame.width, frame.height, screenDC,
+			geometry.GetX(), geometry.GetY(), geometry.GetWidth(), geometry.GetHeight(), SRCCOPY | CAPTUREBLT);
+		GdiFlush();
+		SelectObject(memDC, oldBitmap);
+
+		frame.pixels.assign((const uint32_t *)dibPixels, (const uint32_t *)dibPixels + (size_t)frame.width * frame.height);
+		frame.temp.resize(frame.pixels.size());
+		DeleteObject(dib);
+	}
+
+	DeleteDC(memDC);
+	::ReleaseDC(NULL, screenDC);
+
+	LOG_INFO("Captured %d displays in %lld us", osCaps.numDisplays, (long long)captureTime.TimeInMicro().GetValue());
+
+	_thread = new BackdropThread(_frames, _workers);
+	if (_thread->Run() != wxTHREAD_NO_ERROR)
+	{
+		LOG_WARNING("Can't start the backdrop thread");
+		delete _thread;
+		_thread = 0;
+		_frames.clear();
+	}
+}
+
+bool Backdrops::IsReady()
+{
+	if (_ready || !_thread || _thread->IsRunning())
+		return _ready;
+
+	_thread->Wait();
+	LOG_INFO("Blurred the backdrops in %lld us on %d threads", _thread->GetBlurTime(), _thread->GetTiles());
+	delete _thread;
+	_thread = 0;
+
+	_ready = true;
+	return true;
+}
+
+void Backdrops::Draw(int displayInd, HDC dc, wxSize const & size) const
+{
+	if (!_ready || displayInd >= (int)_frames.size() || _frames[displayInd].pixels.empty())
+		return;
+
+	BackdropFrame const & frame = _frames[displayInd];
+
+	BITMAPINFO info;
+	memset(&info, 0, sizeof(info));
+	info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	info.bmiHeader.biWidth = frame.width;
+	info.bmiHeader.biHeight = -frame.height;
+	info.bmiHeader.biPlanes = 1;
+	info.bmiHeader.biBitCount = 32;
+	info.bmiHeader.biCompression = BI_RGB;
+
+	SetStretchBltMode(dc, HALFTONE);
+	SetBrushOrgEx(dc, 0, 0, NULL);
+	StretchDIBits(dc, 0, 0, size.GetWidth(), size.GetHeight(), 0, 0, frame.width, frame.height,
+		&frame.pixels[0], &info, DIB_RGB_COLORS, SRCCOPY);
+}
+
+////////////////////////////////////////////////////////////////////////
+
+BEGIN_EVENT_TABLE(BackdropWindow, wxFrame)
+	EVT_PAINT(BackdropWindow::OnPaint)
+	EVT_ERASE_BACKGROUND(BackdropWindow::OnErase)
+END_EVENT_TABLE()
+
+BackdropWindow::BackdropWindow(int displayInd) :
+	wxFrame(NULL, -1, L"", wxDefaultPosition, wxDefaultSize, wxFRAME_TOOL_WINDOW | wxNO_BORDER | wxFRAME_NO_TASKBAR | wxSTAY_ON_TOP),
+	_displayInd(displayInd)
+{
+	SetName(wxString("BackdropWindow") + (char)('0' + displayInd));
+
+	assert(displayInd < osCaps.numDisplays);
+	wxRect geometry = osCaps.displays[displayInd].geometry;
+	SetPosition(geometry.GetPosition());
+	SetSize(geometry.GetSize());
+}
+
+void BackdropWindow::ShowBelow(wxWindow * window)
+{
+	// the z-order is set while the window is hidden, showing it doesn't change it
+	SetWindowPos(GetHWND(), window->GetHWND(), 0, 0, 0, 0, SWP_NOACTIVATE | SWP_NOMOVE | SWP_NOSIZE);
+	ShowWithoutActivating();
+}
+
+void BackdropWindow::OnPaint(wxPaintEvent& WXUNUSED(evt))
+{
+	wxPaintDC dc(this);
+	Backdrops * backdrops = getApp()->GetBackdrops();
+	if (backdrops)
+		backdrops->Draw(_displayInd, dc.GetHDC(), GetClientSize());
+}
+
+void BackdropWindow::OnErase(wxEraseEvent& WXUNUSED(evt))
+{
+	// everything is painted by OnPaint
+}
@@ -0,0 +1,47 @@
+#ifndef BACKDROP_H
+#define BACKDROP_H
+
+#include "wx/wx.h"
+#include "backdrop_blur.h"
+
+// Blurred desktops of all the displays. Capture() takes the snapshots on the GUI thread,
+// they are blurred on worker threads while the big pause windows fade in.
+class Backdrops
+{
+public:
+	// The workers aren't owned, they outlive the backdrops
+	Backdrops(BlurWorkers & workers);
+	~Backdrops(); // waits for the blur
+
+	// Must be called before the big pause windows are shown, they would be in the snapshots
+	void Capture();
+	// Finishes the blur thread when it is done, never waits
+	bool IsReady();
+	// Stretches the backdrop of a display over size
+	void Draw(int displayInd, HDC dc, wxSize const & size) const;
+
+private:
+	std::vector<BackdropFrame> _frames;
+	BlurWorkers & _workers;
+	BackdropThread * _thread;
+	bool _ready;
+};
+
+// The backdrop of one display, shown right under its big pause window
+class BackdropWindow : public wxFrame
+{
+public:
+	BackdropWindow(int displayInd);
+
+	void ShowBelow(wxWindow * window);
+
+private:
+	void OnPaint(wxPaintEvent& evt);
+	void OnErase(wxEraseEvent& evt);
+
+	int _displayInd;
+
+	DECLARE_EVENT_TABLE()
+};
+
+#endif
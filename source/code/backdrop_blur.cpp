@@ -0,0 +1,193 @@
+#include "backdrop_blur.h"
+#include "pixel_kernels.h"
+#include "wx/stopwatch.h"
+
+namespace
+{
+	// Blur passes over columns, so the columns of one tile never depend on another tile.
+	// The horizontal passes run over the transposed frames.
+	enum EStage
+	{
+		STAGE_BLUR_COLUMNS,
+		STAGE_TRANSPOSE,
+		STAGE_BLUR_ROWS,
+		STAGE_TRANSPOSE_BACK,
+
+		STAGE_COUNT
+	};
+
+	const int MAX_BLUR_THREADS = 8;
+
+	// One tile of every frame: a range of columns when blurring, of rows when transposing
+	void runTile(std::vector<BackdropFrame> & frames, int stage, int tile, int tiles)
+	{
+		for (size_t i = 0; i < frames.size(); ++i)
+		{
+			BackdropFrame & frame = frames[i];
+			if (frame.pixels.empty())
+				continue;
+
+			bool transposed = stage >= STAGE_BLUR_ROWS;
+			int width = transposed ? frame.height : frame.width;
+			int height = transposed ? frame.width : frame.height;
+			uint32_t * pixels = &frame.pixels[0];
+			uint32_t * temp = &frame.temp[0];
+
+			if (stage == STAGE_BLUR_COLUMNS || stage == STAGE_BLUR_ROWS)
+			{
+				// odd pass count, the result is in temp
+				int first = width * tile / tiles;
+				int last = width * (tile + 1) / tiles;
+				for (int pass = 0; pass < BACKDROP_BLUR_PASSES; ++pass)
+				{
+					if (pass % 2 == 0)
+						pixelkernels::BlurColumns(pixels, temp, width, height, first, last, BACKDROP_BLUR_RADIUS);
+					else
+						pixelkernels::BlurColumns(temp, pixels, width, height, first, last, BACKDROP_BLUR_RADIUS);
+				}
+			}
+			else
+			{
+				pixelkernels::Transpose(temp, pixels, width, height, height * tile / tiles, height * (tile + 1) / tiles);
+			}
+		}
+	}
+}
+
+// Waits for the stages and does its tile of each one
+class BlurWorkers::Worker : public wxThread
+{
+public:
+	Worker(BlurWorkers & workers, int tile) :
+		wxThread(wxTHREAD_JOINABLE),
+		_workers(workers),
+		_tile(tile)
+	{
+	}
+
+protected:
+	virtual wxThread::ExitCode Entry()
+	{
+		_workers.Work(_tile);
+		return 0;
+	}
+
+private:
+	BlurWorkers & _workers;
+	int _tile;
+};
+
+BlurWorkers::BlurWorkers() :
+	_stageReady(_mutex),
+	_stageDone(_mutex),
+	_frames(0),
+	_stage(0),
+	_tiles(1),
+	_generation(0),
+	_pending(0),
+	_exitRequested(false)
+{
+}
+
+BlurWorkers::~BlurWorkers()
+{
+	{
+		wxMutexLocker lock(_mutex);
+		_exitRequested = true;
+		_stageReady.Broadcast();
+	}
+
+	for (size_t i = 0; i < _threads.size(); ++i)
+	{
+		_threads[i]->Wait();
+		delete _threads[i];
+	}
+}
+
+void BlurWorkers::RunStage(std::vector<BackdropFrame> & frames, int stage, int tiles)
+{
+	while ((int)_threads.size() < tiles - 1)
+	{
+		Worker * thread = new Worker(*this, (int)_threads.size() + 1);
+		if (thread->Run() != wxTHREAD_NO_ERROR)
+		{
+			delete thread;
+			break;
+		}
+		_threads.push_back(thread);
+	}
+
+	// tiles without a worker are done by this thread
+	int workerTiles = tiles - 1 < (int)_threads.size() ? tiles - 1 : (int)_threads.size();
+	{
+		wxMutexLocker lock(_mutex);
+		_frames = &frames;
+		_stage = stage;
+		_tiles = tiles;
+		_pending = workerTiles;
+		++_generation;
+		_stageReady.Broadcast();
+	}
+
+	runTile(frames, stage, 0, tiles);
+	for (int tile = workerTiles + 1; tile < tiles; ++tile)
+		runTile(frames, stage, tile, tiles);
+
+	wxMutexLocker lock(_mutex);
+	while (_pending > 0)
+		_stageDone.Wait();
+}
+
+void BlurWorkers::Work(int tile)
+{
+	unsigned int generation = 0;
+	for (;;)
+	{
+		std::vector<BackdropFrame> * frames;
+		int stage;
+		int tiles;
+		{
+			wxMutexLocker lock(_mutex);
+			while (!_exitRequested && _generation == generation)
+				_stageReady.Wait();
+			if (_exitRequested)
+				return;
+
+			generation = _generation;
+			if (tile >= _tiles)
+				continue;
+			frames = _frames;
+			stage = _stage;
+			tiles = _tiles;
+		}
+
+		runTile(*frames, stage, tile, tiles);
+
+		wxMutexLocker lock(_mutex);
+		if (--_pending == 0)
+			_stageDone.Signal();
+	}
+}
+
+BackdropThread::BackdropThread(std::vector<BackdropFrame> & frames, BlurWorkers & workers, int tiles) :
+	wxThread(wxTHREAD_JOINABLE),
+	_frames(frames),
+	_workers(workers),
+	_tiles(1),
+	_blurTime(0)
+{
+	int count = tiles > 0 ? tiles : wxThread::GetCPUCount();
+	if (count > MAX_BLUR_THREADS)
+		count = MAX_BLUR_THREADS;
+	if (count > 1)
+		_tiles = count;
+}
+
+wxThread::ExitCode BackdropThread::Entry()
+{
+	wxStopWatch blurTime;
+	for (int stage = 0; stage < STAGE_COUNT; ++stage)
+		_workers.RunStage(_frames, stage, _tiles);
+	_blurTime = blurTime.TimeInMicro().GetValue();
+	return 0;
+}
@@ -0,0 +1,79 @@
+#ifndef BACKDROP_BLUR_H
+#define BACKDROP_BLUR_H
+
+#include "wx/thread.h"
+#include <stdint.h>
+#include <vector>
+
+enum
+{
+	BACKDROP_SCALE = 4, // displays are captured at 1/BACKDROP_SCALE of their size
+	BACKDROP_BLUR_RADIUS = 12, // of each of the box blur passes, in reduced pixels
+	BACKDROP_BLUR_PASSES = 3 // three box blurs are close to a gaussian one
+};
+
+// Snapshot of a display at 1/BACKDROP_SCALE of its size, blurred behind a big pause window
+struct BackdropFrame
+{
+	int width;
+	int height;
+	std::vector<uint32_t> pixels;
+	std::vector<uint32_t> temp;
+
+	BackdropFrame() : width(0), height(0) {}
+};
+
+// Threads that blur the tiles besides the first one. They are started by the first blur
+// that needs them and wait for the stages of the next ones, until the workers are deleted.
+class BlurWorkers
+{
+public:
+	BlurWorkers();
+	~BlurWorkers(); // stops and joins the threads
+
+	// One stage of the blur over 'tiles' tiles of every frame, the calling thread does the first one.
+	// Returns when all of them are done. One caller at a time.
+	void RunStage(std::vector<BackdropFrame> & frames, int stage, int tiles);
+
+	int GetThreadCount() const { return (int)_threads.size(); }
+
+private:
+	class Worker;
+	void Work(int tile);
+
+	std::vector<Worker *> _threads; // the worker of tile i + 1 is the i-th
+
+	wxMutex _mutex;
+	wxCondition _stageReady;
+	wxCondition _stageDone;
+	std::vector<BackdropFrame> * _frames;
+	int _stage;
+	int _tiles;
+	unsigned int _generation; // of the stage, the workers wait for it to change
+	int _pending; // tiles of the stage the workers haven't finished
+	bool _exitRequested;
+};
+
+// Blurs the frames of all the displays in place. The stages run one after another,
+// each one split into a tile per core.
+class BackdropThread : public wxThread
+{
+public:
+	// tiles is 0 for one per core
+	BackdropThread(std::vector<BackdropFrame> & frames, BlurWorkers & workers, int tiles = 0);
+
+	int GetTiles() const { return _tiles; }
+	// read after the thread finished, logging is only done on the GUI thread
+	long long GetBlurTime() const { return _blurTime; }
+
+protected:
+	virtual wxThread::ExitCode Entry();
+
+private:
+	std::vector<BackdropFrame> & _frames;
+	BlurWorkers & _workers;
+	int _tiles;
+	long long _blurTime;
+};
+
+#endif
@@ -13,41 +13,31 @@ BEGIN_EVENT_TABLE(BeforePauseWindow, wxFrame)
 END_EVENT_TABLE()
 
 
-BeforePauseWindow::BeforePauseWindow(int displayInd, int postponeCount) :
+BeforePauseWindow::BeforePauseWindow(int displayInd) :
 	wxFrame(NULL, -1, L"", wxDefaultPosition, wxDefaultSize, wxFRAME_TOOL_WINDOW | wxFRAME_SHAPED | wxNO_BORDER | wxFRAME_NO_TASKBAR | wxSTAY_ON_TOP),
 	_preventClosing(true),
-	_readyTimer((float)eyeleo::settings::timeForLongBreakConfirmation),
+	_shownTime(0),
 	_result(RESULT_NONE),
-	_postponeCount(postponeCount),
+	_postponeCount(0),
 	_displayInd(displayInd),
 	_btnReady(nullptr),
+	_btnPostpone(nullptr),
+	_btnRefuse(nullptr),
 	_showing(true),
 	_hiding(false),
-	_alpha(0.0f)
+	_alpha(0)
 {
 	SetName("BeforePauseWindow");
 }
 
 void BeforePauseWindow::Init()
 {
-	wxRegion region(*_backBitmap, *wxWHITE);
-	SetShape(region);
+	SetShape(GetResourceShape(_backBitmap));
 
-	refillResolutionParams();
-
-	_showing = true;
-	_hiding = false;
-	_alpha = 0.0f;
-
-	SetTransparent((int)_alpha);
-
-	// Set position to center of the screen
+	SetTransparent(_alpha);
 	SetSize(wxSize(_backBitmap->GetWidth(), _backBitmap->GetHeight()));
-	assert(_displayInd < osCaps.numDisplays);
-	wxRect displayRect = osCaps.displays[_displayInd].clientArea;
-	SetPosition(wxPoint(displayRect.GetX() + displayRect.GetWidth() / 2 - GetSize().GetX() / 2, displayRect.GetY() + displayRect.GetHeight() / 2 - GetSize().GetY() / 2));
 
-	wxStaticText * txt = new wxStaticText(this, wxID_ANY, langPack->Get("before_pause_text"), wxDefaultPosition, wxDefaultSize, wxALIGN_CENTRE);
+	wxStaticText * txt = new wxStaticText(this, wxID_ANY, langPack->Get(StrId::before_pause_text), wxDefaultPosition, wxDefaultSize, wxALIGN_CENTRE);
 	wxFont font(15, wxFONTFAMILY_DEFAULT, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL, false);
 	txt->SetFont(font);
 	txt->SetBackgroundStyle(wxBG_STYLE_COLOUR);
@@ -60,121 +50,137 @@ void BeforePauseWindow::Init()
 	_btnReady->SetSize(110, _btnReady->GetSize().y);
 	_btnReady->SetBackgroundColour(wxColor(255, 255, 255, 0));
 	_btnReady->SetBackgroundStyle(wxBG_STYLE_COLOUR);
-	UpdateReadyTimer();
 
-	wxButton * btnPostpone = new wxButton(this, ID_BEFORE_PAUSE_GIVE_ME_TIME, langPack->Get("before_pause_postpone_button"));
-	btnPostpone->SetBackgroundColour(wxColor(255, 255, 255, 0));
-	btnPostpone->SetBackgroundStyle(wxBG_STYLE_COLOUR);
+	_btnPostpone = new wxButton(this, ID_BEFORE_PAUSE_GIVE_ME_TIME, langPack->Get(StrId::before_pause_postpone_button));
+	_btnPostpone->SetBackgroundColour(wxColor(255, 255, 255, 0));
+	_btnPostpone->SetBackgroundStyle(wxBG_STYLE_COLOUR);
 
+	_btnRefuse = new wxButton(this, ID_BEFORE_PAUSE_NO_THANKS, langPack->Get(StrId::before_pause_refuse_button));
+	_btnRefuse->SetBackgroundColour(wxColor(255, 255, 255, 0));
+	_btnRefuse->SetBackgroundStyle(wxBG_STYLE_COLOUR);
+	_btnRefuse->SetPosition(wxPoint(50, 102));
+
+	Connect(ID_BEFORE_PAUSE_NO_THANKS, wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler(BeforePauseWindow::OnRefuseClicked));
+	Connect(ID_BEFORE_PAUSE_IAM_READY, wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler(BeforePauseWindow::OnReadyClicked));
+	Connect(ID_BEFORE_PAUSE_GIVE_ME_TIME, wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler(BeforePauseWindow::OnPostponeClicked));
+}
+
+// Only the content of this request, the window may come from the pool
+void BeforePauseWindow::Start(int postponeCount)
+{
+	refillResolutionParams();
+
+	// Set position to center of the screen
+	assert(_displayInd < osCaps.numDisplays);
+	SetPosition(centerInClientArea(_displayInd, GetSize()));
+
+	_postponeCount = postponeCount;
+	_result = RESULT_NONE;
+	_showing = true;
+	_hiding = false;
+	_preventClosing = true;
+	_alpha = 0;
+	SetTransparent(_alpha);
+
+	_readyTimer.Start(eyeleo::settings::timeForLongBreakConfirmation * 1000L);
+	UpdateReadyTimer();
+
+	// the break can only be refused after it was postponed
+	_btnRefuse->Show(_postponeCount >= 1);
 	if (_postponeCount < 1)
 	{
-		btnPostpone->SetPosition(wxPoint(70, 102));
+		_btnPostpone->SetPosition(wxPoint(70, 102));
 		_btnReady->SetPosition(wxPoint(270, 102));
 	}
 	else
 	{
-		wxButton * btnRefuse = new wxButton(this, ID_BEFORE_PAUSE_NO_THANKS, langPack->Get("before_pause_refuse_button"));
-		btnRefuse->SetBackgroundColour(wxColor(255, 255, 255, 0));
-		btnRefuse->SetBackgroundStyle(wxBG_STYLE_COLOUR);
-
-		btnRefuse->SetPosition(wxPoint(50, 102));
-		btnPostpone->SetPosition(wxPoint(160, 102));
+		_btnPostpone->SetPosition(wxPoint(160, 102));
 		_btnReady->SetPosition(wxPoint(300, 102));
 	}
 
-	Connect(ID_BEFORE_PAUSE_NO_THANKS, wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler(BeforePauseWindow::OnRefuseClicked));
-	Connect(ID_BEFORE_PAUSE_IAM_READY, wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler(BeforePauseWindow::OnReadyClicked));
-	Connect(ID_BEFORE_PAUSE_GIVE_ME_TIME, wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler(BeforePauseWindow::OnPostponeClicked));
-
-	g_TaskMgr->AddTask(GetName(), 20);
+	_shownTime = ::wxGetLocalTimeMillis();
+	g_Animations->Fade(this, 0, 210, 400, EASE_OUT);
 }
 
 BeforePauseWindow::~BeforePauseWindow()
 {
-	logging::msg("BeforePauseWindow::~BeforePauseWindow");
+	LOG_DEBUG("BeforePauseWindow::~BeforePauseWindow");
 
 	if (!getApp()->isFinished())
 		g_TaskMgr->RemoveTasks(GetName());
+	if (g_Animations)
+		g_Animations->Stop(this);
 
 	getApp()->OnCloseBeforePauseWnd(this);
 }
 
 void BeforePauseWindow::UpdateReadyTimer()
 {
-	int iReadyTimer = (int)(_readyTimer + 1.0f);
-	wxString readyText = wxString::Format(langPack->Get("before_pause_accept_button"), iReadyTimer);
+	int iReadyTimer = _readyTimer.GetSecondsLeft();
+	wxString readyText = wxString::Format(langPack->Get(StrId::before_pause_accept_button), iReadyTimer);
 	_btnReady->SetLabel(readyText);
 }
 
 void BeforePauseWindow::ExecuteTask(float f, long time_went)
 {
+	(void)f;
 	(void)time_went;
 
-	if (!_showing && !_hiding && _alpha > 0.0f)
+	if (!_showing && !_hiding && _alpha > 0)
 	{
-		_readyTimer -= 0.1f * f;
-		
 		UpdateReadyTimer();
 		
-		if (_readyTimer <= 0)
+		if (_readyTimer.IsExpired())
 		{
-			g_TaskMgr->AddTask(GetName(), 20);
 			_result = RESULT_ACCEPT;
-			_hiding = true;
+			StartHiding();
 		}
 		else
 		{
-			g_TaskMgr->AddTask(GetName(), 100);
+			g_TaskMgr->AddTask(GetName(), _readyTimer.GetTimeToNextSecond());
 		}
 	}
+}
 
-	if (_showing)
-	{
-		_alpha += 11.0f * f;
-		if (_alpha >= 210.0f)
-		{
-			_alpha = 210.0f;
-			_showing = false;
-			
-			g_TaskMgr->AddTask(GetName(), 100);
-		}
-		else
-		{
-			g_TaskMgr->AddTask(GetName(), 20);
-		}
-		SetTransparent((int)_alpha);
-	}
+void BeforePauseWindow::SetFadeAlpha(int alpha)
+{
+	_alpha = alpha;
+	SetTransparent(_alpha);
 
+	if (_showing && _alpha > 0)
+		getApp()->OnOverlayVisible(GetName());
+}
+
+void BeforePauseWindow::OnFadeFinished()
+{
 	if (_hiding)
 	{
-		_alpha -= 15.0f * f;
-		if (_alpha <= 0.0f)
+		_hiding = false;
+		_preventClosing = false;
+		
+		if (_result == RESULT_ACCEPT)
 		{
-			_alpha = 0.0f;
-			_hiding = false;
-			_preventClosing = false;
-			
-			if (_result == RESULT_ACCEPT)
-			{
-				getApp()->StartBigPause();
-			}
-			else if (_result == RESULT_POSTPONE)
-			{
-				getApp()->PostponeBigPause();
-			}
-			else if (_result == RESULT_REFUSE)
-			{
-				getApp()->RefuseBigPause();
-			}
-			
-			Close();
-			g_TaskMgr->RemoveTasks(GetName());
+			getApp()->StartBigPause();
 		}
-		else
+		else if (_result == RESULT_POSTPONE)
+		{
+			getApp()->PostponeBigPause();
+		}
+		else if (_result == RESULT_REFUSE)
 		{
-			SetTransparent((int)_alpha);
-			g_TaskMgr->AddTask(GetName(), 20);
+			getApp()->RefuseBigPause();
 		}
+		
+		g_TaskMgr->RemoveTasks(GetName());
+		if (!getApp()->OnBeforePauseWindowHidden(this))
+			Close();
+	}
+	else if (_showing)
+	{
+		// the user gets the whole time once the window is visible
+		_showing = false;
+		_readyTimer.Start(eyeleo::settings::timeForLongBreakConfirmation * 1000L);
+		g_TaskMgr->AddTask(GetName(), _readyTimer.GetTimeToNextSecond());
 	}
 }
 
@@ -184,25 +190,36 @@ void BeforePauseWindow::OnClose(wxCloseEvent& event)
 		event.Skip(true);
 }
 
-void BeforePauseWindow::OnRefuseClicked(wxCommandEvent &)
+void BeforePauseWindow::Answer(EResult result)
+{
+	if (_result == RESULT_NONE)
+		getApp()->OnBreakRequestAnswered((::wxGetLocalTimeMillis() - _shownTime).ToLong());
+
+	_result = result;
+	StartHiding();
+}
+
+void BeforePauseWindow::StartHiding()
 {
-	_result = RESULT_REFUSE;
-	g_TaskMgr->AddTask(GetName(), 20);
+	_showing = false;
 	_hiding = true;
+	g_TaskMgr->RemoveTasks(GetName());
+	g_Animations->Fade(this, _alpha, 0, 300, EASE_IN);
+}
+
+void BeforePauseWindow::OnRefuseClicked(wxCommandEvent &)
+{
+	Answer(RESULT_REFUSE);
 }
 
 void BeforePauseWindow::OnReadyClicked(wxCommandEvent &)
 {
-	_result = RESULT_ACCEPT;
-	g_TaskMgr->AddTask(GetName(), 20);
-	_hiding = true;
+	Answer(RESULT_ACCEPT);
 }
 
 void BeforePauseWindow::OnPostponeClicked(wxCommandEvent &)
 {
-	_result = RESULT_POSTPONE;
-	g_TaskMgr->AddTask(GetName(), 20);
-	_hiding = true;
+	Answer(RESULT_POSTPONE);
 }
 
 void BeforePauseWindow::OnPaint(wxPaintEvent& WXUNUSED(evt))
@@ -213,6 +230,6 @@ void BeforePauseWindow::OnPaint(wxPaintEvent& WXUNUSED(evt))
 
 void BeforePauseWindow::Hide()
 {
-	logging::msg("BeforePauseWindow::Hide");
+	LOG_DEBUG("BeforePauseWindow::Hide");
 	Destroy();
 }
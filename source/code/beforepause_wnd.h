@@ -4,6 +4,8 @@
 #include "wx/wx.h"
 #include "wx/timer.h"
 #include "task_mgr.h"
+#include "animation_driver.h"
+#include "countdown.h"
 
 enum
 {
@@ -20,13 +22,17 @@ enum EResult
 	RESULT_ACCEPT,
 };
 
-class BeforePauseWindow : public wxFrame, public ITask
+class BeforePauseWindow : public wxFrame, public ITask, public IFadeTarget
 {
 public:
-	BeforePauseWindow(int displayInd = 0, int postponeCount = 0);
+	BeforePauseWindow(int displayInd = 0);
 	virtual ~BeforePauseWindow();
 
+	// Builds the window once, Start() fades it in for each request it is used for
 	void Init();
+	void Start(int postponeCount);
+
+	int GetDisplay() const { return _displayInd; }
 
 	void Hide();
 
@@ -34,6 +40,8 @@ private:
 	void OnPaint(wxPaintEvent& evt);
 	void OnErase(wxEraseEvent& evt);
 	void ExecuteTask(float f, long time_went);
+	void SetFadeAlpha(int alpha);
+	void OnFadeFinished();
 	void OnClose(wxCloseEvent& event);
 	
 	void OnRefuseClicked(wxCommandEvent &);
@@ -41,20 +49,25 @@ private:
 	void OnPostponeClicked(wxCommandEvent &);
 
 	void UpdateReadyTimer();
+	void Answer(EResult result);
+	void StartHiding();
 
 	int _displayInd;
 	int _postponeCount;
 
 	bool _showing;
 	bool _hiding;
-	float _alpha;
+	int _alpha;
 	bool _preventClosing;
 
-	float _readyTimer;
+	Countdown _readyTimer;
+	wxMilliClock_t _shownTime;
 
 	EResult _result;
 
 	wxButton * _btnReady;
+	wxButton * _btnPostpone;
+	wxButton * _btnRefuse;
 	
 	DECLARE_EVENT_TABLE()
 
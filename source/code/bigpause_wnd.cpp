@@ -6,6 +6,7 @@
 #include "language_set.h"
 #include "timeloc.h"
 #include "excercises.h"
+#include "backdrop.h"
 #include "logging.h"
 
 #ifdef WIN32
@@ -21,20 +22,22 @@ END_EVENT_TABLE()
 BigPauseWindow::BigPauseWindow(int displayInd) :
 	wxFrame(NULL, -1, L"", wxDefaultPosition, wxDefaultSize, wxFRAME_SHAPED | wxFRAME_NO_TASKBAR | wxSTAY_ON_TOP),
 	_preventClosing(true),
-	_breakTimeLeft(0),
-	_breakTimeFull(0),
+	_text(0),
 	_timeText(0),
 	_restoreFocus(false),
 	_displayInd(displayInd),
 	_showing(true),
 	_hiding(false),
-	_alpha(0.0f),
+	_alpha(0),
+	_targetAlpha(215),
 	_primary(false),
-	_sizer(nullptr)
+	_backdrop(0)
 {
+	_timeStr[0] = 0;
+
 	SetName(std::string("BigPauseWindow") + (char)('0' + displayInd));
 
-	logging::msg("BigPauseWindow::BigPauseWindow");
+	LOG_DEBUG("BigPauseWindow::BigPauseWindow");
 }
 
 void BigPauseWindow::Init()
@@ -46,15 +49,12 @@ void BigPauseWindow::Init()
 
 	SetPosition(displayRect.GetPosition());
 
-	//logging::msg(wxString::Format("BigPauseWindow init displayInd=%d, x=%d, y=%d, w=%d, h=%d", _displayInd, displayRect.GetPosition().x, displayRect.GetPosition().y, displayRect.GetSize().GetWidth(), displayRect.GetSize().GetHeight()));
+	//LOG_DEBUG("BigPauseWindow init displayInd=%d, x=%d, y=%d, w=%d, h=%d", _displayInd, displayRect.GetPosition().x, displayRect.GetPosition().y, displayRect.GetSize().GetWidth(), displayRect.GetSize().GetHeight());
 
-	_showing = true;
-	_hiding = false;
-	_alpha = 0.0f;
 	_primary = _displayInd == osCaps.primaryDisplayInd;
 
 	SetBackgroundColour(wxColour(0, 0, 0));
-	SetTransparent((int)_alpha);
+	SetTransparent(_alpha);
 
 	if (_primary)
 	{
@@ -78,34 +78,22 @@ void BigPauseWindow::Init()
 		text->SetBackgroundColour(wxColour(0, 0, 0, 0));
 		text->SetForegroundColour(wxColour(255, 255, 255, 255));
 		text->Wrap(600);
-
-		int ind = 1;
-		while (ind < 20)
-		{
-			if (!langPack->Has(wxString::Format(L"big_pause_text_%d", ind)))
-			{
-				ind--;
-				break;
-			}
-			++ind;
-		}
-
-		if (ind > 0)
-			text->SetLabel(langPack->Get(wxString::Format(L"big_pause_text_%d", rand() % ind + 1)));
+		_text = text;
 
 		vsizer->Add(text);
 		vsizer->AddSpacer(50);
 
-		wxStaticText * timeText = new wxStaticText(this, wxID_ANY, L"", wxDefaultPosition, wxDefaultSize, wxALIGN_CENTRE);
+		// fixed size, a new label only repaints the control and doesn't lay out the window
+		wxStaticText * timeText = new wxStaticText(this, wxID_ANY, L"", wxDefaultPosition, wxDefaultSize, wxALIGN_CENTRE | wxST_NO_AUTORESIZE);
 		wxFont font2(12, wxFONTFAMILY_DEFAULT, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL, false);
 		timeText->SetFont(font2);
 		timeText->SetBackgroundStyle(wxBG_STYLE_COLOUR);
 		timeText->SetBackgroundColour(wxColour(0, 0, 0, 0));
 		timeText->SetForegroundColour(wxColour(210, 210, 210, 255));
-		timeText->SetSize(200, 30);
+		timeText->SetMinSize(wxSize(600, 30));
 		_timeText = timeText;
 
-		wxButton * btnSkip = new wxButton(this, ID_BTN_SKIP, langPack->Get("big_pause_skip_button"));
+		wxButton * btnSkip = new wxButton(this, ID_BTN_SKIP, langPack->Get(StrId::big_pause_skip_button));
 		btnSkip->SetFont(wxFont(10, wxFONTFAMILY_DEFAULT, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL, false));
 		btnSkip->SetBackgroundColour(wxColor(255, 255, 255, 0));
 		btnSkip->SetBackgroundStyle(wxBG_STYLE_COLOUR);
@@ -117,7 +105,6 @@ void BigPauseWindow::Init()
 		vsizer->Add(timeText, wxSizerFlags().Center());
 		vsizer->AddSpacer(20);
 		vsizer->Add(btnSkip, wxSizerFlags().Center());
-		_sizer = vsizer;
 
 		SetSizerAndFit(sizer);
 	}
@@ -126,28 +113,58 @@ void BigPauseWindow::Init()
 
 	Connect(ID_BTN_SKIP, wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler(BigPauseWindow::OnSkipClicked));
 
-	g_TaskMgr->AddTask(GetName(), 20);
-	
 #ifdef WIN32
 	if (IsWindowsVistaOrGreater())
 		WTSRegisterSessionNotification(GetHandle(), NOTIFY_FOR_THIS_SESSION);
 #endif
 }
 
+// Only the content of this break, the window may come from the pool
+void BigPauseWindow::Start()
+{
+	refillResolutionParams();
+
+	assert(_displayInd < osCaps.numDisplays);
+	wxRect displayRect = osCaps.displays[_displayInd].geometry;
+	SetPosition(displayRect.GetPosition());
+	SetSize(displayRect.GetSize());
+
+	_showing = true;
+	_hiding = false;
+	_preventClosing = true;
+	_alpha = 0;
+	SetTransparent(_alpha);
+
+	if (_text)
+	{
+		_text->SetLabel(getApp()->GetBigPauseText() ? getApp()->GetBigPauseText() : L"");
+		_timeText->SetLabel(L"");
+		_timeStr[0] = 0;
+		Layout();
+	}
+
+	// over the blurred desktop the window is lighter
+	_targetAlpha = getApp()->GetBackdrops() ? 180 : 215;
+	g_Animations->Fade(this, 0, _targetAlpha, 600, EASE_OUT);
+}
+
 BigPauseWindow::~BigPauseWindow()
 {
 	if (!getApp()->isFinished())
 		g_TaskMgr->RemoveTasks(GetName());
+	if (g_Animations)
+		g_Animations->Stop(this);
+	if (_backdrop)
+		_backdrop->Destroy();
 
 	getApp()->OnBigPauseWindowClosed(this);
 
-	logging::msg("BigPauseWindow::~BigPauseWindow end");
+	LOG_DEBUG("BigPauseWindow::~BigPauseWindow end");
 }
 
 void BigPauseWindow::SetBreakDuration(int seconds)
 {
-	_breakTimeLeft = seconds;
-	_breakTimeFull = seconds;
+	_breakTime.Start(seconds * 1000L);
 }
 
 void BigPauseWindow::UpdateTimeLabel()
@@ -155,31 +172,41 @@ void BigPauseWindow::UpdateTimeLabel()
 	if (!_timeText)
 		return;
 	
-	if ( fabsf(_breakTimeLeft) < 0.000001f )
+	if (_breakTime.IsExpired())
 	{
 		_timeText->SetLabel(L"");
+		_timeStr[0] = 0;
 	}
 	else
 	{
-		wxString str = wxString::Format(langPack->Get("big_pause_time_left_text"), getTimeStr(_breakTimeLeft, SECONDS, getApp()->getLang()));
-		if (str != _timeText->GetLabel())
+		// the label only changes once a second
+		wchar_t timeStr[TIME_STR_SIZE];
+		formatTime(timeStr, TIME_STR_SIZE, _breakTime.GetSecondsLeft(), SECONDS);
+		if (wcscmp(timeStr, _timeStr) != 0)
 		{
-			_timeText->SetLabel(str);
-			_sizer->Layout();
+			wcscpy(_timeStr, timeStr);
+			_timeText->SetLabel(wxString::Format(langPack->Get(StrId::big_pause_time_left_text), timeStr));
 		}
 	}
 }
 
-void BigPauseWindow::ExecuteTask(float f, long /*time_went*/)
+// The task fires when the shown seconds change
+void BigPauseWindow::ScheduleTimeLabel()
+{
+	long delay = _breakTime.GetTimeToNextSecond();
+	if (delay > 0)
+		g_TaskMgr->AddTask(GetName(), delay);
+	else
+		g_TaskMgr->RemoveTasks(GetName());
+}
+
+void BigPauseWindow::ExecuteTask(float /*f*/, long /*time_went*/)
 {
 	if (!_showing && !_hiding)
 	{
-		_breakTimeLeft -= 0.1f * f;
-		if (_breakTimeLeft < 0.0f)
-			_breakTimeLeft = 0.0f;
 		UpdateTimeLabel();
-		
-		g_TaskMgr->AddTask(GetName(), 100);
+		ScheduleTimeLabel();
+		UpdateBackdrop();
 		/*if (_restoreFocus)
 		{
 			SetForegroundWindow(GetHWND());
@@ -187,65 +214,83 @@ void BigPauseWindow::ExecuteTask(float f, long /*time_went*/)
 			ShowWindow(GetHWND(), SW_RESTORE);
 			_restoreFocus = false;
 		}*/
+	}
+}
 
-		return;
+void BigPauseWindow::SetFadeAlpha(int alpha)
+{
+	_alpha = alpha;
+	SetTransparent(_alpha);
+	UpdateBackdrop();
+
+	if (_showing && _alpha > 0)
+		getApp()->OnOverlayVisible(GetName());
+}
+
+// The backdrop shows up once it is blurred and fades along with the window
+void BigPauseWindow::UpdateBackdrop()
+{
+	if (!_backdrop)
+	{
+		Backdrops * backdrops = getApp()->GetBackdrops();
+		if (!backdrops || !backdrops->IsReady())
+			return;
+		_backdrop = new BackdropWindow(_displayInd);
 	}
 
+	int alpha = _alpha * 255 / _targetAlpha;
+	_backdrop->SetTransparent(alpha < 255 ? alpha : 255);
+	if (!_backdrop->IsShown())
+		_backdrop->ShowBelow(this);
+}
+
+void BigPauseWindow::OnFadeFinished()
+{
 	if (_showing)
 	{
-		_alpha += 7.0f * f;
-		if (_alpha >= 215.0f)
-		{
-			_alpha = 215.0f;
-			_showing = false;
-			UpdateTimeLabel();
-			g_TaskMgr->AddTask(GetName(), 100);
-		}
-		else
-		{
-			g_TaskMgr->AddTask(GetName(), 20);
-		}
-		SetTransparent((int)_alpha);
-
-		return;
+		_showing = false;
+		UpdateTimeLabel();
+		ScheduleTimeLabel();
 	}
-	
-	if (_hiding)
+	else if (_hiding)
 	{
-		_alpha -= 9.0f * f;
-		if (_alpha <= 0.0f)
+		_hiding = false;
+		if (_backdrop)
 		{
-			_alpha = 0.0f;
-			_hiding = false;
-			_preventClosing = false;
-			Close();
-
-			logging::msg(wxString::Format("BigPauseWindow (%s)::Update -> Close", GetName()));
+			_backdrop->Destroy();
+			_backdrop = 0;
 		}
-		else
+
+		if (getApp()->OnBigPauseWindowHidden(this))
 		{
-			SetTransparent((int)_alpha);
-			g_TaskMgr->AddTask(GetName(), 20);
+			LOG_DEBUG("BigPauseWindow (%s)::Update -> Pool", GetName());
+			return;
 		}
+
+		_preventClosing = false;
+		Close();
+
+		LOG_DEBUG("BigPauseWindow (%s)::Update -> Close", GetName());
 	}
 }
 
 
 WXLRESULT BigPauseWindow::MSWWindowProc(WXUINT message, WXWPARAM wParam, WXLPARAM lParam)
 { 
-	if (message == WM_WTSSESSION_CHANGE)
+	// a pooled window is hidden and has no break to end
+	if (message == WM_WTSSESSION_CHANGE && IsShown())
 	{
 		if (wParam == WTS_SESSION_LOGON)
 		{
 			Hide();
 			getApp()->OnSessionUnlock();
-			_alpha = 0;
+			g_Animations->Fade(this, 0, 0, 0, EASE_LINEAR);
 		}
 		else if (wParam == WTS_SESSION_UNLOCK)
 		{
 			Hide();
 			getApp()->OnSessionUnlock();
-			_alpha = 0;
+			g_Animations->Fade(this, 0, 0, 0, EASE_LINEAR);
 		}
 	}
 	
@@ -260,7 +305,7 @@ WXLRESULT BigPauseWindow::MSWWindowProc(WXUINT message, WXWPARAM wParam, WXLPARA
 
 void BigPauseWindow::Hide()
 {
-	logging::msg("BigPauseWindow::Hide");
+	LOG_DEBUG("BigPauseWindow::Hide");
 
 	if ( _hiding )
 		return;
@@ -268,17 +313,17 @@ void BigPauseWindow::Hide()
 	_hiding = true;
 	_showing = false;
 	_preventClosing = false;
-	g_TaskMgr->AddTask(GetName(), 20);
+	g_TaskMgr->RemoveTasks(GetName());
 
-	if (_breakTimeFull - _breakTimeLeft < 3.0f)
-	{
-		_alpha = 0.0f; // quick hide
-	}
+	long duration = 500;
+	if (_breakTime.GetElapsed() < 3000)
+		duration = 0; // quick hide
+	g_Animations->Fade(this, _alpha, 0, duration, EASE_IN);
 }
 
 void BigPauseWindow::OnSkipClicked(wxCommandEvent &)
 {
-	logging::msg("BigPauseWindow::OnSkipClicked");
+	LOG_DEBUG("BigPauseWindow::OnSkipClicked");
 
 	getApp()->OnSkipBigPauseClicked();
 }
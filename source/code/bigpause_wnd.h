@@ -4,20 +4,29 @@
 #include "wx/wx.h"
 #include "wx/timer.h"
 #include "task_mgr.h"
+#include "animation_driver.h"
+#include "countdown.h"
+#include "timeloc.h"
 
 enum
 {
 	ID_BTN_SKIP = 1
 };
 
-class BigPauseWindow : public wxFrame, public ITask
+class BackdropWindow;
+
+class BigPauseWindow : public wxFrame, public ITask, public IFadeTarget
 {
 public:
 	BigPauseWindow(int displayInd = 0);
 	virtual ~BigPauseWindow();
 
+	// Builds the controls once, Start() fades the window in for each break it is used for
 	virtual void Init();
 	void SetBreakDuration(int minutes);
+	void Start();
+
+	int GetDisplay() const { return _displayInd; }
 
 	virtual void Hide();
 
@@ -25,27 +34,33 @@ private:
 	void OnPaint(wxPaintEvent& evt);
 	void OnErase(wxEraseEvent& evt);
 	void ExecuteTask(float f, long time_went);
+	void SetFadeAlpha(int alpha);
+	void OnFadeFinished();
 	void OnClose(wxCloseEvent& event);
 	void OnKillFocus(wxFocusEvent &);
 	void OnSkipClicked(wxCommandEvent &);
 
 	void UpdateTimeLabel();
+	void ScheduleTimeLabel();
+	void UpdateBackdrop();
 
 	virtual WXLRESULT MSWWindowProc(WXUINT message, WXWPARAM wParam, WXLPARAM lParam);
 
 	bool _showing;
 	bool _hiding;
-	float _alpha;
+	int _alpha;
+	int _targetAlpha;
 	bool _preventClosing;
 	bool _restoreFocus;
-	float _breakTimeLeft;
-	float _breakTimeFull;
+	Countdown _breakTime;
 	bool _primary;
 
 	int _displayInd;
 
+	BackdropWindow * _backdrop;
+	wxStaticText * _text;
 	wxStaticText * _timeText;
-	wxBoxSizer * _sizer;
+	wchar_t _timeStr[TIME_STR_SIZE]; // duration shown in _timeText
 
 	DECLARE_EVENT_TABLE()
 };
@@ -0,0 +1,40 @@
+#include "countdown.h"
+
+Countdown::Countdown() :
+	_deadline(Clock::now()),
+	_duration(0)
+{
+}
+
+void Countdown::Start(long durationMs)
+{
+	_duration = durationMs > 0 ? durationMs : 0;
+	_deadline = Clock::now() + std::chrono::milliseconds(_duration);
+}
+
+long Countdown::GetTimeLeft() const
+{
+	long long us = std::chrono::duration_cast<std::chrono::microseconds>(_deadline - Clock::now()).count();
+	if (us <= 0)
+		return 0;
+	return (long)((us + 999) / 1000);
+}
+
+long Countdown::GetElapsed() const
+{
+	return _duration - GetTimeLeft();
+}
+
+int Countdown::GetSecondsLeft() const
+{
+	return (int)((GetTimeLeft() + 999) / 1000);
+}
+
+long Countdown::GetTimeToNextSecond() const
+{
+	long left = GetTimeLeft();
+	if (left == 0)
+		return 0;
+	long delay = left % 1000;
+	return delay ? delay : 1000;
+}
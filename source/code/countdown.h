@@ -0,0 +1,33 @@
+#ifndef COUNTDOWN_H
+#define COUNTDOWN_H
+
+#include <chrono>
+
+// Time left until a deadline on the monotonic clock. Nothing is accumulated, so late
+// or missed ticks don't make it drift, and its owner only has to wake up when the
+// shown seconds change.
+class Countdown
+{
+public:
+	Countdown();
+
+	void Start(long durationMs);
+
+	// ms, 0 once the deadline passed
+	long GetTimeLeft() const;
+	long GetElapsed() const;
+	bool IsExpired() const { return GetTimeLeft() == 0; }
+
+	// Seconds as they are shown: rounded up, so 0 only at the deadline
+	int GetSecondsLeft() const;
+	// ms until GetSecondsLeft() changes, 0 once the deadline passed
+	long GetTimeToNextSecond() const;
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	Clock::time_point _deadline;
+	long _duration;
+};
+
+#endif
@@ -0,0 +1,116 @@
+#include "excercise_timeline.h"
+#include "logging.h"
+#include "pugixml.hpp"
+#include <wchar.h>
+
+// Names of the frames and the excercises in animations.xml
+static const wchar_t * frameNames[NUM_FRAMES] = {
+	L"default",
+	L"look_left",
+	L"look_right",
+	L"look_up",
+	L"look_down",
+	L"blink",
+	L"close_tightly",
+	L"window"
+};
+
+static const wchar_t * excerciseIds[NUM_EXCERCISES + 1] = {
+	L"",
+	L"roll",
+	L"look_vert",
+	L"look_horz",
+	L"close_tightly",
+	L"blink",
+	L"window"
+};
+
+static int findName(const wchar_t * const * names, int count, const wchar_t * name)
+{
+	for (int i = 0; i < count; ++i)
+	{
+		if (wcscmp(names[i], name) == 0)
+			return i;
+	}
+	return -1;
+}
+
+size_t ExcerciseTimeline::FindKeyframe(long time, long & left) const
+{
+	size_t count = frames.size();
+	left = -1;
+	if (count == 0)
+		return count;
+
+	long cycle = 0;
+	for (size_t i = loop; i < count; ++i)
+		cycle += frames[i].hold;
+
+	size_t i = 0;
+	while (i < count)
+	{
+		long hold = frames[i].hold;
+		if (hold <= 0)
+			break;
+		if (time < hold)
+		{
+			left = hold - time;
+			return i;
+		}
+		time -= hold;
+
+		if (++i == count && loop < count)
+		{
+			time %= cycle;
+			i = loop;
+		}
+	}
+
+	return i < count ? i : count - 1;
+}
+
+bool LoadExcerciseTimelines(wxString const & filename, ExcerciseTimeline * timelines)
+{
+	pugi::xml_document doc;
+	pugi::xml_parse_result res = doc.load_file(filename.wchar_str());
+
+	if (res.status != pugi::status_ok)
+		return false;
+
+	pugi::xml_node nodeAnimations = doc.child(L"animations");
+	if (nodeAnimations.empty())
+		return false;
+
+	for (pugi::xml_node node = nodeAnimations.child(L"excercise"); node; node = node.next_sibling(L"excercise"))
+	{
+		int excercise = findName(excerciseIds, NUM_EXCERCISES + 1, node.attribute(L"id").value());
+		if (excercise <= EXCERCISE_NONE)
+		{
+			LOG_WARNING("Unknown excercise %s in %s", node.attribute(L"id").value(), filename);
+			continue;
+		}
+
+		ExcerciseTimeline & timeline = timelines[excercise];
+		timeline.frames.clear();
+		for (pugi::xml_node nodeFrame = node.child(L"frame"); nodeFrame; nodeFrame = nodeFrame.next_sibling(L"frame"))
+		{
+			Keyframe key;
+			key.frame = findName(frameNames, NUM_FRAMES, nodeFrame.attribute(L"image").value());
+			key.hold = nodeFrame.attribute(L"hold").as_int(0);
+			if (key.frame < 0)
+			{
+				LOG_WARNING("Unknown frame %s in %s", nodeFrame.attribute(L"image").value(), filename);
+				continue;
+			}
+			timeline.frames.push_back(key);
+		}
+
+		// without 'loop' the last frame stays
+		pugi::xml_attribute loop = node.attribute(L"loop");
+		timeline.loop = loop ? loop.as_uint() : timeline.frames.size();
+		if (timeline.loop > timeline.frames.size())
+			timeline.loop = timeline.frames.size();
+	}
+
+	return true;
+}
@@ -0,0 +1,54 @@
+#ifndef EXCERCISE_TIMELINE_H
+#define EXCERCISE_TIMELINE_H
+#include "wx/string.h"
+#include <vector>
+
+#define NUM_EXCERCISES 6
+
+enum
+{
+	EXCERCISE_NONE,
+	EXCERCISE_ROLL,
+	EXCERCISE_LOOK_VERT,
+	EXCERCISE_LOOK_HORZ,
+	EXCERCISE_CLOSE_TIGHTLY,
+	EXCERCISE_BLINK,
+	EXCERCISE_WINDOW
+};
+
+enum EPersonageFrame
+{
+	FRAME_DEFAULT,
+	FRAME_LOOK_LEFT,
+	FRAME_LOOK_RIGHT,
+	FRAME_LOOK_UP,
+	FRAME_LOOK_DOWN,
+	FRAME_BLINK,
+	FRAME_CLOSE_TIGHTLY,
+	FRAME_WINDOW, // minipause_window.png, not an image of the personage
+	NUM_FRAMES
+};
+
+struct Keyframe
+{
+	int frame;
+	long hold; // ms, 0 holds the frame until the end
+};
+
+// Frames from 'loop' to the end repeat once the ones before it are played
+struct ExcerciseTimeline
+{
+	std::vector<Keyframe> frames;
+	size_t loop;
+
+	ExcerciseTimeline() : loop(0) {}
+
+	// Index of the keyframe shown 'time' ms after the start, frames.size() when there are none.
+	// 'left' gets the ms it is still shown, -1 when it stays.
+	size_t FindKeyframe(long time, long & left) const;
+};
+
+// Reads the excercises of animations.xml into timelines[EXCERCISE_ROLL..EXCERCISE_WINDOW]
+bool LoadExcerciseTimelines(wxString const & filename, ExcerciseTimeline * timelines);
+
+#endif
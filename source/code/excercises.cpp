@@ -1,7 +1,9 @@
 #include "excercises.h"
 #include "wx/bitmap.h"
-#include "wx/statbmp.h"
 #include "image_resources.h"
+#include "overlay_window.h"
+#include "logging.h"
+#include <algorithm>
 
 PersonageData * g_Personage = 0;
 
@@ -14,17 +16,11 @@ PersonageData::PersonageData(wxString const & name) :
 	_blink(0),
 	_closeTightly(0)
 {
+	// bitmaps are filled in by EnsureResourcesLoaded()
 	_name = name;
 
-	wxString path = wxString::Format(L"Personages/%s/%s_", name, name);
-	
-	_default = new wxBitmap(path + L"default.png", wxBITMAP_TYPE_PNG);
-	_lookLeft = new wxBitmap(path + L"look_left.png", wxBITMAP_TYPE_PNG);
-	_lookRight = new wxBitmap(path + L"look_right.png", wxBITMAP_TYPE_PNG);
-	_lookUp = new wxBitmap(path + L"look_up.png", wxBITMAP_TYPE_PNG);
-	_lookDown = new wxBitmap(path + L"look_down.png", wxBITMAP_TYPE_PNG);
-	_blink = new wxBitmap(path + L"blink.png", wxBITMAP_TYPE_PNG);
-	_closeTightly = new wxBitmap(path + L"close_tightly.png", wxBITMAP_TYPE_PNG);
+	if (!LoadAnimations())
+		LOG_WARNING("Can't read the animations of %s", _name);
 }
 
 PersonageData::~PersonageData()
@@ -38,89 +34,88 @@ PersonageData::~PersonageData()
 	delete _closeTightly;
 }
 
-ExcerciseAnim::ExcerciseAnim(wxStaticBitmap * img, int excerciseNum) :
-	_personageImg(img),
-	_excercise(excerciseNum),
-	_state(0)
+bool PersonageData::LoadAnimations()
 {
-	if (_excercise == EXCERCISE_WINDOW)
+	return LoadExcerciseTimelines(wxString::Format(L"Personages/%s/animations.xml", _name), _timelines);
+}
+
+void PersonageData::BuildAtlas()
+{
+	if (!_atlas.pixels.empty())
+		return;
+
+	OverlayImage frames[NUM_FRAMES];
+	int width = 0;
+	int height = 0;
+	for (int i = 0; i < NUM_FRAMES; ++i)
 	{
-		_personageImg->SetBitmap(*_bmpWindow);
+		wxBitmap const * bitmap = GetFrameBitmap(i);
+		if (bitmap && bitmap->IsOk())
+			ConvertBitmap(*bitmap, frames[i]);
+		_frameRects[i] = wxRect(width, 0, frames[i].width, frames[i].height);
+		width += frames[i].width;
+		if (frames[i].height > height)
+			height = frames[i].height;
 	}
-	else
+
+	_atlas.width = width;
+	_atlas.height = height;
+	_atlas.pixels.assign((size_t)width * height, 0);
+	for (int i = 0; i < NUM_FRAMES; ++i)
 	{
-		_personageImg->SetBitmap(*g_Personage->_default);
+		for (int y = 0; y < frames[i].height; ++y)
+		{
+			std::copy(frames[i].pixels.begin() + (size_t)y * frames[i].width, frames[i].pixels.begin() + (size_t)(y + 1) * frames[i].width,
+				_atlas.pixels.begin() + (size_t)y * width + _frameRects[i].GetX());
+		}
 	}
-	
-	_time = 400;
+
+	LOG_INFO("Packed the frames of %s into a %dx%d atlas", _name, width, height);
 }
 
-void ExcerciseAnim::Update()
+size_t PersonageData::ReleaseAtlas()
 {
-	if (_excercise == EXCERCISE_WINDOW)
-		return;
-	
-	_time -= 100;
+	size_t bytes = _atlas.pixels.capacity() * sizeof(uint32_t);
+	_atlas = OverlayImage(); // clear() would keep the memory
+	return bytes;
+}
 
-	if (_time <= 0)
+wxBitmap const * PersonageData::GetFrameBitmap(int frame) const
+{
+	switch (frame)
 	{
-		switch(_excercise)
-		{
-		case EXCERCISE_LOOK_HORZ:
-			{
-				if (_state)
-					_personageImg->SetBitmap(*g_Personage->_lookLeft);
-				else
-					_personageImg->SetBitmap(*g_Personage->_lookRight);
-				_state = _state == 1 ? 0 : 1;
-				_time = 1200;
-			}
-			break;
-		case EXCERCISE_LOOK_VERT:
-			{
-				if (_state)
-					_personageImg->SetBitmap(*g_Personage->_lookUp);
-				else
-					_personageImg->SetBitmap(*g_Personage->_lookDown);
-				_state = _state == 1 ? 0 : 1;
-				_time = 1200;
-			}
-			break;
-		case EXCERCISE_ROLL:
-			{
-				if (_state == 0)
-					_personageImg->SetBitmap(*g_Personage->_lookLeft);
-				else if (_state == 1)
-					_personageImg->SetBitmap(*g_Personage->_lookUp);
-				else if (_state == 2)
-					_personageImg->SetBitmap(*g_Personage->_lookRight);
-				else if (_state == 3)
-					_personageImg->SetBitmap(*g_Personage->_lookDown);
-				if (++_state == 4)
-					_state = 0;
-				_time = 1200;
-			}
-			break;
-		case EXCERCISE_BLINK:
-			{
-				if (_state)
-					_personageImg->SetBitmap(*g_Personage->_blink);
-				else
-					_personageImg->SetBitmap(*g_Personage->_default);
-				_state = _state == 1 ? 0 : 1;
-				_time = 200;
-			}
-			break;
-		case EXCERCISE_CLOSE_TIGHTLY:
-			{
-				if (_state)
-					_personageImg->SetBitmap(*g_Personage->_closeTightly);
-				else
-					_personageImg->SetBitmap(*g_Personage->_default);
-				_state = _state == 1 ? 0 : 1;
-				_time = 2000;
-			}
-			break;
-		}
+	case FRAME_LOOK_LEFT: return _lookLeft;
+	case FRAME_LOOK_RIGHT: return _lookRight;
+	case FRAME_LOOK_UP: return _lookUp;
+	case FRAME_LOOK_DOWN: return _lookDown;
+	case FRAME_BLINK: return _blink;
+	case FRAME_CLOSE_TIGHTLY: return _closeTightly;
+	case FRAME_WINDOW: return _bmpWindow;
 	}
+	return _default;
+}
+
+ExcerciseAnim::ExcerciseAnim(int excerciseNum) :
+	_timeline(g_Personage->_timelines[excerciseNum]),
+	_excercise(excerciseNum)
+{
+	// _clock starts here
+}
+
+EPersonageFrame ExcerciseAnim::GetFrame() const
+{
+	long left;
+	size_t key = _timeline.FindKeyframe(_clock.Time(), left);
+
+	// without a timeline the personage just sits there
+	if (key == _timeline.frames.size())
+		return _excercise == EXCERCISE_WINDOW ? FRAME_WINDOW : FRAME_DEFAULT;
+	return (EPersonageFrame)_timeline.frames[key].frame;
+}
+
+long ExcerciseAnim::GetTimeToNextFrame() const
+{
+	long left;
+	_timeline.FindKeyframe(_clock.Time(), left);
+	return left;
 }
\ No newline at end of file
@@ -1,21 +1,11 @@
 #ifndef EXCERCISES_H
 #define EXCERCISES_H
 #include "wx/string.h"
+#include "wx/stopwatch.h"
+#include "wx/gdicmn.h"
+#include "overlay_compositor.h"
+#include "excercise_timeline.h"
 
-#define NUM_EXCERCISES 6
-
-enum
-{
-	EXCERCISE_NONE,
-	EXCERCISE_ROLL,
-	EXCERCISE_LOOK_VERT,
-	EXCERCISE_LOOK_HORZ,
-	EXCERCISE_CLOSE_TIGHTLY,
-	EXCERCISE_BLINK,
-	EXCERCISE_WINDOW
-};
-
-class wxStaticBitmap;
 class wxBitmap;
 
 struct PersonageData
@@ -28,25 +18,41 @@ struct PersonageData
 	wxBitmap * _lookDown;
 	wxBitmap * _blink;
 	wxBitmap * _closeTightly;
+	ExcerciseTimeline _timelines[NUM_EXCERCISES + 1];
+
+	// All the frames side by side, drawn by every mini-pause window
+	OverlayImage _atlas;
+	wxRect _frameRects[NUM_FRAMES];
 	
 	PersonageData(wxString const & name);
 	~PersonageData();
+
+	// Reads Personages/<name>/animations.xml
+	bool LoadAnimations();
+	// Packs the frames into _atlas, once the bitmaps are loaded
+	void BuildAtlas();
+	// Frees _atlas with the bitmaps, BuildAtlas() makes it again. Returns the bytes freed.
+	size_t ReleaseAtlas();
+	wxBitmap const * GetFrameBitmap(int frame) const;
 };
 
 extern PersonageData * g_Personage;
 
+// Plays the timeline of the excercise from the moment it is created.
+// The frame only depends on the time, so all the windows showing it stay in step.
 class ExcerciseAnim
 {
 public:
-	ExcerciseAnim(wxStaticBitmap * img, int excerciseNum);
-	
-	void Update();
+	ExcerciseAnim(int excerciseNum);
 	
+	EPersonageFrame GetFrame() const;
+	// ms until the bitmap changes, -1 when it never does
+	long GetTimeToNextFrame() const;
+
 private:
-	wxStaticBitmap * _personageImg;
+	ExcerciseTimeline const & _timeline;
 	int _excercise;
-	int _time;
-	int _state;
+	wxStopWatch _clock;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,168 @@
+#include "exclusion_rules.h"
+#include "pugixml.hpp"
+#include <algorithm>
+
+namespace
+{
+	std::wstring foldName(wxString const & name)
+	{
+		return name.Lower().ToStdWstring();
+	}
+
+	// Either slash separates the directories
+	std::wstring foldPath(wxString const & path)
+	{
+		std::wstring folded = foldName(path);
+		std::replace(folded.begin(), folded.end(), L'/', L'\\');
+		return folded;
+	}
+
+	bool parsePolicy(const wchar_t * name, BreakPolicy & policy)
+	{
+		if (wcscmp(name, L"no_breaks") == 0)
+			policy = POLICY_NO_BREAKS;
+		else if (wcscmp(name, L"mini_pauses_only") == 0)
+			policy = POLICY_MINI_PAUSES_ONLY;
+		else if (wcscmp(name, L"all_breaks") == 0)
+			policy = POLICY_ALL_BREAKS;
+		else
+			return false;
+		return true;
+	}
+
+	void addName(std::unordered_map<std::wstring, BreakPolicy> & names, std::wstring const & name, BreakPolicy policy)
+	{
+		BreakPolicy & stored = names.insert(std::make_pair(name, POLICY_ALL_BREAKS)).first->second;
+		stored = std::max(stored, policy);
+	}
+
+	void matchName(std::unordered_map<std::wstring, BreakPolicy> const & names, std::wstring const & name, BreakPolicy & policy)
+	{
+		std::unordered_map<std::wstring, BreakPolicy>::const_iterator it = names.find(name);
+		if (it != names.end())
+			policy = std::max(policy, it->second);
+	}
+}
+
+ExclusionRules::ExclusionRules()
+{
+	Clear();
+}
+
+// <exclusions>
+//	<rule exe="zoom.exe" policy="no_breaks"/>
+//	<rule path="C:\Program Files\JetBrains\" policy="mini_pauses_only"/>
+//	<rule class="screenClass" policy="no_breaks"/>
+// </exclusions>
+bool ExclusionRules::Load(wxString const & path)
+{
+	Clear();
+
+	pugi::xml_document doc;
+	pugi::xml_parse_result result = doc.load_file(path.wchar_str());
+	if (result.status != pugi::status_ok)
+		return false;
+
+	pugi::xml_node nodeExclusions = doc.child(L"exclusions");
+	if (nodeExclusions.empty())
+		return false;
+
+	for (pugi::xml_node node = nodeExclusions.child(L"rule"); node; node = node.next_sibling(L"rule"))
+	{
+		BreakPolicy policy;
+		if (!parsePolicy(node.attribute(L"policy").value(), policy))
+			continue;
+
+		if (pugi::xml_attribute exe = node.attribute(L"exe"))
+			Add(EXCLUDE_EXE_NAME, exe.value(), policy);
+		if (pugi::xml_attribute prefix = node.attribute(L"path"))
+			Add(EXCLUDE_PATH_PREFIX, prefix.value(), policy);
+		if (pugi::xml_attribute windowClass = node.attribute(L"class"))
+			Add(EXCLUDE_WINDOW_CLASS, windowClass.value(), policy);
+	}
+	return true;
+}
+
+void ExclusionRules::Clear()
+{
+	_exeNames.clear();
+	_windowClasses.clear();
+	_prefixes.assign(1, PrefixNode());
+	_count = 0;
+}
+
+void ExclusionRules::Add(ExclusionKey key, wxString const & value, BreakPolicy policy)
+{
+	if (value.empty())
+		return;
+
+	switch (key)
+	{
+	case EXCLUDE_EXE_NAME:
+		addName(_exeNames, foldName(value), policy);
+		break;
+
+	case EXCLUDE_WINDOW_CLASS:
+		addName(_windowClasses, foldName(value), policy);
+		break;
+
+	case EXCLUDE_PATH_PREFIX:
+		{
+			std::wstring prefix = foldPath(value);
+			int node = 0;
+			for (size_t i = 0; i < prefix.size(); ++i)
+			{
+				int child = FindChild(node, prefix[i]);
+				if (child < 0)
+				{
+					child = (int)_prefixes.size();
+					_prefixes[node].children.push_back(std::make_pair(prefix[i], child));
+					_prefixes.push_back(PrefixNode());
+				}
+				node = child;
+			}
+			_prefixes[node].policy = std::max(_prefixes[node].policy, policy);
+		}
+		break;
+	}
+	++_count;
+}
+
+BreakPolicy ExclusionRules::Evaluate(wxString const & exePath, wxString const & windowClass) const
+{
+	BreakPolicy policy = POLICY_ALL_BREAKS;
+	if (_count == 0)
+		return policy;
+
+	std::wstring path = foldPath(exePath);
+	if (!_exeNames.empty())
+	{
+		size_t slash = path.rfind(L'\\');
+		matchName(_exeNames, slash == std::wstring::npos ? path : path.substr(slash + 1), policy);
+	}
+
+	if (!_windowClasses.empty())
+		matchName(_windowClasses, foldName(windowClass), policy);
+
+	// every prefix of the path that is a rule counts, not only the longest one
+	int node = 0;
+	for (size_t i = 0; i < path.size() && node >= 0; ++i)
+	{
+		node = FindChild(node, path[i]);
+		if (node >= 0)
+			policy = std::max(policy, _prefixes[node].policy);
+	}
+	return policy;
+}
+
+// Paths branch little, a scan of the few children is cheaper than a map per node
+int ExclusionRules::FindChild(int node, wchar_t ch) const
+{
+	std::vector<std::pair<wchar_t, int> > const & children = _prefixes[node].children;
+	for (size_t i = 0; i < children.size(); ++i)
+	{
+		if (children[i].first == ch)
+			return children[i].second;
+	}
+	return -1;
+}
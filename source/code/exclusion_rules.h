@@ -0,0 +1,60 @@
+#ifndef EXCLUSION_RULES_H
+#define EXCLUSION_RULES_H
+
+#include "wx/string.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// Breaks that may start while an application is in the foreground, stricter policies are greater
+enum BreakPolicy
+{
+	POLICY_ALL_BREAKS,
+	POLICY_MINI_PAUSES_ONLY,
+	POLICY_NO_BREAKS
+};
+
+enum ExclusionKey
+{
+	EXCLUDE_EXE_NAME, // file name of the executable, "zoom.exe"
+	EXCLUDE_PATH_PREFIX, // start of the executable path, "C:\Program Files\JetBrains\"
+	EXCLUDE_WINDOW_CLASS
+};
+
+// Per-application break policies from exclusions.xml. Names are compared case-insensitively,
+// when several rules match a window the strictest one wins.
+class ExclusionRules
+{
+public:
+	ExclusionRules();
+
+	// Replaces the rules, false when the file is missing or broken
+	bool Load(wxString const & path);
+	void Clear();
+	void Add(ExclusionKey key, wxString const & value, BreakPolicy policy);
+
+	int GetCount() const { return _count; }
+
+	// A lookup per key and a walk down the path, doesn't depend on the number of rules
+	BreakPolicy Evaluate(wxString const & exePath, wxString const & windowClass) const;
+
+private:
+	typedef std::unordered_map<std::wstring, BreakPolicy> NameMap;
+
+	struct PrefixNode
+	{
+		std::vector<std::pair<wchar_t, int> > children; // indices into _prefixes
+		BreakPolicy policy; // of the rule ending here, POLICY_ALL_BREAKS when there is none
+
+		PrefixNode() : policy(POLICY_ALL_BREAKS) {}
+	};
+
+	int FindChild(int node, wchar_t ch) const;
+
+	NameMap _exeNames;
+	NameMap _windowClasses;
+	std::vector<PrefixNode> _prefixes; // the root is the first node
+	int _count;
+};
+
+#endif
@@ -0,0 +1,58 @@
+#include "file_utils.h"
+#ifdef WIN32
+	#include <windows.h>
+#else
+	#include <stdio.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+static BeforeReplaceHook beforeReplace = 0;
+
+void setBeforeReplaceHook(BeforeReplaceHook hook)
+{
+	beforeReplace = hook;
+}
+
+bool writeFileAtomically(wxString const & path, const void * data, size_t size)
+{
+	wxString tmpPath = path + L".tmp";
+
+#ifdef WIN32
+	HANDLE file = CreateFileW(tmpPath.wc_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	DWORD written = 0;
+	bool ok = WriteFile(file, data, (DWORD)size, &written, NULL) != FALSE &&
+		written == size &&
+		FlushFileBuffers(file) != FALSE;
+	CloseHandle(file);
+
+	if (ok && beforeReplace)
+		beforeReplace(path);
+	if (ok)
+		ok = MoveFileExW(tmpPath.wc_str(), path.wc_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != FALSE;
+
+	if (!ok)
+		DeleteFileW(tmpPath.wc_str());
+	return ok;
+#else
+	wxScopedCharBuffer tmpName = tmpPath.fn_str();
+	int file = open(tmpName.data(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (file < 0)
+		return false;
+
+	bool ok = write(file, data, size) == (ssize_t)size && fsync(file) == 0;
+	close(file);
+
+	if (ok && beforeReplace)
+		beforeReplace(path);
+	if (ok)
+		ok = rename(tmpName.data(), path.fn_str()) == 0;
+
+	if (!ok)
+		unlink(tmpName.data());
+	return ok;
+#endif
+}
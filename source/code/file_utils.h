@@ -0,0 +1,16 @@
+#ifndef FILE_UTILS_H
+#define FILE_UTILS_H
+
+#include "wx/string.h"
+#include <stddef.h>
+
+// Writes the data next to the target, flushes it to the disk and renames it over the target.
+// Readers see either the old or the new file, never a partially written one.
+bool writeFileAtomically(wxString const & path, const void * data, size_t size);
+
+// Called when the temporary file is on the disk, right before it replaces the target.
+// Tests kill the writer there, 0 removes the hook.
+typedef void (*BeforeReplaceHook)(wxString const & path);
+void setBeforeReplaceHook(BeforeReplaceHook hook);
+
+#endif
@@ -0,0 +1,228 @@
+#include "fullscreen_tracker.h"
+#include "oscapabilities.h"
+
+#ifdef WIN32
+#include "windows.h"
+
+namespace
+{
+	// WinEvent callbacks have no context, out-of-context ones run on the thread that set the hook
+	FullscreenTracker * activeTracker = 0;
+
+	// Opening the process is too slow for location events, it's only done for a new foreground window
+	void identifyWindow(HWND hWnd, ForegroundWindow & wnd)
+	{
+		wchar_t className[256];
+		if (GetClassNameW(hWnd, className, 256) > 0)
+			wnd.className = className;
+
+		DWORD processId = 0;
+		GetWindowThreadProcessId(hWnd, &processId);
+		HANDLE process = processId ? OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, processId) : NULL;
+		if (!process)
+			return;
+
+		wchar_t path[MAX_PATH];
+		DWORD length = MAX_PATH;
+		if (QueryFullProcessImageNameW(process, 0, path, &length))
+			wnd.exePath = wxString(path, length);
+		CloseHandle(process);
+	}
+
+	ForegroundWindow describeWindow(HWND hWnd, bool identify)
+	{
+		ForegroundWindow wnd;
+		wnd.handle = hWnd;
+		if (!hWnd)
+			return wnd;
+
+		if (identify)
+			identifyWindow(hWnd, wnd);
+
+		wnd.shell = hWnd == GetDesktopWindow() || hWnd == GetShellWindow();
+		wnd.visible = IsWindowVisible(hWnd) != FALSE;
+		wnd.iconic = IsIconic(hWnd) != FALSE;
+
+		RECT rect;
+		if (GetWindowRect(hWnd, &rect))
+			wnd.rect = wxRect(rect.left, rect.top, rect.right - rect.left, rect.bottom - rect.top);
+		return wnd;
+	}
+
+	void CALLBACK onWindowEvent(HWINEVENTHOOK, DWORD event, HWND hWnd, LONG idObject, LONG idChild, DWORD, DWORD)
+	{
+		if (!activeTracker)
+			return;
+
+		if (event == EVENT_SYSTEM_FOREGROUND)
+			activeTracker->OnForegroundChanged(describeWindow(hWnd, true));
+		else if (idObject == OBJID_WINDOW && idChild == CHILDID_SELF && hWnd)
+			activeTracker->OnWindowChanged(describeWindow(hWnd, false));
+	}
+
+	// Object events are many, they are only hooked for the thread of the foreground window
+	HWINEVENTHOOK hookWindowThread(HWND hWnd)
+	{
+		DWORD processId = 0;
+		DWORD threadId = hWnd ? GetWindowThreadProcessId(hWnd, &processId) : 0;
+		if (!threadId)
+			return 0;
+		return SetWinEventHook(EVENT_OBJECT_DESTROY, EVENT_OBJECT_LOCATIONCHANGE, NULL, onWindowEvent,
+			processId, threadId, WINEVENT_OUTOFCONTEXT);
+	}
+}
+#endif
+
+FullscreenTracker::FullscreenTracker() :
+	_display(-1),
+	_generation(0),
+	_rules(0),
+	_policy(POLICY_ALL_BREAKS),
+	_hooked(false),
+	_polled(true),
+	_foregroundHook(0),
+	_windowHook(0)
+{
+}
+
+FullscreenTracker::~FullscreenTracker()
+{
+	Stop();
+}
+
+bool FullscreenTracker::Start()
+{
+#ifdef WIN32
+	if (_hooked || activeTracker)
+		return _hooked;
+
+	activeTracker = this;
+	_foregroundHook = SetWinEventHook(EVENT_SYSTEM_FOREGROUND, EVENT_SYSTEM_FOREGROUND, NULL, onWindowEvent,
+		0, 0, WINEVENT_OUTOFCONTEXT);
+	if (!_foregroundHook)
+	{
+		activeTracker = 0;
+		return false;
+	}
+
+	_hooked = true;
+	_polled = false;
+	OnForegroundChanged(describeWindow(GetForegroundWindow(), true));
+	return true;
+#else
+	return false;
+#endif
+}
+
+void FullscreenTracker::Stop()
+{
+#ifdef WIN32
+	if (_windowHook)
+		UnhookWinEvent((HWINEVENTHOOK)_windowHook);
+	if (_foregroundHook)
+		UnhookWinEvent((HWINEVENTHOOK)_foregroundHook);
+	if (activeTracker == this)
+		activeTracker = 0;
+#endif
+	_windowHook = 0;
+	_foregroundHook = 0;
+	_hooked = false;
+	_polled = true;
+}
+
+void FullscreenTracker::UseEventsOnly()
+{
+	Stop();
+	_polled = false;
+}
+
+void FullscreenTracker::OnForegroundChanged(ForegroundWindow const & wnd)
+{
+#ifdef WIN32
+	if (_hooked && wnd.handle != _window.handle)
+	{
+		if (_windowHook)
+			UnhookWinEvent((HWINEVENTHOOK)_windowHook);
+		_windowHook = hookWindowThread((HWND)wnd.handle);
+	}
+#endif
+	_window = wnd;
+	_policy = _rules ? _rules->Evaluate(_window.exePath, _window.className) : POLICY_ALL_BREAKS;
+	Match();
+}
+
+void FullscreenTracker::OnWindowChanged(ForegroundWindow const & wnd)
+{
+	if (!wnd.handle || wnd.handle != _window.handle)
+		return;
+
+	_window.shell = wnd.shell;
+	_window.visible = wnd.visible;
+	_window.iconic = wnd.iconic;
+	_window.rect = wnd.rect;
+	Match();
+}
+
+bool FullscreenTracker::IsFullscreen(int * display, void ** handle)
+{
+	if (_polled)
+		Poll();
+
+	refillResolutionParams();
+	if (_generation != osCaps.topologyGeneration)
+		Match();
+
+	if (_display < 0)
+		return false;
+
+	if (display)
+		*display = _display;
+	if (handle)
+		*handle = _window.handle;
+	return true;
+}
+
+void FullscreenTracker::SetRules(ExclusionRules const * rules)
+{
+	_rules = rules;
+	_policy = _rules ? _rules->Evaluate(_window.exePath, _window.className) : POLICY_ALL_BREAKS;
+}
+
+BreakPolicy FullscreenTracker::GetPolicy()
+{
+	if (_polled)
+		Poll();
+	return _policy;
+}
+
+// Without the hooks, the application of the window is only looked up when the window changes
+void FullscreenTracker::Poll()
+{
+#ifdef WIN32
+	HWND hWnd = GetForegroundWindow();
+	if (hWnd && hWnd == (HWND)_window.handle)
+		OnWindowChanged(describeWindow(hWnd, false));
+	else
+		OnForegroundChanged(describeWindow(hWnd, true));
+#endif
+}
+
+// The window covers exactly the whole of a display
+void FullscreenTracker::Match()
+{
+	refillResolutionParams();
+	_generation = osCaps.topologyGeneration;
+	_display = -1;
+
+	if (!_window.handle || _window.shell || !_window.visible || _window.iconic)
+		return;
+
+	for (int d = 0; d < osCaps.numDisplays; ++d)
+	{
+		if (_window.rect == osCaps.displays[d].geometry)
+		{
+			_display = d;
+			return;
+		}
+	}
+}
@@ -0,0 +1,68 @@
+#ifndef FULLSCREEN_TRACKER_H
+#define FULLSCREEN_TRACKER_H
+
+#include "wx/gdicmn.h" // wxRect
+#include "wx/string.h"
+#include "exclusion_rules.h"
+
+// What the tracker needs to know about the foreground window
+struct ForegroundWindow
+{
+	void * handle; // 0 when no window is in the foreground
+	bool shell; // the desktop or the shell window
+	bool visible;
+	bool iconic;
+	wxRect rect;
+	// only filled by foreground changes, the same window keeps them
+	wxString exePath;
+	wxString className;
+
+	ForegroundWindow() : handle(0), shell(false), visible(false), iconic(false) {}
+};
+
+// Keeps the display that the foreground window covers, if any, and the break policy of its
+// application. The state changes with foreground and location change events, so a check
+// doesn't query the window again.
+class FullscreenTracker
+{
+public:
+	FullscreenTracker();
+	~FullscreenTracker();
+
+	// Hooks the system events, false when the foreground window is polled on every check
+	bool Start();
+	void Stop();
+	// Neither hooks nor polls, only the events sent to it change the state
+	void UseEventsOnly();
+
+	// The events, sent by the system hooks or by anything that makes windows up
+	void OnForegroundChanged(ForegroundWindow const & wnd);
+	// Ignored unless it is the foreground window
+	void OnWindowChanged(ForegroundWindow const & wnd);
+
+	// Only matches the window rect again when the displays changed since the last event
+	bool IsFullscreen(int * display = 0, void ** handle = 0);
+
+	// The rules aren't owned, the foreground window is evaluated with them right away
+	void SetRules(ExclusionRules const * rules);
+	// Evaluated when the foreground window changes
+	BreakPolicy GetPolicy();
+
+private:
+	void Poll();
+	void Match();
+
+	ForegroundWindow _window;
+	int _display; // -1 when the window isn't fullscreen
+	unsigned int _generation; // of the display topology _display was matched with
+
+	ExclusionRules const * _rules;
+	BreakPolicy _policy;
+
+	bool _hooked;
+	bool _polled; // the foreground window is queried on every check
+	void * _foregroundHook;
+	void * _windowHook; // events of the thread that owns the foreground window
+};
+
+#endif
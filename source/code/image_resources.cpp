@@ -1,4 +1,12 @@
 #include "image_resources.h"
+#include "wx/image.h"
+#include "wx/thread.h"
+#include "wx/stopwatch.h"
+#include "excercises.h"
+#include "resource_archive.h"
+#include "logging.h"
+#include <vector>
+#include <assert.h>
 
 wxBitmap * _backBitmap = 0;
 wxBitmap * _backBitmap_long = 0;
@@ -7,12 +15,333 @@ wxBitmap * _bmpTitle = 0;
 wxBitmap * _bmpWindow = 0;
 wxBitmap * _bmpNotificationLeopard = 0;
 
-void LoadEyeLeoResources()
+namespace
 {
-	_backBitmap = new wxBitmap("Resources/skin2.png", wxBITMAP_TYPE_PNG);
-	_backBitmap_long = new wxBitmap("Resources/skin3.png", wxBITMAP_TYPE_PNG);
-	_backBitmap_notification = new wxBitmap("Resources/skin4.png", wxBITMAP_TYPE_PNG);
-	_bmpTitle = new wxBitmap("Resources/eyeleo_title.png", wxBITMAP_TYPE_PNG);
-	_bmpWindow = new wxBitmap("Resources/minipause_window.png", wxBITMAP_TYPE_PNG);
-	_bmpNotificationLeopard = new wxBitmap("Resources/notification_leopard.png", wxBITMAP_TYPE_PNG);
-}
\ No newline at end of file
+	const int MAX_DECODE_THREADS = 4;
+
+	struct ImageJob
+	{
+		wxString path;
+		wxBitmap ** bitmap;
+		wxImage image;
+	};
+
+	// Only wxImage is touched off the GUI thread, bitmaps are GDI objects
+	class ImageDecodeThread : public wxThread
+	{
+	public:
+		ImageDecodeThread(std::vector<ImageJob> & jobs, size_t first, size_t step) :
+			wxThread(wxTHREAD_JOINABLE),
+			_jobs(jobs),
+			_first(first),
+			_step(step)
+		{
+		}
+
+	protected:
+		virtual wxThread::ExitCode Entry()
+		{
+			for (size_t i = _first; i < _jobs.size(); i += _step)
+				_jobs[i].image.LoadFile(_jobs[i].path, wxBITMAP_TYPE_PNG);
+			return 0;
+		}
+
+	private:
+		std::vector<ImageJob> & _jobs;
+		size_t _first;
+		size_t _step;
+	};
+
+	// every image the windows use, resident or not
+	struct ImageSlot
+	{
+		wxString path;
+		wxBitmap ** bitmap;
+		size_t bytes; // of the last materialised bitmap
+		bool shaped; // a window takes its shape from the image
+		wxRegion shape;
+	};
+
+	ResourceArchive archive;
+	std::vector<ImageSlot> slots;
+	std::vector<ImageJob> jobs;
+	std::vector<ImageDecodeThread*> threads;
+	wxStopWatch loadTime;
+
+	void addSlot(wxString const & path, wxBitmap ** bitmap, bool shaped = false)
+	{
+		ImageSlot slot;
+		slot.path = path;
+		slot.bitmap = bitmap;
+		slot.bytes = 0;
+		slot.shaped = shaped;
+		slots.push_back(slot);
+	}
+
+	// Rows with the same spans are merged into one rectangle per span
+	wxRegion regionFromSpans(std::vector<resourceformat::Span> const & spans)
+	{
+		wxRegion region;
+		size_t row = 0;
+		while (row < spans.size())
+		{
+			size_t rowEnd = row;
+			while (rowEnd < spans.size() && spans[rowEnd].y == spans[row].y)
+				rowEnd++;
+
+			int height = 1;
+			size_t next = rowEnd;
+			for (;;)
+			{
+				size_t nextEnd = next;
+				while (nextEnd < spans.size() && spans[nextEnd].y == spans[row].y + height)
+					nextEnd++;
+				if (nextEnd == next || nextEnd - next != rowEnd - row)
+					break;
+
+				bool same = true;
+				for (size_t i = 0; i < rowEnd - row && same; ++i)
+					same = spans[next + i].x0 == spans[row + i].x0 && spans[next + i].x1 == spans[row + i].x1;
+				if (!same)
+					break;
+
+				height++;
+				next = nextEnd;
+			}
+
+			for (size_t i = row; i < rowEnd; ++i)
+				region.Union(spans[i].x0, spans[i].y, spans[i].x1 - spans[i].x0, height);
+			row = next;
+		}
+		return region;
+	}
+
+	void setBitmap(ImageSlot & slot, wxBitmap const & bitmap)
+	{
+		*slot.bitmap = new wxBitmap(bitmap);
+		slot.bytes = (size_t)bitmap.GetWidth() * bitmap.GetHeight() * 4;
+	}
+
+	ImageSlot * findSlot(wxBitmap ** bitmap)
+	{
+		for (size_t i = 0; i < slots.size(); ++i)
+		{
+			if (slots[i].bitmap == bitmap)
+				return &slots[i];
+		}
+		return 0;
+	}
+}
+
+void StartLoadingResources()
+{
+	assert(g_Personage);
+	assert(slots.empty());
+
+	addSlot(L"Resources/skin2.png", &_backBitmap, true);
+	addSlot(L"Resources/skin3.png", &_backBitmap_long, true);
+	addSlot(L"Resources/skin4.png", &_backBitmap_notification, true);
+	addSlot(L"Resources/eyeleo_title.png", &_bmpTitle);
+	addSlot(L"Resources/minipause_window.png", &_bmpWindow);
+	addSlot(L"Resources/notification_leopard.png", &_bmpNotificationLeopard);
+
+	wxString path = wxString::Format(L"Personages/%s/%s_", g_Personage->_name, g_Personage->_name);
+	addSlot(path + L"default.png", &g_Personage->_default);
+	addSlot(path + L"look_left.png", &g_Personage->_lookLeft);
+	addSlot(path + L"look_right.png", &g_Personage->_lookRight);
+	addSlot(path + L"look_up.png", &g_Personage->_lookUp);
+	addSlot(path + L"look_down.png", &g_Personage->_lookDown);
+	addSlot(path + L"blink.png", &g_Personage->_blink);
+	addSlot(path + L"close_tightly.png", &g_Personage->_closeTightly);
+
+	if (!archive.Open(L"resources.pak"))
+		LOG_WARNING("Can't open resources.pak, decoding images");
+
+	PrefetchResources();
+}
+
+void PrefetchResources()
+{
+	if (!threads.empty() || !jobs.empty())
+		return; // already on the way
+
+	loadTime.Start();
+
+	int fromArchive = 0;
+	for (size_t i = 0; i < slots.size(); ++i)
+	{
+		if (*slots[i].bitmap)
+			continue;
+
+		wxBitmap bitmap;
+		if (archive.LoadBitmap(slots[i].path, bitmap))
+		{
+			std::vector<resourceformat::Span> spans;
+			if (slots[i].shaped && slots[i].shape.IsEmpty() && archive.LoadShape(slots[i].path, spans))
+				slots[i].shape = regionFromSpans(spans);
+			setBitmap(slots[i], bitmap);
+			fromArchive++;
+			continue;
+		}
+
+		ImageJob job;
+		job.path = slots[i].path;
+		job.bitmap = slots[i].bitmap;
+		jobs.push_back(job);
+	}
+
+	if (fromArchive)
+		LOG_INFO("Took %d images from resources.pak", fromArchive);
+
+	if (jobs.empty())
+	{
+		if (fromArchive)
+			LOG_INFO("Resources loaded in %lld us", (long long)loadTime.TimeInMicro().GetValue());
+		return;
+	}
+
+	// one core is left to the GUI thread
+	int count = wxThread::GetCPUCount() - 1;
+	if (count < 1)
+		count = 1;
+	else if (count > MAX_DECODE_THREADS)
+		count = MAX_DECODE_THREADS;
+
+	for (int i = 0; i < count; ++i)
+	{
+		ImageDecodeThread * thread = new ImageDecodeThread(jobs, i, count);
+		if (thread->Run() != wxTHREAD_NO_ERROR)
+		{
+			delete thread;
+			break;
+		}
+		threads.push_back(thread);
+	}
+
+	LOG_INFO("Decoding %d images on %d threads", (int)jobs.size(), (int)threads.size());
+}
+
+// Waits for the decoding started by PrefetchResources()
+static void finishLoading()
+{
+	if (jobs.empty())
+		return;
+
+	wxStopWatch waitTime;
+	for (size_t i = 0; i < threads.size(); ++i)
+	{
+		threads[i]->Wait();
+		delete threads[i];
+	}
+
+	// no thread could be started, decode right here
+	if (threads.empty())
+	{
+		for (size_t i = 0; i < jobs.size(); ++i)
+			jobs[i].image.LoadFile(jobs[i].path, wxBITMAP_TYPE_PNG);
+	}
+	LOG_INFO("Waited %lld us for image decoding", (long long)waitTime.TimeInMicro().GetValue());
+
+	for (size_t i = 0; i < jobs.size(); ++i)
+	{
+		if (!jobs[i].image.IsOk())
+			LOG_WARNING("Failed to load %s", jobs[i].path);
+		ImageSlot & slot = *findSlot(jobs[i].bitmap);
+		if (slot.shaped && slot.shape.IsEmpty() && jobs[i].image.IsOk())
+		{
+			std::vector<resourceformat::Span> spans;
+			resourceformat::FindShapeSpans(jobs[i].image.GetData(), jobs[i].image.GetWidth(), jobs[i].image.GetHeight(), spans);
+			slot.shape = regionFromSpans(spans);
+		}
+		setBitmap(slot, wxBitmap(jobs[i].image));
+	}
+
+	LOG_INFO("Resources loaded in %lld us", (long long)loadTime.TimeInMicro().GetValue());
+
+	threads.clear();
+	jobs.clear();
+}
+
+void EnsureResourcesLoaded()
+{
+	PrefetchResources();
+	finishLoading();
+}
+
+wxRegion GetResourceShape(wxBitmap const * bitmap)
+{
+	for (size_t i = 0; i < slots.size(); ++i)
+	{
+		ImageSlot & slot = slots[i];
+		if (*slot.bitmap != bitmap)
+			continue;
+
+		if (slot.shape.IsEmpty())
+		{
+			LOG_WARNING("No precomputed shape for %s", slot.path);
+			slot.shape = wxRegion(*bitmap, *wxWHITE);
+		}
+		return slot.shape;
+	}
+	return wxRegion(*bitmap, *wxWHITE);
+}
+
+size_t GetResidentResourceBytes()
+{
+	size_t resident = 0;
+	for (size_t i = 0; i < slots.size(); ++i)
+	{
+		if (*slots[i].bitmap)
+			resident += slots[i].bytes;
+	}
+	if (g_Personage)
+		resident += g_Personage->_atlas.pixels.capacity() * sizeof(uint32_t);
+	return resident;
+}
+
+size_t TrimResources(size_t budget)
+{
+	finishLoading(); // a prefetch that is no longer needed
+
+	size_t resident = GetResidentResourceBytes();
+
+	// the atlas is a copy of the personage's frames, it goes first
+	size_t released = 0;
+	if (resident > budget && g_Personage)
+	{
+		size_t atlasBytes = g_Personage->ReleaseAtlas();
+		resident -= atlasBytes;
+		released += atlasBytes;
+	}
+
+	// the largest images go first, small ones are cheap to keep
+	while (resident > budget)
+	{
+		ImageSlot * largest = 0;
+		for (size_t i = 0; i < slots.size(); ++i)
+		{
+			if (*slots[i].bitmap && (!largest || slots[i].bytes > largest->bytes))
+				largest = &slots[i];
+		}
+		if (!largest)
+			break;
+
+		delete *largest->bitmap;
+		*largest->bitmap = 0;
+		resident -= largest->bytes;
+		released += largest->bytes;
+	}
+	return released;
+}
+
+wxIcon LoadIconResource(wxString const & path, wxBitmapType type, int size)
+{
+	wxBitmap bitmap;
+	if (archive.LoadBitmap(path, bitmap, size))
+	{
+		wxIcon icon;
+		icon.CopyFromBitmap(bitmap);
+		return icon;
+	}
+	return wxIcon(path, type, size, size);
+}
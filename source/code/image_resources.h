@@ -1,5 +1,7 @@
 #pragma once
 #include "wx/bitmap.h"
+#include "wx/icon.h"
+#include "wx/region.h"
 
 extern wxBitmap * _backBitmap;
 extern wxBitmap * _backBitmap_long;
@@ -9,4 +11,29 @@ extern wxBitmap * _bmpTitle;
 
 extern wxBitmap * _bmpNotificationLeopard;
 
-void LoadEyeLeoResources();
+// The skins and g_Personage images are cached: they are taken from resources.pak,
+// the ones the archive doesn't have are decoded on worker threads. While no window
+// needs them TrimResources() can release them, they are loaded again on demand.
+
+// The PNG handler must be registered and g_Personage created before the call
+void StartLoadingResources();
+
+// Starts loading the released images in the background, e.g. shortly before a break
+void PrefetchResources();
+
+// Waits for the loading and turns the decoded images into bitmaps. Must be called
+// on the GUI thread before any window uses the bitmaps; cheap when they are resident.
+void EnsureResourcesLoaded();
+
+// Window shape of a skin bitmap: the pixels that aren't white. It is built once, when the
+// skin is loaded, and stays cached while the bitmap is released.
+wxRegion GetResourceShape(wxBitmap const * bitmap);
+
+size_t GetResidentResourceBytes();
+
+// Releases the atlas of g_Personage and bitmaps, the largest first, until at most budget
+// bytes stay resident. No window may use them. Returns the bytes released.
+size_t TrimResources(size_t budget);
+
+// An icon from resources.pak when it has one of this size, otherwise from the file
+wxIcon LoadIconResource(wxString const & path, wxBitmapType type, int size = -1);
@@ -0,0 +1,40 @@
+#ifndef LANGPACK_FORMAT_H
+#define LANGPACK_FORMAT_H
+
+#include <stdint.h>
+
+// Layout of a compiled language pack (langpack.<lang>.lpk). Written by tools/langpack-compiler
+// and mapped into memory by the application, so keep this header free of wxWidgets.
+//
+//   header
+//   entries[stringCount]: offset(u32) of every StrId in the pool, ENTRY_OWN is set
+//                         when the string comes from the pack rather than from English
+//   pool[poolSize]:       NUL-terminated strings in wchar_t of the compiling platform,
+//                         "{n}" already replaced with a line break
+// Offsets are in characters from the start of the pool. All values are little-endian.
+
+namespace langpackformat
+{
+	const uint32_t kMagic = 0x4B504C45; // "ELPK"
+	const uint16_t kVersion = 1;
+
+	const uint32_t ENTRY_OWN = 0x80000000;
+	const uint32_t ENTRY_OFFSET_MASK = 0x7FFFFFFF;
+
+	struct Header
+	{
+		uint32_t magic;
+		uint16_t version;
+		uint16_t charSize; // sizeof(wchar_t), a blob from another platform isn't used
+		uint32_t idsHash; // STRING_IDS_HASH the blob was compiled for
+		uint32_t stringCount;
+		uint32_t author; // pool offsets
+		uint32_t contact;
+		uint32_t poolSize; // in characters
+		uint32_t reserved;
+	};
+
+	static_assert(sizeof(Header) == 32, "lpk header must stay 32 bytes");
+}
+
+#endif
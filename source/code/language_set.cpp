@@ -1,19 +1,67 @@
 #include "language_set.h"
+#include "langpack_format.h"
+#include "logging.h"
 #include "pugixml.hpp"
+#include "wx/filefn.h"
+#include "wx/stopwatch.h"
+#include <stdlib.h>
 
 LanguagePack * langPack = 0;
 
-wxString const & LanguagePack::Get(wxString const & id)
+// Maps langpack.<lang>.lpk built by langpack-compiler. The blob is only used
+// when it was compiled for this build and is newer than the XML.
+static bool loadCompiledPack(wxString const & path, wxString const & xmlPath, LanguagePack * pack)
 {
-	return strings[id];
-}
+	time_t xmlTime = wxFileModificationTime(xmlPath);
+	time_t blobTime = wxFileModificationTime(path);
+	if (blobTime == (time_t)-1 || (xmlTime != (time_t)-1 && blobTime < xmlTime))
+		return false;
 
-bool LanguagePack::Has(wxString const & id) const
-{
-	return strings.find(id) != strings.end();
+	if (!pack->blob.OpenReadOnly(path))
+		return false;
+
+	const char * data = static_cast<const char*>(pack->blob.GetData());
+	size_t size = pack->blob.GetSize();
+
+	langpackformat::Header const * header = reinterpret_cast<langpackformat::Header const *>(data);
+	if (size < sizeof(*header) || header->magic != langpackformat::kMagic ||
+		header->version != langpackformat::kVersion || header->charSize != sizeof(wchar_t) ||
+		header->idsHash != STRING_IDS_HASH || header->stringCount != (uint32_t)StrId::Count ||
+		size < sizeof(*header) + header->stringCount * sizeof(uint32_t) + (size_t)header->poolSize * sizeof(wchar_t))
+	{
+		pack->blob.Close();
+		return false;
+	}
+
+	const uint32_t * entries = reinterpret_cast<const uint32_t *>(header + 1);
+	const wchar_t * pool = reinterpret_cast<const wchar_t *>(entries + header->stringCount);
+	uint32_t poolSize = header->poolSize;
+	if (poolSize == 0 || pool[poolSize - 1] != 0 || header->author >= poolSize || header->contact >= poolSize)
+	{
+		pack->blob.Close();
+		return false;
+	}
+
+	for (uint32_t i = 0; i < header->stringCount; ++i)
+	{
+		uint32_t offset = entries[i] & langpackformat::ENTRY_OFFSET_MASK;
+		if (offset >= poolSize)
+		{
+			pack->blob.Close();
+			return false;
+		}
+		pack->strings[i] = pool + offset;
+		pack->defined[i] = (entries[i] & langpackformat::ENTRY_OWN) != 0;
+	}
+
+	pack->author = pool + header->author;
+	pack->contact = pool + header->contact;
+	return true;
 }
 
-bool LoadLanguagePack(wxString const & lang)
+// Reads langpack.<lang>.xml over the texts read so far.
+// Ids that the English pack doesn't have are skipped.
+static bool readXmlPack(wxString const & lang, std::vector<wxString> & texts, LanguagePack * pack, bool own)
 {
 	wxString filename = wxString::Format(L"Langpacks/langpack.%s.xml", lang);
 	
@@ -27,28 +75,133 @@ bool LoadLanguagePack(wxString const & lang)
 	if (nodeLangPack.empty())
 		return false;
 
-	LanguagePack * newPack = new LanguagePack();
-	
-	newPack->author = nodeLangPack.attribute(L"author").value();
-	newPack->contact = nodeLangPack.attribute(L"contact").value();
+	if (own)
+	{
+		texts[(size_t)StrId::Count] = nodeLangPack.attribute(L"author").value();
+		texts[(size_t)StrId::Count + 1] = nodeLangPack.attribute(L"contact").value();
+	}
 	
+	bool found = false;
 	for (pugi::xml_node node = nodeLangPack.first_child(); node; node = node.next_sibling())
 	{
 		const wchar_t * name = node.name();
 		if (wcscmp(name, L"string") != 0)
 			continue;
 		
-		wxString id = node.attribute(L"id").value();
-		wxString text = node.attribute(L"text").value();
+		const wchar_t * id = node.attribute(L"id").value();
+		StrId strId = FindStrId(id, wcslen(id));
+		if (strId == StrId::Count)
+			continue;
+
+		wxString & text = texts[(size_t)strId];
+		text = node.attribute(L"text").value();
 		text.Replace(L"{n}", L"\n", true);
-		newPack->strings[id] = text;
+		pack->defined[(size_t)strId] = own;
+		found = true;
 	}
 	
-	if (newPack->strings.empty())
+	return found;
+}
+
+static bool loadXmlPack(wxString const & lang, LanguagePack * pack)
+{
+	// strings, then author and contact
+	std::vector<wxString> texts((size_t)StrId::Count + 2);
+	pack->defined.assign((size_t)StrId::Count, false);
+
+	if (lang != L"en")
+		readXmlPack(L"en", texts, pack, false);
+	
+	if (!readXmlPack(lang, texts, pack, true))
+		return false;
+
+	size_t poolSize = 0;
+	for (size_t i = 0; i < texts.size(); ++i)
+		poolSize += texts[i].length() + 1;
+	pack->pool.reserve(poolSize);
+
+	std::vector<size_t> offsets(texts.size());
+	for (size_t i = 0; i < texts.size(); ++i)
+	{
+		offsets[i] = pack->pool.size();
+		const wchar_t * text = texts[i].wc_str();
+		pack->pool.insert(pack->pool.end(), text, text + texts[i].length() + 1);
+	}
+
+	for (size_t i = 0; i < (size_t)StrId::Count; ++i)
+		pack->strings[i] = &pack->pool[offsets[i]];
+	pack->author = &pack->pool[offsets[(size_t)StrId::Count]];
+	pack->contact = &pack->pool[offsets[(size_t)StrId::Count + 1]];
+	return true;
+}
+
+static void buildVariantIndex(LanguagePack * pack)
+{
+	pack->families.assign((size_t)StrId::Count, VariantFamily());
+	pack->variants.clear();
+
+	for (size_t i = 0; i < (size_t)StrId::Count; ++i)
+	{
+		wxString prefix;
+		if (!pack->defined[i] || !wxString(GetStrIdName(StrId(i))).EndsWith(L"_1", &prefix))
+			continue;
+
+		VariantFamily & family = pack->families[i];
+		family.start = (uint16_t)pack->variants.size();
+		for (int n = 1; ; ++n)
+		{
+			wxString id = wxString::Format(L"%s_%d", prefix, n);
+			StrId strId = FindStrId(id.wc_str(), id.length());
+			if (strId == StrId::Count || !pack->defined[(size_t)strId])
+				break;
+			pack->variants.push_back(strId);
+		}
+		family.count = (uint16_t)(pack->variants.size() - family.start);
+	}
+}
+
+const wchar_t * LanguagePack::PickVariant(StrId first) const
+{
+	size_t count = GetVariantCount(first);
+	if (count == 0)
+		return 0;
+	return GetVariant(first, rand() % count);
+}
+
+const wchar_t * LanguagePack::Get(wxString const & id) const
+{
+	StrId strId = FindStrId(id.wc_str(), id.length());
+	if (strId == StrId::Count)
+		return L"";
+	return strings[(size_t)strId];
+}
+
+bool LanguagePack::Has(wxString const & id) const
+{
+	StrId strId = FindStrId(id.wc_str(), id.length());
+	return strId != StrId::Count && defined[(size_t)strId];
+}
+
+bool LoadLanguagePack(wxString const & lang)
+{
+	wxStopWatch loadTime;
+
+	LanguagePack * newPack = new LanguagePack();
+	newPack->strings.resize((size_t)StrId::Count);
+	newPack->defined.resize((size_t)StrId::Count, false);
+
+	wxString path = wxString::Format(L"Langpacks/langpack.%s", lang);
+	bool compiled = loadCompiledPack(path + L".lpk", path + L".xml", newPack);
+	if (!compiled && !loadXmlPack(lang, newPack))
 	{
 		delete newPack;
 		return false;
 	}
+
+	buildVariantIndex(newPack);
+	newPack->timeFormat.Init(*newPack);
+
+	LOG_INFO("Language pack %s loaded from %s in %lld us", lang, compiled ? "lpk" : "xml", (long long)loadTime.TimeInMicro().GetValue());
 	
 	if (langPack)
 		delete langPack;
@@ -1,15 +1,41 @@
 #ifndef LANGUAGE_SET_H
 #define LANGUAGE_SET_H
-#include <map>
+#include <vector>
 #include "wx/string.h"
+#include "mapped_file.h"
+#include "timeloc.h"
+#include "string_ids.h"
+
+// Numbered texts like big_pause_text_1, big_pause_text_2... Only variants from 1 up to
+// the first one missing in the pack are used.
+struct VariantFamily
+{
+	uint16_t start; // in LanguagePack::variants
+	uint16_t count;
+};
 
 struct LanguagePack
 {
-	wxString author;
-	wxString contact;
-	std::map<wxString, wxString> strings;
+	const wchar_t * author;
+	const wchar_t * contact;
+	std::vector<const wchar_t *> strings; // indexed by StrId, strings missing in the pack are taken from English
+	std::vector<bool> defined; // the string comes from the pack itself
+	std::vector<VariantFamily> families; // indexed by the StrId of the first variant
+	std::vector<StrId> variants;
+	TimeFormat timeFormat;
+
+	MappedFile blob; // compiled langpack.<lang>.lpk the strings point into
+	std::vector<wchar_t> pool; // or the strings read from XML when there is no compiled pack
 	
-	wxString const &	Get(wxString const & id);
+	const wchar_t *		Get(StrId id) const { return strings[(size_t)id]; }
+	bool				Has(StrId id) const { return defined[(size_t)id]; }
+
+	size_t				GetVariantCount(StrId first) const { return families[(size_t)first].count; }
+	const wchar_t *		GetVariant(StrId first, size_t index) const { return Get(variants[families[(size_t)first].start + index]); }
+	const wchar_t *		PickVariant(StrId first) const; // random one, 0 when there are none
+
+	// For ids built at runtime, unknown ids give an empty string
+	const wchar_t *		Get(wxString const & id) const;
 	bool				Has(wxString const & id) const;
 };
 
@@ -0,0 +1,49 @@
+#ifndef LOG_FORMAT_H
+#define LOG_FORMAT_H
+
+#include <stdint.h>
+
+// On-disk layout of the binary log (log.bin). Shared by the application and tools/log-decoder,
+// so keep this header free of wxWidgets.
+//
+// The file is a sequence of records, each starting with a one byte kind:
+//   SESSION: magic(u32) version(u16) start_time_ms(i64)
+//            written once per process start, resets the site dictionary
+//   SITE:    site_id(u16) level(u8) line(u32) file_len(u16) file[] fmt_len(u16) fmt[]
+//            written the first time a log statement is executed
+//   ENTRY:   site_id(u16) time_ms(i64) argc(u8) { arg_type(u8) payload }*
+//            INT/UINT payload is 8 bytes, DOUBLE is 8 bytes, STRING is len(u16) + utf8 bytes
+// All values are little-endian.
+
+namespace logformat
+{
+	const uint32_t kMagic = 0x474F4C45; // "ELOG"
+	const uint16_t kVersion = 1;
+
+	const uint16_t kMaxStringArg = 1024; // longer string arguments are truncated
+
+	enum ERecordKind
+	{
+		RECORD_SESSION = 1,
+		RECORD_SITE = 2,
+		RECORD_ENTRY = 3
+	};
+
+	enum EArgType
+	{
+		ARG_INT = 1,
+		ARG_UINT = 2,
+		ARG_DOUBLE = 3,
+		ARG_STRING = 4
+	};
+
+	enum ELevel
+	{
+		LEVEL_DEBUG = 0,
+		LEVEL_INFO = 1,
+		LEVEL_WARNING = 2,
+		LEVEL_ERROR = 3
+	};
+}
+
+#endif
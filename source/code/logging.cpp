@@ -1,6 +1,7 @@
 #include <stdarg.h>
 #include "logging.h"
 #include <wx/filefn.h>
+#include <wx/time.h>
 #ifdef WIN32
 	#include <stdio.h>
 	#include <windows.h>
@@ -11,6 +12,10 @@
 
 static FILE * logFile;
 
+static const size_t LOG_BUFFER_SIZE = 16 * 1024;
+static char logBuffer[LOG_BUFFER_SIZE];
+static uint16_t lastSiteId = 0;
+
 wxString GetSavePath()
 {
 	static bool isInited = false;
@@ -20,7 +25,7 @@ wxString GetSavePath()
 	if (!isInited)
 	{
 		wchar_t appDataPath[MAX_PATH];
-		
+
 		// Getting a special path
 		// CSIDL_COMMON_APPDATA -> 'C:\Documents and Settings\All Users\Application Data\'
 		// CSIDL_APPDATA -> 'C:\Documents and Settings\username\Application Data\'
@@ -30,11 +35,11 @@ wxString GetSavePath()
 			assert(!"SHGetSpecialFolderPath failed");
 			return wxString(L"");
 		}
-		
+
 		savePath.assign(appDataPath);
 		savePath += L"\\EyeLeo\\";
 		_wmkdir(savePath.c_str());
-		
+
 		isInited = true;
 	}
 #endif
@@ -44,13 +49,102 @@ wxString GetSavePath()
 
 namespace logging
 {
-	void Init()
+	namespace detail
 	{
+		char * cursor = logBuffer;
+		char * end = logBuffer; // nothing is buffered until Init opens the file
+
+		void Overflow(const void * data, size_t size)
+		{
+			if (!logFile)
+				return;
+
+			Flush();
+
+			if (size > LOG_BUFFER_SIZE)
+			{
+				fwrite(data, 1, size, logFile);
+				return;
+			}
+
+			memcpy(cursor, data, size);
+			cursor += size;
+		}
+
+		int64_t Now()
+		{
+			return wxGetUTCTimeMillis().GetValue();
+		}
+
+		static void AppendString(const char * str, size_t len)
+		{
+			if (len > logformat::kMaxStringArg)
+				len = logformat::kMaxStringArg;
+
+			uint16_t len16 = (uint16_t)len;
+			Append(&len16, sizeof(len16));
+			Append(str, len);
+		}
+
+		uint16_t RegisterSite(int level, const char * file, int line, const char * fmt)
+		{
+			// strip the directories, the file name is enough to find a statement
+			const char * fileName = file;
+			for (const char * p = file; *p; ++p)
+			{
+				if (*p == '/' || *p == '\\')
+					fileName = p + 1;
+			}
+
+			uint16_t id = ++lastSiteId;
+			uint8_t kind = logformat::RECORD_SITE;
+			uint8_t level8 = (uint8_t)level;
+			uint32_t line32 = (uint32_t)line;
 
+			Append(&kind, 1);
+			Append(&id, sizeof(id));
+			Append(&level8, 1);
+			Append(&line32, sizeof(line32));
+			AppendString(fileName, strlen(fileName));
+			AppendString(fmt, strlen(fmt));
+			return id;
+		}
+
+		void EndRecord(int level)
+		{
+			// warnings and errors are written right away, so they survive a crash
+			if (level >= logformat::LEVEL_WARNING)
+				Flush();
+		}
+
+		void Encode(const char * v)
+		{
+			uint8_t type = logformat::ARG_STRING;
+			Append(&type, 1);
+			AppendString(v, v ? strlen(v) : 0);
+		}
+
+		void Encode(const wchar_t * v)
+		{
+			Encode(wxString(v));
+		}
+
+		void Encode(wxString const & v)
+		{
+			wxScopedCharBuffer utf8 = v.utf8_str();
+
+			uint8_t type = logformat::ARG_STRING;
+			Append(&type, 1);
+			AppendString(utf8.data(), utf8.length());
+		}
+	}
+
+	void Init()
+	{
 #ifdef WIN32
-		_wfopen_s(&logFile, GetSavePath() + L"log.txt", L"r");
+		_wfopen_s(&logFile, GetSavePath() + L"log.bin", L"r");
 #else
-		logFile = fopen("log.txt", "w");
+		logFile = fopen("log.bin", "r");
 #endif
 		if (logFile) {
 			fseek(logFile, 0, SEEK_END);
@@ -62,24 +156,45 @@ namespace logging
 
 			if (size > 1024 * 1024 * 3) // remove the log, if's larger than 3 megs
 			{
-				wxRemoveFile(GetSavePath() + L"log.txt");
+				wxRemoveFile(GetSavePath() + L"log.bin");
 			}
 		}
-	}
 
-	void msg(wxString const & msg) {
+		// the file stays open for the whole session, records are written in batches by Flush
 #ifdef WIN32
-		_wfopen_s(&logFile, (GetSavePath() + L"log.txt").c_str(), L"a");
+		_wfopen_s(&logFile, (GetSavePath() + L"log.bin").c_str(), L"ab");
 #else
-		logFile = fopen("log.txt", "a");
+		logFile = fopen("log.bin", "ab");
 #endif
+		if (!logFile)
+			return;
 
-		if (logFile) {
-			fwrite((const char *) msg.mb_str(wxConvUTF8), 1, msg.size(), logFile);
-			fwrite("\n", 1, 1, logFile);
+		detail::cursor = logBuffer;
+		detail::end = logBuffer + LOG_BUFFER_SIZE;
 
-			fclose(logFile);
-		}
-		logFile = 0;
+		uint8_t kind = logformat::RECORD_SESSION;
+		uint32_t magic = logformat::kMagic;
+		uint16_t version = logformat::kVersion;
+		int64_t now = detail::Now();
+		detail::Append(&kind, 1);
+		detail::Append(&magic, sizeof(magic));
+		detail::Append(&version, sizeof(version));
+		detail::Append(&now, sizeof(now));
+		Flush();
 	}
-}
\ No newline at end of file
+
+	void Flush()
+	{
+		if (!logFile || detail::cursor == logBuffer)
+			return;
+
+		fwrite(logBuffer, 1, detail::cursor - logBuffer, logFile);
+		fflush(logFile);
+		detail::cursor = logBuffer;
+	}
+
+	void msg(wxString const & msg)
+	{
+		LOG_INFO("%s", msg);
+	}
+}
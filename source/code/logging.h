@@ -1,9 +1,125 @@
 #pragma once
 
 #include "wx/string.h"
+#include "log_format.h"
+#include <string.h>
+
+// Log levels. Statements below EYELEO_LOG_LEVEL are removed at compile time,
+// arguments included, so they cost nothing in release builds.
+#define LOG_LEVEL_DEBUG		0
+#define LOG_LEVEL_INFO		1
+#define LOG_LEVEL_WARNING	2
+#define LOG_LEVEL_ERROR		3
+#define LOG_LEVEL_NONE		4
+
+#ifndef EYELEO_LOG_LEVEL
+	#ifdef NDEBUG
+		#define EYELEO_LOG_LEVEL LOG_LEVEL_INFO
+	#else
+		#define EYELEO_LOG_LEVEL LOG_LEVEL_DEBUG
+	#endif
+#endif
+
+// Enabled statements don't format anything: they store the call site id and the raw
+// arguments into a binary record (see log_format.h). Use tools/log-decoder to read the log.
+// Format strings are printf-style and must be string literals.
+#define EYELEO_LOG(level, ...) \
+	do { \
+		static uint16_t eyeleoLogSite = 0; \
+		logging::Write(level, eyeleoLogSite, __FILE__, __LINE__, __VA_ARGS__); \
+	} while (0)
+
+#if EYELEO_LOG_LEVEL <= LOG_LEVEL_DEBUG
+	#define LOG_DEBUG(...) EYELEO_LOG(logformat::LEVEL_DEBUG, __VA_ARGS__)
+#else
+	#define LOG_DEBUG(...) ((void)0)
+#endif
+
+#if EYELEO_LOG_LEVEL <= LOG_LEVEL_INFO
+	#define LOG_INFO(...) EYELEO_LOG(logformat::LEVEL_INFO, __VA_ARGS__)
+#else
+	#define LOG_INFO(...) ((void)0)
+#endif
+
+#if EYELEO_LOG_LEVEL <= LOG_LEVEL_WARNING
+	#define LOG_WARNING(...) EYELEO_LOG(logformat::LEVEL_WARNING, __VA_ARGS__)
+#else
+	#define LOG_WARNING(...) ((void)0)
+#endif
+
+#if EYELEO_LOG_LEVEL <= LOG_LEVEL_ERROR
+	#define LOG_ERROR(...) EYELEO_LOG(logformat::LEVEL_ERROR, __VA_ARGS__)
+#else
+	#define LOG_ERROR(...) ((void)0)
+#endif
 
 namespace logging
 {
 	void Init();
-	void msg(wxString const & msg);
-}
\ No newline at end of file
+	void Flush();
+	void msg(wxString const & msg); // logged with LOG_INFO
+
+	// Logging is only done from the GUI thread, the buffer below isn't locked.
+	namespace detail
+	{
+		extern char * cursor;
+		extern char * end;
+
+		void Overflow(const void * data, size_t size);
+		uint16_t RegisterSite(int level, const char * file, int line, const char * fmt);
+		int64_t Now();
+		void EndRecord(int level);
+
+		inline void Append(const void * data, size_t size)
+		{
+			if (size <= size_t(end - cursor))
+			{
+				memcpy(cursor, data, size);
+				cursor += size;
+			}
+			else
+			{
+				Overflow(data, size);
+			}
+		}
+
+		template <typename T>
+		inline void AppendValue(uint8_t type, T value)
+		{
+			Append(&type, 1);
+			Append(&value, sizeof(value));
+		}
+
+		inline void Encode(int v)					{ AppendValue(logformat::ARG_INT, (int64_t)v); }
+		inline void Encode(long v)					{ AppendValue(logformat::ARG_INT, (int64_t)v); }
+		inline void Encode(long long v)				{ AppendValue(logformat::ARG_INT, (int64_t)v); }
+		inline void Encode(unsigned int v)			{ AppendValue(logformat::ARG_UINT, (uint64_t)v); }
+		inline void Encode(unsigned long v)			{ AppendValue(logformat::ARG_UINT, (uint64_t)v); }
+		inline void Encode(unsigned long long v)	{ AppendValue(logformat::ARG_UINT, (uint64_t)v); }
+		inline void Encode(double v)				{ AppendValue(logformat::ARG_DOUBLE, v); }
+		inline void Encode(const void * v)			{ AppendValue(logformat::ARG_UINT, (uint64_t)(uintptr_t)v); }
+		void Encode(const char * v);
+		void Encode(const wchar_t * v);
+		void Encode(wxString const & v);
+	}
+
+	template <typename... Args>
+	void Write(int level, uint16_t & site, const char * file, int line, const char * fmt, Args const &... args)
+	{
+		if (!site)
+			site = detail::RegisterSite(level, file, line, fmt);
+
+		uint8_t header[1 + sizeof(uint16_t) + sizeof(int64_t) + 1];
+		int64_t now = detail::Now();
+		header[0] = logformat::RECORD_ENTRY;
+		memcpy(header + 1, &site, sizeof(site));
+		memcpy(header + 3, &now, sizeof(now));
+		header[11] = (uint8_t)sizeof...(Args);
+		detail::Append(header, sizeof(header));
+
+		int expand[] = { 0, (detail::Encode(args), 0)... };
+		(void)expand;
+
+		detail::EndRecord(level);
+	}
+}
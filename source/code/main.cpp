@@ -1,5 +1,6 @@
 #include "main.h"
 #include <algorithm>
+#include <climits>
 #include <wx/tipwin.h>
 #include <wx/taskbar.h>
 #include <wx/sizer.h>
@@ -9,6 +10,7 @@
 #include <wx/stattext.h>
 #include <wx/stdpaths.h>
 #include <wx/filename.h>
+#include <wx/imagpng.h>
 #include "pugixml.hpp"
 #include "bigpause_wnd.h"
 #include "beforepause_wnd.h"
@@ -23,8 +25,16 @@
 #include "language_set.h"
 #include "debug_wnd.h"
 #include "excercises.h"
+#include "backdrop.h"
+#include "fullscreen_tracker.h"
+#include "exclusion_rules.h"
 #include "logging.h"
 #include "settings.h"
+#include "settings_store.h"
+#include "state_journal.h"
+#include "stats_store.h"
+#include "adherence_stats.h"
+#include "animation_driver.h"
 
 #ifdef WIN32
 	#include <Wtsapi32.h>
@@ -33,6 +43,7 @@
 	#include <direct.h>
 	#include <winver.h>
 	#include <VersionHelpers.h>
+	#include <psapi.h>
 #endif
 
 static EyeApp * g_eyeApp = nullptr;
@@ -50,12 +61,36 @@ EyeApp * getApp()
 BEGIN_EVENT_TABLE(EyeApp, wxApp)
 	EVT_QUERY_END_SESSION(EyeApp::OnQueryEndSession)
 	EVT_END_SESSION(EyeApp::OnEndSession)
+	EVT_DISPLAY_CHANGED(EyeApp::OnDisplayChanged)
+#if wxCHECK_VERSION(3, 1, 3)
+	EVT_DPI_CHANGED(EyeApp::OnDpiChanged)
+#endif
 	EVT_COMMAND(wxID_ANY, EXECUTE_TASK_EVENT, EyeApp::OnTaskEvent)
 END_EVENT_TABLE()
 
 
 EyeApp::EyeApp() : 
 	_settingsWnd(nullptr),
+	_settingsStore(nullptr),
+	_journal(nullptr),
+	_stats(nullptr),
+	_adherence(nullptr),
+	_activeSinceBreak(0),
+	_bigPauseText(0),
+	_excercise(0),
+	_lastExcercise(0),
+	_excerciseText(0),
+	_excerciseAnim(0),
+	_backdrops(0),
+	_blurWorkers(0),
+	_fullscreenTracker(0),
+	_exclusionRules(0),
+	_overlayPoolGeneration(0),
+	_overlayOverdue(0),
+	_overlayDeadlinePending(false),
+	_overlayPooled(false),
+	_timeSinceJournal(0),
+	_timeWithoutOverlays(0),
 	_inactivityTime(0),
 	_timeLeftToBigPause(0),
 	_timeLeftToMiniPause(0),
@@ -97,7 +132,7 @@ void EyeApp::ReadConfig()
 		wxFileName execPath = wxStandardPaths::Get().GetExecutablePath();
 		execPath.SetFullName("config.xml");
 
-		logging::msg("Failed to load config.xml from cwd, trying executable path: " + execPath.GetFullPath());
+		LOG_WARNING("Failed to load config.xml from cwd, trying executable path: %s", execPath.GetFullPath());
 
 		result = doc.load_file((const wchar_t *)execPath.GetFullPath().c_str());
 	}
@@ -111,11 +146,11 @@ void EyeApp::ReadConfig()
 			_version.assign(node.attribute(L"version").value());
 			_website.assign(node.attribute(L"website").value());
 		}
-		logging::msg(wxString::Format("Config read, lang=%s, version=%s, website=%s", _lang, _version, _website));
+		LOG_INFO("Config read, lang=%s, version=%s, website=%s", _lang, _version, _website);
 	}
 	else
 	{
-		logging::msg("Failed to read config.xml");
+		LOG_WARNING("Failed to read config.xml");
 		wxMessageBox(_("Could't load config.xml file."), _("EyeLeo"));
 	}
 }
@@ -126,11 +161,25 @@ bool EyeApp::OnInit()
 		return false;
 
 	logging::Init();
+
+	// Startup runs in phases: images are decoded on worker threads while config, language
+	// and settings load here; the tray icon goes up as soon as its strings are there.
+	// The decoded images are only waited for before the first window needs them.
+	wxStopWatch startupTime;
+	wxStopWatch phaseTime;
 	
 	srand((unsigned)time(0));
+
+	wxImage::AddHandler(new wxPNGHandler);
+	g_Personage = new PersonageData(L"leopard");
+	StartLoadingResources();
 	
 	fillOSCapabilities();
 
+	_fullscreenTracker = new FullscreenTracker();
+	if (!_fullscreenTracker->Start())
+		LOG_WARNING("Can't hook foreground changes, the foreground window is checked every time");
+
 	_lang = L"en";
 	_version = L"(?)";
 	_website = L"eyeleo.com";
@@ -149,12 +198,14 @@ bool EyeApp::OnInit()
 		}
 	}
 	
-	wxInitAllImageHandlers();
-	
-	LoadEyeLeoResources();
-	
+	LOG_INFO("Startup: config and language pack in %lld us", (long long)phaseTime.TimeInMicro().GetValue());
+	phaseTime.Start();
+
 	_taskBarIcon = new EyeTaskBarIcon();
 
+	LOG_INFO("Startup: tray icon in %lld us", (long long)phaseTime.TimeInMicro().GetValue());
+	phaseTime.Start();
+
 	g_TaskMgr = new TaskManager();
 	
 	wxThreadError err = g_TaskMgr->Run();
@@ -163,15 +214,60 @@ bool EyeApp::OnInit()
 		wxMessageBox(_("Can't start timer thread!"));
 		return false;
 	}
+	g_Animations = new AnimationDriver();
 
 	//_fastMode = true;
 
+	_settingsStore = new SettingsStore(GetSavePath() + L"settings.xml", eyeleo::settings::settingsSaveDelay);
+	if (_settingsStore->Run() != wxTHREAD_NO_ERROR)
+	{
+		wxMessageBox(_("Can't start settings thread!"));
+		return false;
+	}
+
+	_journal = new StateJournal();
+	if (!_journal->Open(GetSavePath() + L"state.journal"))
+		LOG_WARNING("Can't open the state journal");
+
+	_stats = new StatsStore();
+	if (!_stats->Open(GetSavePath() + L"stats.bin"))
+		LOG_WARNING("Can't open the statistics");
+
+	_adherence = new AdherenceStats();
+	_adherence->Load(GetSavePath() + L"sketches.bin");
+
+	LOG_INFO("Startup: threads and stores in %lld us", (long long)phaseTime.TimeInMicro().GetValue());
+	phaseTime.Start();
+
 	ResetSettings();
 
 	if (!LoadSettings())
 		ResetSettings();
 	else
 		CheckSettings();
+
+	_exclusionRules = new ExclusionRules();
+	LoadExclusionRules();
+
+	// timers and statistics from the journal take precedence over the ones
+	// older versions kept in settings.xml
+	wxStopWatch replayTime;
+	RuntimeState runtimeState;
+	if (_journal->Replay(runtimeState))
+	{
+		_lastShutdown = wxDateTime(wxLongLong(runtimeState.wallTime));
+		_lastBigPauseTimeLeft = runtimeState.timeLeftToBigPause;
+		_lastMiniPauseTimeLeft = runtimeState.timeLeftToMiniPause;
+		_postponeCount = runtimeState.postponeCount;
+		_userLongBreakCount = runtimeState.longBreakCount;
+		_userEarlySkipCount = runtimeState.earlySkipCount;
+		_userLateSkipCount = runtimeState.lateSkipCount;
+		_userRefuseCount = runtimeState.refuseCount;
+		_userPostponeCount = runtimeState.postponeTotal;
+		_userAutoBreakCount = runtimeState.autoBreakCount;
+		_userShortBreakCount = runtimeState.shortBreakCount;
+		LOG_INFO("State journal replayed in %lld us", (long long)replayTime.TimeInMicro().GetValue());
+	}
 	
 	if (_firstLaunch)
 	{
@@ -181,34 +277,16 @@ bool EyeApp::OnInit()
 	{
 		if (_lastShutdown.IsValid())
 		{
-			wxDateTime now = wxDateTime::Now();
+			wxTimeSpan lastShutdownP = wxDateTime::Now().Subtract(_lastShutdown);
+			ResumedTimers timers = resumeTimers(_lastBigPauseTimeLeft, _lastMiniPauseTimeLeft, _postponeCount,
+				lastShutdownP.GetMilliseconds().GetValue());
 
-			wxTimeSpan lastShutdownP = now.Subtract(_lastShutdown);
-			long secondsWent = lastShutdownP.GetSeconds().ToLong();
-
-			if (secondsWent > 0 && secondsWent <= 30 * 60 /*<= 30 mins */)
+			if (timers.resumed)
 			{
-				wxLongLong_t p = lastShutdownP.GetMilliseconds().GetValue();
-				long lastBigPauseTimeLeft = _lastBigPauseTimeLeft - p;
-				long lastMiniPauseTimeLeft = _lastMiniPauseTimeLeft - p;
-
-				if (lastBigPauseTimeLeft < -1000 * 60 * 3)
-				{
-					RestartBigPauseInterval();
-					RestartMiniPauseInterval();
-				}
-				else {
-					if (lastBigPauseTimeLeft < 1000 * 60) // not less than a minute
-						lastBigPauseTimeLeft = 1000 * 60;
-
-					SetBigPauseTime(lastBigPauseTimeLeft);
-
-					if (lastMiniPauseTimeLeft < 1000 * 60)
-						lastMiniPauseTimeLeft = 1000 * 60;
-
-					SetMiniPauseTime(lastMiniPauseTimeLeft);
-				}
-
+				SetBigPauseTime(timers.timeLeftToBigPause);
+				SetMiniPauseTime(timers.timeLeftToMiniPause);
+				// SetBigPauseTime starts the postpones over, the replayed ones are kept
+				_postponeCount = timers.postponeCount;
 				UpdateTaskbarText();
 			}
 			else
@@ -223,10 +301,13 @@ bool EyeApp::OnInit()
 		}
 	}
 	
+	LOG_INFO("Startup: settings and timers in %lld us", (long long)phaseTime.TimeInMicro().GetValue());
+	phaseTime.Start();
+
 	PrepareActivityMonitor();
 	InstallActivityMonitor();
-	
-	g_Personage = new PersonageData(L"leopard");
+
+	LOG_INFO("Startup: activity monitor in %lld us", (long long)phaseTime.TimeInMicro().GetValue());
 	
 #ifndef RELEASE
 	//_debugWindow = new DebugWindow();
@@ -234,8 +315,10 @@ bool EyeApp::OnInit()
 #endif
 
 	int big_pause_seconds = _timeLeftToBigPause / 1000;
-	wxString text = wxString::Format(langPack->Get("tb_notification_first_launch"), getTimeStr(big_pause_seconds, SECONDS, _lang));
-	_taskBarIcon->ShowBalloon(langPack->Get("tb_popup_default"), text, 1000 * 10, wxICON_INFORMATION);
+	wxString text = wxString::Format(langPack->Get(StrId::tb_notification_first_launch), getTimeStr(big_pause_seconds, SECONDS));
+	_taskBarIcon->ShowBalloon(langPack->Get(StrId::tb_popup_default), text, 1000 * 10, wxICON_INFORMATION);
+
+	LOG_INFO("Startup finished in %lld us", (long long)startupTime.TimeInMicro().GetValue());
 	
 	return true;
 }
@@ -288,7 +371,7 @@ wxString EyeApp::GetSavePath() const
 
 void EyeApp::RestartBigPauseInterval()
 {
-	logging::msg("RestartBigPauseInterval");
+	LOG_INFO("RestartBigPauseInterval");
 
 	_postponeCount = 0;
 	_inactivityTime = 0;
@@ -304,7 +387,7 @@ void EyeApp::RestartBigPauseInterval()
 
 void EyeApp::SetBigPauseTime(long ms)
 {
-	logging::msg(wxString::Format(L"SetBigPauseTime to %d", ms));
+	LOG_INFO("SetBigPauseTime to %d", ms);
 	
 	_postponeCount = 0;
 	_inactivityTime = 0;
@@ -315,7 +398,7 @@ void EyeApp::SetBigPauseTime(long ms)
 	}
 	else if (ms > 1000 * 60 * _bigPauseInterval) // not more current duration setting (bug check)
 	{
-		logging::msg(wxString::Format(L"Error! SetBigPauseTime"));
+		LOG_ERROR("Error! SetBigPauseTime");
 		ms = 1000 * 60 * _bigPauseInterval;
 	}
 
@@ -329,7 +412,7 @@ void EyeApp::SetBigPauseTime(long ms)
 
 void EyeApp::RestartMiniPauseInterval()
 {
-	logging::msg("RestartMiniPauseInterval");
+	LOG_INFO("RestartMiniPauseInterval");
 
 	if (_enableMiniPause)
 		_timeLeftToMiniPause = _miniPauseInterval * 1000 * 60;
@@ -339,7 +422,7 @@ void EyeApp::RestartMiniPauseInterval()
 
 void EyeApp::SetMiniPauseTime(long ms)
 {
-	logging::msg(wxString::Format(L"SetMiniPauseTime to %d", ms));
+	LOG_INFO("SetMiniPauseTime to %d", ms);
 
 	if (ms < 1000 * 91)
 		ms = 1000 * 91;
@@ -361,71 +444,35 @@ void EyeApp::OnUserActivity()
 
 	if (GetNextState() == STATE_AUTO_RELAX)
 	{
-		logging::msg("OnUserActivity ended auto-relax");
+		LOG_INFO("OnUserActivity ended auto-relax");
 		ApplySettings();
 
 		int big_pause_seconds = _timeLeftToBigPause / 1000;
-		wxString text = wxString::Format(langPack->Get("tb_notification_auto_relax_ended"), getTimeStr(big_pause_seconds, SECONDS, _lang));
-		_taskBarIcon->ShowBalloon(langPack->Get("tb_popup_default"), text, 1000 * 8, wxICON_INFORMATION);
+		wxString text = wxString::Format(langPack->Get(StrId::tb_notification_auto_relax_ended), getTimeStr(big_pause_seconds, SECONDS));
+		_taskBarIcon->ShowBalloon(langPack->Get(StrId::tb_popup_default), text, 1000 * 8, wxICON_INFORMATION);
 	}
 }
 
 // Check if full screen app is running, returns display number or -1 as 'display'
 bool EyeApp::IsFullscreenAppRunning(int * display, HWND * fullscreenWndHandle) const
 {
-	HWND hWnd = GetForegroundWindow();
-	if (!hWnd)
-	{
-		//logging::msg("IsFullscreenAppRunning failed 0");
+	void * handle = 0;
+	if (!_fullscreenTracker || !_fullscreenTracker->IsFullscreen(display, &handle))
 		return false;
-	}
 
-	HWND hDesktop = GetDesktopWindow();
-	HWND hShell = GetShellWindow();
-	if (hWnd == hDesktop || hWnd == hShell)
-	{
-		logging::msg("IsFullscreenAppRunning failed 1");
-		return false;
-	}
-
-	if (!IsWindowVisible(hWnd) || IsIconic(hWnd))
-	{
-		logging::msg("IsFullscreenAppRunning failed 2");
-		return false;
-	}
-	
-	RECT wndArea;
-	if (!GetWindowRect(hWnd, &wndArea))
-	{
-		logging::msg("IsFullscreenAppRunning failed 3");
-		return false;
-	}
-
-	refillResolutionParams();
+	if (fullscreenWndHandle)
+		*fullscreenWndHandle = (HWND)handle;
+	return true;
+}
 
-	//logging::msg(wxString::Format("wndArea (%d, %d), (%d, %d)", wndArea.left, wndArea.right, wndArea.top, wndArea.bottom));
+bool EyeApp::IsBigPauseExcluded() const
+{
+	return _fullscreenTracker && _fullscreenTracker->GetPolicy() >= POLICY_MINI_PAUSES_ONLY;
+}
 
-	for (int d = 0; d < osCaps.numDisplays; ++d)
-	{
-		wxRect displayArea = osCaps.displays[d].geometry;
-		
-		//logging::msg(wxString::Format("%d) displayArea (%d, %d, %d, %d)", d, displayArea.x, displayArea.y, displayArea.width, displayArea.height));
-		
-		if (wndArea.left == displayArea.x &&
-			wndArea.top == displayArea.y &&
-			wndArea.right - wndArea.left == displayArea.width &&
-			wndArea.bottom - wndArea.top == displayArea.height)
-		{
-			if (display)
-				*display = d;
-			if (fullscreenWndHandle)
-				*fullscreenWndHandle = hWnd;
-			//logging::msg(wxString::Format("Fullscreen app is at disp %d", d));
-			return true;
-		}
-	}
-	//logging::msg("No fullscreen app running");
-	return false;
+bool EyeApp::IsMiniPauseExcluded() const
+{
+	return _fullscreenTracker && _fullscreenTracker->GetPolicy() >= POLICY_NO_BREAKS;
 }
 
 void EyeApp::UpdateTaskbarText()
@@ -439,7 +486,9 @@ void EyeApp::UpdateTaskbarText()
 	if (GetNextState() == STATE_SUSPENDED)
 	{
 		int secs = _inactivityTime / 1000;
-		wxString text = wxString::Format(langPack->Get("tb_popup_paused"), getTimeStr(secs, SECONDS, _lang));
+		wchar_t timeStr[TIME_STR_SIZE];
+		formatTime(timeStr, TIME_STR_SIZE, secs, SECONDS);
+		wxString text = wxString::Format(langPack->Get(StrId::tb_popup_paused), timeStr);
 		_taskBarIcon->UpdateTooltip(text);
 		return;
 	}
@@ -447,12 +496,14 @@ void EyeApp::UpdateTaskbarText()
 	if (_enableBigPause)
 	{
 		int secs = _timeLeftToBigPause / 1000;
-		wxString text = wxString::Format(langPack->Get("tb_popup_active_1"), getTimeStr(secs, SECONDS, _lang));
+		wchar_t timeStr[TIME_STR_SIZE];
+		formatTime(timeStr, TIME_STR_SIZE, secs, SECONDS);
+		wxString text = wxString::Format(langPack->Get(StrId::tb_popup_active_1), timeStr);
 		_taskBarIcon->UpdateTooltip(text);
 	}
 	else
 	{
-		_taskBarIcon->UpdateTooltip(langPack->Get("tb_popup_default"));
+		_taskBarIcon->UpdateTooltip(langPack->Get(StrId::tb_popup_default));
 	}
 }
 
@@ -491,7 +542,7 @@ void EyeApp::OnTaskEvent(wxCommandEvent &c)
 
 	if (pl->check != 12345)
 	{
-		logging::msg(wxString::Format("Detected wrong event! pl=%x", pl));
+		LOG_ERROR("Detected wrong event! pl=%x", pl);
 		assert(false);
 	}
 
@@ -523,6 +574,9 @@ ITask *EyeApp::getWindow(const wxString &address)
 	if (address == "EyeApp")
 		return this;
 
+	if (address == AnimationDriver::ADDRESS)
+		return g_Animations;
+
 	for (std::vector<BigPauseWindow*>::iterator wnd = _bigPauseWnds.begin(); wnd != _bigPauseWnds.end(); ++wnd)
 	{
 		if ((*wnd)->GetName() == address)
@@ -555,6 +609,7 @@ ITask *EyeApp::getWindow(const wxString &address)
 
 void EyeApp::ExecuteTask(float, long time_went)
 {
+	int previousState = _currentState;
 	_currentState = _nextState;
 	_nextState = 0;
 
@@ -579,11 +634,11 @@ void EyeApp::ExecuteTask(float, long time_went)
 			_inactivityTime -= time_went * multiplier;
 			if (_inactivityTime <= 0)
 			{
-				_taskBarIcon->ShowBalloon(langPack->Get("tb_popup_default"), langPack->Get("tb_notification_start_after_pause"), 1000 * 10, wxICON_INFORMATION);
+				_taskBarIcon->ShowBalloon(langPack->Get(StrId::tb_popup_default), langPack->Get(StrId::tb_notification_start_after_pause), 1000 * 10, wxICON_INFORMATION);
 				RestartBigPauseInterval();
 				RestartMiniPauseInterval();
 
-				SaveSettings();
+				SaveRuntimeState();
 			}
 
 			UpdateTaskbarText();
@@ -592,8 +647,8 @@ void EyeApp::ExecuteTask(float, long time_went)
 
 	case STATE_FIRST_LAUNCH:
 		{
-			wxString text = wxString::Format(langPack->Get("tb_notification_first_launch"), getTimeStr(_bigPauseInterval, MINUTES, _lang));
-			_taskBarIcon->ShowBalloon(langPack->Get("tb_popup_default"), text, 1000 * 10, wxICON_INFORMATION);
+			wxString text = wxString::Format(langPack->Get(StrId::tb_notification_first_launch), getTimeStr(_bigPauseInterval, MINUTES));
+			_taskBarIcon->ShowBalloon(langPack->Get(StrId::tb_popup_default), text, 1000 * 10, wxICON_INFORMATION);
 
 			_firstLaunch = false;
 
@@ -605,12 +660,19 @@ void EyeApp::ExecuteTask(float, long time_went)
 	case STATE_IDLE:
 		if (_enableBigPause || _enableMiniPause)
 		{
-			static int skipCounter = 0;
-			if (++skipCounter == 3) {
-				logging::msg(
-						wxString::Format("State: Idle: _timeLeftToBigPause=%ld, _timeLeftToMiniPause=%ld, _inactivityTime=%ld",
-										 _timeLeftToBigPause, _timeLeftToMiniPause, _inactivityTime));
-				skipCounter = 0;
+			// the timers tick every second, log them only when the minute value changes
+			static long loggedBigPauseMinutes = -1;
+			static long loggedMiniPauseMinutes = -1;
+			static long loggedInactivityMinutes = -1;
+			if (loggedBigPauseMinutes != _timeLeftToBigPause / 60000 ||
+				loggedMiniPauseMinutes != _timeLeftToMiniPause / 60000 ||
+				loggedInactivityMinutes != _inactivityTime / 60000)
+			{
+				loggedBigPauseMinutes = _timeLeftToBigPause / 60000;
+				loggedMiniPauseMinutes = _timeLeftToMiniPause / 60000;
+				loggedInactivityMinutes = _inactivityTime / 60000;
+				LOG_DEBUG("State: Idle: _timeLeftToBigPause=%ld, _timeLeftToMiniPause=%ld, _inactivityTime=%ld",
+					_timeLeftToBigPause, _timeLeftToMiniPause, _inactivityTime);
 			}
 			
 			RepeatState();
@@ -619,6 +681,9 @@ void EyeApp::ExecuteTask(float, long time_went)
 
 			CheckSettings();
 
+			UpdateResourceResidency(time_went);
+			WarmOverlayPools();
+
 			if (_settingInactivityTracking) {
 				if (_inactivityTime >= 8 * 60 * 1000) // 8 mins
 				{
@@ -636,8 +701,10 @@ void EyeApp::ExecuteTask(float, long time_went)
 					if (_timeLeftToBigPause <= _warningInterval * 60 * 1000 &&
 						_timeLeftToBigPause > eyeleo::settings::timeForLongBreakConfirmation * 1000)
 					{
-						if (!NotificationWindow::hasAnyInstance() && !_showedLongBreakCountdown)
+						if (!NotificationWindow::hasAnyInstance() && !_showedLongBreakCountdown && !IsBigPauseExcluded())
 						{
+							EnsureResourcesLoaded();
+
 							// открыть countdown окно, но только не поверх fullscreen приложения
 							int fullscreenDisplay = -1;
 							bool isFullscreen = IsFullscreenAppRunning(&fullscreenDisplay);
@@ -655,7 +722,7 @@ void EyeApp::ExecuteTask(float, long time_went)
 								wnd->Show(true);
 								_notificationWnd = wnd;
 
-								logging::msg(wxString("Countdown window opened"));
+								LOG_INFO("Countdown window opened");
 
 								_showedLongBreakCountdown = true;
 								//_fastMode = false;
@@ -663,13 +730,14 @@ void EyeApp::ExecuteTask(float, long time_went)
 							}
 
 							if (!_showedLongBreakCountdown)
-								logging::msg("Couldn't show a coundown because of fullscreen app");
+								LOG_WARNING("Couldn't show a coundown because of fullscreen app");
 						}
 					}
 				}
 				
 				if (_timeLeftToBigPause <= eyeleo::settings::timeForLongBreakConfirmation * 1000)
 				{
+					MarkOverlayDeadline(eyeleo::settings::timeForLongBreakConfirmation * 1000 - _timeLeftToBigPause);
 					ChangeState(STATE_START_BIG_PAUSE, 100);
 				}
 			}
@@ -682,12 +750,34 @@ void EyeApp::ExecuteTask(float, long time_went)
 				{
 					if (_timeLeftToMiniPause <= 0)
 					{
-						StartMiniPause();
+						if (IsMiniPauseExcluded())
+						{
+							LOG_INFO("Mini pause skipped because of an exclusion rule");
+							RestartMiniPauseInterval();
+						}
+						else
+						{
+							MarkOverlayDeadline(-_timeLeftToMiniPause);
+							StartMiniPause();
+						}
 
-						SaveSettings();
+						SaveRuntimeState();
 					}
 				}
 			}
+
+			if (_inactivityTime == 0)
+			{
+				_stats->AddActiveTime(time_went);
+				_activeSinceBreak += time_went;
+			}
+
+			_timeSinceJournal += time_went;
+			if (_timeSinceJournal >= eyeleo::settings::journalInterval)
+			{
+				SaveRuntimeState();
+				_adherence->Flush();
+			}
 		}
 		else
 		{
@@ -698,7 +788,7 @@ void EyeApp::ExecuteTask(float, long time_went)
 	case STATE_WAITING_SCREEN:
 		{
 			// Note that we might be in this state not only because of fullscreen application, but also because of locked OS
-			logging::msg(wxString::Format("State: Waiting screen: _fullscreenBlockDuration=%d", _fullscreenBlockDuration));
+			LOG_DEBUG("State: Waiting screen: _fullscreenBlockDuration=%d", _fullscreenBlockDuration);
 			RepeatState();
 
 			int multiplier = _fastMode ? 1 : 1;
@@ -706,29 +796,31 @@ void EyeApp::ExecuteTask(float, long time_went)
 			_timeUntilWaitingWnd += time_went * multiplier;
 			
 			if (_timeUntilWaitingWnd >= 1000 * 60 * 1 &&
-				_fullscreenBlockDuration < 1000 * 60 * 3) // should appear 2 times with 1 min interval after 1 min of wait
+				_fullscreenBlockDuration < 1000 * 60 * 3 && // should appear 2 times with 1 min interval after 1 min of wait
+				!IsBigPauseExcluded())
 			{
 				ShowWaitingWnd();
 			}
 			
 			if (_fullscreenBlockDuration >= 1000 * 60 * 5) // after 5 mins
 			{
-				logging::msg("Restarting big pause after 5 mins waiting");
+				LOG_INFO("Restarting big pause after 5 mins waiting");
 
 				RestartBigPauseInterval(); // cancel current big pause
-				SaveSettings();
+				SaveRuntimeState();
 			}
 			else
 			{
-				bool fullscreenBlock = IsFullscreenAppRunning();
+				bool fullscreenBlock = IsFullscreenAppRunning() || IsBigPauseExcluded();
 				if (fullscreenBlock)
 				{
 					ChangeState(STATE_WAITING_SCREEN, 3000);
 				}
 				else
 				{
-					logging::msg("Big pause no longer blocked, starting it...");
+					LOG_INFO("Big pause no longer blocked, starting it...");
 					CloseWaitingWnd();
+					MarkOverlayDeadline(-3000);
 					ChangeState(STATE_START_BIG_PAUSE, 3000);
 				}
 			}
@@ -737,8 +829,10 @@ void EyeApp::ExecuteTask(float, long time_went)
 	
 	case STATE_START_BIG_PAUSE:
 		{
-			logging::msg(wxString("State: Start big pause"));
-			if (_enableStrictMode)
+			LOG_INFO("State: Start big pause");
+			// strict mode minimizes fullscreen windows, but the applications excluded by the user are left alone
+			bool excluded = IsBigPauseExcluded();
+			if (_enableStrictMode && !excluded)
 			{
 				HWND hwnd;
 				bool fullscreenBlock = IsFullscreenAppRunning(0, &hwnd);
@@ -754,16 +848,23 @@ void EyeApp::ExecuteTask(float, long time_went)
 			}
 			else
 			{
-				bool fullscreenBlock = IsFullscreenAppRunning();
+				bool fullscreenBlock = excluded || IsFullscreenAppRunning();
 				if (!fullscreenBlock)
 				{
 					AskForBigPause();
 				}
 				else
 				{
-					logging::msg(wxString("Couldn't start big pause because of fullscreen block"));
-
-					ShowWaitingWnd();
+					// the user asked for no breaks in that application, nothing is put over it
+					if (excluded)
+					{
+						LOG_WARNING("Couldn't start big pause because of an exclusion rule");
+					}
+					else
+					{
+						LOG_WARNING("Couldn't start big pause because of fullscreen block");
+						ShowWaitingWnd();
+					}
 					_fullscreenBlockDuration = 0;
 					_timeUntilWaitingWnd = 0;
 					ChangeState(STATE_WAITING_SCREEN, 1000);
@@ -774,7 +875,8 @@ void EyeApp::ExecuteTask(float, long time_went)
 	
 	case STATE_AUTO_RELAX:
 		RepeatState();
-		logging::msg(wxString("State: Auto relax"));
+		if (previousState != STATE_AUTO_RELAX)
+			LOG_INFO("State: Auto relax");
 		_inactivityTime += time_went;
 		
 		if (!CheckInactivity())
@@ -785,7 +887,12 @@ void EyeApp::ExecuteTask(float, long time_went)
 	
 	case STATE_RELAXING:
 		{
-			logging::msg(wxString::Format("State: Relaxing: _relaxingTimeLeft=%d", _relaxingTimeLeft));
+			static long loggedRelaxingMinutes = -1;
+			if (previousState != STATE_RELAXING || loggedRelaxingMinutes != _relaxingTimeLeft / 60000)
+			{
+				loggedRelaxingMinutes = _relaxingTimeLeft / 60000;
+				LOG_DEBUG("State: Relaxing: _relaxingTimeLeft=%d", _relaxingTimeLeft);
+			}
 
 			int multiplier = _fastMode ? 1 : 1;
 			_relaxingTimeLeft -= time_went * multiplier;
@@ -797,7 +904,6 @@ void EyeApp::ExecuteTask(float, long time_went)
 					::PlaySound(L"SystemExclamation", NULL, SND_ALIAS | SND_ASYNC);
 	#endif
 				StopBigPause();
-				SaveSettings();
 			}
 			else
 			{
@@ -814,6 +920,196 @@ void EyeApp::ExecuteTask(float, long time_went)
 	}
 
 	UpdateDebugWindow();
+
+	logging::Flush();
+}
+
+bool EyeApp::HasOverlayWindows() const
+{
+	return !_bigPauseWnds.empty() || !_miniPauseWnds.empty() || !_waitWnds.empty() ||
+		!_beforePauseWnds.empty() || NotificationWindow::hasAnyInstance();
+}
+
+// ms until the idle state opens the next window, LONG_MAX when none is scheduled
+long EyeApp::GetTimeToNextOverlay() const
+{
+	long next = LONG_MAX;
+	if (_enableBigPause)
+	{
+		long opensAt = eyeleo::settings::timeForLongBreakConfirmation * 1000;
+		if (_warningInterval > 0.0f && !_showedLongBreakCountdown)
+			opensAt = (long)(_warningInterval * 60 * 1000);
+		next = std::min(next, _timeLeftToBigPause - opensAt);
+	}
+	if (_enableMiniPause)
+		next = std::min(next, _timeLeftToMiniPause);
+	return next;
+}
+
+#ifdef WIN32
+static void logProcessResources(const char * when)
+{
+	PROCESS_MEMORY_COUNTERS counters = { sizeof(counters) };
+	GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+	LOG_INFO("%s: working set %u KB, GDI objects %u", when,
+		(unsigned)(counters.WorkingSetSize / 1024), (unsigned)GetGuiResources(GetCurrentProcess(), GR_GDIOBJECTS));
+}
+#endif
+
+// Break window images are only kept while a window may need them soon
+void EyeApp::UpdateResourceResidency(long time_went)
+{
+	if (HasOverlayWindows())
+	{
+		_timeWithoutOverlays = 0;
+		return;
+	}
+
+	if (GetTimeToNextOverlay() <= eyeleo::settings::resourcePrefetchTime)
+	{
+		PrefetchResources();
+		return;
+	}
+
+	_timeWithoutOverlays += time_went;
+	if (_timeWithoutOverlays < eyeleo::settings::resourceReleaseDelay)
+		return;
+
+	size_t budget = (size_t)eyeleo::settings::resourceMemoryBudget * 1024;
+	if (GetResidentResourceBytes() <= budget)
+		return;
+
+#ifdef WIN32
+	logProcessResources("Before releasing images");
+#endif
+	// pooled windows keep pointers to the images
+	ClearOverlayPools();
+	size_t released = TrimResources(budget);
+	LOG_INFO("Released %u KB of images", (unsigned)(released / 1024));
+#ifdef WIN32
+	logProcessResources("After releasing images");
+#endif
+}
+
+// A hidden window from the pool, a new one when the pool wasn't warmed in time
+template <class Window>
+static Window * takeWindow(OverlayPool<Window> & pool, int displayInd, bool & pooled)
+{
+	Window * wnd = pool.Take(displayInd);
+	pooled = wnd != 0;
+	if (!wnd)
+	{
+		wnd = new Window(displayInd);
+		wnd->Init();
+	}
+	return wnd;
+}
+
+template <class Window>
+static int warmWindow(OverlayPool<Window> & pool, int displayInd)
+{
+	if (pool.Find(displayInd))
+		return 0;
+	Window * wnd = new Window(displayInd);
+	wnd->Init();
+	pool.Put(wnd);
+	return 1;
+}
+
+// The windows of a break that starts soon are made ahead and kept hidden,
+// so showing them only sets their content and starts the fade
+void EyeApp::WarmOverlayPools()
+{
+	long warmTime = eyeleo::settings::overlayWarmTime;
+	bool bigPause = _enableBigPause && _bigPauseWnds.empty() && _beforePauseWnds.empty() &&
+		_timeLeftToBigPause - eyeleo::settings::timeForLongBreakConfirmation * 1000 <= warmTime;
+	bool miniPause = _enableMiniPause && _miniPauseWnds.empty() && _timeLeftToMiniPause <= warmTime;
+	if (!bigPause && !miniPause)
+		return;
+
+	wxStopWatch warmTimer;
+	int created = 0;
+
+	EnsureResourcesLoaded();
+	ValidateOverlayPools();
+	for (int displayInd = 0; displayInd < osCaps.numDisplays; ++displayInd)
+	{
+		if (bigPause)
+			created += warmWindow(_bigPausePool, displayInd);
+		if (miniPause)
+			created += warmWindow(_miniPausePool, displayInd);
+	}
+	if (bigPause && !_enableStrictMode)
+		created += warmWindow(_beforePausePool, 0);
+
+	if (created > 0)
+		LOG_INFO("Created %d hidden break windows in %ld ms", created, warmTimer.Time());
+}
+
+void EyeApp::ClearOverlayPools()
+{
+	_bigPausePool.Clear();
+	_miniPausePool.Clear();
+	_beforePausePool.Clear();
+}
+
+// Pooled windows were sized and laid out for the displays they were made on
+void EyeApp::ValidateOverlayPools()
+{
+	refillResolutionParams();
+	if (_overlayPoolGeneration == osCaps.topologyGeneration)
+		return;
+
+	ClearOverlayPools();
+	_overlayPoolGeneration = osCaps.topologyGeneration;
+}
+
+// The timers tick once a second, so a break may open up to a tick after its deadline
+void EyeApp::MarkOverlayDeadline(long overdue)
+{
+	_overlayOverdue = overdue;
+	_overlayDeadlinePending = true;
+	_sinceOverlayDeadline.Start();
+}
+
+void EyeApp::OnOverlayVisible(wxString const & name)
+{
+	if (!_overlayDeadlinePending)
+		return;
+
+	_overlayDeadlinePending = false;
+	LOG_INFO("%s visible %ld ms after its deadline, %s window", name,
+		_overlayOverdue + _sinceOverlayDeadline.Time(), _overlayPooled ? "pooled" : "new");
+}
+
+bool EyeApp::OnBigPauseWindowHidden(BigPauseWindow * wnd)
+{
+	if (_finished || wnd->GetDisplay() >= osCaps.numDisplays || _bigPausePool.Find(wnd->GetDisplay()))
+		return false;
+
+	OnBigPauseWindowClosed(wnd);
+	_bigPausePool.Put(wnd);
+	return true;
+}
+
+bool EyeApp::OnMiniPauseWindowHidden(MiniPauseWindow * wnd)
+{
+	if (_finished || wnd->GetDisplay() >= osCaps.numDisplays || _miniPausePool.Find(wnd->GetDisplay()))
+		return false;
+
+	OnMiniPauseWindowClosed(wnd);
+	_miniPausePool.Put(wnd);
+	return true;
+}
+
+bool EyeApp::OnBeforePauseWindowHidden(BeforePauseWindow * wnd)
+{
+	if (_finished || _beforePausePool.Find(wnd->GetDisplay()))
+		return false;
+
+	OnCloseBeforePauseWnd(wnd);
+	_beforePausePool.Put(wnd);
+	return true;
 }
 
 void EyeApp::UpdateDebugWindow()
@@ -828,10 +1124,13 @@ void EyeApp::UpdateDebugWindow()
 
 void EyeApp::AskForBigPause()
 {
-	logging::msg("AskForBigPause()");
+	LOG_INFO("AskForBigPause()");
 
-	BeforePauseWindow * wnd = new BeforePauseWindow(0, _postponeCount);
-	wnd->Init();
+	EnsureResourcesLoaded();
+
+	ValidateOverlayPools();
+	BeforePauseWindow * wnd = takeWindow(_beforePausePool, 0, _overlayPooled);
+	wnd->Start(_postponeCount);
 	wnd->Show(true);
 
 	_beforePauseWnds.push_back(wnd);
@@ -851,6 +1150,7 @@ void EyeApp::PostponeBigPause()
 {
 	_showedLongBreakCountdown = false;
 	_userPostponeCount++;
+	_stats->Add(STAT_POSTPONES);
 	_postponeCount++;
 	_inactivityTime = 0;
 	_timeLeftToBigPause = 3000 * 60; // 3 mins
@@ -858,20 +1158,23 @@ void EyeApp::PostponeBigPause()
 	ChangeState(STATE_IDLE, 1000);
 	
 	UpdateTaskbarText();
+
+	SaveRuntimeState();
 }
 
 void EyeApp::RefuseBigPause()
 {
 	_userRefuseCount++;
+	_stats->Add(STAT_REFUSALS);
 	RestartBigPauseInterval();
 	RestartMiniPauseInterval();
 
-	SaveSettings();
+	SaveRuntimeState();
 }
 
 void EyeApp::AutoRelax()
 {
-	logging::msg("AutoRelax");
+	LOG_INFO("AutoRelax");
 
 	UninstallActivityMonitor();
 	InstallActivityMonitor();
@@ -880,8 +1183,12 @@ void EyeApp::AutoRelax()
 	_timeLeftToBigPause = 0;
 	_timeLeftToMiniPause = 0;
 	_userAutoBreakCount++;
+	_stats->Add(STAT_AUTO_RELAX);
+	RecordScreenTime();
 	ChangeState(STATE_AUTO_RELAX, 500);
 	UpdateTaskbarText();
+
+	SaveRuntimeState();
 }
 
 void EyeApp::StartBigPause()
@@ -892,7 +1199,11 @@ void EyeApp::StartBigPause()
 		return;
 	}
 	
-	logging::msg("StartBigPause");
+	LOG_INFO("StartBigPause");
+
+	// accepted or asked for by the user, there was no timer deadline
+	if (_currentState != STATE_START_BIG_PAUSE)
+		MarkOverlayDeadline();
 
 	_showedLongBreakCountdown = false;
 
@@ -906,16 +1217,35 @@ void EyeApp::StartBigPause()
 	if (!fullscreenBlock)
 	{
 		_userLongBreakCount++;
+		_stats->Add(STAT_LONG_BREAKS);
+		RecordScreenTime();
 		
 		StopMiniPause();
 		
+		_bigPauseText = langPack->PickVariant(StrId::big_pause_text_1);
+
+		EnsureResourcesLoaded();
+
+		// the desktop is captured before the windows cover it
+		delete _backdrops;
+		_backdrops = 0;
+		if (_settingBlurredBackground)
+		{
+			if (!_blurWorkers)
+				_blurWorkers = new BlurWorkers();
+			_backdrops = new Backdrops(*_blurWorkers);
+			_backdrops->Capture();
+		}
+
+		ValidateOverlayPools();
+
 		assert(_bigPauseWnds.empty());
 		for (int displayInd = 0; displayInd < osCaps.numDisplays; ++displayInd)
 		{
-			BigPauseWindow * wnd = new BigPauseWindow(displayInd);
-			logging::msg(wxString::Format("_bigPauseDuration = %d", _bigPauseDuration * 60));
-			wnd->Init();
+			BigPauseWindow * wnd = takeWindow(_bigPausePool, displayInd, _overlayPooled);
+			LOG_INFO("_bigPauseDuration = %d", _bigPauseDuration * 60);
 			wnd->SetBreakDuration(_bigPauseDuration * 60);
+			wnd->Start();
 			wnd->Show(true);
 			_bigPauseWnds.push_back(wnd);
 		}
@@ -926,7 +1256,7 @@ void EyeApp::StartBigPause()
 	}
 	else
 	{
-		logging::msg("fullscreen block, show wait wnd");
+		LOG_INFO("fullscreen block, show wait wnd");
 		
 		//ShowWaitingWnd();
 		_fullscreenBlockDuration = 0;
@@ -938,11 +1268,13 @@ void EyeApp::StartBigPause()
 void EyeApp::ShowWaitingWnd()
 {
 	if (!_waitWnds.empty()) {
-		logging::msg(wxString::Format("ShowWaitingWnd() failed, _waitWnds not empty"));
+		LOG_WARNING("ShowWaitingWnd() failed, _waitWnds not empty");
 		return;
 	}
 
-	logging::msg(wxString::Format("ShowWaitingWnd()"));
+	LOG_INFO("ShowWaitingWnd()");
+
+	EnsureResourcesLoaded();
 
 	int fullscreenDisplay = -1;
 	IsFullscreenAppRunning(&fullscreenDisplay);
@@ -952,7 +1284,7 @@ void EyeApp::ShowWaitingWnd()
 		if (fullscreenDisplay == displayInd)
 			continue;
 		
-		logging::msg(wxString::Format("ShowWaitingWnd shows wnd at disp %d", displayInd));
+		LOG_DEBUG("ShowWaitingWnd shows wnd at disp %d", displayInd);
 
 		WaitingFullscreenWindow * wnd = new WaitingFullscreenWindow();
 		wnd->Init(displayInd);
@@ -966,7 +1298,7 @@ void EyeApp::ShowWaitingWnd()
 
 void EyeApp::CloseWaitingWnd()
 {
-	logging::msg(wxString::Format("CloseWaitingWnd"));
+	LOG_INFO("CloseWaitingWnd");
 
 	if (!_waitWnds.empty())
 	{
@@ -988,7 +1320,7 @@ void EyeApp::OnCloseWaitingWnd(WaitingFullscreenWindow * ptr)
 	}
 	else
 	{
-		logging::msg(wxString::Format("OnCloseWaitingWnd failed to find wnd"));
+		LOG_WARNING("OnCloseWaitingWnd failed to find wnd");
 	}
 }
 
@@ -999,6 +1331,10 @@ void EyeApp::OnCloseBeforePauseWnd(BeforePauseWindow * ptr)
 	{
 		_beforePauseWnds.erase(it);
 	}
+	else
+	{
+		_beforePausePool.Remove(ptr);
+	}
 }
 
 void EyeApp::CloseBigPauseWnds()
@@ -1015,16 +1351,16 @@ void EyeApp::CloseBigPauseWnds()
 
 void EyeApp::StopBigPause()
 {
-	logging::msg(wxString::Format("EyeApp::StopBigPause, bigPauseWnds.size=%d", _bigPauseWnds.size()));
+	LOG_INFO("EyeApp::StopBigPause, bigPauseWnds.size=%d", _bigPauseWnds.size());
 	
 	CloseBigPauseWnds();
 	
 	RestartBigPauseInterval();
 	RestartMiniPauseInterval();
 
-	SaveSettings();
+	SaveRuntimeState();
 
-	logging::msg(wxString::Format("EyeApp::StopBigPause end"));
+	LOG_INFO("EyeApp::StopBigPause end");
 }
 
 void EyeApp::OnSkipBigPauseClicked()
@@ -1032,17 +1368,37 @@ void EyeApp::OnSkipBigPauseClicked()
 	long fullPeriod = _bigPauseDuration * 1000 * 60;
 	long earlyThreshold = long(float(fullPeriod) * 0.35f);
 
+	_adherence->Add(ADHERENCE_RELAX_BEFORE_SKIP, fullPeriod - _relaxingTimeLeft);
+
 	if (_relaxingTimeLeft > earlyThreshold)
+	{
 		_userEarlySkipCount++;
+		_stats->Add(STAT_EARLY_SKIPS);
+	}
 	else
+	{
 		_userLateSkipCount++;
+		_stats->Add(STAT_LATE_SKIPS);
+	}
 
 	StopBigPause();
 }
 
+void EyeApp::OnBreakRequestAnswered(long ms)
+{
+	_adherence->Add(ADHERENCE_RESPONSE_TIME, ms);
+}
+
+void EyeApp::RecordScreenTime()
+{
+	if (_activeSinceBreak > 0)
+		_adherence->Add(ADHERENCE_SCREEN_TIME, _activeSinceBreak);
+	_activeSinceBreak = 0;
+}
+
 void EyeApp::StartMiniPause()
 {
-	logging::msg("StartMiniPause");
+	LOG_INFO("StartMiniPause");
 	
 	int fullscreenDisplay = -1;
 	IsFullscreenAppRunning(&fullscreenDisplay);
@@ -1050,22 +1406,32 @@ void EyeApp::StartMiniPause()
 	if (_miniPauseWnds.empty())
 	{
 		_userShortBreakCount++;
+		_stats->Add(STAT_SHORT_BREAKS);
+		RecordScreenTime();
+
+		PickExcercise();
+		EnsureResourcesLoaded();
+		g_Personage->BuildAtlas();
+
+		delete _excerciseAnim;
+		_excerciseAnim = new ExcerciseAnim(_excercise);
+
+		ValidateOverlayPools();
 
 		for (int displayInd = 0; displayInd < osCaps.numDisplays; ++displayInd)
 		{
 			if (fullscreenDisplay == displayInd)
 				continue;
 			
-			MiniPauseWindow * wnd = new MiniPauseWindow(displayInd, _userShortBreakCount);
-			wnd->Init();
-			wnd->Show(true);
+			MiniPauseWindow * wnd = takeWindow(_miniPausePool, displayInd, _overlayPooled);
+			wnd->Start(_userShortBreakCount);
 			
 			_miniPauseWnds.push_back(wnd);
 		}
 	}
 	else
 	{
-		logging::msg("(!) _miniPauseWnds is not empty");
+		LOG_WARNING("(!) _miniPauseWnds is not empty");
 	}
 	
 	// play sound
@@ -1073,6 +1439,30 @@ void EyeApp::StartMiniPause()
 	RestartMiniPauseInterval(); // little flaw
 }
 
+void EyeApp::PickExcercise()
+{
+	static const StrId excerciseTexts[NUM_EXCERCISES] = {
+		StrId::mini_pause_text_1_1,
+		StrId::mini_pause_text_2_1,
+		StrId::mini_pause_text_3_1,
+		StrId::mini_pause_text_4_1,
+		StrId::mini_pause_text_5_1,
+		StrId::mini_pause_text_6_1
+	};
+
+	for (int tries = 0; tries < 8; ++tries)
+	{
+		_excercise = rand() % NUM_EXCERCISES + 1;
+		if (!_settingWindowNearby && _excercise == EXCERCISE_WINDOW)
+			continue;
+		if (_excercise != _lastExcercise)
+			break;
+	}
+
+	_lastExcercise = _excercise;
+	_excerciseText = langPack->PickVariant(excerciseTexts[_excercise - 1]);
+}
+
 void EyeApp::StopMiniPause()
 {
 	if (!_miniPauseWnds.empty())
@@ -1089,21 +1479,36 @@ void EyeApp::StopMiniPause()
 
 void EyeApp::OnMiniPauseWindowClosed(MiniPauseWindow * ptr)
 {
+	// a pooled window is in neither list once the pool was cleared
 	std::vector<MiniPauseWindow *>::iterator it = std::find(_miniPauseWnds.begin(), _miniPauseWnds.end(), ptr);
-	assert(it != _miniPauseWnds.end());
 	if (it != _miniPauseWnds.end())
 		_miniPauseWnds.erase(it);
+	else
+		_miniPausePool.Remove(ptr);
+
+	if (_miniPauseWnds.empty())
+	{
+		delete _excerciseAnim;
+		_excerciseAnim = 0;
+	}
 }
 
 void EyeApp::OnBigPauseWindowClosed(BigPauseWindow *ptr)
 {
 	std::vector<BigPauseWindow *>::iterator it = std::find(_bigPauseWnds.begin(), _bigPauseWnds.end(), ptr);
-	assert(it != _bigPauseWnds.end());
 	if (it != _bigPauseWnds.end())
 		_bigPauseWnds.erase(it);
+	else
+		_bigPausePool.Remove(ptr);
 
 	it = std::find(_bigPauseWnds.begin(), _bigPauseWnds.end(), ptr);
 	assert(it == _bigPauseWnds.end());
+
+	if (_bigPauseWnds.empty())
+	{
+		delete _backdrops;
+		_backdrops = 0;
+	}
 }
 
 void EyeApp::OnNotificationWindowClosed()
@@ -1124,16 +1529,23 @@ void EyeApp::OpenSettings()
 		return;
 	}
 
-	SettingsWindow *wnd = new SettingsWindow(langPack->Get("settings_title"));
+	SettingsWindow *wnd = new SettingsWindow(langPack->Get(StrId::settings_title));
 	wnd->Show(true);
 	_settingsWnd = wnd;
 
 	_seenSettingsWindow = true;
 }
 
+void EyeApp::LoadExclusionRules()
+{
+	if (_exclusionRules->Load(GetSavePath() + L"exclusions.xml"))
+		LOG_INFO("Exclusion rules: %d", _exclusionRules->GetCount());
+	_fullscreenTracker->SetRules(_exclusionRules);
+}
+
 bool EyeApp::LoadSettings()
 {
-	logging::msg("LoadSettings");
+	LOG_INFO("LoadSettings");
 
 	pugi::xml_document doc;
 	pugi::xml_parse_result result = doc.load_file((GetSavePath() + L"settings.xml").wchar_str());
@@ -1152,6 +1564,7 @@ bool EyeApp::LoadSettings()
 		{
 			_firstLaunch = node.attribute(L"first_launch").as_bool();
 			_seenSettingsWindow = node.attribute(L"seen_settings").as_bool();
+			// the rest is only written by versions without the state journal
 			_userLongBreakCount = node.attribute(L"long_break_count").as_uint();
 			_userEarlySkipCount = node.attribute(L"early_skip_count").as_uint();
 			_userLateSkipCount = node.attribute(L"late_skip_count").as_uint();
@@ -1222,6 +1635,11 @@ bool EyeApp::LoadSettings()
 			bool enabled = node.attribute(L"enabled").as_bool();
 			_settingInactivityTracking = enabled;
 		}
+		else if (wcscmp(name, L"blurred_background") == 0)
+		{
+			bool enabled = node.attribute(L"enabled").as_bool();
+			_settingBlurredBackground = enabled;
+		}
 	}
 	return true;
 }
@@ -1230,7 +1648,7 @@ void EyeApp::CheckSettings()
 {
 	if (_bigPauseInterval > 120)
 	{
-		logging::msg("CheckSettings: bigPauseInterval corrected");
+		LOG_WARNING("CheckSettings: bigPauseInterval corrected");
 		assert(false);
 
 		_bigPauseInterval = 120; // in minutes
@@ -1238,7 +1656,7 @@ void EyeApp::CheckSettings()
 	
 	if (_bigPauseDuration > 30)
 	{
-		logging::msg("CheckSettings: bigPauseDuration corrected");
+		LOG_WARNING("CheckSettings: bigPauseDuration corrected");
 		assert(false);
 
 		_bigPauseDuration = 30;
@@ -1246,7 +1664,7 @@ void EyeApp::CheckSettings()
 	
 	if (_warningInterval > 3.0f)
 	{
-		logging::msg("CheckSettings: warningInterval corrected");
+		LOG_WARNING("CheckSettings: warningInterval corrected");
 		assert(false);
 
 		_warningInterval = 3.0f;
@@ -1254,7 +1672,7 @@ void EyeApp::CheckSettings()
 	
 	if (_miniPauseInterval > 30)
 	{
-		logging::msg("CheckSettings: miniPauseInterval corrected");
+		LOG_WARNING("CheckSettings: miniPauseInterval corrected");
 		assert(false);
 
 		_miniPauseInterval = 30;
@@ -1262,7 +1680,7 @@ void EyeApp::CheckSettings()
 
 	if (_miniPauseDuration > 20)
 	{
-		logging::msg("CheckSettings: miniPauseDuration corrected");
+		LOG_WARNING("CheckSettings: miniPauseDuration corrected");
 		assert(false);
 
 		_miniPauseDuration = 20;
@@ -1270,7 +1688,7 @@ void EyeApp::CheckSettings()
 	
 	if (_timeLeftToBigPause > 1000 * 60 * _bigPauseInterval)
 	{
-		logging::msg("CheckSettings: _timeLeftToBigPause corrected");
+		LOG_WARNING("CheckSettings: _timeLeftToBigPause corrected");
 		assert(false);
 
 		_timeLeftToBigPause = 1000 * 60 * _bigPauseInterval;
@@ -1278,7 +1696,7 @@ void EyeApp::CheckSettings()
 
 	if (_timeLeftToMiniPause > 1000 * 60 * _miniPauseInterval)
 	{
-		logging::msg("CheckSettings: _timeLeftToMiniPause corrected");
+		LOG_WARNING("CheckSettings: _timeLeftToMiniPause corrected");
 		assert(false);
 
 		_timeLeftToMiniPause = 1000 * 60 * _miniPauseInterval;
@@ -1291,74 +1709,53 @@ void EyeApp::CheckSettings()
 
 void EyeApp::SaveSettings()
 {
-	_lastBigPauseTimeLeft = _timeLeftToBigPause;
-	_lastMiniPauseTimeLeft = _timeLeftToMiniPause;
+	if (!_settingsStore)
+		return;
 
-	///
-	logging::msg("SaveSettings");
-	
-	pugi::xml_document doc;
-	pugi::xml_node node = doc.append_child(pugi::node_element);
-	node.set_name(L"settings");
-	
-	pugi::xml_node nodeStatistics = node.append_child(pugi::node_element);
-	nodeStatistics.set_name(L"statistics");
-	nodeStatistics.append_attribute(L"first_launch") = _firstLaunch;
-	nodeStatistics.append_attribute(L"seen_settings") = _seenSettingsWindow;
-	nodeStatistics.append_attribute(L"long_break_count") = _userLongBreakCount;
-	nodeStatistics.append_attribute(L"early_skip_count") = _userEarlySkipCount;
-	nodeStatistics.append_attribute(L"late_skip_count") = _userLateSkipCount;
-	nodeStatistics.append_attribute(L"refuse_count") = _userRefuseCount;
-	nodeStatistics.append_attribute(L"postpone_count") = _userPostponeCount;
-	nodeStatistics.append_attribute(L"auto_break_count") = _userAutoBreakCount;
-	nodeStatistics.append_attribute(L"short_break_count") = _userShortBreakCount;
-	if (_lastShutdown.IsValid())
-		nodeStatistics.append_attribute(L"last_shutdown") = _lastShutdown.FormatISOCombined().c_str();
-
-	assert(_lastBigPauseTimeLeft < INT_MAX);
-	nodeStatistics.append_attribute(L"last_big_pause_time_left") = (int)(_lastBigPauseTimeLeft);
-
-	assert(_lastMiniPauseTimeLeft < INT_MAX);
-	nodeStatistics.append_attribute(L"last_mini_pause_time_left") = (int)(_lastMiniPauseTimeLeft);
-	
-	pugi::xml_node nodeBigPause = node.append_child(pugi::node_element);
-	nodeBigPause.set_name(L"big_pause");
-	nodeBigPause.append_attribute(L"enabled") = GetBigPauseEnabled();
-	nodeBigPause.append_attribute(L"interval") = GetBigPauseInterval();
-	nodeBigPause.append_attribute(L"duration") = GetBigPauseDuration();
-	
-	pugi::xml_node nodeMiniPause = node.append_child(pugi::node_element);
-	nodeMiniPause.set_name(L"mini_pause");
-	nodeMiniPause.append_attribute(L"enabled") = GetMiniPauseEnabled();
-	nodeMiniPause.append_attribute(L"interval") = GetMiniPauseInterval();
-	nodeMiniPause.append_attribute(L"duration") = GetMiniPauseDuration();
-	
-	pugi::xml_node nodeWarning = node.append_child(pugi::node_element);
-	nodeWarning.set_name(L"warning");
-	nodeWarning.append_attribute(L"enabled") = GetWarningEnabled();
-	nodeWarning.append_attribute(L"interval") = GetWarningInterval();
-	
-	pugi::xml_node nodeSounds = node.append_child(pugi::node_element);
-	nodeSounds.set_name(L"sounds");
-	nodeSounds.append_attribute(L"enabled") = GetSoundsEnabled();
-	
-	pugi::xml_node nodeStrictMode = node.append_child(pugi::node_element);
-	nodeStrictMode.set_name(L"strict_mode");
-	nodeStrictMode.append_attribute(L"enabled") = GetStrictModeEnabled();
-	
-	pugi::xml_node nodeWindowNearby = node.append_child(pugi::node_element);
-	nodeWindowNearby.set_name(L"window_nearby");
-	nodeWindowNearby.append_attribute(L"enabled") = GetWindowNearbySetting();
+	LOG_INFO("SaveSettings");
 
-	pugi::xml_node nodeInactivityTracking = node.append_child(pugi::node_element);
-	nodeInactivityTracking.set_name(L"inactivity_tracking");
-	nodeInactivityTracking.append_attribute(L"enabled") = GetInactivityTrackingEnabled();
+	SettingsData data;
+	data.firstLaunch = _firstLaunch;
+	data.seenSettings = _seenSettingsWindow;
+	data.bigPauseEnabled = GetBigPauseEnabled();
+	data.bigPauseInterval = GetBigPauseInterval();
+	data.bigPauseDuration = GetBigPauseDuration();
+	data.miniPauseEnabled = GetMiniPauseEnabled();
+	data.miniPauseInterval = GetMiniPauseInterval();
+	data.miniPauseDuration = GetMiniPauseDuration();
+	data.warningEnabled = GetWarningEnabled();
+	data.warningInterval = GetWarningInterval();
+	data.soundsEnabled = GetSoundsEnabled();
+	data.strictModeEnabled = GetStrictModeEnabled();
+	data.windowNearby = GetWindowNearbySetting();
+	data.inactivityTracking = GetInactivityTrackingEnabled();
+	data.canCloseNotifications = GetCanCloseNotificationsSetting();
+	data.blurredBackground = GetBlurredBackgroundEnabled();
 
-	pugi::xml_node nodeCanCloseNotifications = node.append_child(pugi::node_element);
-	nodeCanCloseNotifications.set_name(L"can_close_notifications");
-	nodeCanCloseNotifications.append_attribute(L"enabled") = GetCanCloseNotificationsSetting();
-	
-	doc.save_file((GetSavePath() + L"settings.xml").wchar_str(), L"\t");
+	// written by the store's thread after a short delay, see SettingsStore
+	_settingsStore->Save(data);
+}
+
+void EyeApp::SaveRuntimeState()
+{
+	_timeSinceJournal = 0;
+
+	if (!_journal)
+		return;
+
+	RuntimeState state;
+	state.wallTime = wxDateTime::Now().GetValue().GetValue();
+	state.timeLeftToBigPause = _timeLeftToBigPause;
+	state.timeLeftToMiniPause = _timeLeftToMiniPause;
+	state.postponeCount = _postponeCount;
+	state.longBreakCount = _userLongBreakCount;
+	state.earlySkipCount = _userEarlySkipCount;
+	state.lateSkipCount = _userLateSkipCount;
+	state.refuseCount = _userRefuseCount;
+	state.postponeTotal = _userPostponeCount;
+	state.autoBreakCount = _userAutoBreakCount;
+	state.shortBreakCount = _userShortBreakCount;
+	_journal->Append(state);
 }
 
 void EyeApp::ResetSettings()
@@ -1378,11 +1775,12 @@ void EyeApp::ResetSettings()
 	_firstLaunch = true;
 	_seenSettingsWindow = false;
 	_settingInactivityTracking = true;
+	_settingBlurredBackground = false;
 }
 
 void EyeApp::ApplySettings()
 {
-	logging::msg("ApplySettings");
+	LOG_INFO("ApplySettings");
 
 	RestartBigPauseInterval();
 	RestartMiniPauseInterval();
@@ -1391,9 +1789,15 @@ void EyeApp::ApplySettings()
 
 void EyeApp::OnSettingsClosed()
 {
-	logging::msg("OnSettingsClosed");
+	LOG_INFO("OnSettingsClosed");
 	
 	_settingsWnd = 0;
+
+	// the hidden windows were made with the old strict mode and language
+	ClearOverlayPools();
+
+	// exclusions.xml is edited by hand, the changes are picked up here
+	LoadExclusionRules();
 	
 	if (_enableBigPause)
 	{
@@ -1432,7 +1836,7 @@ void EyeApp::OnSettingsClosed()
 			_timeLeftToMiniPause = 0;
 	}
 
-	logging::msg(wxString::Format("    _timeLeftToMiniPause = %d, _timeLeftToBigPause = %d", _timeLeftToMiniPause, _timeLeftToBigPause));
+	LOG_INFO("    _timeLeftToMiniPause = %d, _timeLeftToBigPause = %d", _timeLeftToMiniPause, _timeLeftToBigPause);
 }
 
 void EyeApp::TogglePausedMode(int minutes)
@@ -1458,7 +1862,7 @@ void EyeApp::TogglePausedMode(int minutes)
 		RestartMiniPauseInterval();
 		UpdateTaskbarText();
 
-		SaveSettings();
+		SaveRuntimeState();
 	}
 }
 
@@ -1483,6 +1887,8 @@ void EyeApp::TakeLongBreakNow()
 
 void EyeApp::Exit()
 {
+	ClearOverlayPools();
+
 	if (!_miniPauseWnds.empty())
 	{
 		for (std::vector<MiniPauseWindow *>::iterator it = _miniPauseWnds.begin(); it != _miniPauseWnds.end(); ++it)
@@ -1512,7 +1918,7 @@ void EyeApp::Exit()
 
 int EyeApp::OnExit()
 {
-	logging::msg("OnExit");
+	LOG_INFO("OnExit");
 	
 	static int destroyCount = 0;
 	if (destroyCount)
@@ -1520,8 +1926,27 @@ int EyeApp::OnExit()
 	destroyCount++;
 	
 	_lastShutdown = wxDateTime::Now();
+	SaveRuntimeState();
 	SaveSettings();
 
+	delete _journal;
+	_journal = nullptr;
+
+	delete _stats;
+	_stats = nullptr;
+
+	if (_adherence)
+		_adherence->Flush();
+	delete _adherence;
+	_adherence = nullptr;
+
+	if (_settingsStore)
+	{
+		if (!_settingsStore->Shutdown(eyeleo::settings::settingsFlushBudget))
+			LOG_WARNING("Settings weren't saved in %d ms", eyeleo::settings::settingsFlushBudget);
+		_settingsStore = nullptr;
+	}
+
 	_finished = true;
 
 	DeletePendingEvents();
@@ -1531,30 +1956,68 @@ int EyeApp::OnExit()
 	
 	Stop();
 
+	delete g_Animations;
+	g_Animations = 0;
+	delete _excerciseAnim;
+	_excerciseAnim = 0;
+	delete _backdrops;
+	_backdrops = 0;
+	delete _blurWorkers;
+	_blurWorkers = 0;
+	delete _fullscreenTracker;
+	_fullscreenTracker = 0;
+	delete _exclusionRules;
+	_exclusionRules = 0;
+
 	DeleteLanguagePack();
+	TrimResources(0); // waits for the decode threads, they write into g_Personage
 	delete g_Personage;
 	
 	int res = wxApp::OnExit();
-	logging::msg("done OnExit");
+	LOG_INFO("done OnExit");
+	logging::Flush();
 	return res;
 }
 
 void EyeApp::OnQueryEndSession(wxCloseEvent &evt)
 {
-	logging::msg("OnQueryEndSession");
+	LOG_INFO("OnQueryEndSession");
 	
 	DeletePendingEvents();
 	getApp()->Exit();
 	
 	wxApp::OnQueryEndSession(evt);
 	
-	logging::msg("done OnQueryEndSession");
+	LOG_INFO("done OnQueryEndSession");
+}
+
+// Every top-level window gets the notification, the displays are queried once when they are used next
+void EyeApp::OnDisplayChanged(wxDisplayChangedEvent &evt)
+{
+	LOG_INFO("OnDisplayChanged");
+
+	invalidateDisplayTopology();
+	evt.Skip();
+}
+
+#if wxCHECK_VERSION(3, 1, 3)
+void EyeApp::OnDpiChanged(wxDPIChangedEvent &evt)
+{
+	LOG_INFO("OnDpiChanged");
+
+	invalidateDisplayTopology();
+	evt.Skip();
 }
+#endif
 
 void EyeApp::OnEndSession(wxCloseEvent &evt)
 {
-	logging::msg("OnEndSession");
+	LOG_INFO("OnEndSession");
 	
+	// the process can be killed right after this handler returns
+	if (_settingsStore && !_settingsStore->Flush(eyeleo::settings::settingsFlushBudget))
+		LOG_WARNING("Settings weren't saved in %d ms", eyeleo::settings::settingsFlushBudget);
+
 	UninstallActivityMonitor();
 	_taskBarIcon->RemoveIcon();
 	
@@ -1562,14 +2025,15 @@ void EyeApp::OnEndSession(wxCloseEvent &evt)
 	
 	wxApp::OnEndSession(evt);
 	
-	logging::msg("done OnEndSession");
+	LOG_INFO("done OnEndSession");
+	logging::Flush();
 }
 
 void EyeApp::OnSessionUnlock()
 {
-	logging::msg("EyeApp::OnSessionUnlock");
+	LOG_INFO("EyeApp::OnSessionUnlock");
 
-	_taskBarIcon->ShowBalloon(langPack->Get("tb_popup_default"), langPack->Get("tb_notification_start_after_pause"), 1000 * 10, wxICON_INFORMATION);
+	_taskBarIcon->ShowBalloon(langPack->Get(StrId::tb_popup_default), langPack->Get(StrId::tb_notification_start_after_pause), 1000 * 10, wxICON_INFORMATION);
 
 	RestartBigPauseInterval();
 	RestartMiniPauseInterval();
@@ -1581,25 +2045,25 @@ EyeTaskBarIcon::EyeTaskBarIcon() :
 	wxTaskBarIcon(),
 	_menu(0)
 {
-	_icon = new wxIcon(L"Resources/icon.ico", wxBITMAP_TYPE_ICO, 16, 16);
+	_icon = new wxIcon(LoadIconResource(L"Resources/icon.ico", wxBITMAP_TYPE_ICO, 16));
 	if (!_icon->IsOk()) // case for larger fonts
 	{
 		delete _icon;
-		_icon = new wxIcon(L"Resources/icon.ico", wxBITMAP_TYPE_ICO);
+		_icon = new wxIcon(LoadIconResource(L"Resources/icon.ico", wxBITMAP_TYPE_ICO));
 	}
 
-	_iconGray = new wxIcon(L"Resources/icongray.ico", wxBITMAP_TYPE_ICO, 16, 16);
+	_iconGray = new wxIcon(LoadIconResource(L"Resources/icongray.ico", wxBITMAP_TYPE_ICO, 16));
 	if (!_iconGray->IsOk()) // case for larger fonts
 	{
 		delete _iconGray;
-		_iconGray = new wxIcon(L"Resources/icongray.ico", wxBITMAP_TYPE_ICO);
+		_iconGray = new wxIcon(LoadIconResource(L"Resources/icongray.ico", wxBITMAP_TYPE_ICO));
 	}
 
-	_iconSettings = new wxIcon(L"Resources/settings.ico", wxBITMAP_TYPE_ICO, 16, 16);
-	_iconPause = new wxIcon(L"Resources/pause.ico", wxBITMAP_TYPE_ICO, 16, 16);
-	_iconResume = new wxIcon(L"Resources/resume.ico", wxBITMAP_TYPE_ICO, 16, 16);
+	_iconSettings = new wxIcon(LoadIconResource(L"Resources/settings.ico", wxBITMAP_TYPE_ICO, 16));
+	_iconPause = new wxIcon(LoadIconResource(L"Resources/pause.ico", wxBITMAP_TYPE_ICO, 16));
+	_iconResume = new wxIcon(LoadIconResource(L"Resources/resume.ico", wxBITMAP_TYPE_ICO, 16));
 
-	if (!SetIcon(*_icon, langPack->Get("tb_popup_default")))
+	if (!SetIcon(*_icon, langPack->Get(StrId::tb_popup_default)))
 		wxMessageBox(wxT("Could not set icon."));
 	
 	Connect(wxEVT_TASKBAR_LEFT_DOWN,
@@ -1639,13 +2103,13 @@ wxMenu * EyeTaskBarIcon::CreatePopupMenu()
 {
 	_menu = new wxMenu();
 	
-	wxMenuItem *item = new wxMenuItem(_menu, ID_TASKBAR_MENU_SETTINGS, langPack->Get("tb_menu_settings"), langPack->Get("tb_menu_settings_tip"));
+	wxMenuItem *item = new wxMenuItem(_menu, ID_TASKBAR_MENU_SETTINGS, langPack->Get(StrId::tb_menu_settings), langPack->Get(StrId::tb_menu_settings_tip));
 	item->SetBitmap(*_iconSettings);
 	_menu->Append(item);
 	
 	if (getApp()->GetNextState() == STATE_SUSPENDED)
 	{
-		item = new wxMenuItem(_menu, ID_TASKBAR_MENU_PAUSE_RESUME_MONITORING, langPack->Get("tb_menu_resume_monitoring"), langPack->Get("tb_menu_resume_monitoring_tip"));
+		item = new wxMenuItem(_menu, ID_TASKBAR_MENU_PAUSE_RESUME_MONITORING, langPack->Get(StrId::tb_menu_resume_monitoring), langPack->Get(StrId::tb_menu_resume_monitoring_tip));
 		item->SetBitmap(*_iconResume);
 		_menu->Append(item);
 	}
@@ -1653,25 +2117,25 @@ wxMenu * EyeTaskBarIcon::CreatePopupMenu()
 	{
 		wxMenu* subMenu = new wxMenu();
 
-		item = _menu->AppendSubMenu(subMenu, langPack->Get("tb_menu_pause_monitoring"));
+		item = _menu->AppendSubMenu(subMenu, langPack->Get(StrId::tb_menu_pause_monitoring));
 		//item->SetBitmap(*_iconPause);
 
-		wxMenuItem *subitem = new wxMenuItem(_menu, ID_TASKBAR_MENU_PAUSE_RESUME_MONITORING, langPack->Get("tb_menu_pause_monitoring_1"), langPack->Get("tb_menu_pause_monitoring_tip"));
+		wxMenuItem *subitem = new wxMenuItem(_menu, ID_TASKBAR_MENU_PAUSE_RESUME_MONITORING, langPack->Get(StrId::tb_menu_pause_monitoring_1), langPack->Get(StrId::tb_menu_pause_monitoring_tip));
 		subitem->SetBitmap(*_iconPause);
 		subMenu->Append(subitem);
 
-		subitem = new wxMenuItem(_menu, ID_TASKBAR_MENU_PAUSE_RESUME_MONITORING_2, langPack->Get("tb_menu_pause_monitoring_2"), langPack->Get("tb_menu_pause_monitoring_tip"));
+		subitem = new wxMenuItem(_menu, ID_TASKBAR_MENU_PAUSE_RESUME_MONITORING_2, langPack->Get(StrId::tb_menu_pause_monitoring_2), langPack->Get(StrId::tb_menu_pause_monitoring_tip));
 		subitem->SetBitmap(*_iconPause);
 		subMenu->Append(subitem);
 
-		item = new wxMenuItem(_menu, ID_TASKBAR_MENU_TAKE_LONG_BREAK_NOW, langPack->Get("tb_menu_take_break_now"));
+		item = new wxMenuItem(_menu, ID_TASKBAR_MENU_TAKE_LONG_BREAK_NOW, langPack->Get(StrId::tb_menu_take_break_now));
 		//item->SetBitmap(*_iconSettings);
 		_menu->Append(item);
 	}
 
 	_menu->AppendSeparator();
 	
-	item = new wxMenuItem(_menu, ID_TASKBAR_MENU_QUIT, langPack->Get("tb_menu_quit"), langPack->Get("tb_menu_quit_tip"));
+	item = new wxMenuItem(_menu, ID_TASKBAR_MENU_QUIT, langPack->Get(StrId::tb_menu_quit), langPack->Get(StrId::tb_menu_quit_tip));
 	_menu->Append(item);
 
 	return _menu;
@@ -3,15 +3,26 @@
 
 #include "wx/wx.h"
 #include "wx/taskbar.h"
+#include "wx/stopwatch.h"
 #include "task_mgr.h"
+#include "overlay_pool.h"
 #include <vector>
 
 class SettingsWindow;
+class SettingsStore;
+class StateJournal;
+class StatsStore;
+class AdherenceStats;
 class BigPauseWindow;
 class MiniPauseWindow;
 class WaitingFullscreenWindow;
 class NotificationWindow;
 class BeforePauseWindow;
+class ExcerciseAnim;
+class Backdrops;
+class BlurWorkers;
+class FullscreenTracker;
+class ExclusionRules;
 
 enum EStates
 {
@@ -35,7 +46,9 @@ public:
 	EyeApp();
 
 	bool LoadSettings();
+	void LoadExclusionRules();
 	void SaveSettings();
+	void SaveRuntimeState();
 	void ResetSettings();
 	void ApplySettings();
 	void CheckSettings();
@@ -57,10 +70,21 @@ public:
 	void OnDebugWindowClosed();
 	void OnCloseWaitingWnd(WaitingFullscreenWindow * ptr);
 	void OnCloseBeforePauseWnd(BeforePauseWindow * ptr);
+	void OnBreakRequestAnswered(long ms);
 	void OnSkipBigPauseClicked();
 
+	// A window that faded out goes back to its pool, false when it has to be closed
+	bool OnBigPauseWindowHidden(BigPauseWindow * wnd);
+	bool OnMiniPauseWindowHidden(MiniPauseWindow * wnd);
+	bool OnBeforePauseWindowHidden(BeforePauseWindow * wnd);
+	void OnOverlayVisible(wxString const & name);
+
 	void OnQueryEndSession(wxCloseEvent &evt);
 	void OnEndSession(wxCloseEvent &);
+	void OnDisplayChanged(wxDisplayChangedEvent &evt);
+#if wxCHECK_VERSION(3, 1, 3)
+	void OnDpiChanged(wxDPIChangedEvent &evt);
+#endif
 
 	void OnTaskEvent(wxCommandEvent &);
 
@@ -90,6 +114,7 @@ public:
 	bool GetWindowNearbySetting() const { return _settingWindowNearby; }
 	bool GetInactivityTrackingEnabled() const { return _settingInactivityTracking; }
 	bool GetCanCloseNotificationsSetting() const { return _settingCanCloseNotifications; }
+	bool GetBlurredBackgroundEnabled() const { return _settingBlurredBackground; }
 	bool HasSeenSettings() const { return _seenSettingsWindow; }
 
 	void SetBigPauseEnabled(bool enabled) { _enableBigPause = enabled; }
@@ -105,8 +130,12 @@ public:
 	void SetWindowNearbySetting(bool enabled) { _settingWindowNearby = enabled; }
 	void SetInactivityTrackingEnabled(bool enabled) { _settingInactivityTracking = enabled; }
 	void SetCanCloseNotificationsSetting(bool enabled) { _settingCanCloseNotifications = enabled; }
+	void SetBlurredBackgroundEnabled(bool enabled) { _settingBlurredBackground = enabled; }
 
 	bool IsFullscreenAppRunning(int * display = 0, HWND * fullscreenWndHandle = 0) const;
+	// An exclusion rule matches the foreground application
+	bool IsBigPauseExcluded() const;
+	bool IsMiniPauseExcluded() const;
 	
 	void TogglePausedMode(int minites = 0);
 	bool isPausedMode() const;
@@ -125,9 +154,33 @@ public:
 	wxString const & getWebsiteString() const { return _website; }
 
 	bool isFinished() const { return _finished; }
+
+	StatsStore const * GetStats() const { return _stats; }
+	AdherenceStats const * GetAdherence() const { return _adherence; }
+
+	// Texts that every display shows during the current break
+	const wchar_t * GetBigPauseText() const { return _bigPauseText; }
+	int GetExcercise() const { return _excercise; }
+	const wchar_t * GetExcerciseText() const { return _excerciseText; }
+	ExcerciseAnim const * GetExcerciseAnim() const { return _excerciseAnim; }
+	Backdrops * GetBackdrops() const { return _backdrops; }
 	
 private:
 	SettingsWindow * _settingsWnd;
+	SettingsStore * _settingsStore;
+	StateJournal * _journal;
+	StatsStore * _stats;
+	AdherenceStats * _adherence;
+	long _activeSinceBreak; // ms of user activity since the last break
+	const wchar_t * _bigPauseText;
+	int _excercise;
+	int _lastExcercise;
+	const wchar_t * _excerciseText;
+	ExcerciseAnim * _excerciseAnim; // lives while the mini-pause windows do
+	Backdrops * _backdrops; // lives while the big pause windows do
+	BlurWorkers * _blurWorkers; // kept from one big pause to the next
+	FullscreenTracker * _fullscreenTracker;
+	ExclusionRules * _exclusionRules;
 	EyeTaskBarIcon * _taskBarIcon;
 
 	DebugWindow * _debugWindow;
@@ -160,6 +213,7 @@ private:
 	bool _settingWindowNearby;
 	bool _settingInactivityTracking;
 	bool _settingCanCloseNotifications;
+	bool _settingBlurredBackground;
 	bool _seenSettingsWindow;
 	bool _firstLaunch;
 	
@@ -184,6 +238,8 @@ private:
 	long _timeUntilWaitingWnd;
 	long _inactivityTime;
 	int _postponeCount;
+	long _timeSinceJournal; // ms since the runtime state was journaled
+	long _timeWithoutOverlays; // ms since the last break window closed
 
 	POINT _cursorPos;
 
@@ -193,9 +249,22 @@ private:
 	std::vector<BeforePauseWindow*> _beforePauseWnds;
 	NotificationWindow* _notificationWnd;
 
+	// hidden windows kept for the next breaks
+	OverlayPool<BigPauseWindow> _bigPausePool;
+	OverlayPool<MiniPauseWindow> _miniPausePool;
+	OverlayPool<BeforePauseWindow> _beforePausePool;
+	unsigned int _overlayPoolGeneration; // display topology the pooled windows were laid out for
+
+	// time from a break deadline to its first visible frame
+	wxStopWatch _sinceOverlayDeadline;
+	long _overlayOverdue; // ms the deadline had passed when the watch started
+	bool _overlayDeadlinePending;
+	bool _overlayPooled;
+
 	void ReadConfig();
 
 	void RestartMiniPauseInterval();
+	void PickExcercise();
 	void SetBigPauseTime(long ms);
 	void SetMiniPauseTime(long ms);
 	
@@ -206,8 +275,17 @@ private:
 	void ShowWaitingWnd();
 	void CloseWaitingWnd();
 	void AskForBigPause();
+	void RecordScreenTime();
 	void CloseBeforePauseWnds();
 
+	bool HasOverlayWindows() const;
+	long GetTimeToNextOverlay() const;
+	void UpdateResourceResidency(long time_went);
+	void WarmOverlayPools();
+	void ClearOverlayPools();
+	void ValidateOverlayPools();
+	void MarkOverlayDeadline(long overdue = 0);
+
 	void UpdateDebugWindow();
 
 	wxString GetSavePath() const;
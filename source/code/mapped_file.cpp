@@ -0,0 +1,215 @@
+#include "mapped_file.h"
+#ifdef WIN32
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
+
+MappedFile::MappedFile() :
+	_data(0),
+	_size(0),
+#ifdef WIN32
+	_file(INVALID_HANDLE_VALUE),
+	_mapping(0)
+#else
+	_file(-1)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+#ifdef WIN32
+
+bool MappedFile::Open(wxString const & path, size_t minSize)
+{
+	Close();
+
+	_file = CreateFileW(path.wc_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (_file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(_file, &size))
+	{
+		Close();
+		return false;
+	}
+
+	size_t fileSize = (size_t)size.QuadPart;
+	if (fileSize < minSize)
+		fileSize = minSize;
+
+	// the mapping grows the file when it's shorter, new bytes are zeroed
+	_mapping = CreateFileMappingW(_file, NULL, PAGE_READWRITE, 0, (DWORD)fileSize, NULL);
+	if (!_mapping)
+	{
+		Close();
+		return false;
+	}
+
+	_data = MapViewOfFile(_mapping, FILE_MAP_READ | FILE_MAP_WRITE, 0, 0, fileSize);
+	if (!_data)
+	{
+		Close();
+		return false;
+	}
+
+	_size = fileSize;
+	return true;
+}
+
+bool MappedFile::OpenReadOnly(wxString const & path)
+{
+	Close();
+
+	_file = CreateFileW(path.wc_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (_file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(_file, &size) || size.QuadPart == 0)
+	{
+		Close();
+		return false;
+	}
+
+	_mapping = CreateFileMappingW(_file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!_mapping)
+	{
+		Close();
+		return false;
+	}
+
+	_data = MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!_data)
+	{
+		Close();
+		return false;
+	}
+
+	_size = (size_t)size.QuadPart;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (_data)
+	{
+		UnmapViewOfFile(_data);
+		_data = 0;
+	}
+	if (_mapping)
+	{
+		CloseHandle(_mapping);
+		_mapping = 0;
+	}
+	if (_file != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(_file);
+		_file = INVALID_HANDLE_VALUE;
+	}
+	_size = 0;
+}
+
+void MappedFile::Flush()
+{
+	if (_data)
+		FlushViewOfFile(_data, 0);
+}
+
+#else
+
+bool MappedFile::Open(wxString const & path, size_t minSize)
+{
+	Close();
+
+	_file = open(path.fn_str(), O_RDWR | O_CREAT, 0644);
+	if (_file < 0)
+		return false;
+
+	struct stat st;
+	if (fstat(_file, &st) != 0)
+	{
+		Close();
+		return false;
+	}
+
+	size_t fileSize = (size_t)st.st_size;
+	if (fileSize < minSize)
+	{
+		fileSize = minSize;
+		if (ftruncate(_file, (off_t)fileSize) != 0)
+		{
+			Close();
+			return false;
+		}
+	}
+
+	void * data = mmap(0, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, _file, 0);
+	if (data == MAP_FAILED)
+	{
+		Close();
+		return false;
+	}
+
+	_data = data;
+	_size = fileSize;
+	return true;
+}
+
+bool MappedFile::OpenReadOnly(wxString const & path)
+{
+	Close();
+
+	_file = open(path.fn_str(), O_RDONLY);
+	if (_file < 0)
+		return false;
+
+	struct stat st;
+	if (fstat(_file, &st) != 0 || st.st_size == 0)
+	{
+		Close();
+		return false;
+	}
+
+	void * data = mmap(0, (size_t)st.st_size, PROT_READ, MAP_SHARED, _file, 0);
+	if (data == MAP_FAILED)
+	{
+		Close();
+		return false;
+	}
+
+	_data = data;
+	_size = (size_t)st.st_size;
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (_data)
+	{
+		munmap(_data, _size);
+		_data = 0;
+	}
+	if (_file >= 0)
+	{
+		close(_file);
+		_file = -1;
+	}
+	_size = 0;
+}
+
+void MappedFile::Flush()
+{
+	if (_data)
+		msync(_data, _size, MS_ASYNC);
+}
+
+#endif
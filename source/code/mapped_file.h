@@ -0,0 +1,44 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include "wx/string.h"
+#include <stddef.h>
+
+// A file mapped into memory for reading and writing. Changes reach the file through
+// the OS page cache, so they survive a crash of the process without explicit writes.
+// Read-only mappings share their pages with every process that maps the same file.
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	// Maps the file, creating it or growing it to at least minSize bytes
+	bool Open(wxString const & path, size_t minSize);
+	// Maps an existing non-empty file, the data must not be written
+	bool OpenReadOnly(wxString const & path);
+	void Close();
+
+	bool IsOpened() const { return _data != 0; }
+	void * GetData() const { return _data; }
+	size_t GetSize() const { return _size; }
+
+	// Asks the OS to write dirty pages now
+	void Flush();
+
+private:
+	void * _data;
+	size_t _size;
+
+#ifdef WIN32
+	void * _file;
+	void * _mapping;
+#else
+	int _file;
+#endif
+
+	MappedFile(MappedFile const &);
+	MappedFile & operator=(MappedFile const &);
+};
+
+#endif
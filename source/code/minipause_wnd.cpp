@@ -7,329 +7,252 @@
 #include "excercises.h"
 #include <wx/event.h>
 
-BEGIN_EVENT_TABLE(MiniPauseWindow, wxFrame)
-END_EVENT_TABLE()
-
-BEGIN_EVENT_TABLE(MiniPauseControls, wxFrame)
-	EVT_CLOSE(MiniPauseControls::OnClose)
+BEGIN_EVENT_TABLE(MiniPauseWindow, OverlayWindow)
 END_EVENT_TABLE()
 
 ////////////////////////////////////////////////////////////////////////
 struct SpecialMessage
 {
 	int show_count;
-	const wchar_t * message;
+	StrId message;
 	wxColour color;
 };
 
 static SpecialMessage specialMessages[] =
 {
-	{30, L"mini_pause_text_settings", wxColour(160, 255, 100)},
-	{80, L"mini_pause_text_donate", wxColour(160, 255, 100)},
-	{120, L"mini_pause_text_tell_friend", wxColour(160, 255, 100)},
-	{150, L"mini_pause_text_posture", wxColour(160, 255, 100)},
-	{400, L"mini_pause_text_check_eyeleo", wxColour(160, 255, 100)},
-	{600, L"mini_pause_text_donate", wxColour(160, 255, 100)},
-	{1000, L"mini_pause_text_donate", wxColour(160, 255, 100)},
-	{1400, L"mini_pause_text_donate", wxColour(160, 255, 100)}
+	{30, StrId::mini_pause_text_settings, wxColour(160, 255, 100)},
+	{80, StrId::mini_pause_text_donate, wxColour(160, 255, 100)},
+	{120, StrId::mini_pause_text_tell_friend, wxColour(160, 255, 100)},
+	{150, StrId::mini_pause_text_posture, wxColour(160, 255, 100)},
+	{400, StrId::mini_pause_text_check_eyeleo, wxColour(160, 255, 100)},
+	{600, StrId::mini_pause_text_donate, wxColour(160, 255, 100)},
+	{1000, StrId::mini_pause_text_donate, wxColour(160, 255, 100)},
+	{1400, StrId::mini_pause_text_donate, wxColour(160, 255, 100)}
 };
 
+static const wxPoint spritePosition(18, 38);
+
 ////////////////////////////////////////////////////////////////////////
-int MiniPauseControls::_excercise = 0;
-int MiniPauseControls::_line = 0;
-int MiniPauseControls::_lastExcercise = 0;
 
-MiniPauseWindow::MiniPauseWindow(int displayInd, unsigned int showCount) :
-	wxFrame(NULL, -1, L"", wxDefaultPosition, wxDefaultSize, wxFRAME_TOOL_WINDOW | wxFRAME_SHAPED | wxNO_BORDER | wxFRAME_NO_TASKBAR | wxSTAY_ON_TOP),
+MiniPauseWindow::MiniPauseWindow(int displayInd) :
 	_preventClosing(true),
-	_controlsWnd(0),
-	_showCount(showCount),
+	_excerciseAnim(0),
+	_shownFrame(-1),
+	_showCount(0),
 	_displayInd(displayInd),
 	_state(STATE_SHOWING),
-	_alpha(0.0f)
+	_alpha(0)
 {
 	SetName(std::string("MiniPauseWindow") + (char)('0' + displayInd));
 }
 
 void MiniPauseWindow::Init()
 {
-	refillResolutionParams();
-
-	wxRegion region(*_backBitmap, *wxWHITE);
-	SetShape(region);
+	InitOverlay(wxDefaultPosition, _backBitmap->GetSize());
 
-	SetBackgroundColour(wxColour(0, 0, 0));
-	SetTransparent(0);
+	_text.font = wxFont(13, wxFONTFAMILY_DEFAULT, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL, false);
+	_text.box = wxRect(183, 52, 250, 80);
 
-	SetSize(_backBitmap->GetSize());
-	assert(_displayInd < osCaps.numDisplays);
-	wxRect displayRect = osCaps.displays[_displayInd].clientArea;
-	SetPosition(wxPoint(displayRect.GetX() + displayRect.GetWidth() / 2 - GetSize().GetX() / 2, displayRect.GetY() + displayRect.GetHeight() / 2 - GetSize().GetY() / 2));
+	_txtTime.font = wxFont(14, wxFONTFAMILY_DEFAULT, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL, false);
+	_txtTime.colour = wxColour(255, 200, 70);
+	_txtTime.box = wxRect(420, 119, 30, 30);
 
-	_state = MiniPauseWindow::STATE_SHOWING;
-	g_TaskMgr->AddTask(GetName(), 20);
-	_alpha = 0.0f;
-
-	Show(true);
-
-	_controlsWnd = new MiniPauseControls(this);
-	_controlsWnd->Init(_displayInd, _showCount);
-	_controlsWnd->Show(true);
+	Bind(wxEVT_RIGHT_UP, &MiniPauseWindow::OnMouseTap, this);
 }
 
-MiniPauseWindow::~MiniPauseWindow()
+// Only the content of this break, the window may come from the pool
+void MiniPauseWindow::Start(unsigned int showCount)
 {
-	if (!getApp()->isFinished())
-		g_TaskMgr->RemoveTasks(GetName());
-	_controlsWnd = 0;
+	refillResolutionParams();
 
-	getApp()->OnMiniPauseWindowClosed(this);
-	assert(!getApp()->getWindow(GetName()));
-}
+	// Set position to center of the screen
+	assert(_displayInd < osCaps.numDisplays);
+	SetPosition(centerInClientArea(_displayInd, _backBitmap->GetSize()));
 
-void MiniPauseWindow::ExecuteTask(float f, long time_went)
-{
-	(void)time_went;
+	_showCount = showCount;
+	_text.text.clear();
+	_text.colour = wxColour(255, 255, 255);
+	_txtTime.value = -1;
+	_shownFrame = -1;
 
-	switch (_state)
+	const wchar_t * excerciseText = getApp()->GetExcerciseText();
+	if (excerciseText)
 	{
-		case MiniPauseWindow::STATE_SHOWING:
-		{
-			_alpha += 11.0f * f;
-			if (_alpha >= 210.0f)
-			{
-				_alpha = 210.0f;
-				_state = MiniPauseWindow::STATE_ACTIVE;
-				
-				int base_duration = getApp()->GetMiniPauseDuration();
-
-				_timeLeft = 1000 * base_duration;
-				
-				_controlsWnd->UpdateTimeLabel(_timeLeft);
-				
-				g_TaskMgr->AddTask(GetName(), 100);
-			}
-			else
-			{
-				g_TaskMgr->AddTask(GetName(), 20);
-			}
-			SetTransparent((int)_alpha);
-			break;
-		}
-
-		case MiniPauseWindow::STATE_ACTIVE:
+		int numSpecMsgs = sizeof(specialMessages) / sizeof(specialMessages[0]);
+		for (int i = 0; i < numSpecMsgs; i++)
 		{
-			_timeLeft -= 100.0f * f;
-			
-			_controlsWnd->Update();
-			
-			if (_timeLeft <= 0)
+			if (_showCount == specialMessages[i].show_count)
 			{
-				Hide();
-			}
-			else
-			{
-				g_TaskMgr->AddTask(GetName(), 100);
+				_text.text = langPack->Get(specialMessages[i].message);
+				_text.colour = specialMessages[i].color;
+				break;
 			}
-
-			_controlsWnd->UpdateTimeLabel(_timeLeft);
-			break;
 		}
 
-		case MiniPauseWindow::STATE_HIDING:
-		{
-			_alpha -= 15.0f * f;
-			if (_alpha <= 0.0f)
-			{
-				_alpha = 0.0f;
-				_state = MiniPauseWindow::STATE_DONE;
-				_preventClosing = false;
-				SetTransparent(0);
-				
-				Close();
-			}
-			else
-			{
-				SetTransparent((int)_alpha);
-				g_TaskMgr->AddTask(GetName(), 20);
-			}
-			break;
-		}
+		if (_text.text.empty())
+			_text.text = excerciseText;
 	}
-}
 
-void MiniPauseWindow::HideQuick()
-{
-	_controlsWnd->Show(false);
-	_controlsWnd->Destroy();
+	_excerciseAnim = getApp()->GetExcerciseAnim();
 
-	wxFrame::Close();
+	_state = MiniPauseWindow::STATE_SHOWING;
+	_alpha = 0;
+	_preventClosing = true;
 
-	g_TaskMgr->RemoveTasks(GetName());
+	SetOverlayAlpha(0);
+	Render();
+	Show(true);
+	g_Animations->Fade(this, 0, 255, 400, EASE_OUT);
 }
 
-void MiniPauseWindow::Hide()
+MiniPauseWindow::~MiniPauseWindow()
 {
-	if (_state == STATE_HIDING)
-		return;
-
-	_controlsWnd->Show(false);
-	_controlsWnd->Destroy();
+	if (!getApp()->isFinished())
+		g_TaskMgr->RemoveTasks(GetName());
+	if (g_Animations)
+		g_Animations->Stop(this);
 
-	_state = STATE_HIDING;
-	g_TaskMgr->AddTask(GetName(), 20);
+	getApp()->OnMiniPauseWindowClosed(this);
+	assert(!getApp()->getWindow(GetName()));
 }
 
-void MiniPauseWindow::OnClose(wxCloseEvent& event)
+// The background is translucent, the personage and the text are opaque
+void MiniPauseWindow::Render(wxRect const & dirty)
 {
-	if (!_preventClosing)
-	{
-		event.Skip(true);
-	}
+	BeginFrame(dirty);
+	DrawShape(_backBitmap, *wxBLACK, 210);
+	_shownFrame = _excerciseAnim->GetFrame();
+	DrawSprite(g_Personage->_atlas, g_Personage->_frameRects[_shownFrame], spritePosition);
+	DrawBitmap(*_bmpTitle, wxPoint(40, 12));
+	DrawText(_text);
+	DrawNumber(_txtTime);
+	Present();
 }
 
-////////////////////////////////////////////////////////////////////////
+// Only the time label and the personage change while the window is shown
+void MiniPauseWindow::RenderChanges()
+{
+	wxRect dirty;
+	if (UpdateTimeLabel())
+		dirty = _txtTime.box;
+	int frame = _excerciseAnim->GetFrame();
+	if (frame != _shownFrame)
+		dirty.Union(GetSpriteRect(_shownFrame)).Union(GetSpriteRect(frame));
+	if (!dirty.IsEmpty())
+		Render(dirty);
+}
 
-MiniPauseControls::MiniPauseControls(wxWindow * parent) :
-	wxFrame(parent, -1, L"", wxDefaultPosition, wxDefaultSize, wxFRAME_TOOL_WINDOW | wxFRAME_SHAPED | wxNO_BORDER | wxFRAME_NO_TASKBAR | wxSTAY_ON_TOP),
-	_preventClosing(true),
-	_excerciseAnim(0),
-	_excerciseImg(0)
+wxRect MiniPauseWindow::GetSpriteRect(int frame) const
 {
-	
+	if (frame < 0)
+		return wxRect();
+	return wxRect(spritePosition, g_Personage->_frameRects[frame].GetSize());
 }
 
-void MiniPauseControls::Init(int displayInd, unsigned int showCount)
+void MiniPauseWindow::ExecuteTask(float /*f*/, long /*time_went*/)
 {
-	if ((GetExtraStyle() & WS_EX_LAYERED) == 0 )
-		SetWindowLong(GetHWND(), GWL_EXSTYLE, GetExtraStyle() | WS_EX_LAYERED);
-	SetLayeredWindowAttributes(GetHWND(), RGB(32, 33, 34), 0, LWA_COLORKEY);
-	SetBackgroundColour(wxColour(32, 33, 34));
+	if (_state != MiniPauseWindow::STATE_ACTIVE)
+		return;
 
-	// Set position to center of the screen
-	SetSize(wxSize(_backBitmap->GetWidth(), _backBitmap->GetHeight()));
-	assert(displayInd < osCaps.numDisplays);
-	wxRect displayRect = osCaps.displays[displayInd].clientArea;
-	SetPosition(wxPoint(displayRect.GetX() + displayRect.GetWidth() / 2 - GetSize().GetX() / 2, displayRect.GetY() + displayRect.GetHeight() / 2 - GetSize().GetY() / 2));
+	if (_timeLeft.IsExpired())
+	{
+		Hide();
+	}
+	else
+	{
+		ScheduleUpdate();
+	}
 
-	wxStaticText * txt = new wxStaticText(this, ID_MINIPAUSE_TEXT, L"", wxDefaultPosition, wxDefaultSize, wxALIGN_CENTER);
-	txt->SetFont(wxFont(13, wxFONTFAMILY_DEFAULT, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL, false));
-	txt->SetForegroundColour(wxColour(255, 255, 255, 255));
-	txt->SetPosition(wxPoint(183, 52));
+	RenderChanges();
+}
 
-	_txtTime = new wxStaticText(this, ID_MINIPAUSE_TIMER, L"", wxDefaultPosition, wxDefaultSize, wxALIGN_CENTER);
-	_txtTime->SetFont(wxFont(14, wxFONTFAMILY_DEFAULT, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL, false));
-	_txtTime->SetForegroundColour(wxColour(255, 200, 70, 255));
-	_txtTime->SetPosition(wxPoint(420, 119));
-	_txtTime->SetSize(wxSize(30, 30));
+// The task fires when the shown seconds or the personage change
+void MiniPauseWindow::ScheduleUpdate()
+{
+	long delay = _timeLeft.GetTimeToNextSecond();
+	long frame = _excerciseAnim->GetTimeToNextFrame();
+	if (frame >= 0 && frame < delay)
+		delay = frame;
+	g_TaskMgr->AddTask(GetName(), delay);
+}
 
-	_excerciseImg = new wxStaticBitmap(this, ID_MINIPAUSE_PORTRAIT, *_bmpWindow);
-	_excerciseImg->SetPosition(wxPoint(18, 38));
+void MiniPauseWindow::SetFadeAlpha(int alpha)
+{
+	_alpha = alpha;
+	SetOverlayAlpha(_alpha);
 
-	wxStaticBitmap * title = new wxStaticBitmap(this, ID_MINIPAUSE_LOGO, *_bmpTitle);
-	title->SetPosition(wxPoint(40, 12));
+	if (_state == MiniPauseWindow::STATE_SHOWING && _alpha > 0)
+		getApp()->OnOverlayVisible(GetName());
+}
 
-	if (MiniPauseControls::_excercise == 0)
+void MiniPauseWindow::OnFadeFinished()
+{
+	if (_state == MiniPauseWindow::STATE_SHOWING)
 	{
-		for (int tries = 0; tries < 8; ++tries)
-		{
-			MiniPauseControls::_excercise = rand() % NUM_EXCERCISES + 1;
-			if (getApp()->GetWindowNearbySetting() == false && MiniPauseControls::_excercise == EXCERCISE_WINDOW)
-				continue;
-			if (MiniPauseControls::_excercise != MiniPauseControls::_lastExcercise)
-				break;
-		}
-
-		MiniPauseControls::_lastExcercise = MiniPauseControls::_excercise;
-
-		int ind = 1;
-		while (ind < 20)
-		{
-			wxString id = wxString::Format(L"mini_pause_text_%d_%d", _excercise, ind);
-			if (!langPack->Has(id))
-			{
-				ind--;
-				break;
-			}
-			++ind;
-		}
-
-		if (ind > 0)
-			MiniPauseControls::_line = rand() % ind + 1;
+		_state = MiniPauseWindow::STATE_ACTIVE;
+		
+		int base_duration = getApp()->GetMiniPauseDuration();
+
+		_timeLeft.Start(1000L * base_duration);
+		
+		RenderChanges();
+		
+		ScheduleUpdate();
 	}
-
-	if (_excercise > 0 && _line > 0)
+	else if (_state == MiniPauseWindow::STATE_HIDING)
 	{
-		wxString text;
-		int numSpecMsgs = sizeof(specialMessages) / sizeof(specialMessages[0]);
-		for (int i = 0; i < numSpecMsgs; i++)
-		{
-			if ( (int)showCount == specialMessages[i].show_count)
-			{
-				text = langPack->Get(specialMessages[i].message);
-				txt->SetForegroundColour(specialMessages[i].color);
-				break;
-			}
-		}
-
-		if ( text.empty() )
-		{
-			wxString id = wxString::Format(L"mini_pause_text_%d_%d", MiniPauseControls::_excercise, MiniPauseControls::_line);
-			text = langPack->Get(id);
-			txt->SetForegroundColour(wxColour(255, 255, 255));
-		}
-
-		txt->SetLabel(text);
+		Finish();
 	}
+}
 
-	_excerciseAnim = new ExcerciseAnim(_excerciseImg, _excercise);
-
-	txt->SetSize(wxSize(250, 80));
+// Back to the pool, or closed when the pool doesn't take it
+void MiniPauseWindow::Finish()
+{
+	_state = MiniPauseWindow::STATE_DONE;
+	if (getApp()->OnMiniPauseWindowHidden(this))
+		return;
 
-	///
-	_excerciseImg->Bind(wxEVT_RIGHT_UP, &MiniPauseControls::OnMouseTap, this);
-	_txtTime->Bind(wxEVT_RIGHT_UP, &MiniPauseControls::OnMouseTap, this);
-	txt->Bind(wxEVT_RIGHT_UP, &MiniPauseControls::OnMouseTap, this);
-	title->Bind(wxEVT_RIGHT_UP, &MiniPauseControls::OnMouseTap, this);
-	Bind(wxEVT_RIGHT_UP, &MiniPauseControls::OnMouseTap, this);
+	_preventClosing = false;
+	Close();
 }
 
-MiniPauseControls::~MiniPauseControls()
+bool MiniPauseWindow::UpdateTimeLabel()
 {
-	delete _excerciseAnim;
-	MiniPauseControls::_excercise = 0;
-	MiniPauseControls::_line = 0;
+	int seconds = _timeLeft.GetSecondsLeft();
+	if (_txtTime.value == seconds)
+		return false;
+	_txtTime.value = seconds;
+	return true;
 }
 
-void MiniPauseControls::UpdateTimeLabel(int msLeft)
+void MiniPauseWindow::HideQuick()
 {
-	int secsLeft = (msLeft - 1) / 1000 + 1;
-	if (secsLeft < 0)
-		secsLeft = 0;
-	wxString newStr = wxString::Format(L"%d", secsLeft);
-	if (_txtTime->GetLabel() != newStr)
-		_txtTime->SetLabel(newStr);
+	g_TaskMgr->RemoveTasks(GetName());
+	g_Animations->Stop(this);
+
+	Finish();
 }
 
-void MiniPauseControls::Update()
+void MiniPauseWindow::Hide()
 {
-	_excerciseAnim->Update();
+	if (_state == STATE_HIDING)
+		return;
+
+	_state = STATE_HIDING;
+	g_TaskMgr->RemoveTasks(GetName());
+	g_Animations->Fade(this, _alpha, 0, 300, EASE_IN);
 }
 
-void MiniPauseControls::OnMouseTap(wxMouseEvent&)
+void MiniPauseWindow::OnMouseTap(wxMouseEvent&)
 {
 	if (getApp()->GetCanCloseNotificationsSetting())
-	{
-		MiniPauseWindow* wnd = dynamic_cast<MiniPauseWindow *>(GetParent());
-		if (wnd)
-			wnd->HideQuick();
-	}
+		HideQuick();
 }
 
-void MiniPauseControls::OnClose(wxCloseEvent& event)
+void MiniPauseWindow::OnClose(wxCloseEvent& event)
 {
 	if (!_preventClosing)
 	{
 		event.Skip(true);
 	}
-}
+}
\ No newline at end of file
@@ -4,9 +4,12 @@
 #include "wx/wx.h"
 #include "wx/timer.h"
 #include "task_mgr.h"
+#include "overlay_window.h"
+#include "animation_driver.h"
+#include "countdown.h"
 
-class MiniPauseControls;
-class MiniPauseWindow : public wxFrame, public ITask
+class ExcerciseAnim;
+class MiniPauseWindow : public OverlayWindow, public ITask, public IFadeTarget
 {
 	enum EState
 	{
@@ -17,66 +20,43 @@ class MiniPauseWindow : public wxFrame, public ITask
 	};
 
 public:
-	MiniPauseWindow(int displayInd = 0, unsigned int showCount = 0);
+	MiniPauseWindow(int displayInd = 0);
 	virtual ~MiniPauseWindow();
 
+	// Builds the window once, Start() shows it for each break it is used for
 	virtual void Init();
+	void Start(unsigned int showCount);
+
+	int GetDisplay() const { return _displayInd; }
 
 	virtual void Hide();
 	void HideQuick();
 	
 private:
 	void ExecuteTask(float f, long time_went);
+	void SetFadeAlpha(int alpha);
+	void OnFadeFinished();
 	void OnClose(wxCloseEvent& event);
+	void OnMouseTap(wxMouseEvent&);
+
+	void Render(wxRect const & dirty = wxRect());
+	void RenderChanges();
+	wxRect GetSpriteRect(int frame) const;
+	bool UpdateTimeLabel();
+	void ScheduleUpdate();
+	void Finish();
 
 	EState _state;
 	
-	MiniPauseControls * _controlsWnd;
+	ExcerciseAnim const * _excerciseAnim; // shared by the windows of all displays
+	int _shownFrame;
+	OverlayText _text;
+	OverlayNumber _txtTime;
 
-	int _timeLeft;
+	Countdown _timeLeft;
 	int _showCount;
 	int _displayInd;
 
-	float _alpha;
-	bool _preventClosing;
-	
-	DECLARE_EVENT_TABLE()
-};
-
-class ExcerciseAnim;
-class MiniPauseControls : public wxFrame
-{
-	enum
-	{
-		ID_MINIPAUSE_TEXT = 100,
-		ID_MINIPAUSE_PORTRAIT,
-		ID_MINIPAUSE_LOGO,
-		ID_MINIPAUSE_TIMER
-	};
-
-public:
-	MiniPauseControls(wxWindow * parent = 0);
-	virtual ~MiniPauseControls();
-
-	void Init(int displayInd = 0, unsigned int showCount = 0);
-
-	void Update();
-
-	static int _excercise;
-	static int _line;
-	static int _lastExcercise;
-
-	void UpdateTimeLabel(int msLeft);
-
-private:
-	void OnMouseTap(wxMouseEvent&);
-	void OnClose(wxCloseEvent& event);
-	
-	wxStaticBitmap * _excerciseImg;
-	ExcerciseAnim * _excerciseAnim;
-	
-	wxStaticText * _txtTime;
-	
 	int _alpha;
 	bool _preventClosing;
 	
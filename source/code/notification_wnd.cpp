@@ -8,11 +8,7 @@
 #include "settings.h"
 
 
-BEGIN_EVENT_TABLE(NotificationWindow, wxFrame)
-END_EVENT_TABLE()
-
-BEGIN_EVENT_TABLE(NotificationWindowLook, wxFrame)
-	EVT_CLOSE(NotificationWindowLook::OnClose)
+BEGIN_EVENT_TABLE(NotificationWindow, OverlayWindow)
 END_EVENT_TABLE()
 
 ////////////////////////////////////////////////////////////////////////
@@ -20,15 +16,13 @@ END_EVENT_TABLE()
 bool NotificationWindow::isInstanceExist(false);
 
 NotificationWindow::NotificationWindow(unsigned int showCount) :
-	wxFrame(NULL, -1, L"", wxDefaultPosition, wxDefaultSize, wxFRAME_TOOL_WINDOW | wxFRAME_SHAPED | wxNO_BORDER | wxFRAME_NO_TASKBAR | wxSTAY_ON_TOP),
 	_preventClosing(true),
-	_controlsWnd(0),
 	_showCount(showCount),
-	_timeLeft(3000),
-	_alpha(0.0f),
+	_alpha(0),
 	_state(STATE_SHOWING)
 {
 	SetName("NotificationWindow");
+	_timeLeft.Start(3000);
 }
 
 void NotificationWindow::Init(int displayInd)
@@ -38,34 +32,38 @@ void NotificationWindow::Init(int displayInd)
 
 	refillResolutionParams();
 
-	wxRegion region(*_backBitmap_notification, *wxWHITE);
-	SetShape(region);
-
-	SetBackgroundColour(wxColour(0, 0, 0));
-	SetTransparent(0);
-
-	SetSize(_backBitmap_notification->GetSize());
+	// Set position to right bottom side of the screen
+	wxSize size = _backBitmap_notification->GetSize();
 	assert(displayInd < osCaps.numDisplays);
 	wxRect displayRect = osCaps.displays[displayInd].clientArea;
-	SetPosition(wxPoint(displayRect.GetRight() - GetSize().GetX(), 
-		displayRect.GetBottom() - GetSize().GetY()));
+	InitOverlay(wxPoint(displayRect.GetRight() - size.GetX(), displayRect.GetBottom() - size.GetY()), size);
+
+	_text.font = wxFont(12, wxFONTFAMILY_DEFAULT, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL, false);
+	_text.colour = wxColour(255, 255, 255);
+	_text.box = wxRect(89, 13, 100, 25);
+	_text.text = langPack->Get(StrId::notification_wnd_label);
+
+	_txtTime.font = wxFont(14, wxFONTFAMILY_DEFAULT, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL, false);
+	_txtTime.colour = wxColour(255, 200, 70);
+	_txtTime.box = wxRect(132, 38, 40, 30);
+
+	Bind(wxEVT_RIGHT_UP, &NotificationWindow::OnMouseTap, this);
 
 	_state = NotificationWindow::STATE_SHOWING;
-	g_TaskMgr->AddTask(GetName(), 20);
-	_alpha = 0.0f;
+	_alpha = 0;
 
+	SetOverlayAlpha(0);
+	Render();
 	Show(true);
-
-	_controlsWnd = new NotificationWindowLook(this);
-	_controlsWnd->Init(displayInd, _showCount);
-	_controlsWnd->Show(true);
+	g_Animations->Fade(this, 0, 255, 400, EASE_OUT);
 }
 
 NotificationWindow::~NotificationWindow()
 {
 	if (!getApp()->isFinished())
 		g_TaskMgr->RemoveTasks(GetName());
-	_controlsWnd = 0;
+	if (g_Animations)
+		g_Animations->Stop(this);
 
 	NotificationWindow::isInstanceExist = false;
 
@@ -74,166 +72,102 @@ NotificationWindow::~NotificationWindow()
 
 void NotificationWindow::SetTime(int timeBeforeLongBreakMs)
 {
-	_timeLeft = timeBeforeLongBreakMs;
+	_timeLeft.Start(timeBeforeLongBreakMs);
+}
+
+void NotificationWindow::Render()
+{
+	BeginFrame();
+	DrawShape(_backBitmap_notification, *wxBLACK, 210);
+	DrawBitmap(*_bmpNotificationLeopard, wxPoint(12, 16));
+	DrawText(_text);
+	DrawNumber(_txtTime);
+	Present();
 }
 
 void NotificationWindow::ExecuteTask(float f, long time_went)
 {
+	(void)f;
 	(void)time_went;
 
-	switch (_state)
+	if (_state != NotificationWindow::STATE_ACTIVE)
+		return;
+
+	if (_timeLeft.GetTimeLeft() <= eyeleo::settings::timeForLongBreakConfirmation * 1000L)
 	{
-		case NotificationWindow::STATE_SHOWING:
-		{
-			_alpha += 11.0f * f;
-			if (_alpha >= 210.0f)
-			{
-				_alpha = 210.0f;
-				_state = NotificationWindow::STATE_ACTIVE;
-					
-				_controlsWnd->UpdateTimeLabel(_timeLeft);
-				
-				g_TaskMgr->AddTask(GetName(), 100);
-			}
-			else
-			{
-				g_TaskMgr->AddTask(GetName(), 20);
-			}
-			SetTransparent((int)_alpha);
-			break;
-		}
-
-		case NotificationWindow::STATE_ACTIVE:
-		{
-			_timeLeft -= 100.0f * f;
-			
-			_controlsWnd->Update();
-			
-			if (_timeLeft <= eyeleo::settings::timeForLongBreakConfirmation * 1000)
-			{
-				_state = NotificationWindow::STATE_HIDING;
-				_controlsWnd->Show(false);
-				_controlsWnd->Destroy();
-				g_TaskMgr->AddTask(GetName(), 20);
-			}
-			else
-			{
-				g_TaskMgr->AddTask(GetName(), 100);
-			}
-
-			_controlsWnd->UpdateTimeLabel(_timeLeft);
-			break;
-		}
-
-		case NotificationWindow::STATE_HIDING:
-		{
-			_alpha -= 15.0f * f;
-			if (_alpha <= 0.0f)
-			{
-				_alpha = 0.0f;
-				_state = NotificationWindow::STATE_DONE;
-				_preventClosing = false;
-				SetTransparent(0);
-				
-				Close();
-			}
-			else
-			{
-				SetTransparent((int)_alpha);
-				g_TaskMgr->AddTask(GetName(), 20);
-			}
-			break;
-		}
+		StartHiding();
+	}
+	else
+	{
+		ScheduleUpdate();
+		if (UpdateTimeLabel())
+			Render();
 	}
 }
 
-bool NotificationWindow::Hide()
+// The task fires when the shown seconds change or the window has to go
+void NotificationWindow::ScheduleUpdate()
 {
-	if ( _state == NotificationWindow::STATE_HIDING )
-		return false;
-
-	_state = NotificationWindow::STATE_HIDING;
+	long delay = _timeLeft.GetTimeToNextSecond();
+	long hideIn = _timeLeft.GetTimeLeft() - eyeleo::settings::timeForLongBreakConfirmation * 1000L;
+	if (hideIn < delay)
+		delay = hideIn > 0 ? hideIn : 0;
+	g_TaskMgr->AddTask(GetName(), delay);
+}
 
-	_controlsWnd->Hide();
-	return wxFrame::Hide();
+void NotificationWindow::SetFadeAlpha(int alpha)
+{
+	_alpha = alpha;
+	SetOverlayAlpha(_alpha);
 }
 
-void NotificationWindow::OnClose(wxCloseEvent& event)
+void NotificationWindow::OnFadeFinished()
 {
-	if (!_preventClosing)
+	if (_state == NotificationWindow::STATE_SHOWING)
 	{
-		event.Skip(true);
+		_state = NotificationWindow::STATE_ACTIVE;
+			
+		if (UpdateTimeLabel())
+			Render();
+		
+		ScheduleUpdate();
+	}
+	else if (_state == NotificationWindow::STATE_HIDING)
+	{
+		_state = NotificationWindow::STATE_DONE;
+		_preventClosing = false;
+		
+		Close();
 	}
 }
 
-////////////////////////////////////////////////////////////////////////
-
-NotificationWindowLook::NotificationWindowLook(wxWindow * parent) :
-	wxFrame(parent, -1, L"", wxDefaultPosition, wxDefaultSize, wxFRAME_TOOL_WINDOW | wxFRAME_SHAPED | wxNO_BORDER | wxFRAME_NO_TASKBAR | wxSTAY_ON_TOP),
-	_preventClosing(true),
-	_eyeleoLogo(0),
-	_txtTime(nullptr),
-	_alpha(0.0f)
+void NotificationWindow::StartHiding()
 {
+	_state = NotificationWindow::STATE_HIDING;
+	g_TaskMgr->RemoveTasks(GetName());
+	g_Animations->Fade(this, _alpha, 0, 300, EASE_IN);
 }
 
-void NotificationWindowLook::Init(int displayInd, unsigned int showCount)
+bool NotificationWindow::UpdateTimeLabel()
 {
-	(void)showCount;
-
-	if ((GetExtraStyle() & WS_EX_LAYERED) == 0)
-		SetWindowLong(GetHWND(), GWL_EXSTYLE, GetExtraStyle() | WS_EX_LAYERED);
-	SetLayeredWindowAttributes(GetHWND(), RGB(32, 33, 34), 0, LWA_COLORKEY);
-	SetBackgroundColour(wxColour(32, 33, 34));
-
-	// Set position to right bottom side of the screen
-	SetSize(_backBitmap_notification->GetSize());
-	assert(displayInd < osCaps.numDisplays);
-	wxRect displayRect = osCaps.displays[displayInd].clientArea;
-	SetPosition(wxPoint(displayRect.GetRight() - GetSize().GetX(), 
-		displayRect.GetBottom() - GetSize().GetY()));
-
-	wxStaticText * txt = new wxStaticText(this, wxID_ANY, L"", wxDefaultPosition, wxSize(100, 25), wxALIGN_CENTER);
-	txt->SetFont(wxFont(12, wxFONTFAMILY_DEFAULT, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL, false));
-	txt->SetForegroundColour(wxColour(255, 255, 255, 255));
-	txt->SetPosition(wxPoint(89, 13));
-	txt->SetLabel(langPack->Get(L"notification_wnd_label"));
-
-	_txtTime = new wxStaticText(this, wxID_ANY, L"", wxDefaultPosition, wxDefaultSize, wxALIGN_CENTER);
-	_txtTime->SetFont(wxFont(14, wxFONTFAMILY_DEFAULT, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL, false));
-	_txtTime->SetForegroundColour(wxColour(255, 200, 70, 255));
-	_txtTime->SetPosition(wxPoint(132, 38));
-	_txtTime->SetSize(wxSize(40, 30));
-
-	wxStaticBitmap * logo = new wxStaticBitmap(this, wxID_ANY, *_bmpNotificationLeopard);
-	logo->SetPosition(wxPoint(12, 16));
-
-	//
-	txt->Bind(wxEVT_RIGHT_UP, &NotificationWindowLook::OnMouseTap, this);
-	_txtTime->Bind(wxEVT_RIGHT_UP, &NotificationWindowLook::OnMouseTap, this);
-	logo->Bind(wxEVT_RIGHT_UP, &NotificationWindowLook::OnMouseTap, this);
-	Bind(wxEVT_RIGHT_UP, &NotificationWindowLook::OnMouseTap, this);
+	int seconds = _timeLeft.GetSecondsLeft();
+	if (_txtTime.value == seconds)
+		return false;
+	_txtTime.value = seconds;
+	return true;
 }
 
-NotificationWindowLook::~NotificationWindowLook()
+bool NotificationWindow::Hide()
 {
-}
+	if ( _state == NotificationWindow::STATE_HIDING )
+		return false;
 
-void NotificationWindowLook::UpdateTimeLabel(int msLeft)
-{
-	int secsLeft = (msLeft - 1) / 1000 + 1;
-	if (secsLeft < 0)
-		secsLeft = 0;
-	wxString newStr = wxString::Format(L"%d", secsLeft);
-	if (_txtTime->GetLabel() != newStr)
-		_txtTime->SetLabel(newStr);
-}
+	StartHiding();
 
-void NotificationWindowLook::Update()
-{
+	return wxFrame::Hide();
 }
 
-void NotificationWindowLook::OnClose(wxCloseEvent& event)
+void NotificationWindow::OnClose(wxCloseEvent& event)
 {
 	if (!_preventClosing)
 	{
@@ -241,12 +175,8 @@ void NotificationWindowLook::OnClose(wxCloseEvent& event)
 	}
 }
 
-void NotificationWindowLook::OnMouseTap(wxMouseEvent&)
+void NotificationWindow::OnMouseTap(wxMouseEvent&)
 {
 	if (getApp()->GetCanCloseNotificationsSetting())
-	{
-		NotificationWindow* wnd = dynamic_cast<NotificationWindow*>(GetParent());
-		if (wnd)
-			wnd->Hide();
-	}
-}
+		Hide();
+}
\ No newline at end of file
@@ -4,9 +4,11 @@
 #include "wx/wx.h"
 #include "wx/timer.h"
 #include "task_mgr.h"
+#include "overlay_window.h"
+#include "animation_driver.h"
+#include "countdown.h"
 
-class NotificationWindowLook;
-class NotificationWindow : public wxFrame, public ITask
+class NotificationWindow : public OverlayWindow, public ITask, public IFadeTarget
 {
 	enum EState
 	{
@@ -20,9 +22,10 @@ class NotificationWindow : public wxFrame, public ITask
 
 	EState _state;
 
-	NotificationWindowLook * _controlsWnd;
+	OverlayText _text;
+	OverlayNumber _txtTime;
 
-	int _timeLeft;
+	Countdown _timeLeft;
 	int _showCount;
 
 	int _alpha;
@@ -43,33 +46,15 @@ public:
 	
 private:
 	void ExecuteTask(float f, long time_went);
-	void OnClose(wxCloseEvent& event);
-};
-
-class NotificationWindowLook : public wxFrame
-{
-public:
-	NotificationWindowLook(wxWindow * parent = 0);
-	virtual ~NotificationWindowLook();
-
-	void Init(int displayInd, unsigned int showCount);
-
-	void Update();
-	
-	void UpdateTimeLabel(int msLeft);
-
-private:
+	void SetFadeAlpha(int alpha);
+	void OnFadeFinished();
 	void OnClose(wxCloseEvent& event);
 	void OnMouseTap(wxMouseEvent& evt);
-	
-	wxStaticBitmap * _eyeleoLogo;
-
-	wxStaticText * _txtTime;
 
-	int _alpha;
-	bool _preventClosing;
-	
-	DECLARE_EVENT_TABLE()
+	void Render();
+	void StartHiding();
+	bool UpdateTimeLabel();
+	void ScheduleUpdate();
 };
 
 #endif
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "oscapabilities.h"
 #include <wx/display.h>
+#include <atomic>
 
 #ifdef WIN32
 #include "windows.h"
@@ -7,30 +8,101 @@
 
 OSCapabilities osCaps;
 
+namespace
+{
+	class SystemDisplayTopology : public DisplayTopologyProvider
+	{
+	public:
+		virtual void QueryDisplays(std::vector<DisplayData> & displays)
+		{
+			int count = wxDisplay::GetCount();
+			displays.resize(count);
+			for (int ind = 0; ind < count; ++ind)
+			{
+				DisplayData & disp = displays[ind];
+
+				wxDisplay display(ind);
+				disp.primary = display.IsPrimary();
+				disp.clientArea = display.GetClientArea();
+				disp.geometry = display.GetGeometry();
+			}
+		}
+	};
+
+	SystemDisplayTopology systemTopology;
+	DisplayTopologyProvider * topologyProvider = &systemTopology;
+
+	// set until the displays were queried, wxDisplay is created for every one of them
+	std::atomic<bool> topologyChanged(true);
+
+#ifdef WIN32
+	// The work area changes with the taskbar without a display change. Only top-level windows
+	// get WM_SETTINGCHANGE, so a hidden one that is never shown listens for it.
+	LRESULT CALLBACK settingsWindowProc(HWND hWnd, UINT message, WPARAM wParam, LPARAM lParam)
+	{
+		if (message == WM_SETTINGCHANGE && wParam == SPI_SETWORKAREA)
+			invalidateDisplayTopology();
+		return DefWindowProcW(hWnd, message, wParam, lParam);
+	}
+
+	void createSettingsWindow()
+	{
+		static HWND settingsWindow = 0;
+		if (settingsWindow)
+			return;
+
+		WNDCLASSW windowClass = {};
+		windowClass.lpfnWndProc = settingsWindowProc;
+		windowClass.hInstance = GetModuleHandleW(NULL);
+		windowClass.lpszClassName = L"EyeLeoSettingChange";
+		RegisterClassW(&windowClass);
+		settingsWindow = CreateWindowExW(WS_EX_TOOLWINDOW, windowClass.lpszClassName, L"", WS_POPUP, 0, 0, 0, 0, NULL, NULL, windowClass.hInstance, NULL);
+	}
+#endif
+}
+
 void fillOSCapabilities()
 {
-	// retrieve monitor count
-	osCaps.numDisplays = wxDisplay::GetCount();
-	osCaps.multiDisplay = osCaps.numDisplays > 1;
-	
+#ifdef WIN32
+	createSettingsWindow();
+#endif
+	osCaps.topologyGeneration = 0;
+	invalidateDisplayTopology();
+	refillResolutionParams();
+}
+
+void setDisplayTopologyProvider(DisplayTopologyProvider * provider)
+{
+	topologyProvider = provider ? provider : &systemTopology;
+	invalidateDisplayTopology();
 	refillResolutionParams();
 }
 
+void invalidateDisplayTopology()
+{
+	topologyChanged.store(true);
+}
+
 void refillResolutionParams()
 {
-	osCaps.displays.clear();
-	
+	if (!topologyChanged.exchange(false))
+		return;
+
+	topologyProvider->QueryDisplays(osCaps.displays);
+
+	osCaps.numDisplays = (int)osCaps.displays.size();
+	osCaps.multiDisplay = osCaps.numDisplays > 1;
+	osCaps.primaryDisplayInd = 0;
 	for (int ind = 0; ind < osCaps.numDisplays; ++ind)
 	{
-		osCaps.displays.push_back(DisplayData());
-		DisplayData & disp = osCaps.displays[ind];
-		
-		wxDisplay display(ind);
-		//display.ReinitializeImpl();
-		disp.primary = display.IsPrimary();
-		disp.clientArea = display.GetClientArea();
-		disp.geometry = display.GetGeometry();
-		if (disp.primary)
+		if (osCaps.displays[ind].primary)
 			osCaps.primaryDisplayInd = ind;
 	}
+	++osCaps.topologyGeneration;
+}
+
+wxPoint centerInClientArea(int displayInd, wxSize const & size)
+{
+	wxRect displayRect = osCaps.displays[displayInd].clientArea;
+	return wxPoint(displayRect.GetX() + displayRect.GetWidth() / 2 - size.GetX() / 2, displayRect.GetY() + displayRect.GetHeight() / 2 - size.GetY() / 2);
 }
\ No newline at end of file
@@ -21,11 +21,42 @@ struct OSCapabilities
 	int primaryDisplayInd;
 
 	std::vector<DisplayData> displays;
+	unsigned int topologyGeneration; // changes every time the displays are queried again
 };
 
 extern OSCapabilities osCaps;
 
+// Where the displays are queried from, wxDisplay unless another provider is set
+class DisplayTopologyProvider
+{
+public:
+	virtual ~DisplayTopologyProvider() {}
+	virtual void QueryDisplays(std::vector<DisplayData> & displays) = 0;
+};
+
+// A made-up topology, so the window layout can run without the displays it is meant for
+class FixedDisplayTopology : public DisplayTopologyProvider
+{
+public:
+	FixedDisplayTopology(std::vector<DisplayData> const & displays) : _displays(displays) {}
+
+	void SetDisplays(std::vector<DisplayData> const & displays) { _displays = displays; }
+	virtual void QueryDisplays(std::vector<DisplayData> & displays) { displays = _displays; }
+
+private:
+	std::vector<DisplayData> _displays;
+};
+
 void fillOSCapabilities();
+// The provider isn't owned, 0 goes back to wxDisplay. The displays are queried again.
+void setDisplayTopologyProvider(DisplayTopologyProvider * provider);
+
+// Display, DPI and work area change notifications call it, may be called from any thread
+void invalidateDisplayTopology();
+// Queries the displays only when they were invalidated since the last time, GUI thread only
 void refillResolutionParams();
 
+// Position of a window of that size centered in the client area of a display
+wxPoint centerInClientArea(int displayInd, wxSize const & size);
+
 #endif
\ No newline at end of file
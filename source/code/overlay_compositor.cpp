@@ -0,0 +1,123 @@
+#include "overlay_compositor.h"
+#include "pixel_kernels.h"
+#include <algorithm>
+
+uint32_t PremultipliedColor(unsigned int r, unsigned int g, unsigned int b, unsigned int a)
+{
+	uint32_t color = (a << 24) | (r << 16) | (g << 8) | b;
+	pixelkernels::Premultiply(&color, 1);
+	return color;
+}
+
+OverlayCompositor::OverlayCompositor() :
+	_width(0),
+	_height(0),
+	_clipX0(0),
+	_clipY0(0),
+	_clipX1(0),
+	_clipY1(0)
+{
+}
+
+void OverlayCompositor::Resize(int width, int height)
+{
+	_width = width > 0 ? width : 0;
+	_height = height > 0 ? height : 0;
+	_pixels.assign((size_t)_width * _height, 0);
+	ResetClip();
+}
+
+void OverlayCompositor::SetClip(int x, int y, int width, int height)
+{
+	_clipX0 = x > 0 ? x : 0;
+	_clipY0 = y > 0 ? y : 0;
+	_clipX1 = x + width < _width ? x + width : _width;
+	_clipY1 = y + height < _height ? y + height : _height;
+	if (_clipX1 < _clipX0)
+		_clipX1 = _clipX0;
+	if (_clipY1 < _clipY0)
+		_clipY1 = _clipY0;
+}
+
+void OverlayCompositor::ResetClip()
+{
+	_clipX0 = 0;
+	_clipY0 = 0;
+	_clipX1 = _width;
+	_clipY1 = _height;
+}
+
+void OverlayCompositor::Clear()
+{
+	if (_clipX0 == 0 && _clipY0 == 0 && _clipX1 == _width && _clipY1 == _height)
+	{
+		_pixels.assign(_pixels.size(), 0);
+		return;
+	}
+
+	for (int row = _clipY0; row < _clipY1; ++row)
+		std::fill(_pixels.begin() + (size_t)row * _width + _clipX0, _pixels.begin() + (size_t)row * _width + _clipX1, 0);
+}
+
+bool OverlayCompositor::clip(int & x, int & y, int & width, int & height, int & srcX, int & srcY) const
+{
+	srcX = x < _clipX0 ? _clipX0 - x : 0;
+	srcY = y < _clipY0 ? _clipY0 - y : 0;
+	x += srcX;
+	y += srcY;
+	width -= srcX;
+	height -= srcY;
+	if (x + width > _clipX1)
+		width = _clipX1 - x;
+	if (y + height > _clipY1)
+		height = _clipY1 - y;
+	return width > 0 && height > 0;
+}
+
+void OverlayCompositor::FillRect(int x, int y, int width, int height, uint32_t color)
+{
+	int srcX, srcY;
+	if (!clip(x, y, width, height, srcX, srcY))
+		return;
+
+	_row.assign(width, color);
+	for (int row = y; row < y + height; ++row)
+		pixelkernels::BlendOver(&_pixels[(size_t)row * _width + x], &_row[0], width);
+}
+
+void OverlayCompositor::DrawImage(OverlayImage const & image, int x, int y)
+{
+	DrawImage(image, 0, 0, image.width, image.height, x, y);
+}
+
+void OverlayCompositor::DrawImage(OverlayImage const & image, int srcX, int srcY, int width, int height, int x, int y)
+{
+	if (srcX < 0 || srcY < 0 || srcX + width > image.width || srcY + height > image.height)
+		return;
+
+	int offsetX, offsetY;
+	if (image.pixels.empty() || !clip(x, y, width, height, offsetX, offsetY))
+		return;
+	srcX += offsetX;
+	srcY += offsetY;
+
+	for (int row = 0; row < height; ++row)
+	{
+		pixelkernels::BlendOver(&_pixels[(size_t)(y + row) * _width + x],
+			&image.pixels[(size_t)(srcY + row) * image.width + srcX], width);
+	}
+}
+
+void OverlayCompositor::DrawMask(const uint8_t * coverage, int width, int height, int x, int y, uint32_t color)
+{
+	int stride = width;
+	int srcX, srcY;
+	if (!coverage || !clip(x, y, width, height, srcX, srcY))
+		return;
+
+	for (int row = 0; row < height; ++row)
+	{
+		pixelkernels::BlendMask(&_pixels[(size_t)(y + row) * _width + x],
+			coverage + (size_t)(srcY + row) * stride + srcX, width, color);
+	}
+}
@@ -0,0 +1,56 @@
+#ifndef OVERLAY_COMPOSITOR_H
+#define OVERLAY_COMPOSITOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Premultiplied 0xAARRGGBB pixels, top row first
+struct OverlayImage
+{
+	int width;
+	int height;
+	std::vector<uint32_t> pixels;
+
+	OverlayImage() : width(0), height(0) {}
+};
+
+uint32_t PremultipliedColor(unsigned int r, unsigned int g, unsigned int b, unsigned int a = 255);
+
+// Renders a popup into one premultiplied frame that a per-pixel-alpha window presents.
+// Doesn't depend on wx or Windows, everything is drawn over what is already there.
+class OverlayCompositor
+{
+public:
+	OverlayCompositor();
+
+	// Clears the frame and the clip as well
+	void Resize(int width, int height);
+	// Drawing and Clear() only touch this rectangle, to render a part of the frame again
+	void SetClip(int x, int y, int width, int height);
+	void ResetClip();
+	void Clear();
+
+	int GetWidth() const { return _width; }
+	int GetHeight() const { return _height; }
+	const uint32_t * GetPixels() const { return _pixels.empty() ? 0 : &_pixels[0]; }
+
+	void FillRect(int x, int y, int width, int height, uint32_t color);
+	void DrawImage(OverlayImage const & image, int x, int y);
+	// Draws the width x height block of the image at srcX, srcY, e.g. a sprite of an atlas
+	void DrawImage(OverlayImage const & image, int srcX, int srcY, int width, int height, int x, int y);
+	// Glyphs and the like: color times the 8-bit coverage of each pixel
+	void DrawMask(const uint8_t * coverage, int width, int height, int x, int y, uint32_t color);
+
+private:
+	// Cuts a width x height block at x, y to the clip, srcX and srcY get the offset into the block
+	bool clip(int & x, int & y, int & width, int & height, int & srcX, int & srcY) const;
+
+	int _width;
+	int _height;
+	int _clipX0, _clipY0, _clipX1, _clipY1;
+	std::vector<uint32_t> _pixels;
+	std::vector<uint32_t> _row;
+};
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef OVERLAY_POOL_H
+#define OVERLAY_POOL_H
+
+#include <vector>
+#include <algorithm>
+
+// Hidden break windows that are already initialised, at most one per display.
+// A window is either shown and listed by EyeApp or hidden here until the next break.
+template <class Window>
+class OverlayPool
+{
+public:
+	// The hidden window of a display, 0 when there is none
+	Window * Take(int displayInd)
+	{
+		for (typename std::vector<Window *>::iterator it = _windows.begin(); it != _windows.end(); ++it)
+		{
+			if ((*it)->GetDisplay() == displayInd)
+			{
+				Window * wnd = *it;
+				_windows.erase(it);
+				return wnd;
+			}
+		}
+		return 0;
+	}
+
+	// Leaves the window in the pool
+	Window * Find(int displayInd) const
+	{
+		for (typename std::vector<Window *>::const_iterator it = _windows.begin(); it != _windows.end(); ++it)
+		{
+			if ((*it)->GetDisplay() == displayInd)
+				return *it;
+		}
+		return 0;
+	}
+
+	void Put(Window * wnd)
+	{
+		wnd->Show(false);
+		_windows.push_back(wnd);
+	}
+
+	// Called by a destroyed window
+	void Remove(Window * wnd)
+	{
+		typename std::vector<Window *>::iterator it = std::find(_windows.begin(), _windows.end(), wnd);
+		if (it != _windows.end())
+			_windows.erase(it);
+	}
+
+	void Clear()
+	{
+		std::vector<Window *> windows;
+		windows.swap(_windows);
+		for (typename std::vector<Window *>::iterator it = windows.begin(); it != windows.end(); ++it)
+			(*it)->Destroy();
+	}
+
+private:
+	std::vector<Window *> _windows;
+};
+
+#endif
@@ -0,0 +1,419 @@
+#include "overlay_window.h"
+#include "image_resources.h"
+#include "logging.h"
+#include "pixel_kernels.h"
+#include "wx/dcmemory.h"
+#include "wx/rawbmp.h"
+#include <deque>
+#include <string.h>
+
+namespace
+{
+	// Greedy word wrap, like a multiline static control does it
+	void wrapText(wxDC & dc, wxString const & text, int width, wxArrayString & lines)
+	{
+		wxArrayString paragraphs = wxSplit(text, L'\n', L'\0');
+		for (size_t i = 0; i < paragraphs.size(); ++i)
+		{
+			wxArrayString words = wxSplit(paragraphs[i], L' ', L'\0');
+			wxString line;
+			for (size_t j = 0; j < words.size(); ++j)
+			{
+				wxString candidate = line.empty() ? words[j] : line + L" " + words[j];
+				if (!line.empty() && dc.GetTextExtent(candidate).GetWidth() > width)
+				{
+					lines.Add(line);
+					line = words[j];
+				}
+				else
+				{
+					line = candidate;
+				}
+			}
+			lines.Add(line);
+		}
+	}
+
+	// The green channel of white text on black is its coverage
+	void readCoverage(wxBitmap & canvas, std::vector<uint8_t> & coverage)
+	{
+		int width = canvas.GetWidth();
+		coverage.resize((size_t)width * canvas.GetHeight());
+
+		wxNativePixelData data(canvas);
+		wxNativePixelData::Iterator row(data);
+		for (int y = 0; y < canvas.GetHeight(); ++y)
+		{
+			wxNativePixelData::Iterator pixel = row;
+			for (int x = 0; x < width; ++x, ++pixel)
+				coverage[(size_t)y * width + x] = pixel.Green();
+			row.OffsetY(data, 1);
+		}
+	}
+
+	// Wrapped texts are the same on every display and in every break with the same tip
+	struct TextLayout
+	{
+		wxString text;
+		wxString font;
+		wxSize size;
+		std::vector<uint8_t> coverage;
+	};
+
+	const size_t MAX_TEXT_LAYOUTS = 16;
+	std::deque<TextLayout> textLayouts; // the oldest is dropped first
+
+	// Digits of a font, each one rasterized once
+	struct DigitGlyphs
+	{
+		wxFont font;
+		int height;
+		int widths[10];
+		std::vector<uint8_t> coverage[10];
+	};
+
+	std::deque<DigitGlyphs> digitGlyphs; // one per countdown font, a few at most
+
+	DigitGlyphs const & getDigitGlyphs(wxFont const & font)
+	{
+		for (size_t i = 0; i < digitGlyphs.size(); ++i)
+		{
+			if (digitGlyphs[i].font == font)
+				return digitGlyphs[i];
+		}
+
+		digitGlyphs.push_back(DigitGlyphs());
+		DigitGlyphs & glyphs = digitGlyphs.back();
+		glyphs.font = font;
+
+		wxBitmap measure(1, 1, 24);
+		wxMemoryDC measureDC(measure);
+		measureDC.SetFont(font);
+		glyphs.height = measureDC.GetCharHeight();
+
+		for (int digit = 0; digit < 10; ++digit)
+		{
+			wxString text((wxChar)(L'0' + digit));
+			glyphs.widths[digit] = measureDC.GetTextExtent(text).GetWidth();
+			if (glyphs.widths[digit] <= 0 || glyphs.height <= 0)
+				continue;
+
+			wxBitmap canvas(glyphs.widths[digit], glyphs.height, 24);
+			{
+				wxMemoryDC dc(canvas);
+				dc.SetBackground(*wxBLACK_BRUSH);
+				dc.Clear();
+				dc.SetFont(font);
+				dc.SetTextForeground(*wxWHITE);
+				dc.DrawText(text, 0, 0);
+			}
+			readCoverage(canvas, glyphs.coverage[digit]);
+		}
+		return glyphs;
+	}
+
+	typedef BOOL (WINAPI * UpdateLayeredWindowIndirectProc)(HWND, const UPDATELAYEREDWINDOWINFO *);
+
+	// Vista and later, XP only updates the whole window
+	UpdateLayeredWindowIndirectProc getUpdateLayeredWindowIndirect()
+	{
+		static UpdateLayeredWindowIndirectProc proc =
+			(UpdateLayeredWindowIndirectProc)GetProcAddress(GetModuleHandle(L"user32.dll"), "UpdateLayeredWindowIndirect");
+		return proc;
+	}
+}
+
+void ConvertBitmap(wxBitmap const & bitmap, OverlayImage & image)
+{
+	image = OverlayImage();
+	wxImage source = bitmap.ConvertToImage();
+	if (!source.IsOk())
+		return;
+	if (!source.HasAlpha() && source.HasMask())
+		source.InitAlpha();
+
+	image.width = source.GetWidth();
+	image.height = source.GetHeight();
+	image.pixels.resize((size_t)image.width * image.height);
+
+	const unsigned char * rgb = source.GetData();
+	const unsigned char * alpha = source.GetAlpha();
+	for (size_t i = 0; i < image.pixels.size(); ++i)
+	{
+		uint32_t a = alpha ? alpha[i] : 255;
+		image.pixels[i] = (a << 24) | (rgb[i * 3] << 16) | (rgb[i * 3 + 1] << 8) | rgb[i * 3 + 2];
+	}
+	if (!image.pixels.empty())
+		pixelkernels::Premultiply(&image.pixels[0], image.pixels.size());
+}
+
+OverlayWindow::OverlayWindow() :
+	wxFrame(NULL, -1, L"", wxDefaultPosition, wxDefaultSize, wxFRAME_TOOL_WINDOW | wxNO_BORDER | wxFRAME_NO_TASKBAR | wxSTAY_ON_TOP),
+	_dib(0),
+	_dibDC(0),
+	_oldDibBitmap(0),
+	_dibPixels(0),
+	_overlayAlpha(0),
+	_presented(false)
+{
+	// UpdateLayeredWindow() only works while SetLayeredWindowAttributes() was never called,
+	// so neither SetTransparent() nor SetShape() may be used
+	SetWindowLong(GetHWND(), GWL_EXSTYLE, GetWindowLong(GetHWND(), GWL_EXSTYLE) | WS_EX_LAYERED);
+}
+
+OverlayWindow::~OverlayWindow()
+{
+	if (_dibDC)
+	{
+		SelectObject(_dibDC, _oldDibBitmap);
+		DeleteDC(_dibDC);
+	}
+	if (_dib)
+		DeleteObject(_dib);
+}
+
+void OverlayWindow::InitOverlay(wxPoint const & position, wxSize const & size)
+{
+	SetSize(size);
+	SetPosition(position);
+	_compositor.Resize(size.GetWidth(), size.GetHeight());
+
+	BITMAPINFO info;
+	memset(&info, 0, sizeof(info));
+	info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	info.bmiHeader.biWidth = size.GetWidth();
+	info.bmiHeader.biHeight = -size.GetHeight(); // top row first, as in the compositor
+	info.bmiHeader.biPlanes = 1;
+	info.bmiHeader.biBitCount = 32;
+	info.bmiHeader.biCompression = BI_RGB;
+
+	HDC screenDC = ::GetDC(NULL);
+	_dib = CreateDIBSection(screenDC, &info, DIB_RGB_COLORS, &_dibPixels, NULL, 0);
+	_dibDC = CreateCompatibleDC(screenDC);
+	::ReleaseDC(NULL, screenDC);
+
+	if (!_dib || !_dibDC)
+	{
+		LOG_WARNING("%s: can't create the overlay bitmap, error %u", GetName(), (unsigned)GetLastError());
+		return;
+	}
+	_oldDibBitmap = SelectObject(_dibDC, _dib);
+}
+
+void OverlayWindow::BeginFrame(wxRect const & dirty)
+{
+	_frameTimer.Start();
+
+	// the window has no pixels to keep before the first frame
+	_dirty = _presented ? dirty.Intersect(wxRect(0, 0, _compositor.GetWidth(), _compositor.GetHeight())) : wxRect();
+	if (_dirty.IsEmpty())
+		_compositor.ResetClip();
+	else
+		_compositor.SetClip(_dirty.GetX(), _dirty.GetY(), _dirty.GetWidth(), _dirty.GetHeight());
+	_compositor.Clear();
+}
+
+void OverlayWindow::DrawShape(wxBitmap const * skin, wxColour const & colour, int alpha)
+{
+	uint32_t color = PremultipliedColor(colour.Red(), colour.Green(), colour.Blue(), alpha);
+	for (wxRegionIterator rect(GetResourceShape(skin)); rect; ++rect)
+		_compositor.FillRect(rect.GetX(), rect.GetY(), rect.GetW(), rect.GetH(), color);
+}
+
+void OverlayWindow::DrawBitmap(wxBitmap const & bitmap, wxPoint const & position)
+{
+	_compositor.DrawImage(getImage(bitmap), position.x, position.y);
+}
+
+void OverlayWindow::DrawSprite(OverlayImage const & atlas, wxRect const & source, wxPoint const & position)
+{
+	_compositor.DrawImage(atlas, source.GetX(), source.GetY(), source.GetWidth(), source.GetHeight(), position.x, position.y);
+}
+
+void OverlayWindow::DrawText(OverlayText & text)
+{
+	if (text.text.empty())
+		return;
+	if (text.rendered != text.text || text.coverage.empty())
+		rasterize(text);
+	if (text.coverage.empty())
+		return; // the box is empty
+
+	uint32_t color = PremultipliedColor(text.colour.Red(), text.colour.Green(), text.colour.Blue());
+	_compositor.DrawMask(&text.coverage[0], text.box.GetWidth(), text.box.GetHeight(), text.box.GetX(), text.box.GetY(), color);
+}
+
+void OverlayWindow::DrawNumber(OverlayNumber const & number)
+{
+	if (number.value < 0)
+		return;
+
+	DigitGlyphs const & glyphs = getDigitGlyphs(number.font);
+
+	int digits[12];
+	int count = 0;
+	int width = 0;
+	unsigned int value = number.value;
+	do
+	{
+		digits[count] = value % 10;
+		width += glyphs.widths[digits[count]];
+		count++;
+		value /= 10;
+	} while (value);
+
+	int height = glyphs.height < number.box.GetHeight() ? glyphs.height : number.box.GetHeight();
+	int x = number.box.GetX() + (number.box.GetWidth() - width) / 2;
+	uint32_t color = PremultipliedColor(number.colour.Red(), number.colour.Green(), number.colour.Blue());
+	for (int i = count - 1; i >= 0; --i)
+	{
+		std::vector<uint8_t> const & coverage = glyphs.coverage[digits[i]];
+		if (!coverage.empty())
+			_compositor.DrawMask(&coverage[0], glyphs.widths[digits[i]], height, x, number.box.GetY(), color);
+		x += glyphs.widths[digits[i]];
+	}
+}
+
+void OverlayWindow::Present()
+{
+	if (!_dibPixels)
+		return;
+
+	int width = _compositor.GetWidth();
+	if (_dirty.IsEmpty())
+	{
+		memcpy(_dibPixels, _compositor.GetPixels(), (size_t)width * _compositor.GetHeight() * sizeof(uint32_t));
+		updateLayeredWindow(true, 0);
+	}
+	else
+	{
+		for (int y = _dirty.GetTop(); y <= _dirty.GetBottom(); ++y)
+		{
+			size_t offset = (size_t)y * width + _dirty.GetX();
+			memcpy((uint32_t *)_dibPixels + offset, _compositor.GetPixels() + offset, _dirty.GetWidth() * sizeof(uint32_t));
+		}
+		RECT dirty = { _dirty.GetLeft(), _dirty.GetTop(), _dirty.GetRight() + 1, _dirty.GetBottom() + 1 };
+		updateLayeredWindow(true, &dirty);
+	}
+	LOG_DEBUG("%s: frame rendered in %lld us, %dx%d pixels", GetName(), (long long)_frameTimer.TimeInMicro().GetValue(),
+		_dirty.IsEmpty() ? width : _dirty.GetWidth(), _dirty.IsEmpty() ? _compositor.GetHeight() : _dirty.GetHeight());
+
+	if (!_presented)
+	{
+		_presented = true;
+		LOG_INFO("%s: %dx%d overlay, GDI objects %u, USER objects %u", GetName(), _compositor.GetWidth(), _compositor.GetHeight(),
+			(unsigned)GetGuiResources(GetCurrentProcess(), GR_GDIOBJECTS), (unsigned)GetGuiResources(GetCurrentProcess(), GR_USEROBJECTS));
+	}
+}
+
+void OverlayWindow::SetOverlayAlpha(int alpha)
+{
+	_overlayAlpha = alpha < 0 ? 0 : (alpha > 255 ? 255 : alpha);
+	if (_presented)
+		updateLayeredWindow(false, 0);
+}
+
+void OverlayWindow::updateLayeredWindow(bool withPixels, RECT const * dirty)
+{
+	BLENDFUNCTION blend = { AC_SRC_OVER, 0, (BYTE)_overlayAlpha, AC_SRC_ALPHA };
+	BOOL ok;
+	if (withPixels)
+	{
+		wxPoint position = GetPosition();
+		POINT windowPos = { position.x, position.y };
+		SIZE size = { _compositor.GetWidth(), _compositor.GetHeight() };
+		POINT origin = { 0, 0 };
+
+		HDC screenDC = ::GetDC(NULL);
+		UpdateLayeredWindowIndirectProc updateIndirect = getUpdateLayeredWindowIndirect();
+		if (dirty && updateIndirect)
+		{
+			UPDATELAYEREDWINDOWINFO info;
+			memset(&info, 0, sizeof(info));
+			info.cbSize = sizeof(info);
+			info.hdcDst = screenDC;
+			info.pptDst = &windowPos;
+			info.psize = &size;
+			info.hdcSrc = _dibDC;
+			info.pptSrc = &origin;
+			info.pblend = &blend;
+			info.dwFlags = ULW_ALPHA;
+			info.prcDirty = dirty;
+			ok = updateIndirect(GetHWND(), &info);
+		}
+		else
+		{
+			ok = UpdateLayeredWindow(GetHWND(), screenDC, &windowPos, &size, _dibDC, &origin, 0, &blend, ULW_ALPHA);
+		}
+		::ReleaseDC(NULL, screenDC);
+	}
+	else
+	{
+		// only the opacity changes, the window keeps its pixels
+		ok = UpdateLayeredWindow(GetHWND(), NULL, NULL, NULL, NULL, NULL, 0, &blend, ULW_ALPHA);
+	}
+
+	if (!ok)
+		LOG_WARNING("%s: UpdateLayeredWindow failed, error %u", GetName(), (unsigned)GetLastError());
+}
+
+OverlayImage const & OverlayWindow::getImage(wxBitmap const & bitmap)
+{
+	std::map<wxBitmap const *, OverlayImage>::iterator found = _images.find(&bitmap);
+	if (found != _images.end())
+		return found->second;
+
+	OverlayImage & image = _images[&bitmap];
+	ConvertBitmap(bitmap, image);
+	return image;
+}
+
+// White text on black, taken from the layouts of the other windows when they have it
+void OverlayWindow::rasterize(OverlayText & text)
+{
+	int width = text.box.GetWidth();
+	int height = text.box.GetHeight();
+	text.coverage.assign((size_t)width * height, 0);
+	text.rendered = text.text;
+	if (width <= 0 || height <= 0)
+		return;
+
+	wxString font = text.font.GetNativeFontInfoDesc();
+	for (size_t i = 0; i < textLayouts.size(); ++i)
+	{
+		TextLayout const & layout = textLayouts[i];
+		if (layout.size == text.box.GetSize() && layout.text == text.text && layout.font == font)
+		{
+			text.coverage = layout.coverage;
+			return;
+		}
+	}
+
+	wxBitmap canvas(width, height, 24);
+	{
+		wxMemoryDC dc(canvas);
+		dc.SetBackground(*wxBLACK_BRUSH);
+		dc.Clear();
+		dc.SetFont(text.font);
+		dc.SetTextForeground(*wxWHITE);
+
+		wxArrayString lines;
+		wrapText(dc, text.text, width, lines);
+		int y = 0;
+		for (size_t i = 0; i < lines.size(); ++i)
+		{
+			dc.DrawText(lines[i], (width - dc.GetTextExtent(lines[i]).GetWidth()) / 2, y);
+			y += dc.GetCharHeight();
+		}
+	}
+
+	readCoverage(canvas, text.coverage);
+
+	if (textLayouts.size() == MAX_TEXT_LAYOUTS)
+		textLayouts.pop_front();
+	textLayouts.push_back(TextLayout());
+	textLayouts.back().text = text.text;
+	textLayouts.back().font = font;
+	textLayouts.back().size = text.box.GetSize();
+	textLayouts.back().coverage = text.coverage;
+}
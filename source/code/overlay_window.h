@@ -0,0 +1,78 @@
+#ifndef OVERLAY_WINDOW_H
+#define OVERLAY_WINDOW_H
+
+#include "wx/wx.h"
+#include "wx/stopwatch.h"
+#include "overlay_compositor.h"
+#include <map>
+
+// Text block of an overlay, its glyph coverage is rasterized again only when the text changes
+struct OverlayText
+{
+	wxString text;
+	wxFont font;
+	wxColour colour;
+	wxRect box; // lines are wrapped to its width and centered
+
+	wxString rendered;
+	std::vector<uint8_t> coverage;
+};
+
+// Countdown of an overlay, drawn from the digit glyphs of its font without any layout
+struct OverlayNumber
+{
+	int value; // nothing is drawn while it is negative
+	wxFont font;
+	wxColour colour;
+	wxRect box; // the digits are centered in its first line
+
+	OverlayNumber() : value(-1) {}
+};
+
+// Premultiplied copy of a bitmap, a bitmap without alpha is opaque unless it has a mask
+void ConvertBitmap(wxBitmap const & bitmap, OverlayImage & image);
+
+// A popup drawn by OverlayCompositor and presented as a single per-pixel-alpha
+// layered window, instead of a faded frame with a colour-keyed frame of controls on top
+class OverlayWindow : public wxFrame
+{
+public:
+	OverlayWindow();
+	virtual ~OverlayWindow();
+
+protected:
+	void InitOverlay(wxPoint const & position, wxSize const & size);
+
+	// Only the dirty rectangle is rendered and presented again, all of the frame when it is empty
+	void BeginFrame(wxRect const & dirty = wxRect());
+	// Fills the window shape of a skin
+	void DrawShape(wxBitmap const * skin, wxColour const & colour, int alpha);
+	void DrawBitmap(wxBitmap const & bitmap, wxPoint const & position);
+	void DrawSprite(OverlayImage const & atlas, wxRect const & source, wxPoint const & position);
+	void DrawText(OverlayText & text);
+	void DrawNumber(OverlayNumber const & number);
+	void Present();
+
+	// Opacity of the whole window, doesn't render the frame again
+	void SetOverlayAlpha(int alpha);
+
+private:
+	OverlayImage const & getImage(wxBitmap const & bitmap);
+	void rasterize(OverlayText & text);
+	void updateLayeredWindow(bool withPixels, RECT const * dirty);
+
+	OverlayCompositor _compositor;
+	std::map<wxBitmap const *, OverlayImage> _images;
+
+	HBITMAP _dib;
+	HDC _dibDC;
+	HGDIOBJ _oldDibBitmap;
+	void * _dibPixels;
+	wxRect _dirty;
+
+	int _overlayAlpha;
+	bool _presented;
+	wxStopWatch _frameTimer;
+};
+
+#endif
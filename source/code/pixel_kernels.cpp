@@ -0,0 +1,672 @@
+#include "pixel_kernels.h"
+#include <string.h>
+#include <vector>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+	#define PIXEL_KERNELS_X86
+	#include <immintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h>
+		#define TARGET_SSE2
+		#define TARGET_AVX2
+	#else
+		#define TARGET_SSE2 __attribute__((target("sse2")))
+		#define TARGET_AVX2 __attribute__((target("avx2")))
+	#endif
+#endif
+
+namespace pixelkernels
+{
+	namespace
+	{
+		// round(c * a / 255) for c, a in [0, 255] without a division
+		inline uint32_t mulDiv255(uint32_t c, uint32_t a)
+		{
+			uint32_t t = c * a + 128;
+			return (t + (t >> 8)) >> 8;
+		}
+
+		inline void spanPixel(uint32_t pixel, size_t x, uint16_t * bounds, size_t & count, bool & inside)
+		{
+			bool opaque = (pixel >> 24) != 0;
+			if (opaque != inside)
+			{
+				bounds[count++] = (uint16_t)x;
+				inside = opaque;
+			}
+		}
+
+		// Blur divides by the window size as ((sum + n / 2) * mul) >> 16, which stays in 16 bits
+		inline uint32_t blurMultiplier(int radius)
+		{
+			uint32_t n = 2 * radius + 1;
+			return (65536 + n - 1) / n;
+		}
+
+		///////////////////////////////////////////////////////////////////////////////////////
+		// scalar
+
+		void premultiplyScalar(uint32_t * pixels, size_t count)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				uint32_t pixel = pixels[i];
+				uint32_t a = pixel >> 24;
+				pixels[i] = (a << 24) |
+					(mulDiv255((pixel >> 16) & 0xFF, a) << 16) |
+					(mulDiv255((pixel >> 8) & 0xFF, a) << 8) |
+					mulDiv255(pixel & 0xFF, a);
+			}
+		}
+
+		void scaleAlphaScalar(uint32_t * dst, const uint32_t * src, size_t count, unsigned int alpha)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				uint32_t pixel = src[i];
+				dst[i] = (mulDiv255(pixel >> 24, alpha) << 24) |
+					(mulDiv255((pixel >> 16) & 0xFF, alpha) << 16) |
+					(mulDiv255((pixel >> 8) & 0xFF, alpha) << 8) |
+					mulDiv255(pixel & 0xFF, alpha);
+			}
+		}
+
+		inline uint32_t addSaturated(uint32_t a, uint32_t b)
+		{
+			uint32_t sum = a + b;
+			return sum < 255 ? sum : 255;
+		}
+
+		void blendOverScalar(uint32_t * dst, const uint32_t * src, size_t count)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				uint32_t s = src[i];
+				uint32_t inv = 255 - (s >> 24);
+				if (inv == 0)
+				{
+					dst[i] = s;
+					continue;
+				}
+				if (s == 0)
+					continue;
+
+				uint32_t d = dst[i];
+				dst[i] = (addSaturated(s >> 24, mulDiv255(d >> 24, inv)) << 24) |
+					(addSaturated((s >> 16) & 0xFF, mulDiv255((d >> 16) & 0xFF, inv)) << 16) |
+					(addSaturated((s >> 8) & 0xFF, mulDiv255((d >> 8) & 0xFF, inv)) << 8) |
+					addSaturated(s & 0xFF, mulDiv255(d & 0xFF, inv));
+			}
+		}
+
+		void blendMaskScalar(uint32_t * dst, const uint8_t * coverage, size_t count, uint32_t color)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				uint32_t c = coverage[i];
+				if (c == 0)
+					continue;
+
+				uint32_t s = (mulDiv255(color >> 24, c) << 24) |
+					(mulDiv255((color >> 16) & 0xFF, c) << 16) |
+					(mulDiv255((color >> 8) & 0xFF, c) << 8) |
+					mulDiv255(color & 0xFF, c);
+				blendOverScalar(dst + i, &s, 1);
+			}
+		}
+
+		void colorKeyToAlphaScalar(uint32_t * pixels, size_t count, uint32_t key)
+		{
+			key &= 0x00FFFFFF;
+			for (size_t i = 0; i < count; ++i)
+				pixels[i] = (pixels[i] & 0x00FFFFFF) == key ? 0 : pixels[i] | 0xFF000000;
+		}
+
+		size_t findSpansScalar(const uint32_t * row, size_t width, uint16_t * bounds)
+		{
+			size_t count = 0;
+			bool inside = false;
+			for (size_t x = 0; x < width; ++x)
+				spanPixel(row[x], x, bounds, count, inside);
+			if (inside)
+				bounds[count++] = (uint16_t)width;
+			return count / 2;
+		}
+
+		// Vertical blur of the bytes [first, last) of every row
+		void blurColumnsScalar(const uint8_t * src, uint8_t * dst, int first, int last, int height, int stride, int radius)
+		{
+			uint32_t half = radius;
+			uint32_t mul = blurMultiplier(radius);
+			for (int x = first; x < last; ++x)
+			{
+				uint32_t sum = (radius + 1) * src[x];
+				for (int k = 1; k <= radius; ++k)
+					sum += src[(k < height ? k : height - 1) * stride + x];
+
+				for (int y = 0; y < height; ++y)
+				{
+					uint32_t value = ((sum + half) * mul) >> 16;
+					dst[y * stride + x] = (uint8_t)(value < 255 ? value : 255);
+
+					int add = y + radius + 1;
+					int sub = y - radius;
+					sum += src[(add < height ? add : height - 1) * stride + x];
+					sum -= src[(sub > 0 ? sub : 0) * stride + x];
+				}
+			}
+		}
+
+#ifdef PIXEL_KERNELS_X86
+		///////////////////////////////////////////////////////////////////////////////////////
+		// SSE2
+
+		TARGET_SSE2 inline __m128i mulDiv255Sse2(__m128i c, __m128i a)
+		{
+			__m128i t = _mm_add_epi16(_mm_mullo_epi16(c, a), _mm_set1_epi16(128));
+			return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+		}
+
+		TARGET_SSE2 void premultiplySse2(uint32_t * pixels, size_t count)
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i alphaMask = _mm_set1_epi32((int)0xFF000000);
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128i v = _mm_loadu_si128((const __m128i *)(pixels + i));
+				__m128i lo = _mm_unpacklo_epi8(v, zero);
+				__m128i hi = _mm_unpackhi_epi8(v, zero);
+				__m128i alo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, 0xFF), 0xFF);
+				__m128i ahi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, 0xFF), 0xFF);
+				__m128i result = _mm_packus_epi16(mulDiv255Sse2(lo, alo), mulDiv255Sse2(hi, ahi));
+				result = _mm_or_si128(_mm_andnot_si128(alphaMask, result), _mm_and_si128(alphaMask, v));
+				_mm_storeu_si128((__m128i *)(pixels + i), result);
+			}
+			premultiplyScalar(pixels + i, count - i);
+		}
+
+		TARGET_SSE2 void scaleAlphaSse2(uint32_t * dst, const uint32_t * src, size_t count, unsigned int alpha)
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i factor = _mm_set1_epi16((short)alpha);
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+				__m128i lo = mulDiv255Sse2(_mm_unpacklo_epi8(v, zero), factor);
+				__m128i hi = mulDiv255Sse2(_mm_unpackhi_epi8(v, zero), factor);
+				_mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(lo, hi));
+			}
+			scaleAlphaScalar(dst + i, src + i, count - i, alpha);
+		}
+
+		TARGET_SSE2 void blendOverSse2(uint32_t * dst, const uint32_t * src, size_t count)
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i full = _mm_set1_epi16(255);
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+				__m128i d = _mm_loadu_si128((const __m128i *)(dst + i));
+				__m128i slo = _mm_unpacklo_epi8(s, zero);
+				__m128i shi = _mm_unpackhi_epi8(s, zero);
+				__m128i invlo = _mm_sub_epi16(full, _mm_shufflehi_epi16(_mm_shufflelo_epi16(slo, 0xFF), 0xFF));
+				__m128i invhi = _mm_sub_epi16(full, _mm_shufflehi_epi16(_mm_shufflelo_epi16(shi, 0xFF), 0xFF));
+				__m128i dlo = mulDiv255Sse2(_mm_unpacklo_epi8(d, zero), invlo);
+				__m128i dhi = mulDiv255Sse2(_mm_unpackhi_epi8(d, zero), invhi);
+				_mm_storeu_si128((__m128i *)(dst + i), _mm_adds_epu8(s, _mm_packus_epi16(dlo, dhi)));
+			}
+			blendOverScalar(dst + i, src + i, count - i);
+		}
+
+		TARGET_SSE2 void blendMaskSse2(uint32_t * dst, const uint8_t * coverage, size_t count, uint32_t color)
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i full = _mm_set1_epi16(255);
+			const __m128i colorWide = _mm_unpacklo_epi8(_mm_set1_epi32((int)color), zero);
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				int32_t mask;
+				memcpy(&mask, coverage + i, sizeof(mask));
+				if (mask == 0)
+					continue;
+
+				// every coverage byte over the 4 channels of its pixel
+				__m128i c = _mm_cvtsi32_si128(mask);
+				c = _mm_unpacklo_epi8(c, c);
+				c = _mm_unpacklo_epi16(c, c);
+				__m128i slo = mulDiv255Sse2(colorWide, _mm_unpacklo_epi8(c, zero));
+				__m128i shi = mulDiv255Sse2(colorWide, _mm_unpackhi_epi8(c, zero));
+
+				__m128i d = _mm_loadu_si128((const __m128i *)(dst + i));
+				__m128i invlo = _mm_sub_epi16(full, _mm_shufflehi_epi16(_mm_shufflelo_epi16(slo, 0xFF), 0xFF));
+				__m128i invhi = _mm_sub_epi16(full, _mm_shufflehi_epi16(_mm_shufflelo_epi16(shi, 0xFF), 0xFF));
+				__m128i dlo = mulDiv255Sse2(_mm_unpacklo_epi8(d, zero), invlo);
+				__m128i dhi = mulDiv255Sse2(_mm_unpackhi_epi8(d, zero), invhi);
+				_mm_storeu_si128((__m128i *)(dst + i), _mm_adds_epu8(_mm_packus_epi16(slo, shi), _mm_packus_epi16(dlo, dhi)));
+			}
+			blendMaskScalar(dst + i, coverage + i, count - i, color);
+		}
+
+		TARGET_SSE2 void colorKeyToAlphaSse2(uint32_t * pixels, size_t count, uint32_t key)
+		{
+			const __m128i alphaMask = _mm_set1_epi32((int)0xFF000000);
+			const __m128i keyOpaque = _mm_set1_epi32((int)(key | 0xFF000000));
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				__m128i v = _mm_or_si128(_mm_loadu_si128((const __m128i *)(pixels + i)), alphaMask);
+				__m128i keyed = _mm_cmpeq_epi32(v, keyOpaque);
+				_mm_storeu_si128((__m128i *)(pixels + i), _mm_andnot_si128(keyed, v));
+			}
+			colorKeyToAlphaScalar(pixels + i, count - i, key);
+		}
+
+		// Blocks of pixels that don't change the state are skipped at once
+		TARGET_SSE2 size_t findSpansSse2(const uint32_t * row, size_t width, uint16_t * bounds)
+		{
+			const __m128i zero = _mm_setzero_si128();
+			size_t count = 0;
+			bool inside = false;
+			size_t x = 0;
+			for (; x + 4 <= width; x += 4)
+			{
+				__m128i alpha = _mm_srli_epi32(_mm_loadu_si128((const __m128i *)(row + x)), 24);
+				int transparent = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(alpha, zero)));
+				if (transparent == (inside ? 0 : 0xF))
+					continue;
+				for (size_t i = x; i < x + 4; ++i)
+					spanPixel(row[i], i, bounds, count, inside);
+			}
+			for (; x < width; ++x)
+				spanPixel(row[x], x, bounds, count, inside);
+			if (inside)
+				bounds[count++] = (uint16_t)width;
+			return count / 2;
+		}
+
+		TARGET_SSE2 void blurColumnsSse2(const uint8_t * src, uint8_t * dst, int first, int last, int height, int stride, int radius)
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i half = _mm_set1_epi16((short)radius);
+			const __m128i mul = _mm_set1_epi16((short)blurMultiplier(radius));
+			const __m128i edge = _mm_set1_epi16((short)(radius + 1));
+
+			int x = first;
+			for (; x + 8 <= last; x += 8)
+			{
+				#define LOAD_ROW(y) _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(src + (y) * stride + x)), zero)
+
+				// sums wrap around in 16 bits, what is added is subtracted later
+				__m128i sum = _mm_mullo_epi16(LOAD_ROW(0), edge);
+				for (int k = 1; k <= radius; ++k)
+					sum = _mm_add_epi16(sum, LOAD_ROW(k < height ? k : height - 1));
+
+				for (int y = 0; y < height; ++y)
+				{
+					__m128i value = _mm_mulhi_epu16(_mm_add_epi16(sum, half), mul);
+					_mm_storel_epi64((__m128i *)(dst + y * stride + x), _mm_packus_epi16(value, value));
+
+					int add = y + radius + 1;
+					int sub = y - radius;
+					sum = _mm_add_epi16(sum, LOAD_ROW(add < height ? add : height - 1));
+					sum = _mm_sub_epi16(sum, LOAD_ROW(sub > 0 ? sub : 0));
+				}
+
+				#undef LOAD_ROW
+			}
+			blurColumnsScalar(src, dst, x, last, height, stride, radius);
+		}
+
+		///////////////////////////////////////////////////////////////////////////////////////
+		// AVX2
+
+		TARGET_AVX2 inline __m256i mulDiv255Avx2(__m256i c, __m256i a)
+		{
+			__m256i t = _mm256_add_epi16(_mm256_mullo_epi16(c, a), _mm256_set1_epi16(128));
+			return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+		}
+
+		// unpack and pack work within 128-bit lanes, so the pixel order survives the round trip
+		TARGET_AVX2 void premultiplyAvx2(uint32_t * pixels, size_t count)
+		{
+			const __m256i zero = _mm256_setzero_si256();
+			const __m256i alphaMask = _mm256_set1_epi32((int)0xFF000000);
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				__m256i v = _mm256_loadu_si256((const __m256i *)(pixels + i));
+				__m256i lo = _mm256_unpacklo_epi8(v, zero);
+				__m256i hi = _mm256_unpackhi_epi8(v, zero);
+				__m256i alo = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(lo, 0xFF), 0xFF);
+				__m256i ahi = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(hi, 0xFF), 0xFF);
+				__m256i result = _mm256_packus_epi16(mulDiv255Avx2(lo, alo), mulDiv255Avx2(hi, ahi));
+				result = _mm256_or_si256(_mm256_andnot_si256(alphaMask, result), _mm256_and_si256(alphaMask, v));
+				_mm256_storeu_si256((__m256i *)(pixels + i), result);
+			}
+			premultiplySse2(pixels + i, count - i);
+		}
+
+		TARGET_AVX2 void scaleAlphaAvx2(uint32_t * dst, const uint32_t * src, size_t count, unsigned int alpha)
+		{
+			const __m256i zero = _mm256_setzero_si256();
+			const __m256i factor = _mm256_set1_epi16((short)alpha);
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				__m256i v = _mm256_loadu_si256((const __m256i *)(src + i));
+				__m256i lo = mulDiv255Avx2(_mm256_unpacklo_epi8(v, zero), factor);
+				__m256i hi = mulDiv255Avx2(_mm256_unpackhi_epi8(v, zero), factor);
+				_mm256_storeu_si256((__m256i *)(dst + i), _mm256_packus_epi16(lo, hi));
+			}
+			scaleAlphaSse2(dst + i, src + i, count - i, alpha);
+		}
+
+		TARGET_AVX2 void blendOverAvx2(uint32_t * dst, const uint32_t * src, size_t count)
+		{
+			const __m256i zero = _mm256_setzero_si256();
+			const __m256i full = _mm256_set1_epi16(255);
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				__m256i s = _mm256_loadu_si256((const __m256i *)(src + i));
+				__m256i d = _mm256_loadu_si256((const __m256i *)(dst + i));
+				__m256i slo = _mm256_unpacklo_epi8(s, zero);
+				__m256i shi = _mm256_unpackhi_epi8(s, zero);
+				__m256i invlo = _mm256_sub_epi16(full, _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(slo, 0xFF), 0xFF));
+				__m256i invhi = _mm256_sub_epi16(full, _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(shi, 0xFF), 0xFF));
+				__m256i dlo = mulDiv255Avx2(_mm256_unpacklo_epi8(d, zero), invlo);
+				__m256i dhi = mulDiv255Avx2(_mm256_unpackhi_epi8(d, zero), invhi);
+				_mm256_storeu_si256((__m256i *)(dst + i), _mm256_adds_epu8(s, _mm256_packus_epi16(dlo, dhi)));
+			}
+			blendOverSse2(dst + i, src + i, count - i);
+		}
+
+		TARGET_AVX2 void blendMaskAvx2(uint32_t * dst, const uint8_t * coverage, size_t count, uint32_t color)
+		{
+			const __m256i zero = _mm256_setzero_si256();
+			const __m256i full = _mm256_set1_epi16(255);
+			const __m256i colorWide = _mm256_unpacklo_epi8(_mm256_set1_epi32((int)color), zero);
+			// coverage bytes 0-3 to the pixels of the low lane, 4-7 to the high one
+			const __m256i spread = _mm256_setr_epi8(
+				0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+				4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7);
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				uint64_t mask;
+				memcpy(&mask, coverage + i, sizeof(mask));
+				if (mask == 0)
+					continue;
+
+				__m128i bytes = _mm_loadl_epi64((const __m128i *)(coverage + i));
+				__m256i c = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(bytes), spread);
+				__m256i slo = mulDiv255Avx2(colorWide, _mm256_unpacklo_epi8(c, zero));
+				__m256i shi = mulDiv255Avx2(colorWide, _mm256_unpackhi_epi8(c, zero));
+
+				__m256i d = _mm256_loadu_si256((const __m256i *)(dst + i));
+				__m256i invlo = _mm256_sub_epi16(full, _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(slo, 0xFF), 0xFF));
+				__m256i invhi = _mm256_sub_epi16(full, _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(shi, 0xFF), 0xFF));
+				__m256i dlo = mulDiv255Avx2(_mm256_unpacklo_epi8(d, zero), invlo);
+				__m256i dhi = mulDiv255Avx2(_mm256_unpackhi_epi8(d, zero), invhi);
+				_mm256_storeu_si256((__m256i *)(dst + i), _mm256_adds_epu8(_mm256_packus_epi16(slo, shi), _mm256_packus_epi16(dlo, dhi)));
+			}
+			blendMaskSse2(dst + i, coverage + i, count - i, color);
+		}
+
+		TARGET_AVX2 void colorKeyToAlphaAvx2(uint32_t * pixels, size_t count, uint32_t key)
+		{
+			const __m256i alphaMask = _mm256_set1_epi32((int)0xFF000000);
+			const __m256i keyOpaque = _mm256_set1_epi32((int)(key | 0xFF000000));
+			size_t i = 0;
+			for (; i + 8 <= count; i += 8)
+			{
+				__m256i v = _mm256_or_si256(_mm256_loadu_si256((const __m256i *)(pixels + i)), alphaMask);
+				__m256i keyed = _mm256_cmpeq_epi32(v, keyOpaque);
+				_mm256_storeu_si256((__m256i *)(pixels + i), _mm256_andnot_si256(keyed, v));
+			}
+			colorKeyToAlphaSse2(pixels + i, count - i, key);
+		}
+
+		TARGET_AVX2 size_t findSpansAvx2(const uint32_t * row, size_t width, uint16_t * bounds)
+		{
+			const __m256i zero = _mm256_setzero_si256();
+			size_t count = 0;
+			bool inside = false;
+			size_t x = 0;
+			for (; x + 8 <= width; x += 8)
+			{
+				__m256i alpha = _mm256_srli_epi32(_mm256_loadu_si256((const __m256i *)(row + x)), 24);
+				int transparent = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(alpha, zero)));
+				if (transparent == (inside ? 0 : 0xFF))
+					continue;
+				for (size_t i = x; i < x + 8; ++i)
+					spanPixel(row[i], i, bounds, count, inside);
+			}
+			for (; x < width; ++x)
+				spanPixel(row[x], x, bounds, count, inside);
+			if (inside)
+				bounds[count++] = (uint16_t)width;
+			return count / 2;
+		}
+
+		TARGET_AVX2 void blurColumnsAvx2(const uint8_t * src, uint8_t * dst, int first, int last, int height, int stride, int radius)
+		{
+			const __m256i half = _mm256_set1_epi16((short)radius);
+			const __m256i mul = _mm256_set1_epi16((short)blurMultiplier(radius));
+			const __m256i edge = _mm256_set1_epi16((short)(radius + 1));
+
+			int x = first;
+			for (; x + 16 <= last; x += 16)
+			{
+				#define LOAD_ROW(y) _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(src + (y) * stride + x)))
+
+				__m256i sum = _mm256_mullo_epi16(LOAD_ROW(0), edge);
+				for (int k = 1; k <= radius; ++k)
+					sum = _mm256_add_epi16(sum, LOAD_ROW(k < height ? k : height - 1));
+
+				for (int y = 0; y < height; ++y)
+				{
+					__m256i value = _mm256_mulhi_epu16(_mm256_add_epi16(sum, half), mul);
+					__m128i packed = _mm_packus_epi16(_mm256_castsi256_si128(value), _mm256_extracti128_si256(value, 1));
+					_mm_storeu_si128((__m128i *)(dst + y * stride + x), packed);
+
+					int add = y + radius + 1;
+					int sub = y - radius;
+					sum = _mm256_add_epi16(sum, LOAD_ROW(add < height ? add : height - 1));
+					sum = _mm256_sub_epi16(sum, LOAD_ROW(sub > 0 ? sub : 0));
+				}
+
+				#undef LOAD_ROW
+			}
+			blurColumnsSse2(src, dst, x, last, height, stride, radius);
+		}
+
+		///////////////////////////////////////////////////////////////////////////////////////
+		// dispatch
+
+		bool cpuHasSse2()
+		{
+	#if defined(_M_X64) || defined(__x86_64__)
+			return true;
+	#elif defined(_MSC_VER)
+			int info[4];
+			__cpuid(info, 1);
+			return (info[3] & (1 << 26)) != 0;
+	#else
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("sse2") != 0;
+	#endif
+		}
+
+		bool cpuHasAvx2()
+		{
+	#ifdef _MSC_VER
+			int info[4];
+			__cpuid(info, 0);
+			if (info[0] < 7)
+				return false;
+
+			// the OS must save the YMM registers as well
+			__cpuid(info, 1);
+			bool osxsave = (info[2] & (1 << 27)) != 0;
+			bool avx = (info[2] & (1 << 28)) != 0;
+			if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+				return false;
+
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) != 0;
+	#else
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2") != 0;
+	#endif
+		}
+#endif
+
+		EInstructionSet detectInstructionSet()
+		{
+#ifdef PIXEL_KERNELS_X86
+			if (cpuHasAvx2())
+				return ISA_AVX2;
+			if (cpuHasSse2())
+				return ISA_SSE2;
+#endif
+			return ISA_SCALAR;
+		}
+
+		struct Kernels
+		{
+			void (*premultiply)(uint32_t *, size_t);
+			void (*scaleAlpha)(uint32_t *, const uint32_t *, size_t, unsigned int);
+			void (*blendOver)(uint32_t *, const uint32_t *, size_t);
+			void (*blendMask)(uint32_t *, const uint8_t *, size_t, uint32_t);
+			void (*colorKeyToAlpha)(uint32_t *, size_t, uint32_t);
+			size_t (*findSpans)(const uint32_t *, size_t, uint16_t *);
+			void (*blurColumns)(const uint8_t *, uint8_t *, int, int, int, int, int);
+		};
+
+		const Kernels kernelSets[] = {
+			{ premultiplyScalar, scaleAlphaScalar, blendOverScalar, blendMaskScalar, colorKeyToAlphaScalar, findSpansScalar, blurColumnsScalar },
+#ifdef PIXEL_KERNELS_X86
+			{ premultiplySse2, scaleAlphaSse2, blendOverSse2, blendMaskSse2, colorKeyToAlphaSse2, findSpansSse2, blurColumnsSse2 },
+			{ premultiplyAvx2, scaleAlphaAvx2, blendOverAvx2, blendMaskAvx2, colorKeyToAlphaAvx2, findSpansAvx2, blurColumnsAvx2 },
+#endif
+		};
+
+		const EInstructionSet supportedSet = detectInstructionSet();
+		EInstructionSet currentSet = supportedSet;
+
+		inline Kernels const & kernels()
+		{
+			return kernelSets[currentSet];
+		}
+	}
+
+	void Premultiply(uint32_t * pixels, size_t count)
+	{
+		kernels().premultiply(pixels, count);
+	}
+
+	void ScaleAlpha(uint32_t * dst, const uint32_t * src, size_t count, unsigned int alpha)
+	{
+		if (alpha >= 255)
+		{
+			if (dst != src)
+				memcpy(dst, src, count * sizeof(uint32_t));
+			return;
+		}
+		kernels().scaleAlpha(dst, src, count, alpha);
+	}
+
+	void BlendOver(uint32_t * dst, const uint32_t * src, size_t count)
+	{
+		kernels().blendOver(dst, src, count);
+	}
+
+	void BlendMask(uint32_t * dst, const uint8_t * coverage, size_t count, uint32_t color)
+	{
+		kernels().blendMask(dst, coverage, count, color);
+	}
+
+	void ColorKeyToAlpha(uint32_t * pixels, size_t count, uint32_t key)
+	{
+		kernels().colorKeyToAlpha(pixels, count, key);
+	}
+
+	size_t FindSpans(const uint32_t * row, size_t width, uint16_t * bounds)
+	{
+		return kernels().findSpans(row, width, bounds);
+	}
+
+	// Vertical passes only: the horizontal one runs over the transposed image,
+	// so every pass walks whole rows with vectors
+	void BoxBlur(uint32_t * pixels, int width, int height, int radius)
+	{
+		if (radius > MAX_BLUR_RADIUS)
+			radius = MAX_BLUR_RADIUS;
+		if (radius <= 0 || width <= 0 || height <= 0)
+			return;
+
+		std::vector<uint32_t> blurred((size_t)width * height);
+		std::vector<uint32_t> transposed((size_t)width * height);
+
+		BlurColumns(pixels, &blurred[0], width, height, 0, width, radius);
+		Transpose(&blurred[0], &transposed[0], width, height, 0, height);
+		BlurColumns(&transposed[0], &blurred[0], height, width, 0, height, radius);
+		Transpose(&blurred[0], pixels, height, width, 0, width);
+	}
+
+	void BlurColumns(const uint32_t * src, uint32_t * dst, int width, int height, int first, int last, int radius)
+	{
+		if (radius > MAX_BLUR_RADIUS)
+			radius = MAX_BLUR_RADIUS;
+		if (radius <= 0)
+		{
+			for (int y = 0; y < height; ++y)
+				memcpy(dst + (size_t)y * width + first, src + (size_t)y * width + first, (last - first) * sizeof(uint32_t));
+			return;
+		}
+		kernels().blurColumns((const uint8_t *)src, (uint8_t *)dst, first * 4, last * 4, height, width * 4, radius);
+	}
+
+	// In blocks, so the columns written stay in the cache
+	void Transpose(const uint32_t * src, uint32_t * dst, int width, int height, int first, int last)
+	{
+		const int BLOCK = 16;
+		for (int blockY = first; blockY < last; blockY += BLOCK)
+		{
+			int endY = blockY + BLOCK < last ? blockY + BLOCK : last;
+			for (int blockX = 0; blockX < width; blockX += BLOCK)
+			{
+				int endX = blockX + BLOCK < width ? blockX + BLOCK : width;
+				for (int y = blockY; y < endY; ++y)
+				{
+					for (int x = blockX; x < endX; ++x)
+						dst[(size_t)x * height + y] = src[(size_t)y * width + x];
+				}
+			}
+		}
+	}
+
+	EInstructionSet GetInstructionSet()
+	{
+		return currentSet;
+	}
+
+	const char * GetInstructionSetName()
+	{
+		static const char * names[] = { "scalar", "SSE2", "AVX2" };
+		return names[currentSet];
+	}
+
+	bool UseInstructionSet(EInstructionSet set)
+	{
+		if (set > supportedSet)
+			return false;
+		currentSet = set;
+		return true;
+	}
+}
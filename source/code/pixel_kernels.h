@@ -0,0 +1,56 @@
+#ifndef PIXEL_KERNELS_H
+#define PIXEL_KERNELS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Per-pixel loops of the overlay windows. Every kernel has a scalar version and
+// SSE2/AVX2 versions picked at runtime by the CPU, all of them give the same bits.
+// Pixels are 32-bit BGRA in memory (0xAARRGGBB), as in a Windows DIB.
+namespace pixelkernels
+{
+	enum EInstructionSet
+	{
+		ISA_SCALAR,
+		ISA_SSE2,
+		ISA_AVX2
+	};
+
+	const int MAX_BLUR_RADIUS = 127;
+
+	// Straight alpha to premultiplied, in place
+	void Premultiply(uint32_t * pixels, size_t count);
+
+	// Premultiplied pixels times alpha / 255, e.g. for a fade. dst may be src.
+	void ScaleAlpha(uint32_t * dst, const uint32_t * src, size_t count, unsigned int alpha);
+
+	// Premultiplied src over dst, in place in dst
+	void BlendOver(uint32_t * dst, const uint32_t * src, size_t count);
+
+	// Premultiplied color times the 8-bit coverage of each pixel over dst, e.g. for glyphs.
+	// The same as ScaleAlpha and BlendOver pixel by pixel.
+	void BlendMask(uint32_t * dst, const uint8_t * coverage, size_t count, uint32_t color);
+
+	// Pixels of the key colour (alpha is ignored) become transparent, the rest opaque
+	void ColorKeyToAlpha(uint32_t * pixels, size_t count, uint32_t key);
+
+	// Runs of pixels with non-zero alpha: writes x0, x1 (exclusive) of each run to bounds
+	// and returns the number of runs. bounds must hold width + 1 values.
+	size_t FindSpans(const uint32_t * row, size_t width, uint16_t * bounds);
+
+	// Box blur of every channel, in place. Pixels beyond the edges repeat the edge.
+	void BoxBlur(uint32_t * pixels, int width, int height, int radius);
+
+	// The passes of BoxBlur, for callers that split an image between threads.
+	// BlurColumns blurs the columns [first, last) of src vertically into dst,
+	// Transpose writes the rows [first, last) of src as the columns of dst.
+	void BlurColumns(const uint32_t * src, uint32_t * dst, int width, int height, int first, int last, int radius);
+	void Transpose(const uint32_t * src, uint32_t * dst, int width, int height, int first, int last);
+
+	EInstructionSet GetInstructionSet();
+	const char * GetInstructionSetName();
+	// Limits the kernels to a lower set, false if the CPU doesn't support it
+	bool UseInstructionSet(EInstructionSet set);
+}
+
+#endif
@@ -0,0 +1,172 @@
+#include "plural_rules.h"
+#include <wchar.h>
+#include <wctype.h>
+
+namespace
+{
+	class Parser
+	{
+	public:
+		Parser(const wchar_t * text) : _pos(text) {}
+
+		bool AtEnd()
+		{
+			SkipSpaces();
+			return *_pos == 0;
+		}
+
+		bool Accept(const wchar_t * token)
+		{
+			SkipSpaces();
+			size_t length = wcslen(token);
+			if (wcsncmp(_pos, token, length) != 0)
+				return false;
+			// keywords must not run into a longer word
+			if (iswalpha(token[0]) && iswalnum(_pos[length]))
+				return false;
+			_pos += length;
+			return true;
+		}
+
+		bool Number(uint32_t & value)
+		{
+			SkipSpaces();
+			if (!iswdigit(*_pos))
+				return false;
+			value = 0;
+			while (iswdigit(*_pos))
+			{
+				value = value * 10 + (*_pos - L'0');
+				if (value > 1000000)
+					return false;
+				++_pos;
+			}
+			return true;
+		}
+
+	private:
+		void SkipSpaces()
+		{
+			while (iswspace(*_pos))
+				++_pos;
+		}
+
+		const wchar_t * _pos;
+	};
+}
+
+PluralRules::PluralRules()
+{
+	for (int i = 0; i < PLURAL_OTHER; ++i)
+		_rules[i].count = 0;
+}
+
+bool PluralRules::SetRule(EPluralCategory category, const wchar_t * text)
+{
+	if (category >= PLURAL_OTHER)
+		return false;
+
+	Rule & rule = _rules[category];
+	rule.count = 0;
+
+	Parser parser(text);
+	if (parser.AtEnd())
+		return true;
+
+	bool orBefore = true;
+	for (;;)
+	{
+		if (rule.count == MAX_RELATIONS || !parser.Accept(L"n"))
+			break;
+
+		Relation & relation = rule.relations[rule.count];
+		relation.orBefore = orBefore;
+		relation.modulo = 0;
+		relation.rangeCount = 0;
+
+		if (parser.Accept(L"%") && (!parser.Number(relation.modulo) || relation.modulo == 0))
+			break;
+
+		if (parser.Accept(L"!="))
+			relation.negate = true;
+		else if (parser.Accept(L"="))
+			relation.negate = false;
+		else
+			break;
+
+		bool valid = true;
+		do
+		{
+			uint32_t from = 0;
+			if (relation.rangeCount == MAX_RANGES || !parser.Number(from))
+			{
+				valid = false;
+				break;
+			}
+			uint32_t to = from;
+			if (parser.Accept(L"..") && (!parser.Number(to) || to < from))
+			{
+				valid = false;
+				break;
+			}
+			relation.from[relation.rangeCount] = from;
+			relation.to[relation.rangeCount] = to;
+			relation.rangeCount++;
+		}
+		while (parser.Accept(L","));
+
+		if (!valid)
+			break;
+
+		rule.count++;
+
+		if (parser.AtEnd())
+			return true;
+
+		if (parser.Accept(L"and"))
+			orBefore = false;
+		else if (parser.Accept(L"or"))
+			orBefore = true;
+		else
+			break;
+	}
+
+	rule.count = 0;
+	return false;
+}
+
+bool PluralRules::Matches(Rule const & rule, unsigned int n)
+{
+	// "and" binds tighter than "or": the rule matches when any chain matches entirely
+	bool chain = false;
+	for (int i = 0; i < rule.count; ++i)
+	{
+		Relation const & relation = rule.relations[i];
+		if (relation.orBefore)
+		{
+			if (i > 0 && chain)
+				return true;
+			chain = true;
+		}
+		if (!chain)
+			continue;
+
+		uint32_t value = relation.modulo ? n % relation.modulo : n;
+		bool inRange = false;
+		for (int r = 0; r < relation.rangeCount && !inRange; ++r)
+			inRange = value >= relation.from[r] && value <= relation.to[r];
+
+		chain = inRange != relation.negate;
+	}
+	return rule.count > 0 && chain;
+}
+
+EPluralCategory PluralRules::Select(unsigned int n) const
+{
+	for (int i = 0; i < PLURAL_OTHER; ++i)
+	{
+		if (Matches(_rules[i], n))
+			return (EPluralCategory)i;
+	}
+	return PLURAL_OTHER;
+}
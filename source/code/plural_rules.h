@@ -0,0 +1,56 @@
+#ifndef PLURAL_RULES_H
+#define PLURAL_RULES_H
+
+#include <stdint.h>
+
+enum EPluralCategory
+{
+	PLURAL_ONE,
+	PLURAL_FEW,
+	PLURAL_MANY,
+	PLURAL_OTHER, // whatever no rule matched
+
+	PLURAL_CATEGORY_COUNT
+};
+
+// Plural categories of a language, selected by CLDR rules for integers, e.g.
+// "n % 10 = 2..4 and n % 100 != 12..14". Supported are the n operand, %, = and !=,
+// lists of values and ranges, and, or. Rules are parsed once, selecting doesn't allocate.
+class PluralRules
+{
+public:
+	PluralRules();
+
+	// An empty rule never matches. On a syntax error the rule is dropped and false is returned.
+	bool SetRule(EPluralCategory category, const wchar_t * rule);
+	EPluralCategory Select(unsigned int n) const;
+
+private:
+	enum
+	{
+		MAX_RELATIONS = 8,
+		MAX_RANGES = 4
+	};
+
+	struct Relation
+	{
+		uint32_t modulo; // 0 when there's none
+		uint32_t from[MAX_RANGES];
+		uint32_t to[MAX_RANGES];
+		uint8_t rangeCount;
+		bool negate;
+		bool orBefore; // starts a new "and" chain
+	};
+
+	struct Rule
+	{
+		int count;
+		Relation relations[MAX_RELATIONS];
+	};
+
+	static bool Matches(Rule const & rule, unsigned int n);
+
+	Rule _rules[PLURAL_OTHER];
+};
+
+#endif
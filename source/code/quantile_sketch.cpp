@@ -0,0 +1,126 @@
+#include "quantile_sketch.h"
+#include <math.h>
+#include <string.h>
+
+namespace
+{
+	const double RELATIVE_ACCURACY = 0.02;
+	const double GAMMA = (1.0 + RELATIVE_ACCURACY) / (1.0 - RELATIVE_ACCURACY);
+	const double LOG_GAMMA = log(GAMMA);
+
+	void appendVarint(std::string & out, uint32_t value)
+	{
+		while (value >= 0x80)
+		{
+			out += (char)(value | 0x80);
+			value >>= 7;
+		}
+		out += (char)value;
+	}
+
+	bool readVarint(const unsigned char *& data, const unsigned char * end, uint32_t & value)
+	{
+		value = 0;
+		for (int shift = 0; shift < 35; shift += 7)
+		{
+			if (data >= end)
+				return false;
+			unsigned char byte = *data++;
+			value |= uint32_t(byte & 0x7F) << shift;
+			if (!(byte & 0x80))
+				return true;
+		}
+		return false;
+	}
+}
+
+QuantileSketch::QuantileSketch()
+{
+	Clear();
+}
+
+void QuantileSketch::Clear()
+{
+	_count = 0;
+	memset(_buckets, 0, sizeof(_buckets));
+}
+
+void QuantileSketch::Add(long ms)
+{
+	// bucket i holds values in (GAMMA^(i-1), GAMMA^i]
+	int index = 0;
+	if (ms > 1)
+		index = (int)ceil(log((double)ms) / LOG_GAMMA);
+	if (index >= BUCKET_COUNT)
+		index = BUCKET_COUNT - 1;
+
+	_buckets[index]++;
+	_count++;
+}
+
+void QuantileSketch::Merge(QuantileSketch const & other)
+{
+	for (int i = 0; i < BUCKET_COUNT; ++i)
+		_buckets[i] += other._buckets[i];
+	_count += other._count;
+}
+
+long QuantileSketch::GetQuantile(float q) const
+{
+	if (_count == 0)
+		return 0;
+
+	double rank = q * (_count - 1);
+	uint32_t seen = 0;
+	for (int i = 0; i < BUCKET_COUNT; ++i)
+	{
+		seen += _buckets[i];
+		if (seen > rank)
+			return (long)(2.0 * pow(GAMMA, i) / (GAMMA + 1.0) + 0.5);
+	}
+	return (long)(2.0 * pow(GAMMA, BUCKET_COUNT - 1) / (GAMMA + 1.0) + 0.5);
+}
+
+void QuantileSketch::Encode(std::string & out) const
+{
+	uint16_t used = 0;
+	for (int i = 0; i < BUCKET_COUNT; ++i)
+		used += _buckets[i] != 0;
+
+	out.append(reinterpret_cast<const char*>(&used), sizeof(used));
+	for (uint16_t i = 0; i < BUCKET_COUNT; ++i)
+	{
+		if (!_buckets[i])
+			continue;
+		out.append(reinterpret_cast<const char*>(&i), sizeof(i));
+		appendVarint(out, _buckets[i]);
+	}
+}
+
+bool QuantileSketch::Decode(const unsigned char *& data, const unsigned char * end)
+{
+	Clear();
+
+	uint16_t used = 0;
+	if (end - data < (long)sizeof(used))
+		return false;
+	memcpy(&used, data, sizeof(used));
+	data += sizeof(used);
+
+	for (uint16_t n = 0; n < used; ++n)
+	{
+		uint16_t index = 0;
+		uint32_t count = 0;
+		if (end - data < (long)sizeof(index))
+			return false;
+		memcpy(&index, data, sizeof(index));
+		data += sizeof(index);
+
+		if (index >= BUCKET_COUNT || !readVarint(data, end, count))
+			return false;
+
+		_buckets[index] += count;
+		_count += count;
+	}
+	return true;
+}
@@ -0,0 +1,37 @@
+#ifndef QUANTILE_SKETCH_H
+#define QUANTILE_SKETCH_H
+
+#include <stdint.h>
+#include <string>
+
+// Approximate distribution of durations in a fixed amount of memory.
+// Values are counted in logarithmic buckets (the DDSketch scheme), so any quantile is
+// reported within 2% of a real value. Adding is O(1) and two sketches merge by adding
+// their buckets, e.g. to combine several days.
+class QuantileSketch
+{
+public:
+	enum
+	{
+		BUCKET_COUNT = 400 // covers 1 ms .. ~2.5 hours, longer values go to the last bucket
+	};
+
+	QuantileSketch();
+
+	void Clear();
+	void Add(long ms);
+	void Merge(QuantileSketch const & other);
+
+	uint32_t GetCount() const { return _count; }
+	long GetQuantile(float q) const; // q in [0, 1]; 0 when empty
+
+	// Only non-empty buckets are stored
+	void Encode(std::string & out) const;
+	bool Decode(const unsigned char *& data, const unsigned char * end);
+
+private:
+	uint32_t _count;
+	uint32_t _buckets[BUCKET_COUNT];
+};
+
+#endif
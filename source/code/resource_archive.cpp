@@ -0,0 +1,176 @@
+#include "resource_archive.h"
+#include "wx/bitmap.h"
+#include "wx/rawbmp.h"
+#include <string.h>
+#include <algorithm>
+
+ResourceArchive::ResourceArchive() :
+	_header(0),
+	_entries(0)
+{
+}
+
+bool ResourceArchive::Open(wxString const & path)
+{
+	Close();
+
+	if (!_file.OpenReadOnly(path))
+		return false;
+
+	const char * data = static_cast<const char*>(_file.GetData());
+	size_t size = _file.GetSize();
+
+	resourceformat::Header const * header = reinterpret_cast<resourceformat::Header const *>(data);
+	if (size < sizeof(*header) || header->magic != resourceformat::kMagic ||
+		header->version != resourceformat::kVersion ||
+		header->names != sizeof(*header) + (size_t)header->entryCount * sizeof(resourceformat::Entry) ||
+		size < (size_t)header->names + header->namesSize ||
+		header->namesSize == 0 || data[header->names + header->namesSize - 1] != 0)
+	{
+		_file.Close();
+		return false;
+	}
+
+	resourceformat::Entry const * entries = reinterpret_cast<resourceformat::Entry const *>(header + 1);
+	for (uint32_t i = 0; i < header->entryCount; ++i)
+	{
+		resourceformat::Entry const & entry = entries[i];
+		if (entry.name < header->names || entry.name >= header->names + header->namesSize ||
+			entry.pixels % resourceformat::PIXEL_ALIGN != 0 ||
+			size < entry.pixels + (size_t)entry.width * entry.height * 4 ||
+			entry.shape % sizeof(uint32_t) != 0 ||
+			size < entry.shape + (size_t)entry.shapeCount * sizeof(resourceformat::Span))
+		{
+			_file.Close();
+			return false;
+		}
+	}
+
+	_header = header;
+	_entries = entries;
+	return true;
+}
+
+void ResourceArchive::Close()
+{
+	_file.Close();
+	_header = 0;
+	_entries = 0;
+}
+
+const char * ResourceArchive::GetName(resourceformat::Entry const & entry) const
+{
+	return static_cast<const char*>(_file.GetData()) + entry.name;
+}
+
+resourceformat::Entry const * ResourceArchive::Find(wxString const & name, int size) const
+{
+	if (!_header)
+		return 0;
+
+	wxString normalized = name;
+	normalized.Replace(L"\\", L"/");
+	wxScopedCharBuffer utf8 = normalized.utf8_str();
+	const char * key = utf8.data();
+
+	resourceformat::Entry const * end = _entries + _header->entryCount;
+	resourceformat::Entry const * it = std::lower_bound(_entries, end, key,
+		[this](resourceformat::Entry const & entry, const char * key) { return strcmp(GetName(entry), key) < 0; });
+
+	for (; it != end && strcmp(GetName(*it), key) == 0; ++it)
+	{
+		if (size <= 0 || it->width == size)
+			return it;
+	}
+	return 0;
+}
+
+static bool copyAlphaPixels(wxBitmap & bitmap, const unsigned char * src)
+{
+	wxAlphaPixelData data(bitmap);
+	if (!data)
+		return false;
+
+	wxAlphaPixelData::Iterator row(data);
+	for (int y = 0; y < data.GetHeight(); ++y)
+	{
+		wxAlphaPixelData::Iterator p = row;
+		for (int x = 0; x < data.GetWidth(); ++x, ++p, src += 4)
+		{
+#ifdef wxHAS_PREMULTIPLIED_ALPHA
+			p.Blue() = src[0];
+			p.Green() = src[1];
+			p.Red() = src[2];
+#else
+			unsigned int a = src[3];
+			p.Blue() = a ? (unsigned char)((src[0] * 255 + a / 2) / a) : 0;
+			p.Green() = a ? (unsigned char)((src[1] * 255 + a / 2) / a) : 0;
+			p.Red() = a ? (unsigned char)((src[2] * 255 + a / 2) / a) : 0;
+#endif
+			p.Alpha() = src[3];
+		}
+		row.OffsetY(data, 1);
+	}
+	return true;
+}
+
+static bool copyOpaquePixels(wxBitmap & bitmap, const unsigned char * src)
+{
+	wxNativePixelData data(bitmap);
+	if (!data)
+		return false;
+
+	wxNativePixelData::Iterator row(data);
+	for (int y = 0; y < data.GetHeight(); ++y)
+	{
+		wxNativePixelData::Iterator p = row;
+		for (int x = 0; x < data.GetWidth(); ++x, ++p, src += 4)
+		{
+			p.Blue() = src[0];
+			p.Green() = src[1];
+			p.Red() = src[2];
+		}
+		row.OffsetY(data, 1);
+	}
+	return true;
+}
+
+bool ResourceArchive::LoadBitmap(wxString const & name, wxBitmap & bitmap, int size) const
+{
+	resourceformat::Entry const * entry = Find(name, size);
+	if (!entry)
+		return false;
+
+	const unsigned char * src = static_cast<const unsigned char*>(_file.GetData()) + entry->pixels;
+
+	// opaque images stay without alpha, as a decoded PNG would
+	bool alpha = (entry->flags & resourceformat::FLAG_ALPHA) != 0;
+	wxBitmap result(entry->width, entry->height, alpha ? 32 : 24);
+	if (alpha)
+	{
+#ifdef __WXMSW__
+		result.UseAlpha();
+#endif
+		if (!copyAlphaPixels(result, src))
+			return false;
+	}
+	else if (!copyOpaquePixels(result, src))
+	{
+		return false;
+	}
+
+	bitmap = result;
+	return true;
+}
+
+bool ResourceArchive::LoadShape(wxString const & name, std::vector<resourceformat::Span> & spans) const
+{
+	resourceformat::Entry const * entry = Find(name, -1);
+	if (!entry)
+		return false;
+
+	resourceformat::Span const * first = reinterpret_cast<resourceformat::Span const *>(
+		static_cast<const char*>(_file.GetData()) + entry->shape);
+	spans.assign(first, first + entry->shapeCount);
+	return true;
+}
@@ -0,0 +1,38 @@
+#ifndef RESOURCE_ARCHIVE_H
+#define RESOURCE_ARCHIVE_H
+
+#include "wx/string.h"
+#include "mapped_file.h"
+#include "resource_format.h"
+#include <vector>
+
+class wxBitmap;
+
+// Images prebaked by tools/resource-packer into resources.pak. The archive is mapped
+// read-only, so every running instance shares its pages, and a bitmap is a copy of
+// ready pixels without any decoding.
+class ResourceArchive
+{
+public:
+	ResourceArchive();
+
+	bool Open(wxString const & path);
+	void Close();
+	bool IsOpened() const { return _header != 0; }
+
+	// name is the path relative to bin/, e.g. "Resources/skin2.png". With size > 0 only an image
+	// exactly that wide is taken, otherwise the first image of the file.
+	bool LoadBitmap(wxString const & name, wxBitmap & bitmap, int size = -1) const;
+	// Shape of the first image of the file, precomputed by the packer
+	bool LoadShape(wxString const & name, std::vector<resourceformat::Span> & spans) const;
+
+private:
+	resourceformat::Entry const * Find(wxString const & name, int size) const;
+	const char * GetName(resourceformat::Entry const & entry) const;
+
+	MappedFile _file;
+	resourceformat::Header const * _header;
+	resourceformat::Entry const * _entries;
+};
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef RESOURCE_FORMAT_H
+#define RESOURCE_FORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// Layout of the image archive (resources.pak). Written by tools/resource-packer and
+// mapped into memory by the application, so keep this header free of wxWidgets.
+//
+//   header
+//   entries[entryCount]: sorted by name; the images of one .ico file follow each other
+//                        in the order of the file
+//   names[namesSize]:    NUL-terminated UTF-8 paths relative to bin/ with '/' separators,
+//                        e.g. "Resources/skin2.png"
+//   shapes:              Span[] of every image, the window shape wxRegion(bitmap, *wxWHITE)
+//                        would give
+//   pixels:              every image starts at a multiple of PIXEL_ALIGN, rows go top-down
+//                        without padding, 4 bytes per pixel: premultiplied B, G, R, A
+// Offsets are in bytes from the start of the file. All values are little-endian.
+
+namespace resourceformat
+{
+	const uint32_t kMagic = 0x53524C45; // "ELRS"
+	const uint16_t kVersion = 2;
+
+	const uint32_t PIXEL_ALIGN = 16;
+
+	const uint16_t FLAG_ALPHA = 1; // the source image had transparency
+
+	struct Header
+	{
+		uint32_t magic;
+		uint16_t version;
+		uint16_t reserved0;
+		uint32_t entryCount;
+		uint32_t names;
+		uint32_t namesSize;
+		uint32_t reserved[3];
+	};
+
+	struct Entry
+	{
+		uint32_t name;
+		uint32_t pixels;
+		uint16_t width;
+		uint16_t height;
+		uint16_t flags;
+		uint16_t reserved;
+		uint32_t shape; // offset of the first Span
+		uint32_t shapeCount;
+	};
+
+	// A run of pixels in one row that belong to the shape, x1 is exclusive.
+	// Spans go by rows top-down and left to right within a row.
+	struct Span
+	{
+		uint16_t y;
+		uint16_t x0;
+		uint16_t x1;
+		uint16_t reserved;
+	};
+
+	static_assert(sizeof(Header) == 32, "resource archive header must stay 32 bytes");
+	static_assert(sizeof(Entry) == 24, "resource archive entries must stay 24 bytes");
+	static_assert(sizeof(Span) == 8, "shape spans must stay 8 bytes");
+
+	// Spans of the pixels that aren't white, rgb as in wxImage
+	inline void FindShapeSpans(const unsigned char * rgb, int width, int height, std::vector<Span> & spans)
+	{
+		spans.clear();
+		for (int y = 0; y < height; ++y)
+		{
+			const unsigned char * row = rgb + (size_t)y * width * 3;
+			int x = 0;
+			while (x < width)
+			{
+				while (x < width && row[x * 3] == 255 && row[x * 3 + 1] == 255 && row[x * 3 + 2] == 255)
+					x++;
+				if (x == width)
+					break;
+
+				Span span = { (uint16_t)y, (uint16_t)x, 0, 0 };
+				while (x < width && !(row[x * 3] == 255 && row[x * 3 + 1] == 255 && row[x * 3 + 2] == 255))
+					x++;
+				span.x1 = (uint16_t)x;
+				spans.push_back(span);
+			}
+		}
+	}
+}
+
+#endif
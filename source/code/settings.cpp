@@ -9,6 +9,15 @@ namespace eyeleo
 		int disableActivityDuration = 60;
 		int disableActivity2Duration = 180;
 
+		int settingsSaveDelay = 2000;
+		int settingsFlushBudget = 1500;
+		int journalInterval = 10000;
+
+		int resourceMemoryBudget = 256;
+		int resourcePrefetchTime = 30000;
+		int resourceReleaseDelay = 10000;
+		int overlayWarmTime = 5000;
+
 		void load()
 		{}
 	}
@@ -9,5 +9,14 @@ namespace eyeleo
 
 		extern int disableActivityDuration;
 		extern int disableActivity2Duration;
+
+		extern int settingsSaveDelay; // ms, changes made within this period are written to settings.xml at once
+		extern int settingsFlushBudget; // ms, how long the exit may wait for settings.xml to be written
+		extern int journalInterval; // ms, how often timers are recorded to the state journal while idle
+
+		extern int resourceMemoryBudget; // KB of break window images kept while no break window is open
+		extern int resourcePrefetchTime; // ms before a break or warning when released images are loaded again
+		extern int resourceReleaseDelay; // ms after the last break window closes before images are released
+		extern int overlayWarmTime; // ms before a break when its hidden windows are created
 	}
 }
\ No newline at end of file
@@ -0,0 +1,251 @@
+#include "settings_store.h"
+#include "pugixml.hpp"
+#include "file_utils.h"
+#include <string>
+
+bool SettingsData::operator==(SettingsData const & other) const
+{
+	return firstLaunch == other.firstLaunch &&
+		seenSettings == other.seenSettings &&
+		bigPauseEnabled == other.bigPauseEnabled &&
+		bigPauseInterval == other.bigPauseInterval &&
+		bigPauseDuration == other.bigPauseDuration &&
+		miniPauseEnabled == other.miniPauseEnabled &&
+		miniPauseInterval == other.miniPauseInterval &&
+		miniPauseDuration == other.miniPauseDuration &&
+		warningEnabled == other.warningEnabled &&
+		warningInterval == other.warningInterval &&
+		soundsEnabled == other.soundsEnabled &&
+		strictModeEnabled == other.strictModeEnabled &&
+		windowNearby == other.windowNearby &&
+		inactivityTracking == other.inactivityTracking &&
+		canCloseNotifications == other.canCloseNotifications &&
+		blurredBackground == other.blurredBackground;
+}
+
+namespace
+{
+	struct BufferWriter : pugi::xml_writer
+	{
+		std::string data;
+
+		virtual void write(const void * buffer, size_t size)
+		{
+			data.append(static_cast<const char*>(buffer), size);
+		}
+	};
+
+	void serialize(SettingsData const & data, std::string & out)
+	{
+		pugi::xml_document doc;
+		pugi::xml_node node = doc.append_child(pugi::node_element);
+		node.set_name(L"settings");
+
+		pugi::xml_node nodeStatistics = node.append_child(pugi::node_element);
+		nodeStatistics.set_name(L"statistics");
+		nodeStatistics.append_attribute(L"first_launch") = data.firstLaunch;
+		nodeStatistics.append_attribute(L"seen_settings") = data.seenSettings;
+
+		pugi::xml_node nodeBigPause = node.append_child(pugi::node_element);
+		nodeBigPause.set_name(L"big_pause");
+		nodeBigPause.append_attribute(L"enabled") = data.bigPauseEnabled;
+		nodeBigPause.append_attribute(L"interval") = data.bigPauseInterval;
+		nodeBigPause.append_attribute(L"duration") = data.bigPauseDuration;
+
+		pugi::xml_node nodeMiniPause = node.append_child(pugi::node_element);
+		nodeMiniPause.set_name(L"mini_pause");
+		nodeMiniPause.append_attribute(L"enabled") = data.miniPauseEnabled;
+		nodeMiniPause.append_attribute(L"interval") = data.miniPauseInterval;
+		nodeMiniPause.append_attribute(L"duration") = data.miniPauseDuration;
+
+		pugi::xml_node nodeWarning = node.append_child(pugi::node_element);
+		nodeWarning.set_name(L"warning");
+		nodeWarning.append_attribute(L"enabled") = data.warningEnabled;
+		nodeWarning.append_attribute(L"interval") = data.warningInterval;
+
+		pugi::xml_node nodeSounds = node.append_child(pugi::node_element);
+		nodeSounds.set_name(L"sounds");
+		nodeSounds.append_attribute(L"enabled") = data.soundsEnabled;
+
+		pugi::xml_node nodeStrictMode = node.append_child(pugi::node_element);
+		nodeStrictMode.set_name(L"strict_mode");
+		nodeStrictMode.append_attribute(L"enabled") = data.strictModeEnabled;
+
+		pugi::xml_node nodeWindowNearby = node.append_child(pugi::node_element);
+		nodeWindowNearby.set_name(L"window_nearby");
+		nodeWindowNearby.append_attribute(L"enabled") = data.windowNearby;
+
+		pugi::xml_node nodeInactivityTracking = node.append_child(pugi::node_element);
+		nodeInactivityTracking.set_name(L"inactivity_tracking");
+		nodeInactivityTracking.append_attribute(L"enabled") = data.inactivityTracking;
+
+		pugi::xml_node nodeCanCloseNotifications = node.append_child(pugi::node_element);
+		nodeCanCloseNotifications.set_name(L"can_close_notifications");
+		nodeCanCloseNotifications.append_attribute(L"enabled") = data.canCloseNotifications;
+
+		pugi::xml_node nodeBlurredBackground = node.append_child(pugi::node_element);
+		nodeBlurredBackground.set_name(L"blurred_background");
+		nodeBlurredBackground.append_attribute(L"enabled") = data.blurredBackground;
+
+		BufferWriter writer;
+		doc.save(writer, L"\t", pugi::format_default, pugi::encoding_utf8);
+		out.swap(writer.data);
+	}
+}
+
+SettingsStore::SettingsStore(wxString const & path, int debounceMs) :
+	wxThread(wxTHREAD_JOINABLE),
+	_path(path),
+	_debounceMs(debounceMs),
+	_wakeUp(_mutex),
+	_written(_mutex),
+	_hasLastWritten(false),
+	_dirty(false),
+	_flushRequested(false),
+	_exitRequested(false),
+	_finished(false),
+	_writeFailed(false),
+	_deadline(0),
+	_pendingGeneration(0),
+	_writtenGeneration(0)
+{
+	Create();
+}
+
+SettingsStore::~SettingsStore()
+{
+}
+
+void SettingsStore::Save(SettingsData const & data)
+{
+	wxMutexLocker lock(_mutex);
+
+	if (_dirty ? data == _pending : (_hasLastWritten && data == _lastWritten))
+		return;
+
+	_pending = data;
+	_pendingGeneration++;
+
+	// the deadline is set by the first change only, so a stream of saves can't postpone the write forever
+	if (!_dirty)
+	{
+		_dirty = true;
+		_deadline = ::wxGetLocalTimeMillis() + _debounceMs;
+		_wakeUp.Signal();
+	}
+}
+
+bool SettingsStore::Flush(int budgetMs)
+{
+	unsigned int generation;
+	{
+		wxMutexLocker lock(_mutex);
+		if (_writtenGeneration == _pendingGeneration)
+			return !_writeFailed;
+
+		// otherwise the data is either waiting for the deadline or being written right now
+		generation = _pendingGeneration;
+		_flushRequested = true;
+		_wakeUp.Signal();
+	}
+
+	return WaitWritten(generation, budgetMs);
+}
+
+bool SettingsStore::Shutdown(int budgetMs)
+{
+	wxMilliClock_t start = ::wxGetLocalTimeMillis();
+
+	bool finished = false;
+	{
+		wxMutexLocker lock(_mutex);
+		_exitRequested = true;
+		_wakeUp.Signal();
+
+		while (!_finished)
+		{
+			long left = budgetMs - (::wxGetLocalTimeMillis() - start).ToLong();
+			if (left <= 0)
+				break;
+			_written.WaitTimeout(left);
+		}
+		finished = _finished;
+	}
+
+	// a write stuck on a slow disk can't hold up the exit, the process is going away anyway
+	if (!finished)
+		return false;
+
+	Wait();
+	delete this;
+	return true;
+}
+
+bool SettingsStore::WaitWritten(unsigned int generation, int budgetMs)
+{
+	wxMilliClock_t start = ::wxGetLocalTimeMillis();
+
+	wxMutexLocker lock(_mutex);
+	while (_writtenGeneration < generation)
+	{
+		long left = budgetMs - (::wxGetLocalTimeMillis() - start).ToLong();
+		if (left <= 0 || _finished)
+			break;
+		_written.WaitTimeout(left);
+	}
+	return _writtenGeneration >= generation && !_writeFailed;
+}
+
+bool SettingsStore::Write(SettingsData const & data)
+{
+	std::string content;
+	serialize(data, content);
+	return writeFileAtomically(_path, content.data(), content.size());
+}
+
+wxThread::ExitCode SettingsStore::Entry()
+{
+	_mutex.Lock();
+
+	while (true)
+	{
+		if (!_dirty)
+		{
+			if (_exitRequested)
+				break;
+			_wakeUp.Wait();
+			continue;
+		}
+
+		long wait = (_deadline - ::wxGetLocalTimeMillis()).ToLong();
+		if (wait > 0 && !_flushRequested && !_exitRequested)
+		{
+			_wakeUp.WaitTimeout(wait);
+			continue;
+		}
+
+		SettingsData data = _pending;
+		unsigned int generation = _pendingGeneration;
+		_dirty = false;
+		_flushRequested = false;
+		_lastWritten = data;
+		_hasLastWritten = true;
+
+		_mutex.Unlock();
+		bool ok = Write(data);
+		_mutex.Lock();
+
+		// a failed write is retried with the next save, the old file stays in place meanwhile
+		_writeFailed = !ok;
+		if (!ok)
+			_hasLastWritten = false;
+		_writtenGeneration = generation;
+		_written.Broadcast();
+	}
+
+	_finished = true;
+	_written.Broadcast();
+	_mutex.Unlock();
+
+	return 0;
+}
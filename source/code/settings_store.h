@@ -0,0 +1,81 @@
+#ifndef SETTINGS_STORE_H
+#define SETTINGS_STORE_H
+
+#include "wx/string.h"
+#include "wx/thread.h"
+#include "wx/stopwatch.h"
+
+// Configuration EyeApp keeps in settings.xml. Timers and statistics go to the StateJournal.
+struct SettingsData
+{
+	bool firstLaunch;
+	bool seenSettings;
+
+	// settings
+	bool bigPauseEnabled;
+	int bigPauseInterval;
+	int bigPauseDuration;
+	bool miniPauseEnabled;
+	int miniPauseInterval;
+	int miniPauseDuration;
+	bool warningEnabled;
+	float warningInterval;
+	bool soundsEnabled;
+	bool strictModeEnabled;
+	bool windowNearby;
+	bool inactivityTracking;
+	bool canCloseNotifications;
+	bool blurredBackground;
+
+	bool operator==(SettingsData const & other) const;
+	bool operator!=(SettingsData const & other) const { return !(*this == other); }
+};
+
+// Writes settings.xml on a background thread, so saving never blocks the GUI thread.
+// Saves requested within the debounce window are coalesced into a single write, and a save
+// of unchanged data is skipped. The file is written to a temporary file and renamed over
+// the old one, so a crash in the middle of a write leaves the previous version intact.
+class SettingsStore : public wxThread
+{
+public:
+	SettingsStore(wxString const & path, int debounceMs = 2000);
+	virtual ~SettingsStore();
+
+	void Save(SettingsData const & data);
+
+	// Writes pending data right away, waits for it at most budgetMs. Returns true when the data is on disk.
+	bool Flush(int budgetMs);
+
+	// Flushes and stops the thread. The store must not be used afterwards;
+	// returns false if the thread didn't finish in time and the object was left to the OS.
+	bool Shutdown(int budgetMs);
+
+protected:
+	virtual wxThread::ExitCode Entry();
+
+private:
+	bool Write(SettingsData const & data);
+	bool WaitWritten(unsigned int generation, int budgetMs);
+
+	wxString _path;
+	int _debounceMs;
+
+	wxMutex _mutex;
+	wxCondition _wakeUp;
+	wxCondition _written;
+
+	SettingsData _pending;
+	SettingsData _lastWritten;
+	bool _hasLastWritten;
+	bool _dirty;
+	bool _flushRequested;
+	bool _exitRequested;
+	bool _finished;
+	bool _writeFailed;
+	wxMilliClock_t _deadline;
+
+	unsigned int _pendingGeneration;
+	unsigned int _writtenGeneration;
+};
+
+#endif
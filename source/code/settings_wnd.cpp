@@ -3,6 +3,10 @@
 #include "pugixml.hpp"
 #include "main.h"
 #include "language_set.h"
+#include "stats_store.h"
+#include "adherence_stats.h"
+#include "timeloc.h"
+#include "image_resources.h"
 
 ///////////////////////////////////////////////////////////////////////////////////////
 
@@ -31,15 +35,15 @@ END_EVENT_TABLE()
 
 SettingsWindow::SettingsWindow(const wxString& title) :
 	wxFrame(NULL, -1, title, wxDefaultPosition, wxDefaultSize, wxSYSTEM_MENU | wxCAPTION | wxCLOSE_BOX | wxCLIP_CHILDREN),
-	_iconSettings(L"Resources/settings.ico", wxBITMAP_TYPE_ICO),
-	_iconInformation(L"Resources/information.ico", wxBITMAP_TYPE_ICO),
-	_iconLongBreak(L"Resources/long_break.ico", wxBITMAP_TYPE_ICO, 16, 16),
-	_iconShortBreak(L"Resources/short_break.ico", wxBITMAP_TYPE_ICO, 16, 16),
-	_iconSound(L"Resources/sound.ico", wxBITMAP_TYPE_ICO, 16, 16),
-	_iconStrictMode(L"Resources/strict_mode.ico", wxBITMAP_TYPE_ICO, 16, 16),
-	_iconWarning(L"Resources/notification.ico", wxBITMAP_TYPE_ICO, 16, 16),
-	_iconCanCloseNotifs(L"Resources/can-close-notifs.png", wxBITMAP_TYPE_PNG, 16, 16),
-	_iconWindow(L"Resources/window.png", wxBITMAP_TYPE_PNG, 16, 16),
+	_iconSettings(LoadIconResource(L"Resources/settings.ico", wxBITMAP_TYPE_ICO)),
+	_iconInformation(LoadIconResource(L"Resources/information.ico", wxBITMAP_TYPE_ICO)),
+	_iconLongBreak(LoadIconResource(L"Resources/long_break.ico", wxBITMAP_TYPE_ICO, 16)),
+	_iconShortBreak(LoadIconResource(L"Resources/short_break.ico", wxBITMAP_TYPE_ICO, 16)),
+	_iconSound(LoadIconResource(L"Resources/sound.ico", wxBITMAP_TYPE_ICO, 16)),
+	_iconStrictMode(LoadIconResource(L"Resources/strict_mode.ico", wxBITMAP_TYPE_ICO, 16)),
+	_iconWarning(LoadIconResource(L"Resources/notification.ico", wxBITMAP_TYPE_ICO, 16)),
+	_iconCanCloseNotifs(LoadIconResource(L"Resources/can-close-notifs.png", wxBITMAP_TYPE_PNG, 16)),
+	_iconWindow(LoadIconResource(L"Resources/window.png", wxBITMAP_TYPE_PNG, 16)),
 	_notebookImgList(16, 16, true, 2)
 {
 	if (!SettingsWindow::inited)
@@ -64,7 +68,7 @@ SettingsWindow::SettingsWindow(const wxString& title) :
 
 	SetInitialSize(wxSize(580, 420));
 
-	SetIcon(wxIcon(L"Resources/icon.ico", wxBITMAP_TYPE_ICO, 16, 16));
+	SetIcon(LoadIconResource(L"Resources/icon.ico", wxBITMAP_TYPE_ICO, 16));
 
 	_notebook = new wxNotebook(this, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxBK_DEFAULT);
 	
@@ -74,22 +78,22 @@ SettingsWindow::SettingsWindow(const wxString& title) :
 	// PAGE SETTINGS
 	wxBoxSizer * sizerSettings = new wxBoxSizer(wxVERTICAL);
 	
-    wxStaticBoxSizer * sizerPanel = new wxStaticBoxSizer(wxVERTICAL, pageSettings, langPack->Get("settings_general_panel_label"));
+    wxStaticBoxSizer * sizerPanel = new wxStaticBoxSizer(wxVERTICAL, pageSettings, langPack->Get(StrId::settings_general_panel_label));
 	
 	wxBoxSizer * sizerBigPauses = new wxBoxSizer(wxHORIZONTAL);
 	
 	wxStaticBitmap * imgIcon;
 	imgIcon = new wxStaticBitmap(pageSettings, wxID_ANY, _iconLongBreak);
-	_chkBigPauses = new wxCheckBox(pageSettings, ID_SETTINGS_CHK_BIG_PAUSES, langPack->Get("settings_big_pause_label_1"), wxDefaultPosition, wxDefaultSize, wxCHK_2STATE, wxDefaultValidator, _("chkBigPauses"));
+	_chkBigPauses = new wxCheckBox(pageSettings, ID_SETTINGS_CHK_BIG_PAUSES, langPack->Get(StrId::settings_big_pause_label_1), wxDefaultPosition, wxDefaultSize, wxCHK_2STATE, wxDefaultValidator, _("chkBigPauses"));
 	_selBigPauseInterval = new wxComboBox(pageSettings, ID_SETTINGS_SEL_BIG_PAUSE_INTERVAL, wxEmptyString, wxDefaultPosition, wxDefaultSize, sizeof(bigPauseIntervalChoices) / sizeof(bigPauseIntervalChoices[0]), bigPauseIntervalChoices, wxCB_DROPDOWN | wxCB_READONLY, wxDefaultValidator, _("selBigPauseInterval"));
-	wxStaticText * txtBigPauseDuration = new wxStaticText(pageSettings, wxID_ANY, langPack->Get("settings_big_pause_label_2"));
+	wxStaticText * txtBigPauseDuration = new wxStaticText(pageSettings, wxID_ANY, langPack->Get(StrId::settings_big_pause_label_2));
 	_selBigPauseDuration = new wxComboBox(pageSettings, ID_SETTINGS_SEL_BIG_PAUSE_INTERVAL, wxEmptyString, wxDefaultPosition, wxDefaultSize, sizeof(bigPauseDurationChoices) / sizeof(bigPauseDurationChoices[0]), bigPauseDurationChoices, wxCB_DROPDOWN | wxCB_READONLY, wxDefaultValidator, _("selBigPauseDuration"));
 	
-	wxToolTip * tooltip1_0 = new wxToolTip(langPack->Get("settings_big_pause_tooltip"));
+	wxToolTip * tooltip1_0 = new wxToolTip(langPack->Get(StrId::settings_big_pause_tooltip));
 	tooltip1_0->SetDelay(800);
-	wxToolTip * tooltip1_1 = new wxToolTip(langPack->Get("settings_big_pause_tooltip"));
+	wxToolTip * tooltip1_1 = new wxToolTip(langPack->Get(StrId::settings_big_pause_tooltip));
 	tooltip1_1->SetDelay(800);
-	wxToolTip * tooltip1_2 = new wxToolTip(langPack->Get("settings_big_pause_tooltip"));
+	wxToolTip * tooltip1_2 = new wxToolTip(langPack->Get(StrId::settings_big_pause_tooltip));
 	tooltip1_2->SetDelay(800);
 	_selBigPauseInterval->SetToolTip(tooltip1_0);
 	_selBigPauseDuration->SetToolTip(tooltip1_1);
@@ -106,7 +110,7 @@ SettingsWindow::SettingsWindow(const wxString& title) :
 	
 	imgIcon = new wxStaticBitmap(pageSettings, wxID_ANY, _iconWarning);
 	wxBoxSizer * sizerWarnPauses = new wxBoxSizer(wxHORIZONTAL);
-	_chkWarnPauses = new wxCheckBox(pageSettings, ID_SETTINGS_CHK_WARN_ABOUT_PAUSES, langPack->Get("settings_big_pause_warning_label"), wxDefaultPosition, wxDefaultSize, wxCHK_2STATE, wxDefaultValidator, _("chkWarnPauses"));
+	_chkWarnPauses = new wxCheckBox(pageSettings, ID_SETTINGS_CHK_WARN_ABOUT_PAUSES, langPack->Get(StrId::settings_big_pause_warning_label), wxDefaultPosition, wxDefaultSize, wxCHK_2STATE, wxDefaultValidator, _("chkWarnPauses"));
 	
 	_selWarnPauseDelays = new wxComboBox(pageSettings, ID_SETTINGS_SEL_WARN_BEFORE_TIME, wxEmptyString, wxDefaultPosition, wxDefaultSize, sizeof(bigWarnDelayChoices) / sizeof(bigWarnDelayChoices[0]), bigWarnDelayChoices, wxCB_DROPDOWN | wxCB_READONLY, wxDefaultValidator, _("selBigPauseInterval"));
 	sizerWarnPauses->Add(imgIcon, wxSizerFlags().Center());
@@ -114,18 +118,18 @@ SettingsWindow::SettingsWindow(const wxString& title) :
 	sizerWarnPauses->Add(_chkWarnPauses, wxSizerFlags().Center().Border(wxALL, 3));
 	sizerWarnPauses->Add(_selWarnPauseDelays, wxSizerFlags().Center());
 	
-	wxToolTip * tooltip4_0 = new wxToolTip(langPack->Get("settings_big_pause_warning_tooltip"));
+	wxToolTip * tooltip4_0 = new wxToolTip(langPack->Get(StrId::settings_big_pause_warning_tooltip));
 	tooltip4_0->SetDelay(800);
-	wxToolTip * tooltip4_1 = new wxToolTip(langPack->Get("settings_big_pause_warning_tooltip"));
+	wxToolTip * tooltip4_1 = new wxToolTip(langPack->Get(StrId::settings_big_pause_warning_tooltip));
 	tooltip4_1->SetDelay(800);
 	_selWarnPauseDelays->SetToolTip(tooltip4_0);
 	_chkWarnPauses->SetToolTip(tooltip4_1);
 	
 	imgIcon = new wxStaticBitmap(pageSettings, wxID_ANY, _iconShortBreak);
 	wxBoxSizer * sizerMiniPauses = new wxBoxSizer(wxHORIZONTAL);
-	_chkMiniPauses = new wxCheckBox(pageSettings, ID_SETTINGS_CHK_MINI_PAUSES, langPack->Get("settings_mini_pause_label"), wxDefaultPosition, wxDefaultSize, wxCHK_2STATE, wxDefaultValidator, _("chkMiniPauses"));
+	_chkMiniPauses = new wxCheckBox(pageSettings, ID_SETTINGS_CHK_MINI_PAUSES, langPack->Get(StrId::settings_mini_pause_label), wxDefaultPosition, wxDefaultSize, wxCHK_2STATE, wxDefaultValidator, _("chkMiniPauses"));
 	_selMiniPauseInterval = new wxComboBox(pageSettings, ID_SETTINGS_SEL_MINI_PAUSE_INTERVAL, wxEmptyString, wxDefaultPosition, wxDefaultSize, sizeof(miniPauseIntervalChoices) / sizeof(miniPauseIntervalChoices[0]), miniPauseIntervalChoices, wxCB_DROPDOWN | wxCB_READONLY, wxDefaultValidator, _("selBigPauseInterval"));
-	wxStaticText * txtMiniPauseDuration = new wxStaticText(pageSettings, wxID_ANY, langPack->Get("settings_big_pause_label_2"));
+	wxStaticText * txtMiniPauseDuration = new wxStaticText(pageSettings, wxID_ANY, langPack->Get(StrId::settings_big_pause_label_2));
 	_selMiniPauseDuration = new wxComboBox(pageSettings, ID_SETTINGS_SEL_MINI_PAUSE_DURATION, wxEmptyString, wxDefaultPosition, wxDefaultSize, sizeof(miniPauseDurationChoices) / sizeof(miniPauseDurationChoices[0]), miniPauseDurationChoices, wxCB_DROPDOWN | wxCB_READONLY, wxDefaultValidator, _("selBigPauseDuration"));
 
 	sizerMiniPauses->Add(imgIcon, wxSizerFlags().Center());
@@ -137,16 +141,16 @@ SettingsWindow::SettingsWindow(const wxString& title) :
 	sizerMiniPauses->AddSpacer(6);
 	sizerMiniPauses->Add(_selMiniPauseDuration, wxSizerFlags().Center());
 	
-	wxToolTip * tooltip2_0 = new wxToolTip(langPack->Get("settings_mini_pause_tooltip"));
+	wxToolTip * tooltip2_0 = new wxToolTip(langPack->Get(StrId::settings_mini_pause_tooltip));
 	tooltip2_0->SetDelay(800);
-	wxToolTip * tooltip2_1 = new wxToolTip(langPack->Get("settings_mini_pause_tooltip"));
+	wxToolTip * tooltip2_1 = new wxToolTip(langPack->Get(StrId::settings_mini_pause_tooltip));
 	tooltip2_1->SetDelay(800);
 	_selMiniPauseInterval->SetToolTip(tooltip2_0);
 	_chkMiniPauses->SetToolTip(tooltip2_1);
 	
 	imgIcon = new wxStaticBitmap(pageSettings, wxID_ANY, _iconSound);
 	wxBoxSizer * sizerEnableSounds = new wxBoxSizer(wxHORIZONTAL);
-	_chkEnableSounds = new wxCheckBox(pageSettings, ID_SETTINGS_CHK_ENABLE_SOUNDS, langPack->Get("settings_enable_sounds_label"), wxDefaultPosition, wxDefaultSize, wxCHK_2STATE, wxDefaultValidator, _("chkEnableSounds"));
+	_chkEnableSounds = new wxCheckBox(pageSettings, ID_SETTINGS_CHK_ENABLE_SOUNDS, langPack->Get(StrId::settings_enable_sounds_label), wxDefaultPosition, wxDefaultSize, wxCHK_2STATE, wxDefaultValidator, _("chkEnableSounds"));
 
 	sizerEnableSounds->Add(imgIcon, wxSizerFlags().Center());
 	sizerEnableSounds->AddSpacer(3);
@@ -155,13 +159,13 @@ SettingsWindow::SettingsWindow(const wxString& title) :
 	//
 	imgIcon = new wxStaticBitmap(pageSettings, wxID_ANY, _iconStrictMode);
 	wxBoxSizer * sizerEnableStrictMode = new wxBoxSizer(wxHORIZONTAL);
-	_chkEnableStrictMode = new wxCheckBox(pageSettings, ID_SETTINGS_CHK_ENABLE_STRICT_MODE, langPack->Get("settings_enable_strict_mode_label"), wxDefaultPosition, wxDefaultSize, wxCHK_2STATE, wxDefaultValidator, _("chkEnableStrictMode"));
+	_chkEnableStrictMode = new wxCheckBox(pageSettings, ID_SETTINGS_CHK_ENABLE_STRICT_MODE, langPack->Get(StrId::settings_enable_strict_mode_label), wxDefaultPosition, wxDefaultSize, wxCHK_2STATE, wxDefaultValidator, _("chkEnableStrictMode"));
 
 	sizerEnableStrictMode->Add(imgIcon, wxSizerFlags().Center());
 	sizerEnableStrictMode->AddSpacer(3);
 	sizerEnableStrictMode->Add(_chkEnableStrictMode, wxSizerFlags().Center().Border(wxALL, 3));
 	
-	wxToolTip * tooltip3 = new wxToolTip(langPack->Get("settings_enable_strict_mode_tooltip"));
+	wxToolTip * tooltip3 = new wxToolTip(langPack->Get(StrId::settings_enable_strict_mode_tooltip));
 	tooltip3->SetDelay(800);
 	_chkEnableStrictMode->SetToolTip(tooltip3);
 	
@@ -169,19 +173,19 @@ SettingsWindow::SettingsWindow(const wxString& title) :
 	//
 	imgIcon = new wxStaticBitmap(pageSettings, wxID_ANY, _iconCanCloseNotifs);
 	wxBoxSizer * sizerCanCloseNotifications = new wxBoxSizer(wxHORIZONTAL);
-	_chkCanCloseNotifications = new wxCheckBox(pageSettings, ID_SETTINGS_CHK_CAN_CLOSE_NOTIFICATIONS, langPack->Get("settings_can_close_notifications_label"), wxDefaultPosition, wxDefaultSize, wxCHK_2STATE, wxDefaultValidator, _("chkCanCloseNotifications"));
+	_chkCanCloseNotifications = new wxCheckBox(pageSettings, ID_SETTINGS_CHK_CAN_CLOSE_NOTIFICATIONS, langPack->Get(StrId::settings_can_close_notifications_label), wxDefaultPosition, wxDefaultSize, wxCHK_2STATE, wxDefaultValidator, _("chkCanCloseNotifications"));
 
 	sizerCanCloseNotifications->Add(imgIcon, wxSizerFlags().Center());
 	sizerCanCloseNotifications->AddSpacer(3);
 	sizerCanCloseNotifications->Add(_chkCanCloseNotifications, wxSizerFlags().Center().Border(wxALL, 3));
 
-	wxToolTip * tooltip4 = new wxToolTip(langPack->Get("settings_can_close_notifications_tooltip"));
+	wxToolTip * tooltip4 = new wxToolTip(langPack->Get(StrId::settings_can_close_notifications_tooltip));
 	tooltip4->SetDelay(800);
 	_chkCanCloseNotifications->SetToolTip(tooltip4);
 
 	//
-	wxButton * btnTryShortBreak = new wxButton(pageSettings, ID_SETTINGS_BTN_TRY_SHORT_BREAK, langPack->Get("settings_try_short_break_button"));
-	wxButton * btnTryLongBreak = new wxButton(pageSettings, ID_SETTINGS_BTN_TRY_LONG_BREAK, langPack->Get("settings_try_long_break_button"));
+	wxButton * btnTryShortBreak = new wxButton(pageSettings, ID_SETTINGS_BTN_TRY_SHORT_BREAK, langPack->Get(StrId::settings_try_short_break_button));
+	wxButton * btnTryLongBreak = new wxButton(pageSettings, ID_SETTINGS_BTN_TRY_LONG_BREAK, langPack->Get(StrId::settings_try_long_break_button));
 	wxBoxSizer * sizerTryButtons = new wxBoxSizer(wxHORIZONTAL);
 	sizerTryButtons->Add(btnTryShortBreak);
 	sizerTryButtons->AddSpacer(2);
@@ -189,30 +193,43 @@ SettingsWindow::SettingsWindow(const wxString& title) :
 	
 	//
 	imgIcon = new wxStaticBitmap(pageSettings, wxID_ANY, _iconWindow);
-	_chkWindowNearby = new wxCheckBox(pageSettings, ID_SETTINGS_CHK_WINDOW_NEARBY, langPack->Get("settings_have_window_nearby"), wxDefaultPosition, wxDefaultSize, wxCHK_2STATE, wxDefaultValidator, _("chkWindowNearby"));
+	_chkWindowNearby = new wxCheckBox(pageSettings, ID_SETTINGS_CHK_WINDOW_NEARBY, langPack->Get(StrId::settings_have_window_nearby), wxDefaultPosition, wxDefaultSize, wxCHK_2STATE, wxDefaultValidator, _("chkWindowNearby"));
 	wxBoxSizer * sizerWindowNearby = new wxBoxSizer(wxHORIZONTAL);
 
 	sizerWindowNearby->Add(imgIcon, wxSizerFlags().Center());
 	sizerWindowNearby->AddSpacer(3);
 	sizerWindowNearby->Add(_chkWindowNearby, wxSizerFlags().Center().Border(wxALL, 3));
 
-	wxToolTip * tooltip5 = new wxToolTip(langPack->Get("settings_have_window_nearby_tooltip"));
+	wxToolTip * tooltip5 = new wxToolTip(langPack->Get(StrId::settings_have_window_nearby_tooltip));
 	tooltip5->SetDelay(800);
 	_chkWindowNearby->SetToolTip(tooltip5);
 
 	//
 	imgIcon = new wxStaticBitmap(pageSettings, wxID_ANY, _iconWindow);
-	_chkInactivityTracking = new wxCheckBox(pageSettings, ID_SETTINGS_CHK_ENABLE_INACTIVITY_TRACKING, langPack->Get("settings_can_enable_inactivity_tracking"), wxDefaultPosition, wxDefaultSize, wxCHK_2STATE, wxDefaultValidator, _("chkInactivityTracking"));
+	_chkInactivityTracking = new wxCheckBox(pageSettings, ID_SETTINGS_CHK_ENABLE_INACTIVITY_TRACKING, langPack->Get(StrId::settings_can_enable_inactivity_tracking), wxDefaultPosition, wxDefaultSize, wxCHK_2STATE, wxDefaultValidator, _("chkInactivityTracking"));
 	wxBoxSizer * sizerInactivityTracking = new wxBoxSizer(wxHORIZONTAL);
 
 	sizerInactivityTracking->Add(imgIcon, wxSizerFlags().Center());
 	sizerInactivityTracking->AddSpacer(3);
 	sizerInactivityTracking->Add(_chkInactivityTracking, wxSizerFlags().Center().Border(wxALL, 3));
 
-	wxToolTip * tooltip6 = new wxToolTip(langPack->Get("settings_can_enable_inactivity_tracking_tooltip"));
+	wxToolTip * tooltip6 = new wxToolTip(langPack->Get(StrId::settings_can_enable_inactivity_tracking_tooltip));
 	tooltip6->SetDelay(800);
 	_chkInactivityTracking->SetToolTip(tooltip6);
 
+	//
+	imgIcon = new wxStaticBitmap(pageSettings, wxID_ANY, _iconWindow);
+	_chkBlurredBackground = new wxCheckBox(pageSettings, ID_SETTINGS_CHK_BLURRED_BACKGROUND, langPack->Get(StrId::settings_blurred_background_label), wxDefaultPosition, wxDefaultSize, wxCHK_2STATE, wxDefaultValidator, _("chkBlurredBackground"));
+	wxBoxSizer * sizerBlurredBackground = new wxBoxSizer(wxHORIZONTAL);
+
+	sizerBlurredBackground->Add(imgIcon, wxSizerFlags().Center());
+	sizerBlurredBackground->AddSpacer(3);
+	sizerBlurredBackground->Add(_chkBlurredBackground, wxSizerFlags().Center().Border(wxALL, 3));
+
+	wxToolTip * tooltip7 = new wxToolTip(langPack->Get(StrId::settings_blurred_background_tooltip));
+	tooltip7->SetDelay(800);
+	_chkBlurredBackground->SetToolTip(tooltip7);
+
 	//
     sizerPanel->Add(sizerBigPauses, wxSizerFlags().Left().Border(wxALL, 4));
     sizerPanel->Add(sizerWarnPauses, wxSizerFlags().Left().Border(wxALL, 4));
@@ -225,11 +242,13 @@ SettingsWindow::SettingsWindow(const wxString& title) :
 	sizerPanel->AddSpacer(8);
 	sizerPanel->Add(sizerInactivityTracking, wxSizerFlags().Left().Border(wxLEFT, 4));
 	sizerPanel->AddSpacer(8);
+	sizerPanel->Add(sizerBlurredBackground, wxSizerFlags().Left().Border(wxLEFT, 4));
+	sizerPanel->AddSpacer(8);
 	sizerPanel->Add(sizerTryButtons, wxSizerFlags().Left().Border(wxALL, 4));
 
 	sizerSettings->Add(sizerPanel, wxSizerFlags(1).Expand());
 	
-	wxButton * btnSaveAndQuit = new wxButton(pageSettings, ID_SETTINGS_BTN_SAVE_AND_QUIT, langPack->Get("settings_save_and_close_button"));
+	wxButton * btnSaveAndQuit = new wxButton(pageSettings, ID_SETTINGS_BTN_SAVE_AND_QUIT, langPack->Get(StrId::settings_save_and_close_button));
 	
 	sizerSettings->Add(btnSaveAndQuit, wxSizerFlags().Left().Border(wxALL, 5));
     pageSettings->SetSizer(sizerSettings);
@@ -242,20 +261,27 @@ SettingsWindow::SettingsWindow(const wxString& title) :
 	font.SetPointSize(10);
 	textCtrl->SetFont(font);
 	sizerInformation->Add(textCtrl, wxSizerFlags(1).Border(wxALL, 8).Expand());
+
+	wxStaticText * statsCtrl = new wxStaticText(pageInformation, wxID_ANY, GetStatistics());
+	statsCtrl->SetFont(font);
+	sizerInformation->Add(statsCtrl, wxSizerFlags().Border(wxALL, 8).Expand());
 	
 	wxBoxSizer * sizerInformationButtons = new wxBoxSizer(wxHORIZONTAL);
-	wxButton * btnVisitForum = new wxButton(pageInformation, ID_INFORMATION_BTN_GIVE_FEEDBACK, langPack->Get("information_give_feedback_button"));
-	wxButton * btnMakeDonation = new wxButton(pageInformation, ID_INFORMATION_MAKE_DONATION, langPack->Get("information_make_donation_button"));
+	wxButton * btnVisitForum = new wxButton(pageInformation, ID_INFORMATION_BTN_GIVE_FEEDBACK, langPack->Get(StrId::information_give_feedback_button));
+	wxButton * btnMakeDonation = new wxButton(pageInformation, ID_INFORMATION_MAKE_DONATION, langPack->Get(StrId::information_make_donation_button));
+	wxButton * btnExportStats = new wxButton(pageInformation, ID_INFORMATION_BTN_EXPORT_STATS, langPack->Get(StrId::information_export_stats_button));
 	sizerInformationButtons->Add(btnVisitForum, wxSizerFlags().Border(wxALL, 5));
 	sizerInformationButtons->AddSpacer(5);
 	sizerInformationButtons->Add(btnMakeDonation, wxSizerFlags().Border(wxALL, 5));
+	sizerInformationButtons->AddSpacer(5);
+	sizerInformationButtons->Add(btnExportStats, wxSizerFlags().Border(wxALL, 5));
 	
 	sizerInformation->Add(sizerInformationButtons);
 	
 	pageInformation->SetSizer(sizerInformation);
 	
-	_notebook->AddPage(pageSettings, langPack->Get("settings_settings_tab"));
-	_notebook->AddPage(pageInformation, langPack->Get("settings_information_tab"));
+	_notebook->AddPage(pageSettings, langPack->Get(StrId::settings_settings_tab));
+	_notebook->AddPage(pageInformation, langPack->Get(StrId::settings_information_tab));
 	
 	_notebookImgList.Add(_iconSettings);
 	_notebookImgList.Add(_iconInformation);
@@ -281,6 +307,7 @@ SettingsWindow::SettingsWindow(const wxString& title) :
 	Connect(ID_SETTINGS_BTN_TRY_LONG_BREAK, wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler(SettingsWindow::OnTryLongBreakClicked));
 	Connect(ID_INFORMATION_BTN_GIVE_FEEDBACK, wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler(SettingsWindow::OnGiveFeedbackClicked));
 	Connect(ID_INFORMATION_MAKE_DONATION, wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler(SettingsWindow::OnDonateClicked));
+	Connect(ID_INFORMATION_BTN_EXPORT_STATS, wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler(SettingsWindow::OnExportStatsClicked));
 }
 
 void SettingsWindow::OnShow(wxShowEvent &)
@@ -347,13 +374,77 @@ void SettingsWindow::OnDonateClicked(wxCommandEvent &)
 	wxLaunchDefaultBrowser(wxString::Format(L"http://%s/support", getApp()->getWebsiteString()));
 }
 
+void SettingsWindow::OnExportStatsClicked(wxCommandEvent &)
+{
+	StatsStore const * stats = getApp()->GetStats();
+	if (!stats)
+		return;
+
+	wxFileDialog dialog(this, langPack->Get(StrId::information_export_stats_button), wxEmptyString, L"eyeleo-statistics.csv",
+		L"CSV (*.csv)|*.csv", wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+	if (dialog.ShowModal() != wxID_OK)
+		return;
+
+	if (!stats->ExportCsv(dialog.GetPath()))
+		wxMessageBox(langPack->Get(StrId::information_export_stats_failed), _("EyeLeo"), wxOK | wxICON_ERROR, this);
+}
+
 wxString SettingsWindow::GetInformation() const
 {
-	wxString text = wxString(L"EyeLeo Version ") + getApp()->getVersionString() + L". " + langPack->Get("information_info_1");
-	text += _("\n") + langPack->Get("information_author");
-	text += _("\n") + langPack->Get("information_license");
-	text += _("\n") + langPack->Get("information_info_2");
-	text += _("\n") + langPack->Get("information_info_3");
+	wxString text = wxString(L"EyeLeo Version ") + getApp()->getVersionString() + L". " + langPack->Get(StrId::information_info_1);
+	text += _("\n") + langPack->Get(StrId::information_author);
+	text += _("\n") + langPack->Get(StrId::information_license);
+	text += _("\n") + langPack->Get(StrId::information_info_2);
+	text += _("\n") + langPack->Get(StrId::information_info_3);
+	return text;
+}
+
+wxString SettingsWindow::GetStatistics() const
+{
+	StatsStore const * stats = getApp()->GetStats();
+	if (!stats)
+		return wxString();
+
+	int today = StatsStore::Today();
+	const int periods[] = { 7, 30 };
+	const StrId ids[] = { StrId::information_stats_7_days, StrId::information_stats_30_days };
+
+	wxString text;
+	for (int i = 0; i < 2; ++i)
+	{
+		int firstDay = today - periods[i] + 1;
+		unsigned int activeMinutes = stats->Sum(STAT_ACTIVE_MINUTES, firstDay, today);
+
+		if (!text.empty())
+			text += _("\n");
+		text += wxString::Format(langPack->Get(ids[i]),
+			stats->Sum(STAT_LONG_BREAKS, firstDay, today),
+			stats->Sum(STAT_EARLY_SKIPS, firstDay, today) + stats->Sum(STAT_LATE_SKIPS, firstDay, today),
+			stats->Sum(STAT_POSTPONES, firstDay, today),
+			stats->Sum(STAT_SHORT_BREAKS, firstDay, today),
+			activeMinutes / 60, activeMinutes % 60);
+	}
+
+	AdherenceStats const * adherence = getApp()->GetAdherence();
+	if (adherence)
+	{
+		const StrId adherenceIds[ADHERENCE_METRIC_COUNT] = {
+			StrId::information_adherence_relax_before_skip,
+			StrId::information_adherence_response_time,
+			StrId::information_adherence_screen_time
+		};
+
+		for (int metric = 0; metric < ADHERENCE_METRIC_COUNT; ++metric)
+		{
+			QuantileSketch sketch = adherence->GetRecent((AdherenceMetric)metric);
+			if (sketch.GetCount() == 0)
+				continue;
+
+			text += _("\n") + wxString::Format(langPack->Get(adherenceIds[metric]),
+				getTimeStr(sketch.GetQuantile(0.5f), MILLISECONDS),
+				getTimeStr(sketch.GetQuantile(0.9f), MILLISECONDS));
+		}
+	}
 	return text;
 }
 
@@ -467,6 +558,11 @@ void SettingsWindow::SetCanCloseNotifications(bool value)
 	_chkCanCloseNotifications->SetValue(value);
 }
 
+void SettingsWindow::SetBlurredBackgroundEnabled(bool value)
+{
+	_chkBlurredBackground->SetValue(value);
+}
+
 bool SettingsWindow::GetBigPauseEnabled() const
 {
 	return _chkBigPauses->GetValue();
@@ -537,6 +633,11 @@ bool SettingsWindow::GetInactivityTrackingEnabled() const
 	return _chkInactivityTracking->GetValue();
 }
 
+bool SettingsWindow::GetBlurredBackgroundEnabled() const
+{
+	return _chkBlurredBackground->GetValue();
+}
+
 void SettingsWindow::PullSettings()
 {
 	SetBigPauseEnabled(getApp()->GetBigPauseEnabled());
@@ -552,6 +653,7 @@ void SettingsWindow::PullSettings()
 	SetWindowNearbySetting(getApp()->GetWindowNearbySetting());
 	SetCanCloseNotifications(getApp()->GetCanCloseNotificationsSetting());
 	SetInactivityTrackingEnabled(getApp()->GetInactivityTrackingEnabled());
+	SetBlurredBackgroundEnabled(getApp()->GetBlurredBackgroundEnabled());
 }
 
 void SettingsWindow::PushSettings()
@@ -569,6 +671,7 @@ void SettingsWindow::PushSettings()
 	getApp()->SetWindowNearbySetting(GetWindowNearbySetting());
 	getApp()->SetCanCloseNotificationsSetting(GetCanCloseNotifications());
 	getApp()->SetInactivityTrackingEnabled(GetInactivityTrackingEnabled());
+	getApp()->SetBlurredBackgroundEnabled(GetBlurredBackgroundEnabled());
 	getApp()->SaveSettings();
 }
 
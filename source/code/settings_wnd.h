@@ -27,6 +27,7 @@ enum
 
 	ID_SETTINGS_CHK_WINDOW_NEARBY,
 	ID_SETTINGS_CHK_ENABLE_INACTIVITY_TRACKING,
+	ID_SETTINGS_CHK_BLURRED_BACKGROUND,
 
 	ID_SETTINGS_BTN_SAVE_AND_QUIT,
 	ID_SETTINGS_BTN_TRY_SHORT_BREAK,
@@ -35,6 +36,7 @@ enum
 	ID_INFORMATION_BTN_GIVE_FEEDBACK,
 	ID_INFORMATION_WRITE_EMAIL,
 	ID_INFORMATION_MAKE_DONATION,
+	ID_INFORMATION_BTN_EXPORT_STATS,
 };
 
 class wxNotebook;
@@ -59,6 +61,7 @@ public:
 	void OnTryLongBreakClicked(wxCommandEvent &);
 	void OnGiveFeedbackClicked(wxCommandEvent &event);
 	void OnDonateClicked(wxCommandEvent &event);
+	void OnExportStatsClicked(wxCommandEvent &event);
 
 	void PullSettings();
 	void PushSettings();
@@ -94,8 +97,10 @@ private:
 
 	wxCheckBox * _chkWindowNearby;
 	wxCheckBox * _chkInactivityTracking;
+	wxCheckBox * _chkBlurredBackground;
 
 	wxString GetInformation() const;
+	wxString GetStatistics() const;
 
 public:
 	void SetBigPauseEnabled(bool value);
@@ -111,6 +116,7 @@ public:
 	void SetWindowNearbySetting(bool value);
 	void SetInactivityTrackingEnabled(bool value);
 	void SetCanCloseNotifications(bool value);
+	void SetBlurredBackgroundEnabled(bool value);
 
 private:
 	bool GetBigPauseEnabled() const;
@@ -126,6 +132,7 @@ private:
 	bool GetCanCloseNotifications() const;
 	bool GetWindowNearbySetting() const;
 	bool GetInactivityTrackingEnabled() const;
+	bool GetBlurredBackgroundEnabled() const;
 
 	static bool inited;
 
@@ -0,0 +1,164 @@
+#include "state_journal.h"
+#include <stddef.h>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+	const uint32_t JOURNAL_MAGIC = 0x4E524A45; // "EJRN"
+	const uint32_t JOURNAL_CAPACITY = 1024; // records, 64 KB
+
+	struct JournalRecord
+	{
+		uint32_t magic;
+		uint32_t seq;
+		RuntimeState state;
+		uint32_t reserved;
+		uint32_t checksum;
+	};
+
+	static_assert(sizeof(RuntimeState) == 48, "RuntimeState layout is part of the journal format");
+	static_assert(sizeof(JournalRecord) == 64, "journal records must stay 64 bytes");
+
+	// FNV-1a over everything but the checksum itself
+	uint32_t checksum(JournalRecord const & record)
+	{
+		const unsigned char * data = reinterpret_cast<const unsigned char*>(&record);
+		uint32_t hash = 2166136261u;
+		for (size_t i = 0; i < offsetof(JournalRecord, checksum); ++i)
+		{
+			hash ^= data[i];
+			hash *= 16777619u;
+		}
+		return hash;
+	}
+}
+
+StateJournal::StateJournal() :
+	_file(0),
+	_nextSeq(1),
+	_nextSlot(0)
+{
+}
+
+StateJournal::~StateJournal()
+{
+	Close();
+}
+
+bool StateJournal::Open(wxString const & path)
+{
+	Close();
+
+#ifdef WIN32
+	_wfopen_s(&_file, path.c_str(), L"r+b");
+	if (!_file)
+		_wfopen_s(&_file, path.c_str(), L"w+b");
+#else
+	_file = fopen(path.fn_str(), "r+b");
+	if (!_file)
+		_file = fopen(path.fn_str(), "w+b");
+#endif
+	if (!_file)
+		return false;
+
+	// allocate the whole file up front, appends never change its size
+	fseek(_file, 0, SEEK_END);
+	long size = ftell(_file);
+	long fullSize = long(JOURNAL_CAPACITY * sizeof(JournalRecord));
+	if (size < fullSize)
+	{
+		std::vector<char> zeros(fullSize - size, 0);
+		fwrite(&zeros[0], 1, zeros.size(), _file);
+		fflush(_file);
+	}
+
+	_nextSeq = 1;
+	_nextSlot = 0;
+	return true;
+}
+
+void StateJournal::Close()
+{
+	if (_file)
+	{
+		fclose(_file);
+		_file = 0;
+	}
+}
+
+bool StateJournal::Replay(RuntimeState & state)
+{
+	if (!_file)
+		return false;
+
+	std::vector<JournalRecord> records(JOURNAL_CAPACITY);
+	fseek(_file, 0, SEEK_SET);
+	size_t count = fread(&records[0], sizeof(JournalRecord), JOURNAL_CAPACITY, _file);
+
+	const JournalRecord * latest = 0;
+	uint32_t latestSlot = 0;
+	for (size_t slot = 0; slot < count; ++slot)
+	{
+		JournalRecord const & record = records[slot];
+		if (record.magic != JOURNAL_MAGIC || record.checksum != checksum(record))
+			continue;
+
+		if (!latest || record.seq > latest->seq)
+		{
+			latest = &record;
+			latestSlot = (uint32_t)slot;
+		}
+	}
+
+	if (!latest)
+		return false;
+
+	state = latest->state;
+	_nextSeq = latest->seq + 1;
+	_nextSlot = (latestSlot + 1) % JOURNAL_CAPACITY;
+	return true;
+}
+
+void StateJournal::Append(RuntimeState const & state)
+{
+	if (!_file)
+		return;
+
+	JournalRecord record;
+	memset(&record, 0, sizeof(record));
+	record.magic = JOURNAL_MAGIC;
+	record.seq = _nextSeq++;
+	record.state = state;
+	record.checksum = checksum(record);
+
+	// handed to the OS right away, so it survives a crash of the process
+	fseek(_file, long(_nextSlot * sizeof(JournalRecord)), SEEK_SET);
+	fwrite(&record, sizeof(record), 1, _file);
+	fflush(_file);
+
+	_nextSlot = (_nextSlot + 1) % JOURNAL_CAPACITY;
+}
+
+ResumedTimers resumeTimers(long timeLeftToBigPause, long timeLeftToMiniPause, int postponeCount, long long downMs)
+{
+	ResumedTimers timers;
+	timers.resumed = false;
+	timers.timeLeftToBigPause = 0;
+	timers.timeLeftToMiniPause = 0;
+	timers.postponeCount = 0;
+
+	if (downMs < 1000 || downMs > 30 * 60 * 1000)
+		return timers;
+
+	long bigPauseLeft = long(timeLeftToBigPause - downMs);
+	if (bigPauseLeft < -1000 * 60 * 3)
+		return timers;
+
+	long miniPauseLeft = long(timeLeftToMiniPause - downMs);
+	timers.resumed = true;
+	timers.timeLeftToBigPause = bigPauseLeft < 1000 * 60 ? 1000 * 60 : bigPauseLeft; // not less than a minute
+	timers.timeLeftToMiniPause = miniPauseLeft < 1000 * 60 ? 1000 * 60 : miniPauseLeft;
+	timers.postponeCount = postponeCount;
+	return timers;
+}
@@ -0,0 +1,65 @@
+#ifndef STATE_JOURNAL_H
+#define STATE_JOURNAL_H
+
+#include "wx/string.h"
+#include <stdio.h>
+#include <stdint.h>
+
+// Runtime state that changes all the time: timers and statistics.
+// Configuration lives in settings.xml, this goes to the journal.
+struct RuntimeState
+{
+	int64_t wallTime; // ms since epoch (UTC), when the state was recorded
+	int32_t timeLeftToBigPause; // ms
+	int32_t timeLeftToMiniPause; // ms
+	int32_t postponeCount;
+
+	uint32_t longBreakCount;
+	uint32_t earlySkipCount;
+	uint32_t lateSkipCount;
+	uint32_t refuseCount;
+	uint32_t postponeTotal;
+	uint32_t autoBreakCount;
+	uint32_t shortBreakCount;
+};
+
+// Timers to go on with after a restart
+struct ResumedTimers
+{
+	bool resumed; // false when the intervals start over
+	long timeLeftToBigPause; // ms
+	long timeLeftToMiniPause; // ms
+	int postponeCount;
+};
+
+// The recorded timers less the ms the application was down. After more than half an hour,
+// or with the big pause overdue by more than 3 minutes, the intervals start over.
+ResumedTimers resumeTimers(long timeLeftToBigPause, long timeLeftToMiniPause, int postponeCount, long long downMs);
+
+// Journal of RuntimeState snapshots. The file is allocated once for a fixed number of
+// 64 byte records which are appended one after another; when the end of the file is
+// reached, writing continues from the first slot. Every record is a complete snapshot
+// with a sequence number and a checksum, so replay picks the valid record with
+// the highest sequence number. A record torn by a crash fails the checksum and
+// the previous one is used instead.
+class StateJournal
+{
+public:
+	StateJournal();
+	~StateJournal();
+
+	bool Open(wxString const & path);
+	void Close();
+
+	// Finds the most recent snapshot. Must be called right after Open.
+	bool Replay(RuntimeState & state);
+
+	void Append(RuntimeState const & state);
+
+private:
+	FILE * _file;
+	uint32_t _nextSeq;
+	uint32_t _nextSlot;
+};
+
+#endif
@@ -0,0 +1,243 @@
+#include "stats_store.h"
+#include "wx/datetime.h"
+#include "wx/ffile.h"
+#include <string.h>
+
+namespace
+{
+	const uint32_t STATS_MAGIC = 0x54534C45; // "ELST"
+	const uint16_t STATS_VERSION = 1;
+	const uint32_t STATS_CAPACITY = 732; // days
+
+	const char * metricNames[STAT_METRIC_COUNT] = {
+		"long_breaks",
+		"early_skips",
+		"late_skips",
+		"refusals",
+		"postpones",
+		"auto_relax",
+		"short_breaks",
+		"active_minutes"
+	};
+}
+
+struct StatsHeader
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t metricCount;
+	uint32_t capacity;
+	uint32_t first; // slot of the oldest day
+	uint32_t count;
+	uint32_t reserved[3];
+};
+
+static_assert(sizeof(StatsHeader) == 32, "stats.bin header must stay 32 bytes");
+static_assert(sizeof(StatsDay) % 8 == 0, "day rows must stay aligned");
+
+unsigned int StatsDay::Total(StatsMetric metric) const
+{
+	unsigned int total = 0;
+	for (int hour = 0; hour < 24; ++hour)
+		total += hours[metric][hour];
+	return total;
+}
+
+StatsStore::StatsStore() :
+	_header(0),
+	_rows(0),
+	_activeMs(0)
+{
+}
+
+bool StatsStore::Open(wxString const & path)
+{
+	Close();
+
+	size_t size = sizeof(StatsHeader) + STATS_CAPACITY * sizeof(StatsDay);
+	if (!_file.Open(path, size))
+		return false;
+
+	_header = static_cast<StatsHeader*>(_file.GetData());
+	_rows = reinterpret_cast<StatsDay*>(_header + 1);
+
+	if (_header->magic != STATS_MAGIC || _header->version != STATS_VERSION ||
+		_header->metricCount != STAT_METRIC_COUNT || _header->capacity != STATS_CAPACITY ||
+		_header->first >= STATS_CAPACITY || _header->count > STATS_CAPACITY)
+	{
+		// new or unknown file, start from scratch
+		memset(_file.GetData(), 0, size);
+		_header->magic = STATS_MAGIC;
+		_header->version = STATS_VERSION;
+		_header->metricCount = STAT_METRIC_COUNT;
+		_header->capacity = STATS_CAPACITY;
+	}
+	return true;
+}
+
+void StatsStore::Close()
+{
+	_file.Close();
+	_header = 0;
+	_rows = 0;
+}
+
+StatsDay * StatsStore::Row(uint32_t index) const
+{
+	return &_rows[(_header->first + index) % STATS_CAPACITY];
+}
+
+StatsDay * StatsStore::Current()
+{
+	int today = Today();
+
+	// a clock moved back keeps counting into the latest day
+	if (_header->count > 0 && Row(_header->count - 1)->day >= today)
+		return Row(_header->count - 1);
+
+	if (_header->count == STATS_CAPACITY)
+	{
+		_header->first = (_header->first + 1) % STATS_CAPACITY;
+		_header->count--;
+	}
+
+	StatsDay * row = Row(_header->count);
+	memset(row, 0, sizeof(StatsDay));
+	row->day = today;
+	_header->count++;
+	return row;
+}
+
+void StatsStore::Add(StatsMetric metric, unsigned int value)
+{
+	if (!_header)
+		return;
+
+	StatsDay * row = Current();
+	uint16_t & cell = row->hours[metric][wxDateTime::Now().GetHour()];
+	cell = (uint16_t)(cell + value < 0xFFFF ? cell + value : 0xFFFF);
+}
+
+void StatsStore::AddActiveTime(long ms)
+{
+	_activeMs += ms;
+	if (_activeMs >= 60 * 1000)
+	{
+		Add(STAT_ACTIVE_MINUTES, (unsigned int)(_activeMs / (60 * 1000)));
+		_activeMs %= 60 * 1000;
+	}
+}
+
+uint32_t StatsStore::LowerBound(int day) const
+{
+	uint32_t lo = 0;
+	uint32_t hi = _header->count;
+	while (lo < hi)
+	{
+		uint32_t mid = (lo + hi) / 2;
+		if (Row(mid)->day < day)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+void StatsStore::Query(int firstDay, int lastDay, std::vector<StatsDay const *> & days) const
+{
+	days.clear();
+	if (!_header)
+		return;
+
+	for (uint32_t index = LowerBound(firstDay); index < _header->count; ++index)
+	{
+		StatsDay const * row = Row(index);
+		if (row->day > lastDay)
+			break;
+		days.push_back(row);
+	}
+}
+
+unsigned int StatsStore::Sum(StatsMetric metric, int firstDay, int lastDay) const
+{
+	if (!_header)
+		return 0;
+
+	unsigned int total = 0;
+	for (uint32_t index = LowerBound(firstDay); index < _header->count; ++index)
+	{
+		StatsDay const * row = Row(index);
+		if (row->day > lastDay)
+			break;
+		total += row->Total(metric);
+	}
+	return total;
+}
+
+bool StatsStore::ExportCsv(wxString const & path) const
+{
+	wxFFile file(path, L"w");
+	if (!file.IsOpened())
+		return false;
+
+	wxString line = L"date,hour";
+	for (int metric = 0; metric < STAT_METRIC_COUNT; ++metric)
+		line += wxString(L",") + metricNames[metric];
+	file.Write(line + L"\n");
+
+	uint32_t count = _header ? _header->count : 0;
+	for (uint32_t index = 0; index < count; ++index)
+	{
+		StatsDay const * row = Row(index);
+
+		int year, month, day;
+		DayDate(row->day, &year, &month, &day);
+
+		for (int hour = 0; hour < 24; ++hour)
+		{
+			bool empty = true;
+			for (int metric = 0; metric < STAT_METRIC_COUNT && empty; ++metric)
+				empty = row->hours[metric][hour] == 0;
+			if (empty)
+				continue;
+
+			line = wxString::Format(L"%04d-%02d-%02d,%d", year, month, day, hour);
+			for (int metric = 0; metric < STAT_METRIC_COUNT; ++metric)
+				line += wxString::Format(L",%u", (unsigned int)row->hours[metric][hour]);
+			file.Write(line + L"\n");
+		}
+	}
+
+	return file.Close();
+}
+
+int StatsStore::Today()
+{
+	wxDateTime now = wxDateTime::Now();
+	return DayNumber(now.GetYear(), now.GetMonth() + 1, now.GetDay());
+}
+
+// proleptic Gregorian calendar, see http://howardhinnant.github.io/date_algorithms.html
+int StatsStore::DayNumber(int year, int month, int day)
+{
+	year -= month <= 2;
+	int era = (year >= 0 ? year : year - 399) / 400;
+	int yearOfEra = year - era * 400;
+	int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+	int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+	return era * 146097 + dayOfEra - 719468;
+}
+
+void StatsStore::DayDate(int dayNumber, int * year, int * month, int * day)
+{
+	dayNumber += 719468;
+	int era = (dayNumber >= 0 ? dayNumber : dayNumber - 146096) / 146097;
+	int dayOfEra = dayNumber - era * 146097;
+	int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+	int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+	int mp = (5 * dayOfYear + 2) / 153;
+
+	*day = dayOfYear - (153 * mp + 2) / 5 + 1;
+	*month = mp + (mp < 10 ? 3 : -9);
+	*year = yearOfEra + era * 400 + (*month <= 2);
+}
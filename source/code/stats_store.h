@@ -0,0 +1,73 @@
+#ifndef STATS_STORE_H
+#define STATS_STORE_H
+
+#include "wx/string.h"
+#include "mapped_file.h"
+#include <stdint.h>
+#include <vector>
+
+enum StatsMetric
+{
+	STAT_LONG_BREAKS,
+	STAT_EARLY_SKIPS,
+	STAT_LATE_SKIPS,
+	STAT_REFUSALS,
+	STAT_POSTPONES,
+	STAT_AUTO_RELAX,
+	STAT_SHORT_BREAKS,
+	STAT_ACTIVE_MINUTES,
+
+	STAT_METRIC_COUNT
+};
+
+// One day of statistics. Every metric is a column of 24 hourly values.
+struct StatsDay
+{
+	int32_t day; // days since 1970-01-01, local time
+	uint32_t reserved;
+	uint16_t hours[STAT_METRIC_COUNT][24];
+
+	unsigned int Total(StatsMetric metric) const;
+};
+
+struct StatsHeader;
+
+// Per-day history of break statistics in stats.bin. The file is mapped into memory and
+// holds a ring of fixed-size day rows, the oldest days are overwritten after about two years.
+// Opening doesn't read anything, adding to the current hour is O(1), and
+// range queries are a binary search over the rows.
+class StatsStore
+{
+public:
+	StatsStore();
+
+	bool Open(wxString const & path);
+	void Close();
+
+	// Adds to the current hour of today
+	void Add(StatsMetric metric, unsigned int value = 1);
+	void AddActiveTime(long ms);
+
+	// Days in [firstDay, lastDay] that have any data, oldest first
+	void Query(int firstDay, int lastDay, std::vector<StatsDay const *> & days) const;
+	unsigned int Sum(StatsMetric metric, int firstDay, int lastDay) const;
+
+	// One line per hour with any data
+	bool ExportCsv(wxString const & path) const;
+
+	static int Today();
+	static int DayNumber(int year, int month, int day); // month is 1-based
+	static void DayDate(int dayNumber, int * year, int * month, int * day);
+
+private:
+	StatsDay * Row(uint32_t index) const; // 0 is the oldest day
+	StatsDay * Current();
+	uint32_t LowerBound(int day) const;
+
+	MappedFile _file;
+	StatsHeader * _header;
+	StatsDay * _rows;
+	long _activeMs;
+};
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef STRING_ID_HASH_H
+#define STRING_ID_HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Hash of a language pack string id, shared by langpack-compiler and the generated
+// string_ids.cpp. The seed selects one of a family of hash functions for the perfect hash.
+constexpr uint32_t strIdHash(const wchar_t * name, size_t length, uint32_t seed)
+{
+	uint32_t hash = 2166136261u ^ seed; // FNV-1a
+	for (size_t i = 0; i < length; ++i)
+	{
+		hash ^= (uint32_t)name[i];
+		hash *= 16777619u;
+	}
+
+	// spread different seeds over the low bits too
+	hash ^= hash >> 16;
+	hash *= 0x85EBCA6Bu;
+	hash ^= hash >> 13;
+	return hash;
+}
+
+#endif
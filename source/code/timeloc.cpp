@@ -1,131 +1,237 @@
 #include "timeloc.h"
 #include "wx/intl.h"
 #include "language_set.h"
+#include "logging.h"
+#include <stdlib.h>
+#include <wchar.h>
 
-wxString getSecondStr(int seconds, wxString const & lang)
+namespace
 {
-	if (lang == L"ru")
+	const StrId pluralRuleIds[PLURAL_OTHER] = {
+		StrId::plural_rule_one,
+		StrId::plural_rule_few,
+		StrId::plural_rule_many
+	};
+
+	class Writer
 	{
-		int seconds_mod_10 = seconds % 10;
-		if (seconds_mod_10 >= 2 && seconds_mod_10 <= 4 && seconds / 10 != 1) // 2-4, 22-24, 32-34 
+	public:
+		Writer(wchar_t * buffer, size_t size) : _buffer(buffer), _size(size), _length(0) {}
+
+		void Append(const wchar_t * text, size_t length)
 		{
-			return wxString::Format(L"%d %s", seconds, langPack->Get("seconds_"));
+			for (size_t i = 0; i < length && _length + 1 < _size; ++i)
+				_buffer[_length++] = text[i];
 		}
-		else if (seconds_mod_10 == 1 && seconds != 11) // 1, 21, 31 
+
+		void Append(const wchar_t * text)
 		{
-			return wxString::Format(L"%d %s", seconds, langPack->Get("second"));
+			Append(text, wcslen(text));
 		}
-		else if (seconds_mod_10 == 0 || (seconds >= 5 && seconds <= 19) || (seconds_mod_10 >= 5 && seconds_mod_10 <= 9)) // 0, 5-19, 20, 25-29, 30, 35-39 
+
+		void AppendNumber(int value)
+		{
+			wchar_t digits[12];
+			size_t count = 0;
+			unsigned int rest = value < 0 ? 0 : (unsigned int)value;
+			do
+			{
+				digits[sizeof(digits) / sizeof(digits[0]) - 1 - count++] = (wchar_t)(L'0' + rest % 10);
+				rest /= 10;
+			}
+			while (rest);
+			Append(digits + sizeof(digits) / sizeof(digits[0]) - count, count);
+		}
+
+		size_t Finish()
 		{
-			return wxString::Format("%d %s", seconds, langPack->Get("seconds"));
+			_buffer[_length] = 0;
+			return _length;
 		}
+
+	private:
+		wchar_t * _buffer;
+		size_t _size;
+		size_t _length;
+	};
+}
+
+TimeFormat::TimeFormat() :
+	_decimalSeparator(L"."),
+	_tooLong(L""),
+	_maxHours(0)
+{
+	for (int i = 0; i < TEMPLATE_COUNT; ++i)
+		_templates[i].count = 0;
+	for (int field = 0; field < FIELD_UNITS; ++field)
+	{
+		for (int category = 0; category < PLURAL_CATEGORY_COUNT; ++category)
+			_forms[field][category] = L"";
 	}
+}
 
-	// lang "en" and others
-	if (seconds > 1 || seconds == 0)
+void TimeFormat::Init(LanguagePack const & pack)
+{
+	for (int category = 0; category < PLURAL_OTHER; ++category)
 	{
-		return wxString::Format(L"%d %s", seconds, langPack->Get("seconds"));
+		if (!_plural.SetRule((EPluralCategory)category, pack.Get(pluralRuleIds[category])))
+			LOG_WARNING("Bad plural rule: %s", pack.Get(pluralRuleIds[category]));
 	}
-	else if (seconds == 1)
+
+	const StrId forms[FIELD_UNITS][PLURAL_CATEGORY_COUNT] = {
+		{ StrId::hour, StrId::hours_, StrId::hours, StrId::hours },
+		{ StrId::minute, StrId::minutes_, StrId::minutes, StrId::minutes },
+		{ StrId::second, StrId::seconds_, StrId::seconds, StrId::seconds }
+	};
+	for (int field = 0; field < FIELD_UNITS; ++field)
 	{
-		return wxString::Format(L"1 %s", langPack->Get("second"));
+		for (int category = 0; category < PLURAL_CATEGORY_COUNT; ++category)
+			_forms[field][category] = pack.Get(forms[field][category]);
 	}
 
-	return wxString();
+	ParseTemplate(pack.Get(StrId::time_format_hours), _templates[TEMPLATE_HOURS]);
+	ParseTemplate(pack.Get(StrId::time_format_hours_minutes), _templates[TEMPLATE_HOURS_MINUTES]);
+	ParseTemplate(pack.Get(StrId::time_format_minutes), _templates[TEMPLATE_MINUTES]);
+	ParseTemplate(pack.Get(StrId::time_format_minutes_seconds), _templates[TEMPLATE_MINUTES_SECONDS]);
+	ParseTemplate(pack.Get(StrId::time_format_seconds), _templates[TEMPLATE_SECONDS]);
+	ParseTemplate(pack.Get(StrId::time_format_tenths), _templates[TEMPLATE_TENTHS]);
+	_decimalSeparator = pack.Get(StrId::decimal_separator);
+
+	_tooLong = pack.Get(StrId::too_many_hours);
+	_maxHours = wcstol(pack.Get(StrId::time_max_hours), 0, 10);
 }
 
-wxString getTimeStr(int value, ETimeUnit unit, wxString const & lang)
+void TimeFormat::ParseTemplate(const wchar_t * text, Template & result)
 {
-	int hours = 0;
-	int minutes = 0;
-	int seconds = 0;
-	int milliseconds = 0;
-	splitTime(value, unit, &hours, &minutes, &seconds, &milliseconds);
-	
-	if (lang == L"en")
+	result.count = 0;
+	const wchar_t * literal = text;
+	for (const wchar_t * pos = text; ; ++pos)
 	{
-		if (hours > 1)
+		EField field = FIELD_COUNT;
+		if (pos[0] == L'{' && pos[1] && pos[2] == L'}')
 		{
-			if (minutes != 0)
-				return wxString::Format(L"%d %s %d %s", hours, langPack->Get("hours"), minutes, langPack->Get("minutes"));
-			else
-				return wxString::Format(L"%d %s", hours, langPack->Get("hours"));
+			if (pos[1] == L'h')
+				field = FIELD_HOURS;
+			else if (pos[1] == L'm')
+				field = FIELD_MINUTES;
+			else if (pos[1] == L's')
+				field = FIELD_SECONDS;
+			else if (pos[1] == L't')
+				field = FIELD_TENTHS;
 		}
-		else if (hours == 1)
+
+		if ((field != FIELD_COUNT || *pos == 0) && pos > literal && result.count < MAX_TOKENS)
 		{
-			if (minutes != 0)
-				return wxString::Format(L"1 %s %d %s", langPack->Get("hour"), minutes, langPack->Get("minutes"));
-			else
-				return wxString::Format(L"1 %s", langPack->Get("hour"));
+			Token & token = result.tokens[result.count++];
+			token.text = literal;
+			token.length = pos - literal;
+			token.field = FIELD_COUNT;
 		}
-		else if (minutes > 1)
+
+		if (*pos == 0)
+			break;
+
+		if (field != FIELD_COUNT)
 		{
-			if (minutes > 3)
-			{
-				return wxString::Format(L"%d %s", minutes, langPack->Get("minutes"));
-			}
-			else // show seconds too
+			if (result.count < MAX_TOKENS)
 			{
-				return wxString::Format(L"%d %s %s", minutes, langPack->Get("minutes"), getSecondStr(seconds, lang).c_str());
+				Token & token = result.tokens[result.count++];
+				token.text = 0;
+				token.length = 0;
+				token.field = field;
 			}
+			pos += 2;
+			literal = pos + 1;
 		}
-		else if (minutes == 1)
-		{
-			return wxString::Format(L"1 %s %s", langPack->Get("minute"), getSecondStr(seconds, langPack->Get("seconds")));
-		}
-		else
-			return getSecondStr(seconds, lang);
 	}
-	else if (lang == L"ru")
+}
+
+size_t TimeFormat::Format(wchar_t * buffer, size_t size, int value, ETimeUnit unit) const
+{
+	if (size == 0)
+		return 0;
+
+	if (value < 0)
+		value = 0;
+	if (unit == MILLISECONDS)
 	{
-		//int seconds_mod_10 = seconds % 10;
-		int minutes_mod_10 = minutes % 10;
-		if (hours >= 2)
+		// a response in 0.4 s isn't "0 seconds", whole tenths are shown as whole seconds
+		int tenths = (value + 50) / 100;
+		if (tenths < 100 && tenths % 10 != 0 && _templates[TEMPLATE_TENTHS].count > 0)
 		{
-			return langPack->Get("too_many_hours");
+			int fields[FIELD_COUNT] = {};
+			fields[FIELD_TENTHS] = tenths;
+			return Expand(buffer, size, _templates[TEMPLATE_TENTHS], fields);
 		}
-		else if (hours == 1)
-		{
-			if (minutes_mod_10 >= 2 && minutes_mod_10 <= 4 && minutes / 10 != 1) // 2-4, 22-24, 32-34 
-			{
-				return wxString::Format(L"1 %s %d %s", langPack->Get("hour"), minutes, langPack->Get("minutes_"));
-			}
-			else if (minutes_mod_10 == 1 && minutes != 11) // 1, 21, 31 
-			{
-				return wxString::Format(L"1 %s %d %s", langPack->Get("hour"), minutes, langPack->Get("minute"));
-			}
-			else if (minutes_mod_10 == 0 || (minutes >= 5 && minutes <= 19) || (minutes_mod_10 >= 5 && minutes_mod_10 <= 9)) // 0, 5-19, 20, 25-29, 30, 35-39 
-			{
-				if (minutes != 0)
-					return wxString::Format("1 %s %d %s", langPack->Get("hour"), minutes, langPack->Get("minutes"));
-				else
-					return wxString::Format("1 %s", langPack->Get("hour"));
-			}
-		}
-		////////////////////////////////////////////////////////////////////////
-		else if (minutes_mod_10 >= 2 && minutes_mod_10 <= 4 && minutes / 10 != 1) // 2-4, 22-24, 32-34 
-		{
-			if (minutes > 3)
-				return wxString::Format(L"%d %s", minutes, langPack->Get("minutes_"));
-			else
-				return wxString::Format(L"%d %s %s", minutes, langPack->Get("minutes_"), getSecondStr(seconds, lang).c_str()); // 2  35 
-		}
-		else if (minutes_mod_10 == 1 && minutes != 11) // 1, 21, 31 
+		value = (value + 500) / 1000;
+	}
+	else if (unit == MINUTES)
+		value *= 60;
+	else if (unit == HOURS)
+		value *= 60 * 60;
+
+	int fields[FIELD_COUNT];
+	splitTime(value, SECONDS, &fields[FIELD_HOURS], &fields[FIELD_MINUTES], &fields[FIELD_SECONDS], 0);
+	fields[FIELD_TENTHS] = fields[FIELD_SECONDS] * 10;
+
+	Writer out(buffer, size);
+	if (_maxHours > 0 && fields[FIELD_HOURS] >= _maxHours)
+	{
+		out.Append(_tooLong);
+		return out.Finish();
+	}
+
+	ETemplate templateId;
+	if (fields[FIELD_HOURS] > 0)
+		templateId = fields[FIELD_MINUTES] > 0 ? TEMPLATE_HOURS_MINUTES : TEMPLATE_HOURS;
+	else if (fields[FIELD_MINUTES] > 3)
+		templateId = TEMPLATE_MINUTES;
+	else if (fields[FIELD_MINUTES] > 0)
+		templateId = TEMPLATE_MINUTES_SECONDS; // show seconds too
+	else
+		templateId = TEMPLATE_SECONDS;
+
+	return Expand(buffer, size, _templates[templateId], fields);
+}
+
+size_t TimeFormat::Expand(wchar_t * buffer, size_t size, Template const & tmpl, const int * fields) const
+{
+	Writer out(buffer, size);
+	for (int i = 0; i < tmpl.count; ++i)
+	{
+		Token const & token = tmpl.tokens[i];
+		if (token.text)
 		{
-			if (minutes != 1)
-				return wxString::Format(L"%d %s", minutes, langPack->Get("minute"));
-			else
-				return wxString::Format(L"%d %s %s", minutes, langPack->Get("minute"), getSecondStr(seconds, lang).c_str());
+			out.Append(token.text, token.length);
+			continue;
 		}
-		else if ((minutes_mod_10 == 0 && minutes != 0) || (minutes >= 5 && minutes <= 19) || (minutes_mod_10 >= 5 && minutes_mod_10 <= 9)) // 5-19, 20, 25-29, 30, 35-39 
+
+		int number = fields[token.field];
+		if (token.field == FIELD_TENTHS)
 		{
-			return wxString::Format("%d %s", minutes, langPack->Get("minutes"));
+			out.AppendNumber(number / 10);
+			out.Append(_decimalSeparator);
+			out.AppendNumber(number % 10);
+			continue;
 		}
-		////////////////////////////////////////////////////////////////////////
-		else
-			return getSecondStr(seconds, lang);
+
+		out.AppendNumber(number);
+		out.Append(L" ", 1);
+		out.Append(_forms[token.field][_plural.Select((unsigned int)number)]);
 	}
-	return wxString(L"");
+	return out.Finish();
+}
+
+size_t formatTime(wchar_t * buffer, size_t size, int value, ETimeUnit unit)
+{
+	return langPack->timeFormat.Format(buffer, size, value, unit);
+}
+
+wxString getTimeStr(int value, ETimeUnit unit)
+{
+	wchar_t buffer[TIME_STR_SIZE];
+	formatTime(buffer, TIME_STR_SIZE, value, unit);
+	return buffer;
 }
 
 void splitTime(int value, ETimeUnit unit, int * pHours, int * pMinutes, int * pSeconds, int * pMilliseconds)
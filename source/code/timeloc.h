@@ -1,6 +1,7 @@
 #ifndef TIMELOC_H
 #define TIMELOC_H
 #include "wx/string.h"
+#include "plural_rules.h"
 
 
 enum ETimeUnit
@@ -11,7 +12,82 @@ enum ETimeUnit
 	HOURS
 };
 
-wxString getTimeStr(int value, ETimeUnit unit, wxString const & lang);
+enum
+{
+	TIME_STR_SIZE = 64 // enough for any duration in the shipped language packs
+};
+
+struct LanguagePack;
+
+// Duration templates and plural forms of a language pack, parsed when the pack is loaded.
+// Templates like "{h} {m}" put "<number> <plural form of the unit>" in place of {h}, {m} and {s}.
+class TimeFormat
+{
+public:
+	TimeFormat();
+
+	void Init(LanguagePack const & pack);
+
+	// Writes the duration into buffer without allocating and returns its length.
+	// The text is cut to fit the buffer and is always NUL-terminated. Milliseconds are
+	// rounded to the nearest second, under 10 seconds to tenths of a second.
+	size_t Format(wchar_t * buffer, size_t size, int value, ETimeUnit unit) const;
+
+private:
+	enum EField
+	{
+		FIELD_HOURS,
+		FIELD_MINUTES,
+		FIELD_SECONDS,
+		FIELD_UNITS, // the fields above are followed by their unit
+		FIELD_TENTHS = FIELD_UNITS, // seconds with a decimal place, the template has the unit
+
+		FIELD_COUNT
+	};
+
+	enum ETemplate
+	{
+		TEMPLATE_HOURS,
+		TEMPLATE_HOURS_MINUTES,
+		TEMPLATE_MINUTES,
+		TEMPLATE_MINUTES_SECONDS,
+		TEMPLATE_SECONDS,
+		TEMPLATE_TENTHS,
+
+		TEMPLATE_COUNT
+	};
+
+	enum
+	{
+		MAX_TOKENS = 8
+	};
+
+	struct Token
+	{
+		const wchar_t * text; // literal text, 0 for a field
+		size_t length;
+		EField field;
+	};
+
+	struct Template
+	{
+		int count;
+		Token tokens[MAX_TOKENS];
+	};
+
+	static void ParseTemplate(const wchar_t * text, Template & result);
+	size_t Expand(wchar_t * buffer, size_t size, Template const & tmpl, const int * fields) const;
+
+	PluralRules _plural;
+	Template _templates[TEMPLATE_COUNT];
+	const wchar_t * _forms[FIELD_UNITS][PLURAL_CATEGORY_COUNT];
+	const wchar_t * _decimalSeparator;
+	const wchar_t * _tooLong;
+	int _maxHours; // longer durations are shown as _tooLong, 0 for no limit
+};
+
+size_t formatTime(wchar_t * buffer, size_t size, int value, ETimeUnit unit);
+wxString getTimeStr(int value, ETimeUnit unit);
 void splitTime(int value, ETimeUnit unit, int * pHours, int * pMinutes, int * pSeconds, int * pMilliseconds);
 
-#endif
\ No newline at end of file
+#endif
@@ -15,7 +15,7 @@ WaitingFullscreenWindow::WaitingFullscreenWindow() :
 	wxFrame(NULL, -1, L"", wxDefaultPosition, wxDefaultSize, wxFRAME_TOOL_WINDOW | wxFRAME_SHAPED | wxNO_BORDER | wxFRAME_NO_TASKBAR | wxSTAY_ON_TOP),
 	_preventClosing(true),
 	_state(State::Showing),
-	_alpha(0.0f)
+	_alpha(0)
 {
 }
 
@@ -25,18 +25,16 @@ void WaitingFullscreenWindow::Init(int displayInd)
 
 	refillResolutionParams();
 
-	wxRegion region(*_backBitmap_long, *wxWHITE);
-	SetShape(region);
+	SetShape(GetResourceShape(_backBitmap_long));
 
-	SetTransparent((int)_alpha);
+	SetTransparent(_alpha);
 
 	// Set position to center of the screen
 	SetSize(wxSize(_backBitmap_long->GetWidth(), _backBitmap_long->GetHeight()));
 	assert(displayInd < osCaps.numDisplays);
-	wxRect displayRect = osCaps.displays[displayInd].clientArea;
-	SetPosition(wxPoint(displayRect.GetX() + displayRect.GetWidth() / 2 - GetSize().GetX() / 2, displayRect.GetY() + displayRect.GetHeight() / 2 - GetSize().GetY() / 2));
+	SetPosition(centerInClientArea(displayInd, GetSize()));
 
-	wxStaticText * txt = new wxStaticText(this, wxID_ANY, langPack->Get("waiting_text"), wxDefaultPosition, wxDefaultSize, wxALIGN_CENTER);
+	wxStaticText * txt = new wxStaticText(this, wxID_ANY, langPack->Get(StrId::waiting_text), wxDefaultPosition, wxDefaultSize, wxALIGN_CENTER);
 	wxFont font(13, wxFONTFAMILY_DEFAULT, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL, false);
 	txt->SetFont(font);
 	txt->SetBackgroundStyle(wxBG_STYLE_COLOUR);
@@ -48,59 +46,48 @@ void WaitingFullscreenWindow::Init(int displayInd)
 	txt->Bind(wxEVT_RIGHT_UP, &WaitingFullscreenWindow::OnMouseTap, this);
 	Bind(wxEVT_RIGHT_UP, &WaitingFullscreenWindow::OnMouseTap, this);
 
-	g_TaskMgr->AddTask(GetName(), 20);
+	g_Animations->Fade(this, 0, 220, 400, EASE_OUT);
 }
 
 WaitingFullscreenWindow::~WaitingFullscreenWindow()
 {
-	logging::msg("WaitingFullscreenWindow::~WaitingFullscreenWindow");
+	LOG_DEBUG("WaitingFullscreenWindow::~WaitingFullscreenWindow");
 
 	if (!getApp()->isFinished())
 		g_TaskMgr->RemoveTasks(GetName());
+	if (g_Animations)
+		g_Animations->Stop(this);
 
 	getApp()->OnCloseWaitingWnd(this);
 	assert(!getApp()->getWindow(GetName()));
 }
 
-void WaitingFullscreenWindow::ExecuteTask(float f, long /*time_went*/)
+void WaitingFullscreenWindow::ExecuteTask(float /*f*/, long /*time_went*/)
+{
+	if (_state == State::Active)
+		Hide();
+}
+
+void WaitingFullscreenWindow::SetFadeAlpha(int alpha)
+{
+	_alpha = alpha;
+	SetTransparent(_alpha);
+}
+
+void WaitingFullscreenWindow::OnFadeFinished()
 {
 	if (_state == State::Showing)
 	{
-		_alpha += 11.0f * f;
-		if (_alpha >= 220.0f)
-		{
-			_alpha = 220.0f;
-			_state = State::Active;
-			
-			g_TaskMgr->AddTask(GetName(), 7 * 1000); // 7 seconds
-		}
-		else
-		{
-			g_TaskMgr->AddTask(GetName(), 20);
-		}
-		SetTransparent(_alpha);
-	}
-	else if (_state == State::Active)
-	{
-		g_TaskMgr->AddTask(GetName(), 20);
-		_state = State::Hiding;
+		_state = State::Active;
+		
+		g_TaskMgr->AddTask(GetName(), 7 * 1000); // 7 seconds
 	}
 	else if (_state == State::Hiding)
 	{
-		_alpha -= 15.0f * f;
-		if (_alpha <= 0.0f)
-		{
-			_alpha = 0.0f;
-			_state = State::Dead;
-			_preventClosing = false;
-			
-			Close();
-		}
-		else
-		{
-			SetTransparent(_alpha);
-			g_TaskMgr->AddTask(GetName(), 20);
-		}
+		_state = State::Dead;
+		_preventClosing = false;
+		
+		Close();
 	}
 }
 
@@ -109,12 +96,13 @@ void WaitingFullscreenWindow::Hide()
 	if (_state == State::Hiding)
 		return;
 
-	logging::msg("WaitingFullscreenWindow::Hide");
+	LOG_DEBUG("WaitingFullscreenWindow::Hide");
 
 	_state = State::Hiding;
 	_preventClosing = false;
 	
-	g_TaskMgr->AddTask(GetName(), 20);
+	g_TaskMgr->RemoveTasks(GetName());
+	g_Animations->Fade(this, _alpha, 0, 300, EASE_IN);
 }
 
 void WaitingFullscreenWindow::HideQuick()
@@ -124,6 +112,7 @@ void WaitingFullscreenWindow::HideQuick()
 	wxFrame::Close();
 
 	g_TaskMgr->RemoveTasks(GetName());
+	g_Animations->Stop(this);
 }
 
 void WaitingFullscreenWindow::OnMouseTap(wxMouseEvent &)
@@ -4,8 +4,9 @@
 #include "wx/wx.h"
 #include "wx/timer.h"
 #include "task_mgr.h"
+#include "animation_driver.h"
 
-class WaitingFullscreenWindow : public wxFrame, public ITask
+class WaitingFullscreenWindow : public wxFrame, public ITask, public IFadeTarget
 {
 	enum class State
 	{
@@ -27,13 +28,15 @@ public:
 private:
 	virtual void OnPaint(wxPaintEvent& evt);
 	void ExecuteTask(float f, long time_went);
+	void SetFadeAlpha(int alpha);
+	void OnFadeFinished();
 	void OnClose(wxCloseEvent& event);
 
 	void OnMouseTap(wxMouseEvent &);
 
 	State _state;
 
-	float _alpha;
+	int _alpha;
 	bool _preventClosing;
 	
 	DECLARE_EVENT_TABLE()
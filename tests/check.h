@@ -0,0 +1,26 @@
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <stdio.h>
+
+// Checks of the test executables. A failed check is reported and the test goes on,
+// checkResult() is the exit code ctest looks at.
+static int checkFailures = 0;
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) \
+		{ \
+			fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+			++checkFailures; \
+		} \
+	} while (0)
+
+inline int checkResult()
+{
+	if (checkFailures)
+		fprintf(stderr, "%d checks failed\n", checkFailures);
+	return checkFailures ? 1 : 0;
+}
+
+#endif
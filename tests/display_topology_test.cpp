@@ -0,0 +1,129 @@
+// The display topology behind osCaps, from 1 to 16 made-up displays: the counts and the
+// primary display, queries only after an invalidation, centering in the client area.
+// wxDisplay is never queried, so it runs without a desktop.
+
+#include "check.h"
+#include "oscapabilities.h"
+#include "wx/init.h"
+#include <stdlib.h>
+
+namespace
+{
+	// Displays in a row, 'primary' one of them, the client areas without a taskbar at the bottom
+	std::vector<DisplayData> makeDisplays(int count, int primary)
+	{
+		std::vector<DisplayData> displays(count);
+		for (int ind = 0; ind < count; ++ind)
+		{
+			DisplayData & disp = displays[ind];
+			disp.primary = ind == primary;
+			disp.geometry = wxRect(ind * 1920 - primary * 1920, 0, 1920, 1080);
+			disp.clientArea = wxRect(disp.geometry.GetX(), 0, 1920, 1040);
+		}
+		return displays;
+	}
+
+	void checkCounts()
+	{
+		FixedDisplayTopology topology(makeDisplays(1, 0));
+		setDisplayTopologyProvider(&topology);
+
+		for (int count = 1; count <= 16; ++count)
+		{
+			for (int primary = 0; primary < count; primary += count > 4 ? 5 : 1)
+			{
+				topology.SetDisplays(makeDisplays(count, primary));
+				invalidateDisplayTopology();
+				refillResolutionParams();
+
+				CHECK(osCaps.numDisplays == count);
+				CHECK((int)osCaps.displays.size() == count);
+				CHECK(osCaps.multiDisplay == (count > 1));
+				CHECK(osCaps.primaryDisplayInd == primary);
+			}
+		}
+
+		// none of them primary
+		std::vector<DisplayData> displays = makeDisplays(3, 0);
+		displays[0].primary = false;
+		topology.SetDisplays(displays);
+		invalidateDisplayTopology();
+		refillResolutionParams();
+		CHECK(osCaps.primaryDisplayInd == 0);
+	}
+
+	void checkGeneration()
+	{
+		FixedDisplayTopology topology(makeDisplays(2, 1));
+		setDisplayTopologyProvider(&topology);
+		unsigned int generation = osCaps.topologyGeneration;
+		CHECK(osCaps.numDisplays == 2);
+
+		// the displays stay as they were until invalidated
+		topology.SetDisplays(makeDisplays(5, 3));
+		refillResolutionParams();
+		refillResolutionParams();
+		CHECK(osCaps.topologyGeneration == generation);
+		CHECK(osCaps.numDisplays == 2);
+		CHECK(osCaps.primaryDisplayInd == 1);
+
+		invalidateDisplayTopology();
+		invalidateDisplayTopology();
+		refillResolutionParams();
+		CHECK(osCaps.topologyGeneration == generation + 1);
+		CHECK(osCaps.numDisplays == 5);
+		CHECK(osCaps.primaryDisplayInd == 3);
+
+		refillResolutionParams();
+		CHECK(osCaps.topologyGeneration == generation + 1);
+
+		// a new provider is queried right away
+		FixedDisplayTopology other(makeDisplays(16, 0));
+		setDisplayTopologyProvider(&other);
+		CHECK(osCaps.topologyGeneration == generation + 2);
+		CHECK(osCaps.numDisplays == 16);
+	}
+
+	void checkCentering()
+	{
+		for (int count = 1; count <= 16; ++count)
+		{
+			std::vector<DisplayData> displays = makeDisplays(count, count / 2);
+			// the taskbar on the left of the last display
+			DisplayData & last = displays.back();
+			last.clientArea = wxRect(last.geometry.GetX() + 60, 0, 1860, 1080);
+
+			FixedDisplayTopology topology(displays);
+			setDisplayTopologyProvider(&topology);
+
+			for (int ind = 0; ind < count; ++ind)
+			{
+				wxRect area = displays[ind].clientArea;
+				const wxSize sizes[] = { wxSize(400, 300), wxSize(401, 301), wxSize(1, 1), area.GetSize(), wxSize(2560, 1440) };
+				for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+				{
+					wxPoint pos = centerInClientArea(ind, sizes[i]);
+					// the same room on both sides, give or take a pixel for odd sizes
+					int left = pos.x - area.GetX();
+					int right = area.GetRight() + 1 - (pos.x + sizes[i].GetWidth());
+					int top = pos.y - area.GetY();
+					int bottom = area.GetBottom() + 1 - (pos.y + sizes[i].GetHeight());
+					CHECK(abs(right - left) <= 1);
+					CHECK(abs(bottom - top) <= 1);
+				}
+				CHECK(centerInClientArea(ind, area.GetSize()) == area.GetPosition());
+			}
+		}
+	}
+}
+
+int main()
+{
+	wxInitializer initializer;
+
+	checkCounts();
+	checkGeneration();
+	checkCentering();
+
+	return checkResult();
+}
@@ -0,0 +1,188 @@
+// Every duration from 0 to 2 hours in the English and the Russian language pack, loaded
+// from XML like EyeLeo does. Langpacks/ holds only the pack under test, as after the
+// Russian installer, so nothing may depend on the English one being around.
+
+#include "check.h"
+#include "language_set.h"
+#include "pugixml.hpp"
+#include "wx/init.h"
+#include "wx/filefn.h"
+#include <string>
+
+namespace
+{
+	enum EForm
+	{
+		FORM_ONE, // hour, minute, second
+		FORM_FEW, // hours_, minutes_, seconds_
+		FORM_MANY // hours, minutes, seconds
+	};
+
+	// The unit words as written in the pack, the grammar is spelled out below
+	struct Words
+	{
+		std::wstring units[3][3]; // hours, minutes, seconds by EForm
+		std::wstring tooLong;
+		int maxHours;
+		EForm (*form)(int n);
+		// seconds with a decimal place
+		const wchar_t * separator;
+		EForm fractionForm;
+	};
+
+	EForm englishForm(int n)
+	{
+		return n == 1 ? FORM_ONE : FORM_MANY;
+	}
+
+	EForm russianForm(int n)
+	{
+		if (n % 10 == 1 && n % 100 != 11)
+			return FORM_ONE; // 1, 21, 31
+		if (n % 10 >= 2 && n % 10 <= 4 && (n % 100 < 12 || n % 100 > 14))
+			return FORM_FEW; // 2-4, 22-24
+		return FORM_MANY; // 0, 5-20, 25-30
+	}
+
+	bool readWords(const char * path, Words & words)
+	{
+		pugi::xml_document doc;
+		if (doc.load_file(path).status != pugi::status_ok)
+			return false;
+
+		const wchar_t * ids[3][3] = {
+			{ L"hour", L"hours_", L"hours" },
+			{ L"minute", L"minutes_", L"minutes" },
+			{ L"second", L"seconds_", L"seconds" }
+		};
+		pugi::xml_node nodeLangPack = doc.child(L"language_pack");
+		for (pugi::xml_node node = nodeLangPack.child(L"string"); node; node = node.next_sibling(L"string"))
+		{
+			std::wstring id = node.attribute(L"id").value();
+			const wchar_t * text = node.attribute(L"text").value();
+			for (int unit = 0; unit < 3; ++unit)
+			{
+				for (int form = 0; form < 3; ++form)
+				{
+					if (id == ids[unit][form])
+						words.units[unit][form] = text;
+				}
+			}
+			if (id == L"too_many_hours")
+				words.tooLong = text;
+			else if (id == L"time_max_hours")
+				words.maxHours = node.attribute(L"text").as_int();
+		}
+		return !words.units[0][FORM_ONE].empty();
+	}
+
+	std::wstring number(Words const & words, int unit, int n)
+	{
+		return std::to_wstring(n) + L" " + words.units[unit][words.form(n)];
+	}
+
+	// Hours with minutes, minutes alone from 4 on, minutes with seconds below that
+	std::wstring expectedDuration(Words const & words, int value)
+	{
+		int hours = value / 3600;
+		int minutes = value / 60 % 60;
+		int seconds = value % 60;
+
+		if (words.maxHours > 0 && hours >= words.maxHours)
+			return words.tooLong;
+		if (hours > 0)
+			return minutes > 0 ? number(words, 0, hours) + L" " + number(words, 1, minutes) : number(words, 0, hours);
+		if (minutes > 3)
+			return number(words, 1, minutes);
+		if (minutes > 0)
+			return number(words, 1, minutes) + L" " + number(words, 2, seconds);
+		return number(words, 2, seconds);
+	}
+
+	// 1.5 seconds, 1,5 секунды
+	std::wstring expectedTenths(Words const & words, int tenths)
+	{
+		return std::to_wstring(tenths / 10) + words.separator + std::to_wstring(tenths % 10) + L" " + words.units[2][words.fractionForm];
+	}
+
+	void checkLanguage(const char * lang, EForm (*form)(int n), const wchar_t * separator, EForm fractionForm)
+	{
+		std::string source = std::string(EYELEO_BIN_FOLDER "Langpacks/langpack.") + lang + ".xml";
+		std::string installed = std::string("Langpacks/langpack.") + lang + ".xml";
+
+		Words words;
+		words.maxHours = 0;
+		words.form = form;
+		words.separator = separator;
+		words.fractionForm = fractionForm;
+		CHECK(readWords(source.c_str(), words));
+
+		wxRemoveFile(L"Langpacks/langpack.en.xml");
+		wxRemoveFile(L"Langpacks/langpack.ru.xml");
+		CHECK(wxCopyFile(source.c_str(), installed.c_str(), true));
+		CHECK(LoadLanguagePack(lang));
+		if (!langPack)
+			return;
+
+		CHECK(langPack->Has(StrId::time_format_hours_minutes));
+		CHECK(langPack->Has(StrId::time_format_minutes_seconds));
+
+		int mismatches = 0;
+		for (int value = 0; value <= 2 * 60 * 60; ++value)
+		{
+			wchar_t buffer[TIME_STR_SIZE];
+			size_t length = formatTime(buffer, TIME_STR_SIZE, value, SECONDS);
+			std::wstring expected = expectedDuration(words, value);
+
+			CHECK(length > 0);
+			CHECK(length + 1 < TIME_STR_SIZE); // not cut
+			if (expected != buffer && mismatches++ < 10)
+				fprintf(stderr, "%s, %d s: '%ls' instead of '%ls'\n", lang, value, buffer, expected.c_str());
+
+			// the same duration in the other units, milliseconds rounded to it
+			wchar_t other[TIME_STR_SIZE];
+			formatTime(other, TIME_STR_SIZE, value * 1000 + (value < 10 ? 49 : 499), MILLISECONDS);
+			CHECK(wcscmp(other, buffer) == 0);
+			if (value > 0)
+			{
+				formatTime(other, TIME_STR_SIZE, value * 1000 - (value <= 10 ? 50 : 500), MILLISECONDS);
+				CHECK(wcscmp(other, buffer) == 0);
+			}
+			if (value % 60 == 0)
+			{
+				formatTime(other, TIME_STR_SIZE, value / 60, MINUTES);
+				CHECK(wcscmp(other, buffer) == 0);
+			}
+		}
+		CHECK(mismatches == 0);
+
+		// tenths of a second under 10 seconds, unless they are whole seconds
+		for (int value = 0; value < 11000; ++value)
+		{
+			wchar_t buffer[TIME_STR_SIZE];
+			formatTime(buffer, TIME_STR_SIZE, value, MILLISECONDS);
+			int tenths = (value + 50) / 100;
+			std::wstring expected = tenths < 100 && tenths % 10 != 0 ? expectedTenths(words, tenths) : expectedDuration(words, (value + 500) / 1000);
+			if (expected != buffer && mismatches++ < 10)
+				fprintf(stderr, "%s, %d ms: '%ls' instead of '%ls'\n", lang, value, buffer, expected.c_str());
+		}
+		CHECK(mismatches == 0);
+
+		DeleteLanguagePack();
+	}
+}
+
+int main()
+{
+	wxInitializer initializer;
+
+	if (!wxDirExists(L"Langpacks"))
+		wxMkdir(L"Langpacks");
+
+	checkLanguage("en", englishForm, L".", FORM_MANY);
+	checkLanguage("ru", russianForm, L",", FORM_FEW);
+
+	wxRemoveFile(L"Langpacks/langpack.en.xml");
+	wxRemoveFile(L"Langpacks/langpack.ru.xml");
+	return checkResult();
+}
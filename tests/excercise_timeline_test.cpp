@@ -0,0 +1,194 @@
+// ExcerciseTimeline::FindKeyframe: looping, a frame held until the end, an empty timeline.
+// The leopard's animations.xml is played against the switch that animated the excercises
+// before, which stepped every 100 ms.
+
+#include "check.h"
+#include "excercise_timeline.h"
+#include "wx/init.h"
+
+namespace
+{
+	ExcerciseTimeline makeTimeline(long const * holds, size_t count, size_t loop)
+	{
+		ExcerciseTimeline timeline;
+		for (size_t i = 0; i < count; ++i)
+		{
+			Keyframe key;
+			key.frame = (int)i;
+			key.hold = holds[i];
+			timeline.frames.push_back(key);
+		}
+		timeline.loop = loop;
+		return timeline;
+	}
+
+	bool keyframeAt(ExcerciseTimeline const & timeline, long time, size_t expected, long expectedLeft)
+	{
+		long left = 0;
+		size_t key = timeline.FindKeyframe(time, left);
+		if (key == expected && left == expectedLeft)
+			return true;
+		fprintf(stderr, "at %ld ms: keyframe %d, %ld ms left instead of %d, %ld ms\n", time, (int)key, left, (int)expected, expectedLeft);
+		return false;
+	}
+
+	// ExcerciseAnim::Update as it was, called by a 100 ms timer
+	class OldAnim
+	{
+	public:
+		OldAnim(int excercise) : _excercise(excercise), _state(0), _time(400)
+		{
+			_frame = excercise == EXCERCISE_WINDOW ? FRAME_WINDOW : FRAME_DEFAULT;
+		}
+
+		int GetFrame() const { return _frame; }
+
+		void Update()
+		{
+			if (_excercise == EXCERCISE_WINDOW)
+				return;
+
+			_time -= 100;
+			if (_time > 0)
+				return;
+
+			switch (_excercise)
+			{
+			case EXCERCISE_LOOK_HORZ:
+				_frame = _state ? FRAME_LOOK_LEFT : FRAME_LOOK_RIGHT;
+				_state = _state == 1 ? 0 : 1;
+				_time = 1200;
+				break;
+			case EXCERCISE_LOOK_VERT:
+				_frame = _state ? FRAME_LOOK_UP : FRAME_LOOK_DOWN;
+				_state = _state == 1 ? 0 : 1;
+				_time = 1200;
+				break;
+			case EXCERCISE_ROLL:
+				{
+					const int frames[] = { FRAME_LOOK_LEFT, FRAME_LOOK_UP, FRAME_LOOK_RIGHT, FRAME_LOOK_DOWN };
+					_frame = frames[_state];
+					if (++_state == 4)
+						_state = 0;
+					_time = 1200;
+				}
+				break;
+			case EXCERCISE_BLINK:
+				_frame = _state ? FRAME_BLINK : FRAME_DEFAULT;
+				_state = _state == 1 ? 0 : 1;
+				_time = 200;
+				break;
+			case EXCERCISE_CLOSE_TIGHTLY:
+				_frame = _state ? FRAME_CLOSE_TIGHTLY : FRAME_DEFAULT;
+				_state = _state == 1 ? 0 : 1;
+				_time = 2000;
+				break;
+			}
+		}
+
+	private:
+		int _excercise;
+		int _state;
+		long _time;
+		int _frame;
+	};
+
+	void checkLoop()
+	{
+		const long holds[] = { 100, 200, 300 };
+
+		// the first frame once, then the other two over and over
+		ExcerciseTimeline timeline = makeTimeline(holds, 3, 1);
+		CHECK(keyframeAt(timeline, 0, 0, 100));
+		CHECK(keyframeAt(timeline, 99, 0, 1));
+		CHECK(keyframeAt(timeline, 100, 1, 200));
+		CHECK(keyframeAt(timeline, 300, 2, 300));
+		CHECK(keyframeAt(timeline, 599, 2, 1));
+		CHECK(keyframeAt(timeline, 600, 1, 200));
+		CHECK(keyframeAt(timeline, 800, 2, 300));
+		CHECK(keyframeAt(timeline, 100 + 500 * 1000 + 250, 2, 250));
+
+		// everything repeats
+		timeline = makeTimeline(holds, 3, 0);
+		CHECK(keyframeAt(timeline, 600, 0, 100));
+		CHECK(keyframeAt(timeline, 650, 0, 50));
+		CHECK(keyframeAt(timeline, 1199, 2, 1));
+		CHECK(keyframeAt(timeline, 1200, 0, 100));
+
+		// without a loop the last frame stays
+		timeline = makeTimeline(holds, 3, 3);
+		CHECK(keyframeAt(timeline, 599, 2, 1));
+		CHECK(keyframeAt(timeline, 600, 2, -1));
+		CHECK(keyframeAt(timeline, 1000000, 2, -1));
+	}
+
+	void checkTerminalFrame()
+	{
+		// hold="0" stays until the end, the loop never comes
+		const long holds[] = { 100, 0, 300 };
+		ExcerciseTimeline timeline = makeTimeline(holds, 3, 0);
+		CHECK(keyframeAt(timeline, 0, 0, 100));
+		CHECK(keyframeAt(timeline, 100, 1, -1));
+		CHECK(keyframeAt(timeline, 1000000, 1, -1));
+
+		const long single[] = { 0 };
+		timeline = makeTimeline(single, 1, 0);
+		CHECK(keyframeAt(timeline, 0, 0, -1));
+		CHECK(keyframeAt(timeline, 5000, 0, -1));
+	}
+
+	void checkEmpty()
+	{
+		ExcerciseTimeline timeline;
+		CHECK(keyframeAt(timeline, 0, 0, -1));
+		CHECK(keyframeAt(timeline, 1000, 0, -1));
+
+		timeline.loop = 3; // as set for a file without frames
+		CHECK(keyframeAt(timeline, 1000, 0, -1));
+	}
+
+	void checkOldTimings()
+	{
+		ExcerciseTimeline timelines[NUM_EXCERCISES + 1];
+		CHECK(LoadExcerciseTimelines(EYELEO_BIN_FOLDER "Personages/leopard/animations.xml", timelines));
+
+		for (int excercise = EXCERCISE_ROLL; excercise <= EXCERCISE_WINDOW; ++excercise)
+		{
+			ExcerciseTimeline const & timeline = timelines[excercise];
+			CHECK(!timeline.frames.empty());
+			if (timeline.frames.empty())
+				continue;
+
+			// a minute of ticks, the old frame stays until the next tick
+			OldAnim old(excercise);
+			int mismatches = 0;
+			for (long time = 0; time < 60 * 1000; time += 100)
+			{
+				if (time > 0)
+					old.Update();
+
+				long left;
+				long times[] = { time, time + 50, time + 99 };
+				for (size_t i = 0; i < sizeof(times) / sizeof(times[0]); ++i)
+				{
+					int frame = timeline.frames[timeline.FindKeyframe(times[i], left)].frame;
+					if (frame != old.GetFrame() && mismatches++ < 5)
+						fprintf(stderr, "excercise %d at %ld ms: frame %d instead of %d\n", excercise, times[i], frame, old.GetFrame());
+				}
+			}
+			CHECK(mismatches == 0);
+		}
+	}
+}
+
+int main()
+{
+	wxInitializer initializer;
+
+	checkLoop();
+	checkTerminalFrame();
+	checkEmpty();
+	checkOldTimings();
+
+	return checkResult();
+}
@@ -0,0 +1,196 @@
+// Per-application exclusion rules: names compared case-insensitively, path prefixes with
+// either slash, the strictest matching rule, exclusions.xml. Then made-up foreground
+// windows go through FullscreenTracker, as the WinEvent hooks would send them.
+
+#include "check.h"
+#include "exclusion_rules.h"
+#include "fullscreen_tracker.h"
+#include "oscapabilities.h"
+#include "wx/init.h"
+#include <stdio.h>
+
+namespace
+{
+	bool policyOf(ExclusionRules const & rules, const char * exePath, const char * windowClass, BreakPolicy expected)
+	{
+		BreakPolicy policy = rules.Evaluate(exePath, windowClass);
+		if (policy == expected)
+			return true;
+		fprintf(stderr, "%s, %s: policy %d instead of %d\n", exePath, windowClass, (int)policy, (int)expected);
+		return false;
+	}
+
+	void checkNames()
+	{
+		ExclusionRules rules;
+		CHECK(policyOf(rules, "C:\\Program Files\\Zoom\\bin\\Zoom.exe", "", POLICY_ALL_BREAKS));
+
+		rules.Add(EXCLUDE_EXE_NAME, "zoom.exe", POLICY_NO_BREAKS);
+		rules.Add(EXCLUDE_WINDOW_CLASS, "screenClass", POLICY_MINI_PAUSES_ONLY);
+		rules.Add(EXCLUDE_EXE_NAME, "", POLICY_NO_BREAKS);
+		CHECK(rules.GetCount() == 2);
+
+		CHECK(policyOf(rules, "C:\\Program Files\\Zoom\\bin\\Zoom.exe", "", POLICY_NO_BREAKS));
+		CHECK(policyOf(rules, "C:/Program Files/Zoom/bin/ZOOM.EXE", "", POLICY_NO_BREAKS));
+		CHECK(policyOf(rules, "zoom.exe", "", POLICY_NO_BREAKS));
+		// only the whole file name
+		CHECK(policyOf(rules, "C:\\Tools\\notzoom.exe", "", POLICY_ALL_BREAKS));
+		CHECK(policyOf(rules, "C:\\zoom.exe\\app.exe", "", POLICY_ALL_BREAKS));
+
+		CHECK(policyOf(rules, "C:\\Windows\\scrnsave.scr", "ScreenClass", POLICY_MINI_PAUSES_ONLY));
+		CHECK(policyOf(rules, "C:\\Windows\\scrnsave.scr", "screenClass2", POLICY_ALL_BREAKS));
+		CHECK(policyOf(rules, "", "", POLICY_ALL_BREAKS));
+
+		rules.Clear();
+		CHECK(rules.GetCount() == 0);
+		CHECK(policyOf(rules, "C:\\Program Files\\Zoom\\bin\\Zoom.exe", "", POLICY_ALL_BREAKS));
+	}
+
+	void checkPrefixes()
+	{
+		ExclusionRules rules;
+		rules.Add(EXCLUDE_PATH_PREFIX, "C:\\Program Files\\JetBrains\\", POLICY_MINI_PAUSES_ONLY);
+		rules.Add(EXCLUDE_PATH_PREFIX, "c:/program files/jetbrains/clion/", POLICY_NO_BREAKS);
+		rules.Add(EXCLUDE_PATH_PREFIX, "D:\\Games", POLICY_NO_BREAKS);
+
+		CHECK(policyOf(rules, "C:\\Program Files\\JetBrains\\IDEA\\bin\\idea64.exe", "", POLICY_MINI_PAUSES_ONLY));
+		CHECK(policyOf(rules, "C:\\Program Files\\JetBrains\\CLion\\bin\\clion64.exe", "", POLICY_NO_BREAKS));
+		CHECK(policyOf(rules, "C:\\Program Files\\JetBrain.exe", "", POLICY_ALL_BREAKS));
+		CHECK(policyOf(rules, "C:\\Program Files\\", "", POLICY_ALL_BREAKS));
+		// a prefix isn't cut at the directories
+		CHECK(policyOf(rules, "D:\\GamesOld\\old.exe", "", POLICY_NO_BREAKS));
+		CHECK(policyOf(rules, "E:\\Games\\game.exe", "", POLICY_ALL_BREAKS));
+	}
+
+	void checkStrictest()
+	{
+		ExclusionRules rules;
+		rules.Add(EXCLUDE_EXE_NAME, "game.exe", POLICY_MINI_PAUSES_ONLY);
+		rules.Add(EXCLUDE_EXE_NAME, "GAME.exe", POLICY_NO_BREAKS);
+		rules.Add(EXCLUDE_EXE_NAME, "game.exe", POLICY_ALL_BREAKS);
+		rules.Add(EXCLUDE_EXE_NAME, "editor.exe", POLICY_MINI_PAUSES_ONLY);
+		rules.Add(EXCLUDE_PATH_PREFIX, "C:\\Tools\\", POLICY_NO_BREAKS);
+		rules.Add(EXCLUDE_WINDOW_CLASS, "Presentation", POLICY_NO_BREAKS);
+
+		CHECK(policyOf(rules, "D:\\game.exe", "", POLICY_NO_BREAKS));
+		CHECK(policyOf(rules, "D:\\editor.exe", "", POLICY_MINI_PAUSES_ONLY));
+		CHECK(policyOf(rules, "C:\\Tools\\editor.exe", "", POLICY_NO_BREAKS));
+		CHECK(policyOf(rules, "D:\\editor.exe", "Presentation", POLICY_NO_BREAKS));
+	}
+
+	void checkLoad()
+	{
+		const char * path = "exclusions_test.xml";
+		FILE * file = fopen(path, "w");
+		CHECK(file != 0);
+		if (!file)
+			return;
+		fputs("<?xml version=\"1.0\"?>\n"
+			"<exclusions>\n"
+			"\t<rule exe=\"zoom.exe\" policy=\"no_breaks\"/>\n"
+			"\t<rule path=\"C:\\Program Files\\JetBrains\\\" policy=\"mini_pauses_only\"/>\n"
+			"\t<rule class=\"screenClass\" policy=\"no_breaks\"/>\n"
+			"\t<rule exe=\"slides.exe\" class=\"Slideshow\" policy=\"mini_pauses_only\"/>\n"
+			"\t<rule exe=\"unknown.exe\" policy=\"sometimes\"/>\n"
+			"\t<rule exe=\"free.exe\" policy=\"all_breaks\"/>\n"
+			"</exclusions>\n", file);
+		fclose(file);
+
+		ExclusionRules rules;
+		rules.Add(EXCLUDE_EXE_NAME, "old.exe", POLICY_NO_BREAKS);
+		CHECK(rules.Load(path));
+		CHECK(rules.GetCount() == 6);
+		CHECK(policyOf(rules, "C:\\old.exe", "", POLICY_ALL_BREAKS));
+		CHECK(policyOf(rules, "C:\\Zoom\\zoom.exe", "", POLICY_NO_BREAKS));
+		CHECK(policyOf(rules, "C:\\Program Files\\JetBrains\\IDEA\\idea64.exe", "", POLICY_MINI_PAUSES_ONLY));
+		CHECK(policyOf(rules, "C:\\scr.exe", "screenclass", POLICY_NO_BREAKS));
+		CHECK(policyOf(rules, "C:\\slides.exe", "", POLICY_MINI_PAUSES_ONLY));
+		CHECK(policyOf(rules, "C:\\other.exe", "Slideshow", POLICY_MINI_PAUSES_ONLY));
+		CHECK(policyOf(rules, "C:\\unknown.exe", "", POLICY_ALL_BREAKS));
+		remove(path);
+
+		// a missing file leaves no rules
+		CHECK(!rules.Load(path));
+		CHECK(rules.GetCount() == 0);
+		CHECK(policyOf(rules, "C:\\Zoom\\zoom.exe", "", POLICY_ALL_BREAKS));
+	}
+
+	ForegroundWindow makeWindow(void * handle, const char * exePath, const char * className)
+	{
+		ForegroundWindow wnd;
+		wnd.handle = handle;
+		wnd.visible = true;
+		wnd.rect = wxRect(100, 100, 800, 600);
+		wnd.exePath = exePath;
+		wnd.className = className;
+		return wnd;
+	}
+
+	// The policy follows the foreground window, location events keep it
+	void checkWindowEvents()
+	{
+		std::vector<DisplayData> displays(1);
+		displays[0].primary = true;
+		displays[0].geometry = wxRect(0, 0, 1920, 1080);
+		displays[0].clientArea = wxRect(0, 0, 1920, 1040);
+		FixedDisplayTopology topology(displays);
+		setDisplayTopologyProvider(&topology);
+
+		ExclusionRules rules;
+		rules.Add(EXCLUDE_EXE_NAME, "zoom.exe", POLICY_NO_BREAKS);
+		rules.Add(EXCLUDE_PATH_PREFIX, "C:\\Program Files\\JetBrains\\", POLICY_MINI_PAUSES_ONLY);
+
+		FullscreenTracker tracker;
+		tracker.UseEventsOnly();
+		tracker.SetRules(&rules);
+
+		void * const zoom = (void *)0x10;
+		void * const idea = (void *)0x20;
+		void * const notepad = (void *)0x30;
+
+		tracker.OnForegroundChanged(makeWindow(notepad, "C:\\Windows\\notepad.exe", "Notepad"));
+		CHECK(tracker.GetPolicy() == POLICY_ALL_BREAKS);
+
+		tracker.OnForegroundChanged(makeWindow(zoom, "C:\\Users\\me\\AppData\\Roaming\\Zoom\\bin\\Zoom.exe", "ZPContentViewWndClass"));
+		CHECK(tracker.GetPolicy() == POLICY_NO_BREAKS);
+
+		// a meeting shared fullscreen, still excluded
+		ForegroundWindow shared = makeWindow(zoom, "", "");
+		shared.rect = displays[0].geometry;
+		tracker.OnWindowChanged(shared);
+		CHECK(tracker.GetPolicy() == POLICY_NO_BREAKS);
+		CHECK(tracker.IsFullscreen());
+
+		// a background window moving doesn't change it
+		tracker.OnWindowChanged(makeWindow(notepad, "C:\\Windows\\notepad.exe", "Notepad"));
+		CHECK(tracker.GetPolicy() == POLICY_NO_BREAKS);
+
+		tracker.OnForegroundChanged(makeWindow(idea, "C:\\Program Files\\JetBrains\\IDEA\\bin\\idea64.exe", "SunAwtFrame"));
+		CHECK(tracker.GetPolicy() == POLICY_MINI_PAUSES_ONLY);
+		CHECK(!tracker.IsFullscreen());
+
+		// the rules reloaded while the window stays
+		rules.Clear();
+		rules.Add(EXCLUDE_WINDOW_CLASS, "SunAwtFrame", POLICY_NO_BREAKS);
+		tracker.SetRules(&rules);
+		CHECK(tracker.GetPolicy() == POLICY_NO_BREAKS);
+
+		// the desktop in the foreground, nothing to exclude
+		tracker.OnForegroundChanged(ForegroundWindow());
+		CHECK(tracker.GetPolicy() == POLICY_ALL_BREAKS);
+		CHECK(!tracker.IsFullscreen());
+	}
+}
+
+int main()
+{
+	wxInitializer initializer;
+
+	checkNames();
+	checkPrefixes();
+	checkStrictest();
+	checkLoad();
+	checkWindowEvents();
+
+	return checkResult();
+}
@@ -0,0 +1,226 @@
+// FullscreenTracker fed with made-up window events, as the WinEvent hooks would send them:
+// foreground and location changes, minimizing, destroying, the displays changing under
+// a window that stays. The displays come from FixedDisplayTopology, no hooks are set.
+
+#include "check.h"
+#include "fullscreen_tracker.h"
+#include "oscapabilities.h"
+#include "wx/init.h"
+
+namespace
+{
+	// The handles are only compared
+	void * const GAME = (void *)0x10;
+	void * const EDITOR = (void *)0x20;
+	void * const DESKTOP = (void *)0x30;
+
+	// 1920x1080 on the left, 2560x1440 the primary on the right
+	std::vector<DisplayData> makeDisplays()
+	{
+		std::vector<DisplayData> displays(2);
+		displays[0].primary = false;
+		displays[0].geometry = wxRect(-1920, 0, 1920, 1080);
+		displays[0].clientArea = wxRect(-1920, 0, 1920, 1040);
+		displays[1].primary = true;
+		displays[1].geometry = wxRect(0, 0, 2560, 1440);
+		displays[1].clientArea = wxRect(0, 0, 2560, 1400);
+		return displays;
+	}
+
+	ForegroundWindow makeWindow(void * handle, wxRect const & rect, wxString const & exePath = wxString())
+	{
+		ForegroundWindow wnd;
+		wnd.handle = handle;
+		wnd.visible = true;
+		wnd.rect = rect;
+		wnd.exePath = exePath;
+		return wnd;
+	}
+
+	bool fullscreenOn(FullscreenTracker & tracker, int expected, void * expectedHandle = 0)
+	{
+		int display = -1;
+		void * handle = 0;
+		bool fullscreen = tracker.IsFullscreen(&display, &handle);
+		if (expected < 0 ? !fullscreen : fullscreen && display == expected && handle == expectedHandle)
+			return true;
+		fprintf(stderr, "fullscreen %d on display %d, expected display %d\n", (int)fullscreen, display, expected);
+		return false;
+	}
+
+	void checkForeground(FullscreenTracker & tracker)
+	{
+		tracker.OnForegroundChanged(ForegroundWindow());
+		CHECK(fullscreenOn(tracker, -1));
+
+		tracker.OnForegroundChanged(makeWindow(GAME, wxRect(0, 0, 2560, 1440)));
+		CHECK(fullscreenOn(tracker, 1, GAME));
+
+		tracker.OnForegroundChanged(makeWindow(EDITOR, wxRect(100, 100, 800, 600)));
+		CHECK(fullscreenOn(tracker, -1));
+
+		tracker.OnForegroundChanged(makeWindow(GAME, wxRect(-1920, 0, 1920, 1080)));
+		CHECK(fullscreenOn(tracker, 0, GAME));
+
+		// the desktop covers the displays too
+		ForegroundWindow desktop = makeWindow(DESKTOP, wxRect(0, 0, 2560, 1440));
+		desktop.shell = true;
+		tracker.OnForegroundChanged(desktop);
+		CHECK(fullscreenOn(tracker, -1));
+
+		// a window a pixel short of the display, or spanning both of them
+		tracker.OnForegroundChanged(makeWindow(EDITOR, wxRect(0, 0, 2560, 1439)));
+		CHECK(fullscreenOn(tracker, -1));
+		tracker.OnForegroundChanged(makeWindow(EDITOR, wxRect(-1920, 0, 4480, 1440)));
+		CHECK(fullscreenOn(tracker, -1));
+	}
+
+	void checkLocation(FullscreenTracker & tracker)
+	{
+		tracker.OnForegroundChanged(makeWindow(EDITOR, wxRect(100, 100, 800, 600)));
+		CHECK(fullscreenOn(tracker, -1));
+
+		// maximized to borderless fullscreen, then moved to the other display
+		tracker.OnWindowChanged(makeWindow(EDITOR, wxRect(0, 0, 2560, 1440)));
+		CHECK(fullscreenOn(tracker, 1, EDITOR));
+		tracker.OnWindowChanged(makeWindow(EDITOR, wxRect(-1920, 0, 1920, 1080)));
+		CHECK(fullscreenOn(tracker, 0, EDITOR));
+
+		// another window moving in the background doesn't count
+		tracker.OnWindowChanged(makeWindow(GAME, wxRect(0, 0, 2560, 1440)));
+		CHECK(fullscreenOn(tracker, 0, EDITOR));
+		tracker.OnWindowChanged(makeWindow(GAME, wxRect(10, 10, 20, 20)));
+		CHECK(fullscreenOn(tracker, 0, EDITOR));
+
+		// events without a window are dropped
+		tracker.OnWindowChanged(ForegroundWindow());
+		CHECK(fullscreenOn(tracker, 0, EDITOR));
+
+		tracker.OnWindowChanged(makeWindow(EDITOR, wxRect(100, 100, 800, 600)));
+		CHECK(fullscreenOn(tracker, -1));
+	}
+
+	void checkMinimize(FullscreenTracker & tracker)
+	{
+		tracker.OnForegroundChanged(makeWindow(GAME, wxRect(0, 0, 2560, 1440)));
+		CHECK(fullscreenOn(tracker, 1, GAME));
+
+		// minimized windows keep a rect of their own, the iconic state is what counts
+		ForegroundWindow minimized = makeWindow(GAME, wxRect(0, 0, 2560, 1440));
+		minimized.iconic = true;
+		tracker.OnWindowChanged(minimized);
+		CHECK(fullscreenOn(tracker, -1));
+
+		tracker.OnWindowChanged(makeWindow(GAME, wxRect(0, 0, 2560, 1440)));
+		CHECK(fullscreenOn(tracker, 1, GAME));
+
+		ForegroundWindow hidden = makeWindow(GAME, wxRect(0, 0, 2560, 1440));
+		hidden.visible = false;
+		tracker.OnWindowChanged(hidden);
+		CHECK(fullscreenOn(tracker, -1));
+	}
+
+	void checkDestroy(FullscreenTracker & tracker)
+	{
+		tracker.OnForegroundChanged(makeWindow(GAME, wxRect(-1920, 0, 1920, 1080)));
+		CHECK(fullscreenOn(tracker, 0, GAME));
+
+		// a destroyed window is described as invisible and without a rect
+		ForegroundWindow destroyed;
+		destroyed.handle = GAME;
+		tracker.OnWindowChanged(destroyed);
+		CHECK(fullscreenOn(tracker, -1));
+
+		// nothing is in the foreground until the next window gets it
+		tracker.OnForegroundChanged(ForegroundWindow());
+		CHECK(fullscreenOn(tracker, -1));
+		tracker.OnWindowChanged(makeWindow(GAME, wxRect(-1920, 0, 1920, 1080)));
+		CHECK(fullscreenOn(tracker, -1));
+	}
+
+	void checkTopology(FullscreenTracker & tracker, FixedDisplayTopology & topology)
+	{
+		std::vector<DisplayData> displays = makeDisplays();
+		tracker.OnForegroundChanged(makeWindow(GAME, wxRect(0, 0, 2560, 1440)));
+		CHECK(fullscreenOn(tracker, 1, GAME));
+
+		// the resolution of the display goes down, the window stays as it was
+		displays[1].geometry = wxRect(0, 0, 1920, 1080);
+		topology.SetDisplays(displays);
+		CHECK(fullscreenOn(tracker, 1, GAME));
+		invalidateDisplayTopology();
+		CHECK(fullscreenOn(tracker, -1));
+
+		// and the window follows it without an event of its own
+		displays[1].geometry = wxRect(0, 0, 2560, 1440);
+		topology.SetDisplays(displays);
+		invalidateDisplayTopology();
+		CHECK(fullscreenOn(tracker, 1, GAME));
+
+		// a display plugged in on the left, the window covers the second one now
+		DisplayData added;
+		added.primary = false;
+		added.geometry = wxRect(-3840, 0, 1920, 1080);
+		added.clientArea = added.geometry;
+		displays.insert(displays.begin(), added);
+		topology.SetDisplays(displays);
+		invalidateDisplayTopology();
+		CHECK(fullscreenOn(tracker, 2, GAME));
+
+		// unplugged
+		topology.SetDisplays(std::vector<DisplayData>(1, displays[0]));
+		invalidateDisplayTopology();
+		CHECK(fullscreenOn(tracker, -1));
+
+		topology.SetDisplays(makeDisplays());
+		invalidateDisplayTopology();
+		CHECK(fullscreenOn(tracker, 1, GAME));
+	}
+
+	void checkPolicy(FullscreenTracker & tracker)
+	{
+		ExclusionRules rules;
+		rules.Add(EXCLUDE_EXE_NAME, "game.exe", POLICY_NO_BREAKS);
+		rules.Add(EXCLUDE_PATH_PREFIX, "C:\\Tools\\", POLICY_MINI_PAUSES_ONLY);
+
+		tracker.OnForegroundChanged(makeWindow(GAME, wxRect(0, 0, 2560, 1440), "C:\\Games\\Game.exe"));
+		CHECK(tracker.GetPolicy() == POLICY_ALL_BREAKS);
+
+		// the foreground window is evaluated right away
+		tracker.SetRules(&rules);
+		CHECK(tracker.GetPolicy() == POLICY_NO_BREAKS);
+
+		// location events don't identify the window again, the policy stays
+		tracker.OnWindowChanged(makeWindow(GAME, wxRect(100, 100, 800, 600)));
+		CHECK(tracker.GetPolicy() == POLICY_NO_BREAKS);
+		CHECK(fullscreenOn(tracker, -1));
+
+		tracker.OnForegroundChanged(makeWindow(EDITOR, wxRect(100, 100, 800, 600), "C:\\Tools\\editor.exe"));
+		CHECK(tracker.GetPolicy() == POLICY_MINI_PAUSES_ONLY);
+		tracker.OnForegroundChanged(ForegroundWindow());
+		CHECK(tracker.GetPolicy() == POLICY_ALL_BREAKS);
+
+		tracker.OnForegroundChanged(makeWindow(GAME, wxRect(0, 0, 2560, 1440), "C:\\Games\\Game.exe"));
+		tracker.SetRules(0);
+		CHECK(tracker.GetPolicy() == POLICY_ALL_BREAKS);
+	}
+}
+
+int main()
+{
+	wxInitializer initializer;
+
+	FixedDisplayTopology topology(makeDisplays());
+	setDisplayTopologyProvider(&topology);
+
+	FullscreenTracker tracker;
+	tracker.UseEventsOnly();
+	checkForeground(tracker);
+	checkLocation(tracker);
+	checkMinimize(tracker);
+	checkDestroy(tracker);
+	checkTopology(tracker, topology);
+	checkPolicy(tracker);
+
+	return checkResult();
+}
@@ -0,0 +1,121 @@
+// Records written with the logging macros, decoded the way tools/log-decoder does
+
+#include "check.h"
+#include "logging.h"
+#include "log_decoder.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+namespace
+{
+	class Collector : public LogVisitor
+	{
+	public:
+		Collector() : sessions(0) {}
+
+		virtual void OnSession(int64_t)
+		{
+			++sessions;
+		}
+
+		virtual void OnEntry(int64_t, uint16_t, Site const * site, std::vector<Arg> const & args)
+		{
+			levels.push_back(site ? site->level : -1);
+			messages.push_back(site ? formatMessage(site->fmt, args) : std::string("<unknown site>"));
+		}
+
+		int sessions;
+		std::vector<int> levels;
+		std::vector<std::string> messages;
+	};
+
+	std::string format(const char * fmt, ...)
+	{
+		char buf[256];
+		va_list args;
+		va_start(args, fmt);
+		vsnprintf(buf, sizeof(buf), fmt, args);
+		va_end(args);
+		return buf;
+	}
+
+	bool readFile(const char * path, std::vector<char> & data)
+	{
+		FILE * file = fopen(path, "rb");
+		if (!file)
+			return false;
+
+		char chunk[4096];
+		size_t got;
+		while ((got = fread(chunk, 1, sizeof(chunk), file)) > 0)
+			data.insert(data.end(), chunk, chunk + got);
+		fclose(file);
+		return true;
+	}
+}
+
+int main()
+{
+	remove("log.bin");
+	logging::Init();
+
+	int dummy = 0;
+	std::string longText(3000, 'x');
+
+	for (long i = 0; i < 3; ++i)
+		LOG_INFO("State: Idle: _timeLeftToBigPause=%ld, _timeLeftToMiniPause=%d", 60000 * i, (int)-i);
+	LOG_WARNING("%s is %d%% done, %.2f s left", "Saving", 42, 1.5);
+	LOG_ERROR("unsigned %u, hex %x, padded [%5d], text %s", 7u, 255u, 12, wxString(L"\x041f\x0440\x0438\x0432\x0435\x0442"));
+	LOG_INFO("wide %s, pointer %p", L"text", (const void *)&dummy);
+	LOG_DEBUG("debug %d", 1);
+	LOG_INFO("%s", longText.c_str());
+	logging::msg(L"plain message");
+	logging::Flush();
+
+	std::vector<std::string> expected;
+	std::vector<int> expectedLevels;
+	for (long i = 0; i < 3; ++i)
+	{
+		expected.push_back(format("State: Idle: _timeLeftToBigPause=%ld, _timeLeftToMiniPause=%d", 60000 * i, (int)-i));
+		expectedLevels.push_back(logformat::LEVEL_INFO);
+	}
+	expected.push_back(format("%s is %d%% done, %.2f s left", "Saving", 42, 1.5));
+	expectedLevels.push_back(logformat::LEVEL_WARNING);
+	expected.push_back(format("unsigned %u, hex %x, padded [%5d], text %s", 7u, 255u, 12, "\xD0\x9F\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82"));
+	expectedLevels.push_back(logformat::LEVEL_ERROR);
+	expected.push_back(format("wide text, pointer 0x%llx", (unsigned long long)(uintptr_t)&dummy));
+	expectedLevels.push_back(logformat::LEVEL_INFO);
+#if EYELEO_LOG_LEVEL <= LOG_LEVEL_DEBUG
+	expected.push_back("debug 1");
+	expectedLevels.push_back(logformat::LEVEL_DEBUG);
+#endif
+	expected.push_back(std::string(logformat::kMaxStringArg, 'x'));
+	expectedLevels.push_back(logformat::LEVEL_INFO);
+	expected.push_back("plain message");
+	expectedLevels.push_back(logformat::LEVEL_INFO);
+
+	std::vector<char> data;
+	CHECK(readFile("log.bin", data));
+
+	Collector collector;
+	CHECK(decodeLog(data, collector) == DECODE_OK);
+	CHECK(collector.sessions == 1);
+	CHECK(collector.messages.size() == expected.size());
+	for (size_t i = 0; i < expected.size() && i < collector.messages.size(); ++i)
+	{
+		if (collector.messages[i] != expected[i])
+			fprintf(stderr, "record %d: '%s', expected '%s'\n", (int)i, collector.messages[i].c_str(), expected[i].c_str());
+		CHECK(collector.messages[i] == expected[i]);
+		CHECK(collector.levels[i] == expectedLevels[i]);
+	}
+
+	// the process may die in the middle of a record, the ones before it are still read
+	data.resize(data.size() - 3);
+	Collector truncated;
+	CHECK(decodeLog(data, truncated) == DECODE_OK);
+	CHECK(truncated.messages.size() == expected.size() - 1);
+
+	return checkResult();
+}
@@ -0,0 +1,223 @@
+// Frames of a popup rendered without a window: a background, images and sprites cut by
+// the edges, and text masks. Checked against straight per-pixel blending, with every
+// instruction set, and when rendered again in parts through the clip.
+
+#include "check.h"
+#include "overlay_compositor.h"
+#include "pixel_kernels.h"
+#include <vector>
+
+using namespace pixelkernels;
+
+namespace
+{
+	uint32_t randomState = 2463534242u;
+
+	uint32_t nextRandom()
+	{
+		randomState ^= randomState << 13;
+		randomState ^= randomState >> 17;
+		randomState ^= randomState << 5;
+		return randomState;
+	}
+
+	uint32_t mulDiv255(uint32_t c, uint32_t a)
+	{
+		return (c * a + 127) / 255;
+	}
+
+	uint32_t channel(uint32_t pixel, int index)
+	{
+		return (pixel >> (index * 8)) & 0xFF;
+	}
+
+	uint32_t scaled(uint32_t pixel, uint32_t alpha)
+	{
+		uint32_t result = 0;
+		for (int i = 0; i < 4; ++i)
+			result |= mulDiv255(channel(pixel, i), alpha) << (i * 8);
+		return result;
+	}
+
+	uint32_t over(uint32_t dst, uint32_t src)
+	{
+		uint32_t inv = 255 - (src >> 24);
+		uint32_t result = 0;
+		for (int i = 0; i < 4; ++i)
+		{
+			uint32_t value = channel(src, i) + mulDiv255(channel(dst, i), inv);
+			result |= (value < 255 ? value : 255) << (i * 8);
+		}
+		return result;
+	}
+
+	// The frame as a plain array, drawn the slow way
+	struct Reference
+	{
+		int width, height;
+		std::vector<uint32_t> pixels;
+
+		Reference(int w, int h) : width(w), height(h), pixels((size_t)w * h, 0) {}
+
+		void Blend(int x, int y, uint32_t pixel)
+		{
+			if (x >= 0 && y >= 0 && x < width && y < height)
+				pixels[(size_t)y * width + x] = over(pixels[(size_t)y * width + x], pixel);
+		}
+	};
+
+	OverlayImage makeImage(int width, int height)
+	{
+		OverlayImage image;
+		image.width = width;
+		image.height = height;
+		image.pixels.resize((size_t)width * height);
+		for (size_t i = 0; i < image.pixels.size(); ++i)
+		{
+			uint32_t a = i % 5 == 0 ? 0 : (i % 5 == 1 ? 255 : nextRandom() & 0xFF);
+			image.pixels[i] = PremultipliedColor(nextRandom() & 0xFF, nextRandom() & 0xFF, nextRandom() & 0xFF, a);
+		}
+		return image;
+	}
+
+	struct Scene
+	{
+		uint32_t background;
+		OverlayImage picture; // drawn over the left and the top edge
+		OverlayImage atlas;
+		std::vector<uint8_t> glyphs; // a text mask over the right edge
+		int glyphsWidth, glyphsHeight;
+		uint32_t textColor;
+	};
+
+	const int WIDTH = 97;
+	const int HEIGHT = 61;
+
+	Scene makeScene()
+	{
+		Scene scene;
+		scene.background = PremultipliedColor(30, 60, 90, 200);
+		scene.picture = makeImage(40, 30);
+		scene.atlas = makeImage(64, 16);
+		scene.glyphsWidth = 45;
+		scene.glyphsHeight = 13;
+		scene.glyphs.resize((size_t)scene.glyphsWidth * scene.glyphsHeight);
+		for (size_t i = 0; i < scene.glyphs.size(); ++i)
+			scene.glyphs[i] = i % 7 < 2 ? 0 : (i % 7 == 2 ? 255 : (uint8_t)nextRandom());
+		scene.textColor = PremultipliedColor(255, 255, 255);
+		return scene;
+	}
+
+	void draw(OverlayCompositor & compositor, Scene const & scene)
+	{
+		compositor.FillRect(0, 0, WIDTH, HEIGHT, scene.background);
+		compositor.DrawImage(scene.picture, -7, -5);
+		compositor.DrawImage(scene.atlas, 16, 0, 16, 16, 50, 40); // the second sprite
+		compositor.DrawMask(&scene.glyphs[0], scene.glyphsWidth, scene.glyphsHeight, 70, 20, scene.textColor);
+
+		// nothing of these is in the frame
+		compositor.DrawImage(scene.picture, WIDTH, 0);
+		compositor.DrawMask(&scene.glyphs[0], scene.glyphsWidth, scene.glyphsHeight, 0, -scene.glyphsHeight, scene.textColor);
+		compositor.DrawMask(0, 10, 10, 0, 0, scene.textColor);
+		compositor.FillRect(10, 10, 0, 5, scene.textColor);
+	}
+
+	Reference drawReference(Scene const & scene)
+	{
+		Reference frame(WIDTH, HEIGHT);
+		for (int y = 0; y < HEIGHT; ++y)
+		{
+			for (int x = 0; x < WIDTH; ++x)
+				frame.Blend(x, y, scene.background);
+		}
+		for (int y = 0; y < scene.picture.height; ++y)
+		{
+			for (int x = 0; x < scene.picture.width; ++x)
+				frame.Blend(x - 7, y - 5, scene.picture.pixels[(size_t)y * scene.picture.width + x]);
+		}
+		for (int y = 0; y < 16; ++y)
+		{
+			for (int x = 0; x < 16; ++x)
+				frame.Blend(50 + x, 40 + y, scene.atlas.pixels[(size_t)y * scene.atlas.width + 16 + x]);
+		}
+		for (int y = 0; y < scene.glyphsHeight; ++y)
+		{
+			for (int x = 0; x < scene.glyphsWidth; ++x)
+				frame.Blend(70 + x, 20 + y, scaled(scene.textColor, scene.glyphs[(size_t)y * scene.glyphsWidth + x]));
+		}
+		return frame;
+	}
+
+	bool sameFrame(OverlayCompositor const & compositor, std::vector<uint32_t> const & pixels)
+	{
+		if ((size_t)compositor.GetWidth() * compositor.GetHeight() != pixels.size())
+			return false;
+		const uint32_t * frame = compositor.GetPixels();
+		for (size_t i = 0; i < pixels.size(); ++i)
+		{
+			if (frame[i] != pixels[i])
+			{
+				fprintf(stderr, "pixel %d, %d: %08x instead of %08x\n", (int)(i % WIDTH), (int)(i / WIDTH), frame[i], pixels[i]);
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void checkFrame(Scene const & scene, Reference const & reference)
+	{
+		OverlayCompositor compositor;
+		compositor.Resize(WIDTH, HEIGHT);
+		draw(compositor, scene);
+		CHECK(sameFrame(compositor, reference.pixels));
+
+		// parts rendered again over a frame that went stale, as when a countdown changes
+		int clips[][4] = { { 60, 15, 30, 20 }, { -5, -5, 20, 20 }, { 80, 50, 40, 40 }, { 0, 0, WIDTH, HEIGHT } };
+		for (size_t i = 0; i < sizeof(clips) / sizeof(clips[0]); ++i)
+		{
+			compositor.Clear();
+			draw(compositor, scene);
+
+			compositor.SetClip(clips[i][0], clips[i][1], clips[i][2], clips[i][3]);
+			compositor.FillRect(0, 0, WIDTH, HEIGHT, scene.textColor);
+			compositor.Clear();
+			draw(compositor, scene);
+			compositor.ResetClip();
+			CHECK(sameFrame(compositor, reference.pixels));
+		}
+
+		// Clear() of a clip leaves the rest alone
+		compositor.SetClip(10, 10, 5, 5);
+		compositor.Clear();
+		compositor.ResetClip();
+		CHECK(compositor.GetPixels()[10 * WIDTH + 10] == 0);
+		CHECK(compositor.GetPixels()[10 * WIDTH + 9] == reference.pixels[10 * WIDTH + 9]);
+		CHECK(compositor.GetPixels()[15 * WIDTH + 10] == reference.pixels[15 * WIDTH + 10]);
+	}
+}
+
+int main()
+{
+	EInstructionSet detected = GetInstructionSet();
+
+	Scene scene = makeScene();
+	Reference reference = drawReference(scene);
+
+	EInstructionSet sets[] = { ISA_SCALAR, ISA_SSE2, ISA_AVX2 };
+	for (size_t i = 0; i < sizeof(sets) / sizeof(sets[0]); ++i)
+	{
+		if (!UseInstructionSet(sets[i]))
+			continue;
+		printf("%s\n", GetInstructionSetName());
+		checkFrame(scene, reference);
+	}
+
+	// an empty frame has no pixels to draw into
+	OverlayCompositor empty;
+	empty.Resize(0, 10);
+	draw(empty, scene);
+	CHECK(empty.GetPixels() == 0);
+
+	UseInstructionSet(detected);
+	return checkResult();
+}
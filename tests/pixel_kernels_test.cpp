@@ -0,0 +1,271 @@
+// The SSE2 and AVX2 kernels give the same bits as the scalar ones: random pixels,
+// odd lengths and pointers that aren't aligned to the vector size.
+// The sets the CPU doesn't have are skipped.
+
+#include "check.h"
+#include "pixel_kernels.h"
+#include <string.h>
+#include <vector>
+
+using namespace pixelkernels;
+
+namespace
+{
+	uint32_t randomState = 2463534242u;
+
+	uint32_t nextRandom()
+	{
+		randomState ^= randomState << 13;
+		randomState ^= randomState >> 17;
+		randomState ^= randomState << 5;
+		return randomState;
+	}
+
+	const uint32_t KEY = 0x00FF00FF;
+
+	// Random colours with plenty of the values the kernels treat apart:
+	// transparent, opaque, the colour key and runs of them
+	uint32_t randomPixel()
+	{
+		uint32_t pixel = nextRandom();
+		switch (nextRandom() % 8)
+		{
+		case 0: return 0;
+		case 1: return pixel | 0xFF000000;
+		case 2: return pixel & 0x00FFFFFF;
+		case 3: return KEY | (pixel & 0xFF000000);
+		default: return pixel;
+		}
+	}
+
+	uint32_t premultiplied(uint32_t pixel)
+	{
+		uint32_t a = pixel >> 24;
+		uint32_t result = a << 24;
+		for (int shift = 0; shift < 24; shift += 8)
+		{
+			uint32_t c = (pixel >> shift) & 0xFF;
+			result |= (a ? c % (a + 1) : 0) << shift;
+		}
+		return result;
+	}
+
+	// count pixels starting offset pixels into the buffer, so the vectors start misaligned
+	struct Buffer
+	{
+		Buffer(size_t count, size_t offset) : storage(count + offset + 8), data(&storage[offset]) {}
+
+		std::vector<uint32_t> storage;
+		uint32_t * data;
+	};
+
+	std::vector<EInstructionSet> vectorSets()
+	{
+		std::vector<EInstructionSet> sets;
+		if (UseInstructionSet(ISA_SSE2))
+			sets.push_back(ISA_SSE2);
+		else
+			printf("SSE2 isn't supported, skipped\n");
+		if (UseInstructionSet(ISA_AVX2))
+			sets.push_back(ISA_AVX2);
+		else
+			printf("AVX2 isn't supported, skipped\n");
+		UseInstructionSet(ISA_SCALAR);
+		return sets;
+	}
+
+	bool same(const uint32_t * a, const uint32_t * b, size_t count)
+	{
+		return memcmp(a, b, count * sizeof(uint32_t)) == 0;
+	}
+
+	void checkPixelLoops(EInstructionSet set, size_t count, size_t offset)
+	{
+		Buffer src(count, offset), dst(count, (offset + 1) % 8);
+		Buffer expected(count, 0), actual(count, 0);
+		for (size_t i = 0; i < count; ++i)
+		{
+			src.data[i] = randomPixel();
+			dst.data[i] = randomPixel();
+		}
+
+		// Premultiply
+		memcpy(expected.data, src.data, count * sizeof(uint32_t));
+		memcpy(actual.data, src.data, count * sizeof(uint32_t));
+		UseInstructionSet(ISA_SCALAR);
+		Premultiply(expected.data, count);
+		UseInstructionSet(set);
+		Premultiply(actual.data, count);
+		CHECK(same(expected.data, actual.data, count));
+
+		// the rest works on premultiplied pixels
+		for (size_t i = 0; i < count; ++i)
+			src.data[i] = premultiplied(src.data[i]);
+
+		// ScaleAlpha, into another buffer and in place
+		unsigned int alphas[] = { 0, 1, 127, 128, 254, 255, 300, nextRandom() % 256 };
+		for (size_t a = 0; a < sizeof(alphas) / sizeof(alphas[0]); ++a)
+		{
+			UseInstructionSet(ISA_SCALAR);
+			ScaleAlpha(expected.data, src.data, count, alphas[a]);
+			UseInstructionSet(set);
+			ScaleAlpha(dst.data, src.data, count, alphas[a]);
+			CHECK(same(expected.data, dst.data, count));
+
+			memcpy(actual.data, src.data, count * sizeof(uint32_t));
+			ScaleAlpha(actual.data, actual.data, count, alphas[a]);
+			CHECK(same(expected.data, actual.data, count));
+		}
+
+		// BlendOver
+		for (size_t i = 0; i < count; ++i)
+			dst.data[i] = randomPixel();
+		memcpy(expected.data, dst.data, count * sizeof(uint32_t));
+		UseInstructionSet(ISA_SCALAR);
+		BlendOver(expected.data, src.data, count);
+		UseInstructionSet(set);
+		BlendOver(dst.data, src.data, count);
+		CHECK(same(expected.data, dst.data, count));
+
+		// BlendMask, with runs of no coverage as around glyphs
+		std::vector<uint8_t> coverageStorage(count + offset + 8);
+		uint8_t * coverage = &coverageStorage[offset];
+		for (size_t i = 0; i < count; ++i)
+			coverage[i] = (i / 8) % 3 == 0 ? 0 : (uint8_t)nextRandom();
+		uint32_t color = premultiplied(randomPixel());
+		memcpy(expected.data, dst.data, count * sizeof(uint32_t));
+		UseInstructionSet(ISA_SCALAR);
+		BlendMask(expected.data, coverage, count, color);
+		UseInstructionSet(set);
+		BlendMask(dst.data, coverage, count, color);
+		CHECK(same(expected.data, dst.data, count));
+
+		// ColorKeyToAlpha
+		for (size_t i = 0; i < count; ++i)
+			src.data[i] = randomPixel();
+		memcpy(expected.data, src.data, count * sizeof(uint32_t));
+		memcpy(actual.data, src.data, count * sizeof(uint32_t));
+		UseInstructionSet(ISA_SCALAR);
+		ColorKeyToAlpha(expected.data, count, KEY | 0x12000000);
+		UseInstructionSet(set);
+		ColorKeyToAlpha(actual.data, count, KEY | 0x12000000);
+		CHECK(same(expected.data, actual.data, count));
+
+		// FindSpans, on the mixed pixels and on long runs
+		for (int pass = 0; pass < 2; ++pass)
+		{
+			if (pass == 1)
+			{
+				for (size_t i = 0; i < count; )
+				{
+					size_t run = 1 + nextRandom() % 40;
+					uint32_t pixel = nextRandom() % 2 ? 0xFF000000 : 0x00FFFFFF;
+					for (; run > 0 && i < count; --run)
+						src.data[i++] = pixel;
+				}
+			}
+
+			std::vector<uint16_t> expectedBounds(count + 1, 0xFFFF), actualBounds(count + 1, 0xFFFF);
+			UseInstructionSet(ISA_SCALAR);
+			size_t expectedSpans = FindSpans(src.data, count, &expectedBounds[0]);
+			UseInstructionSet(set);
+			size_t actualSpans = FindSpans(src.data, count, &actualBounds[0]);
+			CHECK(expectedSpans == actualSpans);
+			CHECK(expectedBounds == actualBounds);
+		}
+	}
+
+	void checkBlur(EInstructionSet set, int width, int height, int radius)
+	{
+		size_t count = (size_t)width * height;
+		Buffer src(count, 1 + nextRandom() % 7);
+		for (size_t i = 0; i < count; ++i)
+			src.data[i] = nextRandom();
+
+		// BlurColumns of a column range, as the threads of Backdrop do
+		int first = width > 2 ? (int)(nextRandom() % (width / 2)) : 0;
+		int last = width - (width > 2 ? (int)(nextRandom() % (width / 2)) : 0);
+		Buffer expected(count, 0), actual(count, 3);
+		UseInstructionSet(ISA_SCALAR);
+		BlurColumns(src.data, expected.data, width, height, first, last, radius);
+		UseInstructionSet(set);
+		BlurColumns(src.data, actual.data, width, height, first, last, radius);
+		bool columnsMatch = true;
+		for (int y = 0; y < height; ++y)
+			columnsMatch = columnsMatch && same(expected.data + (size_t)y * width + first, actual.data + (size_t)y * width + first, last - first);
+		CHECK(columnsMatch);
+
+		// BoxBlur
+		memcpy(expected.data, src.data, count * sizeof(uint32_t));
+		memcpy(actual.data, src.data, count * sizeof(uint32_t));
+		UseInstructionSet(ISA_SCALAR);
+		BoxBlur(expected.data, width, height, radius);
+		UseInstructionSet(set);
+		BoxBlur(actual.data, width, height, radius);
+		CHECK(same(expected.data, actual.data, count));
+	}
+
+	void checkTranspose(int width, int height)
+	{
+		size_t count = (size_t)width * height;
+		std::vector<uint32_t> src(count), dst(count, 0);
+		for (size_t i = 0; i < count; ++i)
+			src[i] = nextRandom();
+
+		// in two row ranges, as the threads of Backdrop do
+		int middle = height / 3;
+		Transpose(&src[0], &dst[0], width, height, 0, middle);
+		Transpose(&src[0], &dst[0], width, height, middle, height);
+
+		bool transposed = true;
+		for (int y = 0; y < height; ++y)
+		{
+			for (int x = 0; x < width; ++x)
+				transposed = transposed && dst[(size_t)x * height + y] == src[(size_t)y * width + x];
+		}
+		CHECK(transposed);
+	}
+}
+
+int main()
+{
+	EInstructionSet detected = GetInstructionSet();
+	printf("Detected: %s\n", GetInstructionSetName());
+
+	CHECK(UseInstructionSet(ISA_SCALAR));
+	CHECK(GetInstructionSet() == ISA_SCALAR);
+
+	std::vector<EInstructionSet> sets = vectorSets();
+	for (size_t s = 0; s < sets.size(); ++s)
+	{
+		for (size_t count = 0; count <= 70; ++count)
+		{
+			for (size_t offset = 0; offset < 8; ++offset)
+				checkPixelLoops(sets[s], count, offset);
+		}
+		checkPixelLoops(sets[s], 1921, 3);
+		checkPixelLoops(sets[s], 4099, 1);
+
+		int sizes[] = { 1, 2, 3, 7, 8, 9, 17, 31, 33, 67 };
+		int radii[] = { 1, 2, 5, 16, 40, MAX_BLUR_RADIUS, MAX_BLUR_RADIUS + 10 };
+		for (size_t w = 0; w < sizeof(sizes) / sizeof(sizes[0]); ++w)
+		{
+			for (size_t h = 0; h < sizeof(sizes) / sizeof(sizes[0]); ++h)
+			{
+				for (size_t r = 0; r < sizeof(radii) / sizeof(radii[0]); ++r)
+					checkBlur(sets[s], sizes[w], sizes[h], radii[r]);
+			}
+		}
+		checkBlur(sets[s], 333, 201, 24);
+	}
+
+	int sizes[] = { 1, 5, 16, 17, 40, 123 };
+	for (size_t w = 0; w < sizeof(sizes) / sizeof(sizes[0]); ++w)
+	{
+		for (size_t h = 0; h < sizeof(sizes) / sizeof(sizes[0]); ++h)
+			checkTranspose(sizes[w], sizes[h]);
+	}
+
+	CHECK(UseInstructionSet(detected));
+	return checkResult();
+}
@@ -0,0 +1,119 @@
+// settings.xml stays readable when the writer dies between writing the temporary file
+// and renaming it. The test runs itself as a child process that aborts at that point.
+
+#include "check.h"
+#include "settings_store.h"
+#include "file_utils.h"
+#include "pugixml.hpp"
+#include "wx/init.h"
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+namespace
+{
+	const char * settingsPath = "settings_test.xml";
+
+	SettingsData makeData(int bigPauseInterval)
+	{
+		SettingsData data;
+		data.firstLaunch = false;
+		data.seenSettings = true;
+		data.bigPauseEnabled = true;
+		data.bigPauseInterval = bigPauseInterval;
+		data.bigPauseDuration = 5;
+		data.miniPauseEnabled = true;
+		data.miniPauseInterval = 10;
+		data.miniPauseDuration = 8;
+		data.warningEnabled = true;
+		data.warningInterval = 1.5f;
+		data.soundsEnabled = false;
+		data.strictModeEnabled = false;
+		data.windowNearby = true;
+		data.inactivityTracking = true;
+		data.canCloseNotifications = true;
+		data.blurredBackground = false;
+		return data;
+	}
+
+	bool save(SettingsData const & data)
+	{
+		SettingsStore * store = new SettingsStore(wxString(settingsPath), 0);
+		if (store->Run() != wxTHREAD_NO_ERROR)
+			return false;
+		store->Save(data);
+		return store->Shutdown(5000);
+	}
+
+	// -1 when the file is missing or doesn't parse
+	int readBigPauseInterval()
+	{
+		pugi::xml_document doc;
+		if (doc.load_file(settingsPath).status != pugi::status_ok)
+			return -1;
+
+		pugi::xml_node node = doc.child(L"settings").child(L"big_pause");
+		if (node.empty())
+			return -1;
+		return node.attribute(L"interval").as_int();
+	}
+
+	std::string readFile(const char * path)
+	{
+		std::string content;
+		FILE * file = fopen(path, "rb");
+		if (!file)
+			return content;
+
+		char chunk[4096];
+		size_t got;
+		while ((got = fread(chunk, 1, sizeof(chunk), file)) > 0)
+			content.append(chunk, got);
+		fclose(file);
+		return content;
+	}
+
+	// no cleanup at all, as if the process was killed
+	void abortWriter(wxString const &)
+	{
+		_Exit(3);
+	}
+
+	// The child: the data is on the disk under the temporary name, the process dies before the rename
+	int abortBeforeReplace()
+	{
+		setBeforeReplaceHook(abortWriter);
+		save(makeData(90));
+		return 0; // the hook didn't run
+	}
+}
+
+int main(int argc, char ** argv)
+{
+	wxInitializer initializer;
+
+	if (argc > 1 && strcmp(argv[1], "--abort-before-replace") == 0)
+		return abortBeforeReplace();
+
+	remove(settingsPath);
+	CHECK(save(makeData(45)));
+	CHECK(readBigPauseInterval() == 45);
+	std::string oldContent = readFile(settingsPath);
+	CHECK(!oldContent.empty());
+
+	std::string command = std::string("\"") + argv[0] + "\" --abort-before-replace";
+	CHECK(system(command.c_str()) != 0);
+
+	// the old file is untouched, the new one never got its name
+	CHECK(readFile(settingsPath) == oldContent);
+	CHECK(readBigPauseInterval() == 45);
+	CHECK(readFile("settings_test.xml.tmp").find("interval=\"90\"") != std::string::npos);
+
+	// a temporary file left by the dead writer doesn't get in the way of the next save
+	CHECK(save(makeData(60)));
+	CHECK(readBigPauseInterval() == 60);
+
+	remove(settingsPath);
+	remove("settings_test.xml.tmp");
+	return checkResult();
+}
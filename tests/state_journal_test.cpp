@@ -0,0 +1,158 @@
+// StateJournal: the latest snapshot after a reopen, torn records, wrapping around. The
+// replayed timers resumed after a restart, postponed big pauses included.
+
+#include "check.h"
+#include "state_journal.h"
+#include "wx/init.h"
+#include <stdio.h>
+
+namespace
+{
+	const char * JOURNAL_PATH = "state_journal_test.journal";
+
+	RuntimeState makeState(int seq)
+	{
+		RuntimeState state = {};
+		state.wallTime = 1700000000000LL + seq * 1000LL;
+		state.timeLeftToBigPause = 20 * 60 * 1000 - seq;
+		state.timeLeftToMiniPause = 5 * 60 * 1000 - seq;
+		state.postponeCount = seq % 3;
+		state.longBreakCount = seq;
+		state.postponeTotal = seq * 2;
+		return state;
+	}
+
+	bool replayed(int seq)
+	{
+		StateJournal journal;
+		RuntimeState state;
+		if (!journal.Open(JOURNAL_PATH) || !journal.Replay(state))
+		{
+			fprintf(stderr, "nothing replayed instead of %d\n", seq);
+			return false;
+		}
+		RuntimeState expected = makeState(seq);
+		if (state.wallTime == expected.wallTime && state.timeLeftToBigPause == expected.timeLeftToBigPause &&
+			state.postponeCount == expected.postponeCount && state.postponeTotal == expected.postponeTotal)
+			return true;
+		fprintf(stderr, "replayed %d instead of %d\n", (int)state.longBreakCount, seq);
+		return false;
+	}
+
+	void checkReplay()
+	{
+		remove(JOURNAL_PATH);
+		{
+			StateJournal journal;
+			RuntimeState state;
+			CHECK(journal.Open(JOURNAL_PATH));
+			CHECK(!journal.Replay(state));
+			for (int seq = 1; seq <= 5; ++seq)
+				journal.Append(makeState(seq));
+		}
+		CHECK(replayed(5));
+
+		// appends go on after the replayed record, past the end of the file
+		for (int seq = 6; seq < 3000; seq += 997)
+		{
+			StateJournal journal;
+			RuntimeState state;
+			CHECK(journal.Open(JOURNAL_PATH));
+			CHECK(journal.Replay(state));
+			for (int i = (int)state.longBreakCount + 1; i <= seq; ++i)
+				journal.Append(makeState(i));
+			journal.Close();
+			CHECK(replayed(seq));
+		}
+	}
+
+	void checkTornRecord()
+	{
+		remove(JOURNAL_PATH);
+		{
+			StateJournal journal;
+			CHECK(journal.Open(JOURNAL_PATH));
+			journal.Append(makeState(1));
+			journal.Append(makeState(2));
+		}
+
+		// the second record half written
+		FILE * file = fopen(JOURNAL_PATH, "r+b");
+		CHECK(file != 0);
+		if (!file)
+			return;
+		fseek(file, 64 + 40, SEEK_SET);
+		const char garbage[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+		fwrite(garbage, 1, sizeof(garbage), file);
+		fclose(file);
+
+		CHECK(replayed(1));
+		remove(JOURNAL_PATH);
+	}
+
+	void checkResume()
+	{
+		const long minute = 60 * 1000;
+
+		// two postpones, the app gone for 5 minutes
+		ResumedTimers timers = resumeTimers(3 * minute, 10 * minute, 2, 5 * minute);
+		CHECK(timers.resumed);
+		CHECK(timers.timeLeftToBigPause == minute);
+		CHECK(timers.timeLeftToMiniPause == 5 * minute);
+		CHECK(timers.postponeCount == 2);
+
+		timers = resumeTimers(40 * minute, 10 * minute, 1, 2000);
+		CHECK(timers.resumed);
+		CHECK(timers.timeLeftToBigPause == 40 * minute - 2000);
+		CHECK(timers.postponeCount == 1);
+
+		// the big pause overdue by more than 3 minutes
+		timers = resumeTimers(2 * minute, 10 * minute, 2, 5 * minute + 1);
+		CHECK(!timers.resumed);
+		CHECK(timers.postponeCount == 0);
+
+		// gone for too long, or the clock went back
+		CHECK(!resumeTimers(40 * minute, 10 * minute, 2, 30 * minute + 1).resumed);
+		CHECK(resumeTimers(40 * minute, 10 * minute, 2, 30 * minute).resumed);
+		CHECK(!resumeTimers(40 * minute, 10 * minute, 2, -5 * minute).resumed);
+		CHECK(!resumeTimers(40 * minute, 10 * minute, 2, 999).resumed);
+	}
+
+	// A crash after two postpones comes back with them
+	void checkPostponesAfterRestart()
+	{
+		remove(JOURNAL_PATH);
+		RuntimeState postponed = makeState(1);
+		postponed.timeLeftToBigPause = 3 * 60 * 1000;
+		postponed.postponeCount = 2;
+		{
+			StateJournal journal;
+			CHECK(journal.Open(JOURNAL_PATH));
+			journal.Append(makeState(0));
+			journal.Append(postponed);
+		}
+
+		StateJournal journal;
+		RuntimeState state;
+		CHECK(journal.Open(JOURNAL_PATH));
+		CHECK(journal.Replay(state));
+		ResumedTimers timers = resumeTimers(state.timeLeftToBigPause, state.timeLeftToMiniPause, state.postponeCount, 30 * 1000);
+		CHECK(timers.resumed);
+		CHECK(timers.postponeCount == 2);
+		CHECK(timers.timeLeftToBigPause == 150 * 1000);
+		journal.Close();
+		remove(JOURNAL_PATH);
+	}
+}
+
+int main()
+{
+	wxInitializer initializer;
+
+	checkReplay();
+	checkTornRecord();
+	checkResume();
+	checkPostponesAfterRestart();
+
+	return checkResult();
+}
@@ -0,0 +1,77 @@
+// Every string id of the English language pack is found by FindStrId, anything else isn't
+
+#include "check.h"
+#include "string_ids.h"
+#include "pugixml.hpp"
+#include <string.h>
+#include <wchar.h>
+#include <wctype.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace
+{
+	std::vector<std::wstring> ids;
+
+	bool isKnown(std::wstring const & name)
+	{
+		return FindStrId(name.c_str(), name.length()) != StrId::Count;
+	}
+
+	bool isInPack(std::wstring const & name)
+	{
+		return std::find(ids.begin(), ids.end(), name) != ids.end();
+	}
+}
+
+int main()
+{
+	pugi::xml_document doc;
+	CHECK(doc.load_file(EYELEO_BIN_FOLDER "Langpacks/langpack.en.xml").status == pugi::status_ok);
+
+	pugi::xml_node nodeLangPack = doc.child(L"language_pack");
+	for (pugi::xml_node node = nodeLangPack.child(L"string"); node; node = node.next_sibling(L"string"))
+		ids.push_back(node.attribute(L"id").value());
+
+	CHECK(!ids.empty());
+	CHECK(ids.size() == (size_t)StrId::Count);
+
+	std::vector<bool> seen((size_t)StrId::Count, false);
+	for (size_t i = 0; i < ids.size(); ++i)
+	{
+		std::wstring const & id = ids[i];
+		StrId strId = FindStrId(id.c_str(), id.length());
+		CHECK(strId != StrId::Count);
+		if (strId == StrId::Count)
+		{
+			fprintf(stderr, "'%ls' isn't found\n", id.c_str());
+			continue;
+		}
+
+		// the enum follows the order of the English pack
+		CHECK(strId == StrId(i));
+		CHECK(wcscmp(GetStrIdName(strId), id.c_str()) == 0);
+		CHECK(!seen[(size_t)strId]);
+		seen[(size_t)strId] = true;
+
+		// the length is what counts, not the terminating zero
+		std::wstring padded = id + L"_tail";
+		CHECK(FindStrId(padded.c_str(), id.length()) == strId);
+
+		// near misses of a known id are only found when they are ids themselves
+		std::wstring upper = id;
+		for (size_t c = 0; c < upper.length(); ++c)
+			upper[c] = towupper(upper[c]);
+		std::wstring misses[] = { id.substr(0, id.length() - 1), id + L"x", id + L"_1", upper };
+		for (size_t m = 0; m < sizeof(misses) / sizeof(misses[0]); ++m)
+			CHECK(isKnown(misses[m]) == isInPack(misses[m]));
+	}
+
+	CHECK(!isKnown(L""));
+	CHECK(!isKnown(L"unknown_string_id"));
+	CHECK(!isKnown(L"Count"));
+	CHECK(wcscmp(GetStrIdName(StrId::Count), L"") == 0);
+
+	return checkResult();
+}
@@ -0,0 +1,118 @@
+// The blur of the big pause backdrops: synthetic 4K and 8K displays captured at
+// 1/BACKDROP_SCALE, blurred by BackdropThread with a tile per core and on one thread.
+// The first blur of a break starts the worker threads, the ones after it reuse them.
+// Usage: backdrop-bench
+
+#include "bench.h"
+#include "backdrop_blur.h"
+#include "pixel_kernels.h"
+#include "wx/init.h"
+
+namespace
+{
+	struct Setup
+	{
+		const char * name;
+		int width;
+		int height;
+		int displays;
+	};
+
+	void makeFrames(Setup const & setup, std::vector<BackdropFrame> & frames)
+	{
+		uint32_t random = 2463534242u;
+		frames.resize(setup.displays);
+		for (size_t i = 0; i < frames.size(); ++i)
+		{
+			BackdropFrame & frame = frames[i];
+			frame.width = (setup.width + BACKDROP_SCALE - 1) / BACKDROP_SCALE;
+			frame.height = (setup.height + BACKDROP_SCALE - 1) / BACKDROP_SCALE;
+			frame.pixels.resize((size_t)frame.width * frame.height);
+			frame.temp.resize(frame.pixels.size());
+			for (size_t p = 0; p < frame.pixels.size(); ++p)
+			{
+				random ^= random << 13;
+				random ^= random >> 17;
+				random ^= random << 5;
+				frame.pixels[p] = random | 0xFF000000;
+			}
+		}
+	}
+
+	// Best of a few runs, in ms
+	double blur(std::vector<BackdropFrame> & frames, BlurWorkers & workers, int tiles, int & usedTiles)
+	{
+		long long best = -1;
+		for (int run = 0; run < 10; ++run)
+		{
+			BackdropThread thread(frames, workers, tiles);
+			if (thread.Run() != wxTHREAD_NO_ERROR)
+				return -1;
+			thread.Wait();
+			usedTiles = thread.GetTiles();
+			if (best < 0 || thread.GetBlurTime() < best)
+				best = thread.GetBlurTime();
+		}
+		return best / 1000.0;
+	}
+
+	// Average of a few blurs, in ms, each one with new workers or all with the same ones
+	double blurWithWorkers(std::vector<BackdropFrame> & frames, int tiles, bool fresh)
+	{
+		const int runs = 20;
+		BlurWorkers reused;
+		long long total = 0;
+		for (int run = 0; run <= runs; ++run)
+		{
+			BlurWorkers started;
+			BackdropThread thread(frames, fresh ? started : reused, tiles);
+			if (thread.Run() != wxTHREAD_NO_ERROR)
+				return -1;
+			thread.Wait();
+			// the first run started the reused workers
+			if (run > 0)
+				total += thread.GetBlurTime();
+		}
+		return total / 1000.0 / runs;
+	}
+}
+
+int main()
+{
+	wxInitializer initializer;
+
+	printf("Kernels: %s, radius %d, %d passes\n", pixelkernels::GetInstructionSetName(), (int)BACKDROP_BLUR_RADIUS, (int)BACKDROP_BLUR_PASSES);
+
+	const Setup setups[] = {
+		{ "1920x1080", 1920, 1080, 1 },
+		{ "3840x2160", 3840, 2160, 1 },
+		{ "7680x4320", 7680, 4320, 1 },
+		{ "3 x 3840x2160", 3840, 2160, 3 }
+	};
+
+	BlurWorkers workers;
+	for (size_t i = 0; i < sizeof(setups) / sizeof(setups[0]); ++i)
+	{
+		Setup const & setup = setups[i];
+		std::vector<BackdropFrame> frames;
+		makeFrames(setup, frames);
+
+		int tiles = 1;
+		double split = blur(frames, workers, 0, tiles);
+		int single = 1;
+		double one = blur(frames, workers, 1, single);
+
+		printf("%-16s %4dx%-4d frames: %8.2f ms per display on %d threads, %8.2f ms on 1\n", setup.name,
+			frames[0].width, frames[0].height, split / setup.displays, tiles, one / setup.displays);
+	}
+
+	// 4 tiles whatever the cores, 3 worker threads
+	std::vector<BackdropFrame> frames;
+	makeFrames(setups[0], frames);
+	double started = blurWithWorkers(frames, 4, true);
+	double reused = blurWithWorkers(frames, 4, false);
+	printf("%-16s 4 tiles: %8.3f ms with the workers started, %8.3f ms reused, %6.1f us to start them\n",
+		setups[0].name, started, reused, (started - reused) * 1000.0);
+
+	return 0;
+}
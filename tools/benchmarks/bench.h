@@ -0,0 +1,50 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdio.h>
+#include <chrono>
+
+// Runs the body in batches until minMs went by, returns nanoseconds per call.
+// The first batch warms the caches up and isn't counted.
+template <typename Body>
+double measureNs(Body body, int batch = 1000, int minMs = 300)
+{
+	typedef std::chrono::steady_clock Clock;
+
+	for (int i = 0; i < batch; ++i)
+		body();
+
+	long long calls = 0;
+	Clock::time_point start = Clock::now();
+	Clock::duration elapsed;
+	do
+	{
+		for (int i = 0; i < batch; ++i)
+			body();
+		calls += batch;
+		elapsed = Clock::now() - start;
+	} while (elapsed < std::chrono::milliseconds(minMs));
+
+	return std::chrono::duration<double, std::nano>(elapsed).count() / calls;
+}
+
+inline void report(const char * name, double ns)
+{
+	if (ns >= 1000000.0)
+		printf("%-48s %10.2f ms\n", name, ns / 1000000.0);
+	else if (ns >= 10000.0)
+		printf("%-48s %10.2f us\n", name, ns / 1000.0);
+	else
+		printf("%-48s %10.1f ns\n", name, ns);
+}
+
+// Keeps the compiler from dropping a computation whose result isn't used
+template <typename T>
+inline void keep(T const & value)
+{
+	static volatile T sink;
+	sink = value;
+	(void)sink;
+}
+
+#endif
@@ -0,0 +1,54 @@
+// Duration formatting of the countdowns: TimeFormat::Format into a stack buffer against
+// getTimeStr, which wraps it into a wxString, for every duration up to 2 hours.
+// Usage: duration-bench, reads the language packs from bin/
+
+#include "bench.h"
+#include "language_set.h"
+#include "wx/init.h"
+#include "wx/filefn.h"
+
+namespace
+{
+	void measure(const char * lang)
+	{
+		if (!LoadLanguagePack(lang))
+		{
+			fprintf(stderr, "Can't load the %s language pack\n", lang);
+			return;
+		}
+
+		int value = 0;
+		char name[64];
+
+		snprintf(name, sizeof(name), "%s: formatTime into a buffer", lang);
+		report(name, measureNs([&]() {
+			wchar_t buffer[TIME_STR_SIZE];
+			keep(formatTime(buffer, TIME_STR_SIZE, value, SECONDS));
+			value = (value + 1) % (2 * 60 * 60 + 1);
+		}));
+
+		snprintf(name, sizeof(name), "%s: getTimeStr", lang);
+		report(name, measureNs([&]() {
+			keep(getTimeStr(value, SECONDS).length());
+			value = (value + 1) % (2 * 60 * 60 + 1);
+		}));
+
+		DeleteLanguagePack();
+	}
+}
+
+int main()
+{
+	wxInitializer initializer;
+
+	// LoadLanguagePack looks for Langpacks/ in the current directory
+	if (!wxSetWorkingDirectory(EYELEO_BIN_FOLDER))
+	{
+		fprintf(stderr, "Can't find %s\n", EYELEO_BIN_FOLDER);
+		return 1;
+	}
+
+	measure("en");
+	measure("ru");
+	return 0;
+}
@@ -0,0 +1,132 @@
+// The exclusion rules evaluated for a new foreground window, from a few rules to thousands
+// of them, against a scan of every rule. Loading exclusions.xml with as many rules.
+// Usage: exclusion-bench
+
+#include "bench.h"
+#include "exclusion_rules.h"
+#include "wx/init.h"
+#include <algorithm>
+
+namespace
+{
+	struct Rule
+	{
+		ExclusionKey key;
+		std::wstring value;
+		BreakPolicy policy;
+	};
+
+	// Every third rule of each kind, the names and paths all different
+	void makeRules(int count, std::vector<Rule> & rules)
+	{
+		rules.resize(count);
+		for (int i = 0; i < count; ++i)
+		{
+			wchar_t value[128];
+			Rule & rule = rules[i];
+			rule.key = (ExclusionKey)(i % 3);
+			rule.policy = i % 2 ? POLICY_NO_BREAKS : POLICY_MINI_PAUSES_ONLY;
+			if (rule.key == EXCLUDE_EXE_NAME)
+				swprintf(value, 128, L"app%d.exe", i);
+			else if (rule.key == EXCLUDE_PATH_PREFIX)
+				swprintf(value, 128, L"c:\\program files\\vendor%d\\product%d\\", i % 50, i);
+			else
+				swprintf(value, 128, L"windowclass%d", i);
+			rule.value = value;
+		}
+	}
+
+	bool endsWith(std::wstring const & text, std::wstring const & end)
+	{
+		return text.size() >= end.size() && text.compare(text.size() - end.size(), end.size(), end) == 0;
+	}
+
+	// What a list of rules costs, each one compared in turn
+	BreakPolicy scanRules(std::vector<Rule> const & rules, wxString const & exePath, wxString const & windowClass)
+	{
+		std::wstring path = exePath.Lower().ToStdWstring();
+		std::replace(path.begin(), path.end(), L'/', L'\\');
+		std::wstring className = windowClass.Lower().ToStdWstring();
+
+		BreakPolicy policy = POLICY_ALL_BREAKS;
+		for (size_t i = 0; i < rules.size(); ++i)
+		{
+			Rule const & rule = rules[i];
+			bool match;
+			if (rule.key == EXCLUDE_EXE_NAME)
+				match = endsWith(path, L"\\" + rule.value) || path == rule.value;
+			else if (rule.key == EXCLUDE_PATH_PREFIX)
+				match = path.compare(0, rule.value.size(), rule.value) == 0;
+			else
+				match = className == rule.value;
+			if (match)
+				policy = std::max(policy, rule.policy);
+		}
+		return policy;
+	}
+
+	void measure(int count)
+	{
+		std::vector<Rule> list;
+		makeRules(count, list);
+		ExclusionRules rules;
+		for (size_t i = 0; i < list.size(); ++i)
+			rules.Add(list[i].key, list[i].value, list[i].policy);
+
+		// a window no rule matches, one under a vendor with many products, one found by its name
+		const wxString paths[] = {
+			"C:\\Windows\\System32\\notepad.exe",
+			"C:\\Program Files\\Vendor7\\Product7000\\bin\\product.exe",
+			"D:\\Apps\\APP3.exe"
+		};
+		const char * names[] = { "miss", "prefix", "name" };
+
+		for (size_t i = 0; i < sizeof(paths) / sizeof(paths[0]); ++i)
+		{
+			wxString const & path = paths[i];
+			wxString windowClass = "Notepad";
+			char name[64];
+
+			snprintf(name, sizeof(name), "%5d rules, %-6s: Evaluate", count, names[i]);
+			report(name, measureNs([&]() {
+				keep(rules.Evaluate(path, windowClass));
+			}));
+
+			snprintf(name, sizeof(name), "%5d rules, %-6s: scan of the rules", count, names[i]);
+			report(name, measureNs([&]() {
+				keep(scanRules(list, path, windowClass));
+			}, count > 1000 ? 10 : 100));
+		}
+
+		// exclusions.xml, as the user would write it
+		const char * file = "exclusion_bench.xml";
+		FILE * xml = fopen(file, "w");
+		if (!xml)
+			return;
+		fputs("<?xml version=\"1.0\"?>\n<exclusions>\n", xml);
+		const char * policies[] = { "all_breaks", "mini_pauses_only", "no_breaks" };
+		const char * attributes[] = { "exe", "path", "class" };
+		for (size_t i = 0; i < list.size(); ++i)
+			fprintf(xml, "\t<rule %s=\"%ls\" policy=\"%s\"/>\n", attributes[list[i].key], list[i].value.c_str(), policies[list[i].policy]);
+		fputs("</exclusions>\n", xml);
+		fclose(xml);
+
+		char name[64];
+		snprintf(name, sizeof(name), "%5d rules: Load", count);
+		ExclusionRules loaded;
+		report(name, measureNs([&]() {
+			keep(loaded.Load(file));
+		}, 1, 300));
+		remove(file);
+	}
+}
+
+int main()
+{
+	wxInitializer initializer;
+
+	const int counts[] = { 10, 100, 1000, 5000, 20000 };
+	for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); ++i)
+		measure(counts[i]);
+	return 0;
+}
@@ -0,0 +1,103 @@
+// What a window event costs FullscreenTracker once the hook delivered it: location changes
+// of the foreground window and of others, foreground changes with the exclusion rules
+// evaluated, the checks of the timer, with 1 to 16 made-up displays.
+// Usage: fullscreen-bench
+
+#include "bench.h"
+#include "fullscreen_tracker.h"
+#include "oscapabilities.h"
+#include "wx/init.h"
+
+namespace
+{
+	std::vector<DisplayData> makeDisplays(int count)
+	{
+		std::vector<DisplayData> displays(count);
+		for (int ind = 0; ind < count; ++ind)
+		{
+			DisplayData & disp = displays[ind];
+			disp.primary = ind == 0;
+			disp.geometry = wxRect(ind * 1920, 0, 1920, 1080);
+			disp.clientArea = wxRect(ind * 1920, 0, 1920, 1040);
+		}
+		return displays;
+	}
+
+	ForegroundWindow makeWindow(void * handle, wxRect const & rect, wxString const & exePath)
+	{
+		ForegroundWindow wnd;
+		wnd.handle = handle;
+		wnd.visible = true;
+		wnd.rect = rect;
+		wnd.exePath = exePath;
+		wnd.className = "GameWindowClass";
+		return wnd;
+	}
+
+	void measure(int displays, ExclusionRules const & rules)
+	{
+		FixedDisplayTopology topology(makeDisplays(displays));
+		setDisplayTopologyProvider(&topology);
+
+		FullscreenTracker tracker;
+		tracker.UseEventsOnly();
+		tracker.SetRules(&rules);
+
+		void * const game = (void *)0x10;
+		void * const other = (void *)0x20;
+		// the last display is the one matched last
+		wxRect fullscreen((displays - 1) * 1920, 0, 1920, 1080);
+		ForegroundWindow moving = makeWindow(game, wxRect(100, 100, 800, 600), "C:\\Games\\Game\\game.exe");
+		ForegroundWindow covering = makeWindow(game, fullscreen, "C:\\Games\\Game\\game.exe");
+		ForegroundWindow background = makeWindow(other, fullscreen, "C:\\Program Files\\Editor\\editor.exe");
+		tracker.OnForegroundChanged(covering);
+
+		char name[64];
+		int step = 0;
+
+		snprintf(name, sizeof(name), "%2d displays: location change", displays);
+		report(name, measureNs([&]() {
+			tracker.OnWindowChanged((++step & 1) ? moving : covering);
+		}));
+
+		snprintf(name, sizeof(name), "%2d displays: location change of another window", displays);
+		report(name, measureNs([&]() {
+			tracker.OnWindowChanged(background);
+		}));
+
+		snprintf(name, sizeof(name), "%2d displays: foreground change", displays);
+		report(name, measureNs([&]() {
+			tracker.OnForegroundChanged((++step & 1) ? background : covering);
+		}));
+
+		snprintf(name, sizeof(name), "%2d displays: IsFullscreen", displays);
+		report(name, measureNs([&]() {
+			int display;
+			keep(tracker.IsFullscreen(&display));
+		}));
+
+		snprintf(name, sizeof(name), "%2d displays: IsFullscreen, topology changed", displays);
+		report(name, measureNs([&]() {
+			invalidateDisplayTopology();
+			int display;
+			keep(tracker.IsFullscreen(&display));
+		}));
+	}
+}
+
+int main()
+{
+	wxInitializer initializer;
+
+	// a few rules, as a user would have them
+	ExclusionRules rules;
+	rules.Add(EXCLUDE_EXE_NAME, "zoom.exe", POLICY_NO_BREAKS);
+	rules.Add(EXCLUDE_EXE_NAME, "game.exe", POLICY_MINI_PAUSES_ONLY);
+	rules.Add(EXCLUDE_PATH_PREFIX, "C:\\Program Files\\JetBrains\\", POLICY_MINI_PAUSES_ONLY);
+	rules.Add(EXCLUDE_WINDOW_CLASS, "screenClass", POLICY_NO_BREAKS);
+
+	const int displays[] = { 1, 2, 4, 16 };
+	for (size_t i = 0; i < sizeof(displays) / sizeof(displays[0]); ++i)
+		measure(displays[i], rules);
+	return 0;
+}
@@ -0,0 +1,75 @@
+// LoadLanguagePack from the compiled .lpk against the XML it falls back to, for en and ru.
+// The first load of each kind is timed on its own, it pays for the file being opened and
+// mapped or parsed for the first time in the process; the loads after it are averaged.
+// Usage: langpack-bench, reads Langpacks/ with the blobs that the build puts next to it
+
+#include "bench.h"
+#include "language_set.h"
+#include "wx/init.h"
+#include "wx/filefn.h"
+#include "wx/stopwatch.h"
+
+namespace
+{
+	double firstLoadUs(const char * lang)
+	{
+		wxStopWatch loadTime;
+		if (!LoadLanguagePack(lang))
+			return -1;
+		return (double)loadTime.TimeInMicro().GetValue();
+	}
+
+	void measure(const char * lang, const char * source)
+	{
+		char name[64];
+		snprintf(name, sizeof(name), "%s from %s: first load", lang, source);
+		double first = firstLoadUs(lang);
+		if (first < 0)
+		{
+			fprintf(stderr, "Can't load the %s language pack\n", lang);
+			return;
+		}
+		report(name, first * 1000.0);
+
+		snprintf(name, sizeof(name), "%s from %s: LoadLanguagePack", lang, source);
+		report(name, measureNs([&]() {
+			keep(LoadLanguagePack(lang));
+		}, 10));
+
+		DeleteLanguagePack();
+	}
+}
+
+int main()
+{
+	wxInitializer initializer;
+
+	// LoadLanguagePack looks for Langpacks/ in the current directory
+	if (!wxSetWorkingDirectory(LANGPACK_BENCH_FOLDER))
+	{
+		fprintf(stderr, "Can't find %s\n", LANGPACK_BENCH_FOLDER);
+		return 1;
+	}
+
+	const char * langs[] = { "en", "ru" };
+	for (size_t i = 0; i < sizeof(langs) / sizeof(langs[0]); ++i)
+	{
+		const char * lang = langs[i];
+		wxString blob = wxString::Format(L"Langpacks/langpack.%s.lpk", wxString(lang));
+		wxString hidden = blob + L".off";
+		if (!wxFileExists(blob))
+		{
+			fprintf(stderr, "Can't find langpack.%s.lpk, build the langpack-bench target\n", lang);
+			return 1;
+		}
+
+		measure(lang, "lpk");
+
+		// without the blob the XML is read, as for a pack that wasn't compiled
+		if (!wxRenameFile(blob, hidden))
+			return 1;
+		measure(lang, "xml");
+		wxRenameFile(hidden, blob);
+	}
+	return 0;
+}
@@ -0,0 +1,69 @@
+// Cost of a log statement: the binary records of the logging macros against the text
+// lines formatted at the call site that logging::msg used to write.
+// Usage: log-bench, writes log.bin and log.txt to the current directory
+
+#include "bench.h"
+#include "logging.h"
+
+namespace
+{
+	FILE * textFile = 0;
+
+	// What logging::msg did before the binary log: the file was opened for every line
+	void writeTextLine(wxString const & msg)
+	{
+		FILE * file = fopen("log.txt", "a");
+		if (!file)
+			return;
+		wxScopedCharBuffer utf8 = msg.utf8_str();
+		fwrite(utf8.data(), 1, utf8.length(), file);
+		fwrite("\n", 1, 1, file);
+		fclose(file);
+	}
+
+	// The same text into a file that stays open, to tell formatting from opening the file
+	void writeBufferedLine(wxString const & msg)
+	{
+		wxScopedCharBuffer utf8 = msg.utf8_str();
+		fwrite(utf8.data(), 1, utf8.length(), textFile);
+		fwrite("\n", 1, 1, textFile);
+	}
+}
+
+int main()
+{
+	remove("log.bin");
+	remove("log.txt");
+	logging::Init();
+
+	long timeLeft = 1200000;
+	int postponeCount = 2;
+	wxString stateName(L"STATE_IDLE");
+
+	report("LOG_INFO, 3 integers", measureNs([&]() {
+		LOG_INFO("State: Idle: _timeLeftToBigPause=%ld, _timeLeftToMiniPause=%ld, _postponeCount=%d", timeLeft, timeLeft / 3, postponeCount);
+		++timeLeft;
+	}));
+
+	report("LOG_INFO, integer and wxString", measureNs([&]() {
+		LOG_INFO("ChangeState %s, %d", stateName, postponeCount);
+		++postponeCount;
+	}));
+
+	logging::Flush();
+
+	textFile = fopen("log-buffered.txt", "w");
+	report("wxString::Format, buffered file", measureNs([&]() {
+		writeBufferedLine(wxString::Format(L"State: Idle: _timeLeftToBigPause=%ld, _timeLeftToMiniPause=%ld, _postponeCount=%d", timeLeft, timeLeft / 3, postponeCount));
+		++timeLeft;
+	}));
+	fclose(textFile);
+	remove("log-buffered.txt");
+
+	report("wxString::Format, file opened per line", measureNs([&]() {
+		writeTextLine(wxString::Format(L"State: Idle: _timeLeftToBigPause=%ld, _timeLeftToMiniPause=%ld, _postponeCount=%d", timeLeft, timeLeft / 3, postponeCount));
+		++timeLeft;
+	}, 100));
+
+	return 0;
+}
@@ -0,0 +1,98 @@
+// The pixel kernels on a 1920x1080 frame with every instruction set the CPU has.
+// Usage: pixel-kernels-bench
+
+#include "bench.h"
+#include "pixel_kernels.h"
+#include <vector>
+
+using namespace pixelkernels;
+
+namespace
+{
+	const int WIDTH = 1920;
+	const int HEIGHT = 1080;
+	const size_t COUNT = (size_t)WIDTH * HEIGHT;
+
+	void measure(EInstructionSet set, std::vector<uint32_t> const & frame, std::vector<uint8_t> const & coverage)
+	{
+		if (!UseInstructionSet(set))
+		{
+			printf("%s isn't supported\n", set == ISA_AVX2 ? "AVX2" : "SSE2");
+			return;
+		}
+
+		const char * isa = GetInstructionSetName();
+		char name[64];
+		std::vector<uint32_t> dst(frame);
+		std::vector<uint32_t> work(frame);
+		std::vector<uint16_t> bounds(WIDTH + 1);
+
+		snprintf(name, sizeof(name), "%s: Premultiply", isa);
+		report(name, measureNs([&]() {
+			Premultiply(&work[0], COUNT);
+		}, 10));
+
+		snprintf(name, sizeof(name), "%s: ScaleAlpha", isa);
+		report(name, measureNs([&]() {
+			ScaleAlpha(&dst[0], &frame[0], COUNT, 200);
+		}, 10));
+
+		snprintf(name, sizeof(name), "%s: BlendOver", isa);
+		report(name, measureNs([&]() {
+			BlendOver(&dst[0], &frame[0], COUNT);
+		}, 10));
+
+		snprintf(name, sizeof(name), "%s: BlendMask", isa);
+		report(name, measureNs([&]() {
+			BlendMask(&dst[0], &coverage[0], COUNT, 0xFFFFFFFF);
+		}, 10));
+
+		snprintf(name, sizeof(name), "%s: ColorKeyToAlpha", isa);
+		report(name, measureNs([&]() {
+			ColorKeyToAlpha(&work[0], COUNT, 0x00FF00FF);
+		}, 10));
+
+		snprintf(name, sizeof(name), "%s: FindSpans, every row", isa);
+		report(name, measureNs([&]() {
+			size_t spans = 0;
+			for (int y = 0; y < HEIGHT; ++y)
+				spans += FindSpans(&frame[(size_t)y * WIDTH], WIDTH, &bounds[0]);
+			keep(spans);
+		}, 10));
+
+		snprintf(name, sizeof(name), "%s: BoxBlur, radius 24", isa);
+		report(name, measureNs([&]() {
+			BoxBlur(&work[0], WIDTH, HEIGHT, 24);
+		}, 1, 1000));
+	}
+}
+
+int main()
+{
+	EInstructionSet detected = GetInstructionSet();
+
+	// premultiplied pixels with transparent runs, like a rendered popup
+	std::vector<uint32_t> frame(COUNT);
+	uint32_t random = 2463534242u;
+	for (size_t i = 0; i < COUNT; ++i)
+	{
+		random ^= random << 13;
+		random ^= random >> 17;
+		random ^= random << 5;
+		uint32_t a = (i / 37) % 3 == 0 ? 0 : (random >> 24);
+		uint32_t c = a ? (random & 0xFF) % (a + 1) : 0;
+		frame[i] = (a << 24) | (c << 16) | (c << 8) | c;
+	}
+
+	// the alpha of the frame as the coverage of text
+	std::vector<uint8_t> coverage(COUNT);
+	for (size_t i = 0; i < COUNT; ++i)
+		coverage[i] = (uint8_t)(frame[i] >> 24);
+
+	measure(ISA_SCALAR, frame, coverage);
+	measure(ISA_SSE2, frame, coverage);
+	measure(ISA_AVX2, frame, coverage);
+
+	UseInstructionSet(detected);
+	return 0;
+}
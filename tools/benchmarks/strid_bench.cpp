@@ -0,0 +1,69 @@
+// Language pack lookups: the std::map<wxString, wxString> LanguagePack used to have against
+// the StrId index and FindStrId for ids built at runtime.
+// Usage: strid-bench [langpack.en.xml]
+
+#include "bench.h"
+#include "string_ids.h"
+#include "pugixml.hpp"
+#include "wx/string.h"
+#include <wchar.h>
+#include <map>
+#include <string>
+#include <vector>
+
+int main(int argc, char ** argv)
+{
+	const char * path = argc > 1 ? argv[1] : EYELEO_BIN_FOLDER "Langpacks/langpack.en.xml";
+
+	pugi::xml_document doc;
+	if (doc.load_file(path).status != pugi::status_ok)
+	{
+		fprintf(stderr, "Can't read %s\n", path);
+		return 1;
+	}
+
+	std::vector<std::wstring> ids;
+	std::vector<std::wstring> texts;
+	pugi::xml_node nodeLangPack = doc.child(L"language_pack");
+	for (pugi::xml_node node = nodeLangPack.child(L"string"); node; node = node.next_sibling(L"string"))
+	{
+		ids.push_back(node.attribute(L"id").value());
+		texts.push_back(node.attribute(L"text").value());
+	}
+	if (ids.size() != (size_t)StrId::Count)
+	{
+		fprintf(stderr, "%s doesn't match the generated string ids\n", path);
+		return 1;
+	}
+
+	std::map<wxString, wxString> oldPack;
+	std::vector<const wchar_t *> strings;
+	for (size_t i = 0; i < ids.size(); ++i)
+	{
+		oldPack[ids[i].c_str()] = texts[i].c_str();
+		strings.push_back(texts[i].c_str());
+	}
+
+	printf("%d strings\n", (int)ids.size());
+
+	size_t k = 0;
+	size_t count = ids.size();
+
+	report("std::map<wxString, wxString>, key from a literal", measureNs([&]() {
+		keep(oldPack[wxString(ids[k].c_str())].length());
+		k = (k + 1) % count;
+	}));
+
+	report("FindStrId and the index, id built at runtime", measureNs([&]() {
+		StrId id = FindStrId(ids[k].c_str(), ids[k].length());
+		keep(strings[(size_t)id]);
+		k = (k + 1) % count;
+	}));
+
+	report("StrId index", measureNs([&]() {
+		keep(strings[k]);
+		k = (k + 1) % count;
+	}));
+
+	return 0;
+}
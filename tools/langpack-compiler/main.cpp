@@ -0,0 +1,331 @@
+// Build-time compiler for EyeLeo language packs.
+// Usage: langpack-compiler ids <langpack.en.xml> <output dir>
+//   generates string_ids.h/.cpp: the StrId enum and a perfect hash from id names to StrId
+// Usage: langpack-compiler blob <langpack.en.xml> <langpack.xx.xml> <langpack.xx.lpk>
+//   compiles a language pack into the binary format of langpack_format.h
+
+#include "langpack_format.h"
+#include "pugixml.hpp"
+#include "string_id_hash.h"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace
+{
+	const uint32_t MAX_SEED = 1000000;
+
+	uint32_t hashId(std::wstring const & id, uint32_t seed)
+	{
+		return strIdHash(id.c_str(), id.length(), seed);
+	}
+
+	bool isIdentifier(std::wstring const & id)
+	{
+		if (id.empty() || (id[0] >= L'0' && id[0] <= L'9') || id == L"Count")
+			return false;
+		for (size_t i = 0; i < id.length(); ++i)
+		{
+			wchar_t c = id[i];
+			if (!((c >= L'a' && c <= L'z') || (c >= L'A' && c <= L'Z') || (c >= L'0' && c <= L'9') || c == L'_'))
+				return false;
+		}
+		return true;
+	}
+
+	std::string narrow(std::wstring const & id)
+	{
+		return std::string(id.begin(), id.end()); // ids are checked to be ASCII
+	}
+
+	struct LangPackXml
+	{
+		std::wstring author;
+		std::wstring contact;
+		std::vector<std::wstring> ids;
+		std::vector<std::wstring> texts;
+	};
+
+	bool readLangPack(const char * path, LangPackXml & pack)
+	{
+		pugi::xml_document doc;
+		pugi::xml_parse_result res = doc.load_file(path);
+		if (res.status != pugi::status_ok)
+		{
+			fprintf(stderr, "%s: %s\n", path, res.description());
+			return false;
+		}
+
+		pugi::xml_node nodeLangPack = doc.child(L"language_pack");
+		if (nodeLangPack.empty())
+		{
+			fprintf(stderr, "%s: no language_pack node\n", path);
+			return false;
+		}
+
+		pack.author = nodeLangPack.attribute(L"author").value();
+		pack.contact = nodeLangPack.attribute(L"contact").value();
+
+		for (pugi::xml_node node = nodeLangPack.child(L"string"); node; node = node.next_sibling(L"string"))
+		{
+			std::wstring id = node.attribute(L"id").value();
+			if (!isIdentifier(id))
+			{
+				fprintf(stderr, "%s: '%ls' can't be used as a string id\n", path, id.c_str());
+				return false;
+			}
+			if (std::find(pack.ids.begin(), pack.ids.end(), id) != pack.ids.end())
+			{
+				fprintf(stderr, "%s: duplicate string id '%ls'\n", path, id.c_str());
+				return false;
+			}
+			pack.ids.push_back(id);
+			pack.texts.push_back(node.attribute(L"text").value());
+		}
+
+		if (pack.ids.empty())
+		{
+			fprintf(stderr, "%s: no strings\n", path);
+			return false;
+		}
+		return true;
+	}
+
+	// Identifies the set of StrId values, must match STRING_IDS_HASH of the application
+	uint32_t hashIds(std::vector<std::wstring> const & ids)
+	{
+		uint32_t hash = 0;
+		for (size_t i = 0; i < ids.size(); ++i)
+			hash = hashId(ids[i], hash);
+		return hash;
+	}
+
+	// Hash and displace: keys are spread into buckets by the seed 0 hash. Every bucket with
+	// several keys gets a seed that puts all of them into free slots, single keys take the
+	// remaining slots directly (stored as -(slot + 1)).
+	bool buildPerfectHash(std::vector<std::wstring> const & ids, std::vector<int32_t> & displacements, std::vector<uint16_t> & slots)
+	{
+		size_t count = ids.size();
+		std::vector<std::vector<size_t> > buckets(count);
+		for (size_t i = 0; i < count; ++i)
+			buckets[hashId(ids[i], 0) % count].push_back(i);
+
+		std::vector<size_t> order(count);
+		for (size_t i = 0; i < count; ++i)
+			order[i] = i;
+		std::stable_sort(order.begin(), order.end(), [&buckets](size_t a, size_t b) {
+			return buckets[a].size() > buckets[b].size();
+		});
+
+		displacements.assign(count, 0);
+		std::vector<bool> used(count, false);
+		slots.assign(count, 0);
+
+		size_t next = 0;
+		for (; next < count && buckets[order[next]].size() > 1; ++next)
+		{
+			std::vector<size_t> const & bucket = buckets[order[next]];
+			std::vector<size_t> taken;
+
+			uint32_t seed = 1;
+			for (; seed < MAX_SEED; ++seed)
+			{
+				taken.clear();
+				for (size_t i = 0; i < bucket.size(); ++i)
+				{
+					size_t slot = hashId(ids[bucket[i]], seed) % count;
+					if (used[slot] || std::find(taken.begin(), taken.end(), slot) != taken.end())
+						break;
+					taken.push_back(slot);
+				}
+				if (taken.size() == bucket.size())
+					break;
+			}
+			if (seed == MAX_SEED)
+				return false;
+
+			displacements[order[next]] = (int32_t)seed;
+			for (size_t i = 0; i < bucket.size(); ++i)
+			{
+				used[taken[i]] = true;
+				slots[taken[i]] = (uint16_t)bucket[i];
+			}
+		}
+
+		size_t freeSlot = 0;
+		for (; next < count && !buckets[order[next]].empty(); ++next)
+		{
+			while (used[freeSlot])
+				++freeSlot;
+			used[freeSlot] = true;
+			slots[freeSlot] = (uint16_t)buckets[order[next]][0];
+			displacements[order[next]] = -(int32_t)freeSlot - 1;
+		}
+		return true;
+	}
+
+	bool writeFile(std::string const & path, std::string const & text)
+	{
+		FILE * file = fopen(path.c_str(), "wb");
+		if (!file)
+		{
+			fprintf(stderr, "can't write %s\n", path.c_str());
+			return false;
+		}
+		bool ok = fwrite(text.data(), 1, text.size(), file) == text.size();
+		return fclose(file) == 0 && ok;
+	}
+
+	int compileIds(const char * langPackPath, std::string const & outDir)
+	{
+		LangPackXml english;
+		if (!readLangPack(langPackPath, english))
+			return 1;
+
+		std::vector<std::wstring> const & ids = english.ids;
+
+		if (ids.size() > 0xFFFF)
+		{
+			fprintf(stderr, "%s: too many strings\n", langPackPath);
+			return 1;
+		}
+
+		std::vector<int32_t> displacements;
+		std::vector<uint16_t> slots;
+		if (!buildPerfectHash(ids, displacements, slots))
+		{
+			fprintf(stderr, "%s: can't build a perfect hash\n", langPackPath);
+			return 1;
+		}
+
+		const char * banner = "// Generated by langpack-compiler from langpack.en.xml, don't edit.\n\n";
+
+		std::string header = banner;
+		header += "#ifndef STRING_IDS_H\n#define STRING_IDS_H\n\n";
+		header += "#include <stddef.h>\n#include <stdint.h>\n\n";
+		char idsHash[16];
+		snprintf(idsHash, sizeof(idsHash), "0x%08X", hashIds(ids));
+		header += "const uint32_t STRING_IDS_HASH = " + std::string(idsHash) + "u;\n\n";
+		header += "enum class StrId : uint16_t\n{\n";
+		for (size_t i = 0; i < ids.size(); ++i)
+			header += "\t" + narrow(ids[i]) + ",\n";
+		header += "\n\tCount\n};\n\n";
+		header += "// StrId::Count when there is no string with that name\n";
+		header += "StrId FindStrId(const wchar_t * name, size_t length);\n";
+		header += "const wchar_t * GetStrIdName(StrId id);\n\n";
+		header += "#endif\n";
+
+		std::string source = banner;
+		source += "#include \"string_ids.h\"\n#include \"string_id_hash.h\"\n#include <wchar.h>\n\n";
+		source += "namespace\n{\n";
+		source += "\tconst uint32_t STRING_COUNT = " + std::to_string(ids.size()) + ";\n\n";
+		source += "\tconst wchar_t * names[STRING_COUNT] = {\n";
+		for (size_t i = 0; i < ids.size(); ++i)
+			source += "\t\tL\"" + narrow(ids[i]) + (i + 1 < ids.size() ? "\",\n" : "\"\n");
+		source += "\t};\n\n";
+		source += "\tconst int32_t displacements[STRING_COUNT] = {";
+		for (size_t i = 0; i < displacements.size(); ++i)
+			source += (i % 16 == 0 ? "\n\t\t" : " ") + std::to_string(displacements[i]) + (i + 1 < displacements.size() ? "," : "");
+		source += "\n\t};\n\n";
+		source += "\tconst uint16_t slots[STRING_COUNT] = {";
+		for (size_t i = 0; i < slots.size(); ++i)
+			source += (i % 16 == 0 ? "\n\t\t" : " ") + std::to_string(slots[i]) + (i + 1 < slots.size() ? "," : "");
+		source += "\n\t};\n}\n\n";
+		source +=
+			"StrId FindStrId(const wchar_t * name, size_t length)\n"
+			"{\n"
+			"\tint32_t displacement = displacements[strIdHash(name, length, 0) % STRING_COUNT];\n"
+			"\tuint32_t slot = displacement < 0 ? uint32_t(-displacement - 1) : strIdHash(name, length, displacement) % STRING_COUNT;\n"
+			"\n"
+			"\tconst wchar_t * candidate = names[slots[slot]];\n"
+			"\tif (wcsncmp(candidate, name, length) != 0 || candidate[length] != 0)\n"
+			"\t\treturn StrId::Count;\n"
+			"\treturn StrId(slots[slot]);\n"
+			"}\n"
+			"\n"
+			"const wchar_t * GetStrIdName(StrId id)\n"
+			"{\n"
+			"\treturn id < StrId::Count ? names[(size_t)id] : L\"\";\n"
+			"}\n";
+
+		if (!writeFile(outDir + "/string_ids.h", header) || !writeFile(outDir + "/string_ids.cpp", source))
+			return 1;
+		return 0;
+	}
+
+	uint32_t appendToPool(std::vector<wchar_t> & pool, std::wstring text)
+	{
+		for (size_t pos = text.find(L"{n}"); pos != std::wstring::npos; pos = text.find(L"{n}", pos + 1))
+			text.replace(pos, 3, L"\n");
+
+		uint32_t offset = (uint32_t)pool.size();
+		pool.insert(pool.end(), text.begin(), text.end());
+		pool.push_back(0);
+		return offset;
+	}
+
+	int compileBlob(const char * englishPath, const char * langPackPath, const char * outPath)
+	{
+		LangPackXml english;
+		LangPackXml pack;
+		if (!readLangPack(englishPath, english) || !readLangPack(langPackPath, pack))
+			return 1;
+
+		std::vector<wchar_t> pool;
+		pool.push_back(0); // empty string
+
+		langpackformat::Header header;
+		memset(&header, 0, sizeof(header));
+		header.magic = langpackformat::kMagic;
+		header.version = langpackformat::kVersion;
+		header.charSize = sizeof(wchar_t);
+		header.idsHash = hashIds(english.ids);
+		header.stringCount = (uint32_t)english.ids.size();
+		header.author = appendToPool(pool, pack.author);
+		header.contact = appendToPool(pool, pack.contact);
+
+		// strings the pack misses are taken from English
+		std::vector<uint32_t> entries(english.ids.size());
+		for (size_t i = 0; i < english.ids.size(); ++i)
+		{
+			std::vector<std::wstring>::const_iterator it = std::find(pack.ids.begin(), pack.ids.end(), english.ids[i]);
+			if (it != pack.ids.end())
+				entries[i] = appendToPool(pool, pack.texts[it - pack.ids.begin()]) | langpackformat::ENTRY_OWN;
+			else
+				entries[i] = appendToPool(pool, english.texts[i]);
+		}
+
+		for (size_t i = 0; i < pack.ids.size(); ++i)
+		{
+			if (std::find(english.ids.begin(), english.ids.end(), pack.ids[i]) == english.ids.end())
+				fprintf(stderr, "%s: warning: '%ls' isn't in the English pack and is skipped\n", langPackPath, pack.ids[i].c_str());
+		}
+
+		header.poolSize = (uint32_t)pool.size();
+
+		std::string blob((const char *)&header, sizeof(header));
+		blob.append((const char *)&entries[0], entries.size() * sizeof(uint32_t));
+		blob.append((const char *)&pool[0], pool.size() * sizeof(wchar_t));
+		return writeFile(outPath, blob) ? 0 : 1;
+	}
+
+	void printUsage()
+	{
+		fprintf(stderr,
+			"Usage: langpack-compiler ids <langpack.en.xml> <output dir>\n"
+			"       langpack-compiler blob <langpack.en.xml> <langpack.xx.xml> <langpack.xx.lpk>\n");
+	}
+}
+
+int main(int argc, char ** argv)
+{
+	if (argc == 4 && strcmp(argv[1], "ids") == 0)
+		return compileIds(argv[2], argv[3]);
+	if (argc == 5 && strcmp(argv[1], "blob") == 0)
+		return compileBlob(argv[2], argv[3], argv[4]);
+
+	printUsage();
+	return 2;
+}
@@ -0,0 +1,207 @@
+#include "log_decoder.h"
+#include <stdio.h>
+#include <string.h>
+#include <map>
+
+namespace
+{
+	class Reader
+	{
+	public:
+		Reader(std::vector<char> const & data) : _data(data), _pos(0) {}
+
+		bool eof() const { return _pos >= _data.size(); }
+
+		template <typename T>
+		bool read(T & value)
+		{
+			if (_data.size() - _pos < sizeof(T))
+				return false;
+			memcpy(&value, &_data[_pos], sizeof(T));
+			_pos += sizeof(T);
+			return true;
+		}
+
+		bool readString(std::string & str)
+		{
+			uint16_t len = 0;
+			if (!read(len) || _data.size() - _pos < len)
+				return false;
+			str.assign(&_data[_pos], len);
+			_pos += len;
+			return true;
+		}
+
+	private:
+		std::vector<char> const & _data;
+		size_t _pos;
+	};
+
+	std::string argToString(Arg const & arg)
+	{
+		char buf[64];
+		switch (arg.type)
+		{
+		case logformat::ARG_INT: snprintf(buf, sizeof(buf), "%lld", (long long)arg.i); return buf;
+		case logformat::ARG_UINT: snprintf(buf, sizeof(buf), "%llu", (unsigned long long)arg.u); return buf;
+		case logformat::ARG_DOUBLE: snprintf(buf, sizeof(buf), "%g", arg.d); return buf;
+		case logformat::ARG_STRING: return arg.s;
+		}
+		return "?";
+	}
+}
+
+std::string formatMessage(std::string const & fmt, std::vector<Arg> const & args)
+{
+	std::string out;
+	size_t argInd = 0;
+
+	for (size_t i = 0; i < fmt.size(); ++i)
+	{
+		if (fmt[i] != '%')
+		{
+			out += fmt[i];
+			continue;
+		}
+
+		if (i + 1 < fmt.size() && fmt[i + 1] == '%')
+		{
+			out += '%';
+			++i;
+			continue;
+		}
+
+		std::string spec = "%";
+		size_t j = i + 1;
+		while (j < fmt.size() && strchr("-+ #0", fmt[j]))
+			spec += fmt[j++];
+		while (j < fmt.size() && ((fmt[j] >= '0' && fmt[j] <= '9') || fmt[j] == '.'))
+			spec += fmt[j++];
+		while (j < fmt.size() && strchr("hlLqjztI364", fmt[j]))
+			++j;
+		if (j >= fmt.size())
+		{
+			out += fmt.substr(i);
+			break;
+		}
+
+		char conv = fmt[j];
+		i = j;
+
+		if (argInd >= args.size())
+		{
+			out += "<missing>";
+			continue;
+		}
+		Arg const & arg = args[argInd++];
+
+		char buf[256];
+		if (strchr("di", conv) && arg.type != logformat::ARG_STRING && arg.type != logformat::ARG_DOUBLE)
+		{
+			snprintf(buf, sizeof(buf), (spec + "lld").c_str(), arg.type == logformat::ARG_INT ? (long long)arg.i : (long long)arg.u);
+			out += buf;
+		}
+		else if (strchr("uxXoc", conv) && arg.type != logformat::ARG_STRING && arg.type != logformat::ARG_DOUBLE)
+		{
+			if (conv == 'c')
+				snprintf(buf, sizeof(buf), (spec + "c").c_str(), (int)arg.i);
+			else
+				snprintf(buf, sizeof(buf), (spec + "ll" + conv).c_str(), arg.type == logformat::ARG_INT ? (unsigned long long)arg.i : (unsigned long long)arg.u);
+			out += buf;
+		}
+		else if (conv == 'p' && arg.type == logformat::ARG_UINT)
+		{
+			snprintf(buf, sizeof(buf), "0x%llx", (unsigned long long)arg.u);
+			out += buf;
+		}
+		else if (strchr("fFeEgG", conv) && arg.type == logformat::ARG_DOUBLE)
+		{
+			snprintf(buf, sizeof(buf), (spec + conv).c_str(), arg.d);
+			out += buf;
+		}
+		else
+		{
+			// %s or a format/type mismatch: print the value as is
+			out += argToString(arg);
+		}
+	}
+
+	return out;
+}
+
+
+DecodeResult decodeLog(std::vector<char> const & data, LogVisitor & visitor)
+{
+	Reader reader(data);
+	std::map<uint16_t, Site> sites;
+
+	while (!reader.eof())
+	{
+		uint8_t kind = 0;
+		reader.read(kind);
+
+		if (kind == logformat::RECORD_SESSION)
+		{
+			uint32_t magic = 0;
+			uint16_t version = 0;
+			int64_t startTime = 0;
+			if (!reader.read(magic) || !reader.read(version) || !reader.read(startTime))
+				break;
+			if (magic != logformat::kMagic || version != logformat::kVersion)
+				return DECODE_UNSUPPORTED_VERSION;
+			sites.clear();
+			visitor.OnSession(startTime);
+		}
+		else if (kind == logformat::RECORD_SITE)
+		{
+			uint16_t id = 0;
+			uint8_t level = 0;
+			uint32_t line = 0;
+			Site site;
+			if (!reader.read(id) || !reader.read(level) || !reader.read(line) ||
+				!reader.readString(site.file) || !reader.readString(site.fmt))
+				break;
+			site.level = level;
+			site.line = line;
+			sites[id] = site;
+		}
+		else if (kind == logformat::RECORD_ENTRY)
+		{
+			uint16_t id = 0;
+			int64_t time = 0;
+			uint8_t count = 0;
+			if (!reader.read(id) || !reader.read(time) || !reader.read(count))
+				break;
+
+			std::vector<Arg> args(count);
+			bool ok = true;
+			for (uint8_t a = 0; a < count && ok; ++a)
+			{
+				uint8_t type = 0;
+				ok = reader.read(type);
+				args[a].type = type;
+				if (type == logformat::ARG_INT)
+					ok = ok && reader.read(args[a].i);
+				else if (type == logformat::ARG_UINT)
+					ok = ok && reader.read(args[a].u);
+				else if (type == logformat::ARG_DOUBLE)
+					ok = ok && reader.read(args[a].d);
+				else if (type == logformat::ARG_STRING)
+					ok = ok && reader.readString(args[a].s);
+				else
+					ok = false;
+			}
+			if (!ok)
+				break;
+
+			std::map<uint16_t, Site>::const_iterator it = sites.find(id);
+			visitor.OnEntry(time, id, it != sites.end() ? &it->second : 0, args);
+		}
+		else
+		{
+			return DECODE_CORRUPTED;
+		}
+	}
+
+	return DECODE_OK;
+}
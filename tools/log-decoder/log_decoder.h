@@ -0,0 +1,48 @@
+#ifndef LOG_DECODER_H
+#define LOG_DECODER_H
+
+#include "log_format.h"
+#include <string>
+#include <vector>
+
+struct Site
+{
+	int level;
+	unsigned int line;
+	std::string file;
+	std::string fmt;
+};
+
+struct Arg
+{
+	int type;
+	int64_t i;
+	uint64_t u;
+	double d;
+	std::string s;
+};
+
+// Receives the records of a log in the order they were written
+class LogVisitor
+{
+public:
+	virtual ~LogVisitor() {}
+	virtual void OnSession(int64_t startTime) = 0;
+	// site is 0 when the entry refers to a site that wasn't recorded
+	virtual void OnEntry(int64_t time, uint16_t siteId, Site const * site, std::vector<Arg> const & args) = 0;
+};
+
+enum DecodeResult
+{
+	DECODE_OK, // a truncated last record is ignored, the process may have died while writing it
+	DECODE_UNSUPPORTED_VERSION,
+	DECODE_CORRUPTED
+};
+
+DecodeResult decodeLog(std::vector<char> const & data, LogVisitor & visitor);
+
+// Applies a printf-style format to the decoded arguments. Length modifiers are ignored:
+// integers are always stored as 64-bit values.
+std::string formatMessage(std::string const & fmt, std::vector<Arg> const & args);
+
+#endif
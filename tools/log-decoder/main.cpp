@@ -0,0 +1,85 @@
+// Converts EyeLeo binary log (log.bin) into text.
+// Usage: log-decoder [log.bin]
+
+#include "log_decoder.h"
+#include <stdio.h>
+#include <time.h>
+
+static const char * levelName(int level)
+{
+	switch (level)
+	{
+	case logformat::LEVEL_DEBUG: return "DEBUG";
+	case logformat::LEVEL_INFO: return "INFO ";
+	case logformat::LEVEL_WARNING: return "WARN ";
+	case logformat::LEVEL_ERROR: return "ERROR";
+	}
+	return "?    ";
+}
+
+static std::string formatTime(int64_t ms)
+{
+	time_t secs = (time_t)(ms / 1000);
+	struct tm * t = localtime(&secs);
+	char buf[64];
+	if (!t)
+		return "?";
+	snprintf(buf, sizeof(buf), "%04d-%02d-%02d %02d:%02d:%02d.%03d",
+		t->tm_year + 1900, t->tm_mon + 1, t->tm_mday, t->tm_hour, t->tm_min, t->tm_sec, (int)(ms % 1000));
+	return buf;
+}
+
+class Printer : public LogVisitor
+{
+public:
+	virtual void OnSession(int64_t startTime)
+	{
+		printf("==== session started %s ====\n", formatTime(startTime).c_str());
+	}
+
+	virtual void OnEntry(int64_t time, uint16_t siteId, Site const * site, std::vector<Arg> const & args)
+	{
+		if (!site)
+		{
+			printf("%s ?     <unknown site %u>\n", formatTime(time).c_str(), (unsigned)siteId);
+			return;
+		}
+
+		printf("%s %s %s:%u %s\n", formatTime(time).c_str(), levelName(site->level),
+			site->file.c_str(), site->line, formatMessage(site->fmt, args).c_str());
+	}
+};
+
+int main(int argc, char ** argv)
+{
+	const char * path = argc > 1 ? argv[1] : "log.bin";
+
+	FILE * file = fopen(path, "rb");
+	if (!file)
+	{
+		fprintf(stderr, "Can't open %s\n", path);
+		return 1;
+	}
+
+	std::vector<char> data;
+	char chunk[64 * 1024];
+	size_t got;
+	while ((got = fread(chunk, 1, sizeof(chunk), file)) > 0)
+		data.insert(data.end(), chunk, chunk + got);
+	fclose(file);
+
+	Printer printer;
+	DecodeResult result = decodeLog(data, printer);
+	if (result == DECODE_UNSUPPORTED_VERSION)
+	{
+		fprintf(stderr, "Unsupported log version\n");
+		return 1;
+	}
+	if (result == DECODE_CORRUPTED)
+	{
+		fprintf(stderr, "Corrupted record, stopping\n");
+		return 1;
+	}
+
+	return 0;
+}
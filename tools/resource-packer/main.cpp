@@ -0,0 +1,231 @@
+// Build-time packer for EyeLeo images.
+// Usage: resource-packer <resources.pak> <root dir> <image>...
+//   decodes every .png and every image of every .ico into the format of resource_format.h
+//   along with its window shape, images are named by their path relative to the root dir
+
+#include "pixel_kernels.h"
+#include "resource_format.h"
+#include "wx/init.h"
+#include "wx/image.h"
+#include "wx/log.h"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace
+{
+	struct PackedImage
+	{
+		std::string name;
+		int order; // position in the .ico
+		resourceformat::Entry entry;
+		std::vector<resourceformat::Span> shape;
+		std::string pixels;
+	};
+
+	std::string relativeName(std::string path, std::string root)
+	{
+		std::replace(path.begin(), path.end(), '\\', '/');
+		std::replace(root.begin(), root.end(), '\\', '/');
+		if (!root.empty() && root[root.size() - 1] != '/')
+			root += '/';
+		if (path.compare(0, root.size(), root) == 0)
+			return path.substr(root.size());
+		return path;
+	}
+
+	bool hasExtension(std::string const & path, const char * ext)
+	{
+		size_t len = strlen(ext);
+		if (path.size() < len)
+			return false;
+		for (size_t i = 0; i < len; ++i)
+		{
+			char c = path[path.size() - len + i];
+			if (c >= 'A' && c <= 'Z')
+				c = c - 'A' + 'a';
+			if (c != ext[i])
+				return false;
+		}
+		return true;
+	}
+
+	bool packImage(wxImage & image, PackedImage & packed)
+	{
+		if (image.GetWidth() > 0xFFFF || image.GetHeight() > 0xFFFF)
+			return false;
+
+		memset(&packed.entry, 0, sizeof(packed.entry));
+		packed.entry.width = (uint16_t)image.GetWidth();
+		packed.entry.height = (uint16_t)image.GetHeight();
+
+		resourceformat::FindShapeSpans(image.GetData(), image.GetWidth(), image.GetHeight(), packed.shape);
+
+		// a mask colour becomes transparency as well
+		if (!image.HasAlpha() && image.HasMask())
+			image.InitAlpha();
+		if (image.HasAlpha())
+			packed.entry.flags |= resourceformat::FLAG_ALPHA;
+
+		size_t count = (size_t)image.GetWidth() * image.GetHeight();
+		const unsigned char * rgb = image.GetData();
+		const unsigned char * alpha = image.GetAlpha();
+
+		std::vector<uint32_t> bgra(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			uint32_t a = alpha ? alpha[i] : 255;
+			bgra[i] = (a << 24) | (rgb[i * 3 + 0] << 16) | (rgb[i * 3 + 1] << 8) | rgb[i * 3 + 2];
+		}
+		if (alpha)
+			pixelkernels::Premultiply(&bgra[0], count);
+
+		// the archive is little-endian like the x86 targets
+		packed.pixels.assign((const char *)&bgra[0], count * 4);
+		return true;
+	}
+
+	bool loadImages(const char * path, std::string const & name, std::vector<PackedImage> & images)
+	{
+		wxBitmapType type = hasExtension(path, ".ico") ? wxBITMAP_TYPE_ICO : wxBITMAP_TYPE_PNG;
+		wxString filename = wxString::FromUTF8(path);
+
+		int count = type == wxBITMAP_TYPE_ICO ? wxImage::GetImageCount(filename, type) : 1;
+		if (count <= 0)
+		{
+			fprintf(stderr, "%s: no images\n", path);
+			return false;
+		}
+
+		for (int index = 0; index < count; ++index)
+		{
+			wxImage image;
+			if (!image.LoadFile(filename, type, index) || !image.IsOk())
+			{
+				fprintf(stderr, "%s: can't decode image %d\n", path, index);
+				return false;
+			}
+
+			PackedImage packed;
+			packed.name = name;
+			packed.order = index;
+			if (!packImage(image, packed))
+			{
+				fprintf(stderr, "%s: image %d is too large\n", path, index);
+				return false;
+			}
+			images.push_back(packed);
+		}
+		return true;
+	}
+
+	bool writeFile(std::string const & path, std::string const & data)
+	{
+		FILE * file = fopen(path.c_str(), "wb");
+		if (!file)
+		{
+			fprintf(stderr, "can't write %s\n", path.c_str());
+			return false;
+		}
+		bool ok = fwrite(data.data(), 1, data.size(), file) == data.size();
+		return fclose(file) == 0 && ok;
+	}
+
+	void align(std::string & data)
+	{
+		while (data.size() % resourceformat::PIXEL_ALIGN)
+			data += '\0';
+	}
+
+	int pack(const char * outPath, const char * root, int count, char ** paths)
+	{
+		std::vector<PackedImage> images;
+		for (int i = 0; i < count; ++i)
+		{
+			std::string name = relativeName(paths[i], root);
+			if (!loadImages(paths[i], name, images))
+				return 1;
+		}
+
+		std::stable_sort(images.begin(), images.end(), [](PackedImage const & a, PackedImage const & b) {
+			int cmp = strcmp(a.name.c_str(), b.name.c_str());
+			return cmp < 0 || (cmp == 0 && a.order < b.order);
+		});
+
+		resourceformat::Header header;
+		memset(&header, 0, sizeof(header));
+		header.magic = resourceformat::kMagic;
+		header.version = resourceformat::kVersion;
+		header.entryCount = (uint32_t)images.size();
+		header.names = (uint32_t)(sizeof(header) + images.size() * sizeof(resourceformat::Entry));
+
+		std::string names;
+		for (size_t i = 0; i < images.size(); ++i)
+		{
+			if (i > 0 && images[i].name == images[i - 1].name)
+			{
+				images[i].entry.name = images[i - 1].entry.name;
+				continue;
+			}
+			images[i].entry.name = header.names + (uint32_t)names.size();
+			names.append(images[i].name.c_str(), images[i].name.size() + 1);
+		}
+		header.namesSize = (uint32_t)names.size();
+
+		// entries are filled in once the pixel offsets are known
+		std::string data((const char *)&header, sizeof(header));
+		data.append(images.size() * sizeof(resourceformat::Entry), '\0');
+		data += names;
+		align(data);
+		for (size_t i = 0; i < images.size(); ++i)
+		{
+			images[i].entry.shape = (uint32_t)data.size();
+			images[i].entry.shapeCount = (uint32_t)images[i].shape.size();
+			if (!images[i].shape.empty())
+				data.append((const char *)&images[i].shape[0], images[i].shape.size() * sizeof(resourceformat::Span));
+		}
+		align(data);
+		for (size_t i = 0; i < images.size(); ++i)
+		{
+			if ((uint64_t)data.size() + images[i].pixels.size() > 0xFFFFFFFF)
+			{
+				fprintf(stderr, "%s: the archive would be larger than 4 GB\n", outPath);
+				return 1;
+			}
+			images[i].entry.pixels = (uint32_t)data.size();
+			data += images[i].pixels;
+			align(data);
+		}
+
+		for (size_t i = 0; i < images.size(); ++i)
+			memcpy(&data[sizeof(header) + i * sizeof(resourceformat::Entry)], &images[i].entry, sizeof(resourceformat::Entry));
+		return writeFile(outPath, data) ? 0 : 1;
+	}
+
+	void printUsage()
+	{
+		fprintf(stderr, "Usage: resource-packer <resources.pak> <root dir> <image>...\n");
+	}
+}
+
+int main(int argc, char ** argv)
+{
+	if (argc < 4)
+	{
+		printUsage();
+		return 2;
+	}
+
+	wxInitializer initializer;
+	if (!initializer)
+	{
+		fprintf(stderr, "can't initialize wxWidgets\n");
+		return 1;
+	}
+	wxLog::EnableLogging(false); // decoding errors are reported by the packer
+	wxInitAllImageHandlers();
+
+	return pack(argv[1], argv[2], argc - 3, argv + 3);
+}